@@ -0,0 +1,236 @@
+/**
+ * Time-to-confirm of reliable `FlightCommand` delivery over a lossy link.
+ *
+ * The ground station queues a `SetPidGains` command every 250 ms through the ARQ
+ * sender. The vehicle decodes each uplink frame, filters duplicates with the ARQ
+ * receiver and streams `Downlink` telemetry at 50 Hz with the acknowledgement
+ * piggybacked. Both directions lose whole frames independently with the same
+ * probability and delay the rest by a fixed one-way latency.
+ *
+ * Output is CSV:
+ *
+ *     loss,commands,confirmed,expired,mean_ms,p50_ms,p99_ms,max_ms,tx_per_command,duplicates
+ *
+ * Times are measured from queuing a command to the ground receiving its
+ * acknowledgement.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "channel.h"
+#include "rp/arq/arq.h"
+#include "rp/codec.h"
+#include "tvr/command.pb.h"
+#include "tvr/downlink.pb.h"
+
+#define COMMAND_COUNT (2000)
+#define COMMAND_PERIOD_MS (250)
+#define DOWNLINK_PERIOD_MS (20)
+#define ONE_WAY_DELAY_MS (15)
+#define DELAY_LINE_SIZE (64)
+
+typedef struct in_flight_frame {
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    size_t size;
+    uint32_t arrival_ms;
+} in_flight_frame_t;
+
+/**
+ * Fixed latency link, frames arrive in the order they were sent.
+ */
+typedef struct delay_line {
+    in_flight_frame_t frames[DELAY_LINE_SIZE];
+    size_t head;
+    size_t count;
+} delay_line_t;
+
+static const double loss_rates[] = {0.0, 0.01, 0.05, 0.1, 0.2, 0.3, 0.4, 0.5};
+
+static rp_arq_sender_t sender;
+static rp_arq_receiver_t receiver;
+static delay_line_t uplink;
+static delay_line_t downlink;
+static uint32_t confirm_times_ms[COMMAND_COUNT];
+
+static void delay_line_send(delay_line_t *line, bench_rng_t *rng, double loss,
+                            const uint8_t *frame, size_t size, uint32_t now_ms)
+{
+    if (channel_drop(rng, loss) || line->count == DELAY_LINE_SIZE) {
+        return;
+    }
+
+    in_flight_frame_t *slot = &line->frames[(line->head + line->count) % DELAY_LINE_SIZE];
+
+    memcpy(slot->frame, frame, size);
+    slot->size = size;
+    slot->arrival_ms = now_ms + ONE_WAY_DELAY_MS;
+
+    line->count++;
+}
+
+static const in_flight_frame_t *delay_line_receive(delay_line_t *line, uint32_t now_ms)
+{
+    if (line->count == 0 || line->frames[line->head].arrival_ms > now_ms) {
+        return NULL;
+    }
+
+    const in_flight_frame_t *frame = &line->frames[line->head];
+
+    line->head = (line->head + 1) % DELAY_LINE_SIZE;
+    line->count--;
+
+    return frame;
+}
+
+static bool queue_command(uint32_t index, uint32_t now_ms)
+{
+    rp_arq_entry_t *entry = rp_arq_sender_reserve(&sender);
+
+    if (entry == NULL) {
+        return false;
+    }
+
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    command.command_id = entry->command_id;
+    command.which_payload = tvr_FlightCommand_set_pid_gains_tag;
+    command.payload.set_pid_gains.z_kp = 1.0f + (float)index * 0.001f;
+    command.payload.set_pid_gains.z_ki = 0.1f;
+    command.payload.set_pid_gains.z_kd = 0.4f;
+
+    rp_packet_encode_result_t encoded =
+        rp_packet_encode(entry->frame, sizeof(entry->frame), tvr_FlightCommand_fields, &command);
+
+    if (encoded.status != RP_CODEC_OK) {
+        rp_arq_sender_cancel(&sender, entry);
+        return false;
+    }
+
+    return rp_arq_sender_commit(&sender, entry, encoded.written, now_ms) == RP_ARQ_OK;
+}
+
+static void send_downlink(bench_rng_t *rng, double loss, uint32_t now_ms)
+{
+    tvr_Downlink message = tvr_Downlink_init_zero;
+    rp_arq_ack_t ack;
+
+    message.which_payload = tvr_Downlink_telemetry_tag;
+    message.payload.telemetry.timestamp_ms = now_ms;
+    message.payload.telemetry.flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    message.payload.telemetry.thrust_cmd = 14.2f;
+
+    if (rp_arq_receiver_take_ack(&receiver, &ack)) {
+        message.has_ack = true;
+        message.ack.latest_id = ack.latest_id;
+        message.ack.history = ack.history;
+    }
+
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encoded =
+        rp_packet_encode(frame, sizeof(frame), tvr_Downlink_fields, &message);
+
+    if (encoded.status == RP_CODEC_OK) {
+        delay_line_send(&downlink, rng, loss, frame, encoded.written, now_ms);
+    }
+}
+
+static void run(double loss)
+{
+    bench_rng_t rng = {.state = 0xD1B54A32D192ED03ULL};
+    size_t confirmed = 0;
+    uint32_t queued = 0;
+    uint32_t next_command_ms = 0;
+
+    rp_arq_sender_init(&sender, NULL, 1);
+    rp_arq_receiver_init(&receiver);
+    memset(&uplink, 0, sizeof(uplink));
+    memset(&downlink, 0, sizeof(downlink));
+
+    for (uint32_t now_ms = 0; queued < COMMAND_COUNT || rp_arq_sender_in_flight(&sender) > 0;
+         now_ms++) {
+        // Ground: queue, (re)transmit
+        if (queued < COMMAND_COUNT && now_ms >= next_command_ms && queue_command(queued, now_ms)) {
+            queued++;
+            next_command_ms = now_ms + COMMAND_PERIOD_MS;
+        }
+
+        const rp_arq_entry_t *entry;
+
+        while ((entry = rp_arq_sender_poll(&sender, now_ms)) != NULL) {
+            delay_line_send(&uplink, &rng, loss, entry->frame, entry->size, now_ms);
+        }
+
+        // Vehicle: execute new commands, stream telemetry with acknowledgements
+        const in_flight_frame_t *frame;
+
+        while ((frame = delay_line_receive(&uplink, now_ms)) != NULL) {
+            tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(frame->frame, frame->size, tvr_FlightCommand_fields, &command);
+
+            if (decoded.status == RP_CODEC_OK) {
+                rp_arq_receiver_accept(&receiver, command.command_id);
+            }
+        }
+
+        if (now_ms % DOWNLINK_PERIOD_MS == 0) {
+            send_downlink(&rng, loss, now_ms);
+        }
+
+        // Ground: match acknowledgements
+        while ((frame = delay_line_receive(&downlink, now_ms)) != NULL) {
+            tvr_Downlink message = tvr_Downlink_init_zero;
+
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(frame->frame, frame->size, tvr_Downlink_fields, &message);
+
+            if (decoded.status != RP_CODEC_OK || !message.has_ack) {
+                continue;
+            }
+
+            rp_arq_ack_t ack = {.latest_id = message.ack.latest_id,
+                                .history = message.ack.history};
+            rp_arq_confirmation_t confirmations[RP_ARQ_WINDOW_SIZE];
+
+            size_t count =
+                rp_arq_sender_on_ack(&sender, &ack, now_ms, confirmations, RP_ARQ_WINDOW_SIZE);
+
+            for (size_t i = 0; i < count && confirmed < COMMAND_COUNT; i++) {
+                confirm_times_ms[confirmed++] = confirmations[i].elapsed_ms;
+            }
+        }
+    }
+
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < confirmed; i++) {
+        sum += confirm_times_ms[i];
+    }
+
+    double mean = confirmed > 0 ? (double)sum / (double)confirmed : 0.0;
+    uint32_t p50 = bench_percentile_u32(confirm_times_ms, confirmed, 50.0);
+    uint32_t p99 = bench_percentile_u32(confirm_times_ms, confirmed, 99.0);
+    uint32_t max = confirmed > 0 ? confirm_times_ms[confirmed - 1] : 0;
+
+    printf("%g,%u,%u,%u,%.1f,%u,%u,%u,%.3f,%u\n", loss, (unsigned)queued, (unsigned)confirmed,
+           (unsigned)sender.expired, mean, (unsigned)p50, (unsigned)p99, (unsigned)max,
+           (double)sender.transmissions / (double)queued, (unsigned)receiver.duplicates);
+}
+
+int main(void)
+{
+    printf("loss,commands,confirmed,expired,mean_ms,p50_ms,p99_ms,max_ms,tx_per_command,"
+           "duplicates\n");
+
+    for (size_t l = 0; l < sizeof(loss_rates) / sizeof(loss_rates[0]); l++) {
+        run(loss_rates[l]);
+    }
+
+    return 0;
+}
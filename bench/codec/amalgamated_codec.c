@@ -0,0 +1,30 @@
+/**
+ * The frame pipeline built from `rp_protocol_all.h` for `bench_codec_amalgamation`. Kept in
+ * its own translation unit, as the single header defines the same names as the libraries
+ * the benchmark also links.
+ */
+
+#include "rp_protocol_all.h"
+
+rp_packet_encode_result_t amalgamated_packet_encode(uint8_t *packet, size_t packet_capacity,
+                                                    const pb_msgdesc_t *fields,
+                                                    const void *message,
+                                                    const rp_codec_options_t *options);
+rp_packet_decode_result_t amalgamated_packet_decode(const uint8_t *packet, size_t packet_size,
+                                                    const pb_msgdesc_t *fields, void *message,
+                                                    const rp_codec_options_t *options);
+
+rp_packet_encode_result_t amalgamated_packet_encode(uint8_t *packet, size_t packet_capacity,
+                                                    const pb_msgdesc_t *fields,
+                                                    const void *message,
+                                                    const rp_codec_options_t *options)
+{
+    return rp_packet_encode_with_options(packet, packet_capacity, fields, message, options);
+}
+
+rp_packet_decode_result_t amalgamated_packet_decode(const uint8_t *packet, size_t packet_size,
+                                                    const pb_msgdesc_t *fields, void *message,
+                                                    const rp_codec_options_t *options)
+{
+    return rp_packet_decode_with_options(packet, packet_size, fields, message, options);
+}
@@ -0,0 +1,173 @@
+/**
+ * Frame encode and decode through the single header build against the per-library build.
+ *
+ * The same `TelemetryState` downlink frame is encoded and decoded through the libraries
+ * the benchmark links (`rp_packet_*` calling across `rp_crc`, `rp_cobs` and `rp_fec`) and
+ * through `rp_protocol_all.h`, compiled into `amalgamated_codec.c` where every function
+ * is `static inline` in one translation unit. Both builds use the compiler flags of the
+ * benchmark, without LTO. For each case the benchmark prints the median and p99 time
+ * per frame of both builds, the speedup of the single header build, and whether both
+ * produced the same frame.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define ITERATIONS (20000)
+#define BATCH (16)
+
+typedef rp_packet_encode_result_t (*encode_function_t)(uint8_t *packet, size_t packet_capacity,
+                                                       const pb_msgdesc_t *fields,
+                                                       const void *message,
+                                                       const rp_codec_options_t *options);
+typedef rp_packet_decode_result_t (*decode_function_t)(const uint8_t *packet, size_t packet_size,
+                                                       const pb_msgdesc_t *fields, void *message,
+                                                       const rp_codec_options_t *options);
+
+// Defined in amalgamated_codec.c, from rp_protocol_all.h
+rp_packet_encode_result_t amalgamated_packet_encode(uint8_t *packet, size_t packet_capacity,
+                                                    const pb_msgdesc_t *fields,
+                                                    const void *message,
+                                                    const rp_codec_options_t *options);
+rp_packet_decode_result_t amalgamated_packet_decode(const uint8_t *packet, size_t packet_size,
+                                                    const pb_msgdesc_t *fields, void *message,
+                                                    const rp_codec_options_t *options);
+
+static uint32_t samples[ITERATIONS];
+
+// Keeps the results alive so the calls are not optimized away
+static volatile uint32_t sink;
+
+/**
+ * Median and p99 time per frame, timing `BATCH` frames at a time so the clock does not
+ * dominate.
+ */
+static void time_encode(encode_function_t encode, const rp_codec_options_t *options,
+                        uint32_t *median_ns, uint32_t *p99_ns)
+{
+    tvr_Downlink downlink;
+
+    bench_fill_telemetry(&downlink, 123456);
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint64_t start = bench_now_ns();
+
+        for (int b = 0; b < BATCH; b++) {
+            downlink.payload.telemetry.timestamp_ms++;
+            sink += (uint32_t)encode(packet, sizeof(packet), tvr_Downlink_fields, &downlink,
+                                     options)
+                        .written;
+        }
+
+        samples[i] = (uint32_t)((bench_now_ns() - start) / BATCH);
+    }
+
+    *median_ns = bench_percentile_u32(samples, ITERATIONS, 0.50);
+    *p99_ns = bench_percentile_u32(samples, ITERATIONS, 0.99);
+}
+
+static void time_decode(decode_function_t decode, const rp_codec_options_t *options,
+                        const uint8_t *packet, size_t packet_size, uint32_t *median_ns,
+                        uint32_t *p99_ns)
+{
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint64_t start = bench_now_ns();
+
+        for (int b = 0; b < BATCH; b++) {
+            tvr_Downlink decoded = tvr_Downlink_init_zero;
+
+            sink += (uint32_t)decode(packet, packet_size, tvr_Downlink_fields, &decoded, options)
+                        .status;
+        }
+
+        samples[i] = (uint32_t)((bench_now_ns() - start) / BATCH);
+    }
+
+    *median_ns = bench_percentile_u32(samples, ITERATIONS, 0.50);
+    *p99_ns = bench_percentile_u32(samples, ITERATIONS, 0.99);
+}
+
+static void report(const char *name, uint32_t library_median, uint32_t library_p99,
+                   uint32_t amalgamated_median, uint32_t amalgamated_p99, bool same)
+{
+    printf("%-14s %7u %7u %7u %7u %7.2f %6s\n", name, (unsigned)library_median,
+           (unsigned)library_p99, (unsigned)amalgamated_median, (unsigned)amalgamated_p99,
+           (amalgamated_median > 0) ? (double)library_median / (double)amalgamated_median
+                                    : 0.0,
+           same ? "ok" : "FAIL");
+}
+
+static void run_case(const char *name, const rp_codec_options_t *options)
+{
+    tvr_Downlink downlink;
+
+    bench_fill_telemetry(&downlink, 123456);
+    uint8_t library_packet[RP_PACKET_MAX_SIZE];
+    uint8_t amalgamated_packet[RP_PACKET_MAX_SIZE];
+    uint32_t library_median;
+    uint32_t library_p99;
+    uint32_t amalgamated_median;
+    uint32_t amalgamated_p99;
+    char row[32];
+
+    rp_packet_encode_result_t library = rp_packet_encode_with_options(
+        library_packet, sizeof(library_packet), tvr_Downlink_fields, &downlink, options);
+    rp_packet_encode_result_t amalgamated = amalgamated_packet_encode(
+        amalgamated_packet, sizeof(amalgamated_packet), tvr_Downlink_fields, &downlink, options);
+    bool same = library.status == RP_CODEC_OK && amalgamated.status == RP_CODEC_OK &&
+                library.written == amalgamated.written &&
+                memcmp(library_packet, amalgamated_packet, library.written) == 0;
+
+    time_encode(rp_packet_encode_with_options, options, &library_median, &library_p99);
+    time_encode(amalgamated_packet_encode, options, &amalgamated_median, &amalgamated_p99);
+
+    snprintf(row, sizeof(row), "encode_%s", name);
+    report(row, library_median, library_p99, amalgamated_median, amalgamated_p99, same);
+
+    tvr_Downlink library_message = tvr_Downlink_init_zero;
+    tvr_Downlink amalgamated_message = tvr_Downlink_init_zero;
+
+    same = rp_packet_decode_with_options(library_packet, library.written, tvr_Downlink_fields,
+                                         &library_message, options)
+                   .status == RP_CODEC_OK &&
+           amalgamated_packet_decode(library_packet, library.written, tvr_Downlink_fields,
+                                     &amalgamated_message, options)
+                   .status == RP_CODEC_OK &&
+           memcmp(&library_message, &amalgamated_message, sizeof(tvr_Downlink)) == 0;
+
+    time_decode(rp_packet_decode_with_options, options, library_packet, library.written,
+                &library_median, &library_p99);
+    time_decode(amalgamated_packet_decode, options, library_packet, library.written,
+                &amalgamated_median, &amalgamated_p99);
+
+    snprintf(row, sizeof(row), "decode_%s", name);
+    report(row, library_median, library_p99, amalgamated_median, amalgamated_p99, same);
+}
+
+int main(void)
+{
+    rs_codec_t fec;
+
+    rs_codec_init(&fec, 8);
+
+    const rp_codec_options_t crc16 = {.checksum = RP_CODEC_CHECKSUM_CRC16};
+    const rp_codec_options_t crc32c = {.checksum = RP_CODEC_CHECKSUM_CRC32C};
+    const rp_codec_options_t fec_options = {.checksum = RP_CODEC_CHECKSUM_CRC16, .fec = &fec};
+
+    printf("%-14s %7s %7s %7s %7s %7s %6s\n", "case", "lib_p50", "lib_p99", "all_p50",
+           "all_p99", "speedup", "same");
+
+    run_case("crc16", &crc16);
+    run_case("crc32c", &crc32c);
+    run_case("fec", &fec_options);
+
+    return 0;
+}
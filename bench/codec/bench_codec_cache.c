@@ -0,0 +1,96 @@
+/**
+ * Cost of resending a `SystemStatus` downlink frame with and without the frame cache.
+ *
+ * - encode: `rp_packet_encode` every time
+ * - hit: `rp_frame_cache_encode` with an unchanged message, a compare and a copy
+ * - miss: `rp_frame_cache_encode` with the radio counter bumped before every send, the
+ *   full pipeline plus the compare and snapshot copy
+ *
+ * For each path the benchmark prints the median and p99 time per frame and the hit count.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/frame_cache.h"
+#include "tvr/downlink.pb.h"
+
+#define ITERATIONS (20000)
+
+typedef enum send_path {
+    PATH_ENCODE,
+    PATH_HIT,
+    PATH_MISS,
+} send_path_t;
+
+static const char *const path_names[] = {"encode", "hit", "miss"};
+
+static uint32_t frame_ns[ITERATIONS];
+
+static void fill_status(tvr_Downlink *downlink)
+{
+    tvr_SystemStatus *status = &downlink->payload.status;
+
+    *downlink = (tvr_Downlink)tvr_Downlink_init_zero;
+    downlink->which_payload = tvr_Downlink_status_tag;
+
+    status->timestamp_ms = 125000;
+    status->uptime_ms = 125000;
+    status->flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    status->accel_ok = true;
+    status->gyro_ok = true;
+    status->baro1_ok = true;
+    status->baro2_ok = true;
+    status->gps_connected = true;
+    status->radio_tx_count = 1250;
+    status->radio_rx_count = 310;
+    status->cmd_rx_count = 42;
+}
+
+static void run_path(send_path_t path)
+{
+    static tvr_Downlink snapshot;
+    rp_frame_cache_t cache;
+    tvr_Downlink downlink;
+    size_t frame_size = 0;
+
+    rp_frame_cache_init(&cache, tvr_Downlink_fields, &snapshot, sizeof(snapshot));
+    fill_status(&downlink);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+        rp_packet_encode_result_t encoded;
+
+        if (path == PATH_MISS) {
+            downlink.payload.status.radio_tx_count++;
+        }
+
+        uint64_t start = bench_now_ns();
+
+        if (path == PATH_ENCODE) {
+            encoded = rp_packet_encode(packet, sizeof(packet), tvr_Downlink_fields, &downlink);
+        } else {
+            encoded = rp_frame_cache_encode(&cache, packet, sizeof(packet), &downlink, NULL);
+        }
+
+        frame_ns[i] = (uint32_t)(bench_now_ns() - start);
+        frame_size = encoded.written;
+    }
+
+    printf("%-7s %6zu %8u %8u %8u\n", path_names[path], frame_size,
+           (unsigned)bench_percentile_u32(frame_ns, ITERATIONS, 50.0),
+           (unsigned)bench_percentile_u32(frame_ns, ITERATIONS, 99.0), (unsigned)cache.hits);
+}
+
+int main(void)
+{
+    printf("%-7s %6s %8s %8s %8s\n", "path", "bytes", "p50_ns", "p99_ns", "hits");
+
+    for (send_path_t path = PATH_ENCODE; path <= PATH_MISS; path++) {
+        run_path(path);
+    }
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+/**
+ * Full versus incremental encoding of a 1 kHz `TelemetryState` downlink stream.
+ *
+ * Each frame carries a new timestamp and link header and a slowly moving vehicle state,
+ * so every float changes but the set of present fields does not. The full path runs
+ * `rp_packet_encode_with_options` for every frame, the incremental path
+ * `rp_incremental_encode` with `tvr_Downlink_incremental`. For each path the benchmark
+ * prints the median and p99 time per frame and how the incremental frames were produced;
+ * `check` compares every incremental frame with a full encode.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/incremental.h"
+#include "rp/link/link.h"
+#include "telemetry.h"
+#include "tvr/downlink.incremental.h"
+#include "tvr/downlink.pb.h"
+
+#define ITERATIONS (20000)
+
+static uint32_t frame_ns[ITERATIONS];
+
+static void fill_telemetry(tvr_Downlink *downlink, uint32_t now_ms)
+{
+    tvr_TelemetryState *telemetry = &downlink->payload.telemetry;
+    float t = (float)now_ms * 0.001f;
+
+    // Past the first 16 s, so the timestamp varint keeps its length
+    bench_fill_telemetry(downlink, 20000 + now_ms);
+
+    telemetry->position.x = 1.25f + 0.1f * sinf(t);
+    telemetry->position.z = 12.0f + 0.5f * t;
+    telemetry->velocity.x = 0.1f * cosf(t);
+    telemetry->attitude.w = cosf(0.05f * t);
+    telemetry->attitude.z = sinf(0.05f * t);
+    telemetry->angular_rate.x = 0.003f * sinf(3.0f * t);
+    telemetry->thrust_cmd = 14.2f + 0.3f * sinf(2.0f * t);
+    telemetry->gimbal_x = 0.012f * sinf(5.0f * t);
+    telemetry->gimbal_y = -0.008f * cosf(5.0f * t);
+}
+
+static void report(const char *name, size_t frame_size, uint32_t patched, uint32_t full,
+                   uint32_t cobs, const char *check)
+{
+    printf("%-11s %6zu %8u %8u %8u %6u %6u %6s\n", name, frame_size,
+           (unsigned)bench_percentile_u32(frame_ns, ITERATIONS, 50.0),
+           (unsigned)bench_percentile_u32(frame_ns, ITERATIONS, 99.0), (unsigned)patched,
+           (unsigned)full, (unsigned)cobs, check);
+}
+
+static void run_full(void)
+{
+    rp_link_sender_t sender;
+    size_t frame_size = 0;
+
+    rp_link_sender_init(&sender, 0);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        tvr_Downlink downlink;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+        rp_link_header_t header = rp_link_sender_next(&sender, i * 1000);
+        rp_codec_options_t options = {.link_header = &header};
+
+        fill_telemetry(&downlink, i);
+
+        uint64_t start = bench_now_ns();
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            packet, sizeof(packet), tvr_Downlink_fields, &downlink, &options);
+
+        frame_ns[i] = (uint32_t)(bench_now_ns() - start);
+        frame_size = encoded.written;
+    }
+
+    report("full", frame_size, 0, ITERATIONS, 0, "-");
+}
+
+static void run_incremental(void)
+{
+    static tvr_Downlink snapshot;
+    static rp_incremental_encoder_t encoder;
+    rp_link_sender_t sender;
+    size_t frame_size = 0;
+    bool matches = true;
+
+    rp_link_sender_init(&sender, 0);
+    rp_incremental_init(&encoder, &tvr_Downlink_incremental, &snapshot);
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        tvr_Downlink downlink;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+        uint8_t expected[RP_PACKET_MAX_SIZE];
+        rp_link_header_t header = rp_link_sender_next(&sender, i * 1000);
+        rp_codec_options_t options = {.link_header = &header};
+
+        fill_telemetry(&downlink, i);
+
+        uint64_t start = bench_now_ns();
+        rp_packet_encode_result_t encoded =
+            rp_incremental_encode(&encoder, packet, sizeof(packet), &downlink, &options);
+
+        frame_ns[i] = (uint32_t)(bench_now_ns() - start);
+        frame_size = encoded.written;
+
+        rp_packet_encode_result_t full = rp_packet_encode_with_options(
+            expected, sizeof(expected), tvr_Downlink_fields, &downlink, &options);
+
+        matches = matches && encoded.status == RP_CODEC_OK && full.written == encoded.written &&
+                  memcmp(expected, packet, full.written) == 0;
+    }
+
+    report("incremental", frame_size, encoder.patched_encodes, encoder.full_encodes,
+           encoder.cobs_reencodes, matches ? "ok" : "FAIL");
+}
+
+int main(void)
+{
+    printf("%-11s %6s %8s %8s %8s %6s %6s %6s\n", "path", "bytes", "p50_ns", "p99_ns", "patched",
+           "full", "cobs", "check");
+
+    run_full();
+    run_incremental();
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * Buffered versus streaming frame encoding of `TelemetryState` downlink frames.
+ *
+ * Both paths end with the frame in a transmit buffer standing in for a UART FIFO or DMA
+ * region. The buffered path encodes into a packet buffer with `rp_packet_encode` and
+ * then copies it; the streaming path passes COBS blocks straight from
+ * `rp_packet_encode_to_sink`. For each path the benchmark prints the median and p99
+ * time until the first byte could go out and until the frame is complete, plus the
+ * number of sink calls per frame.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define ITERATIONS (20000)
+#define TX_CAPACITY (4096)
+
+typedef struct tx_buffer {
+    uint8_t bytes[TX_CAPACITY];
+    size_t size;
+    size_t calls;
+    uint64_t first_byte_ns;
+} tx_buffer_t;
+
+static tx_buffer_t tx;
+static uint32_t first_byte_ns[ITERATIONS];
+static uint32_t complete_ns[ITERATIONS];
+
+static bool tx_sink(void *context, const uint8_t *data, size_t size)
+{
+    tx_buffer_t *buffer = context;
+
+    if (buffer->calls == 0) {
+        buffer->first_byte_ns = bench_now_ns();
+    }
+
+    if (buffer->size + size > sizeof(buffer->bytes)) {
+        buffer->size = 0;
+    }
+
+    memcpy(&buffer->bytes[buffer->size], data, size);
+    buffer->size += size;
+    buffer->calls++;
+
+    return true;
+}
+
+static void report(const char *name, size_t frame_size, double calls)
+{
+    uint32_t first_p50 = bench_percentile_u32(first_byte_ns, ITERATIONS, 50.0);
+    uint32_t first_p99 = bench_percentile_u32(first_byte_ns, ITERATIONS, 99.0);
+    uint32_t done_p50 = bench_percentile_u32(complete_ns, ITERATIONS, 50.0);
+    uint32_t done_p99 = bench_percentile_u32(complete_ns, ITERATIONS, 99.0);
+
+    printf("%-9s %6zu %10u %10u %10u %10u %7.1f\n", name, frame_size, (unsigned)first_p50,
+           (unsigned)first_p99, (unsigned)done_p50, (unsigned)done_p99, calls);
+}
+
+static void run_buffered(void)
+{
+    size_t frame_size = 0;
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        tvr_Downlink downlink;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        bench_fill_telemetry(&downlink, i);
+
+        uint64_t start = bench_now_ns();
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(packet, sizeof(packet), tvr_Downlink_fields, &downlink);
+
+        tx.calls = 0;
+        tx_sink(&tx, packet, encoded.written);
+
+        first_byte_ns[i] = (uint32_t)(tx.first_byte_ns - start);
+        complete_ns[i] = (uint32_t)(bench_now_ns() - start);
+        frame_size = encoded.written;
+    }
+
+    report("buffered", frame_size, 1.0);
+}
+
+static void run_streaming(void)
+{
+    size_t frame_size = 0;
+    uint64_t calls = 0;
+
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        tvr_Downlink downlink;
+
+        bench_fill_telemetry(&downlink, i);
+
+        tx.calls = 0;
+
+        uint64_t start = bench_now_ns();
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode_to_sink(tx_sink, &tx, tvr_Downlink_fields, &downlink, NULL);
+
+        first_byte_ns[i] = (uint32_t)(tx.first_byte_ns - start);
+        complete_ns[i] = (uint32_t)(bench_now_ns() - start);
+        frame_size = encoded.written;
+        calls += tx.calls;
+    }
+
+    report("streaming", frame_size, (double)calls / ITERATIONS);
+}
+
+int main(void)
+{
+    printf("%-9s %6s %10s %10s %10s %10s %7s\n", "path", "bytes", "first_p50", "first_p99",
+           "done_p50", "done_p99", "calls");
+
+    run_buffered();
+    run_streaming();
+
+    return 0;
+}
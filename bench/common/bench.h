@@ -0,0 +1,68 @@
+#ifndef RP_BENCH_H
+#define RP_BENCH_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+/**
+ * Monotonic wall clock in nanoseconds.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Small deterministic PRNG (xorshift64*) so simulated runs are repeatable.
+ */
+typedef struct bench_rng {
+    uint64_t state;
+} bench_rng_t;
+
+static inline uint64_t bench_rng_next(bench_rng_t *rng)
+{
+    rng->state ^= rng->state >> 12;
+    rng->state ^= rng->state << 25;
+    rng->state ^= rng->state >> 27;
+
+    return rng->state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * Uniform double in [0, 1).
+ */
+static inline double bench_rng_uniform(bench_rng_t *rng)
+{
+    return (double)(bench_rng_next(rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static inline int bench_compare_u32(const void *a, const void *b)
+{
+    uint32_t lhs = *(const uint32_t *)a;
+    uint32_t rhs = *(const uint32_t *)b;
+
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/**
+ * Sorts the samples in place and returns the given percentile (0-100).
+ */
+static inline uint32_t bench_percentile_u32(uint32_t *samples, size_t count, double percentile)
+{
+    if (count == 0) {
+        return 0;
+    }
+
+    qsort(samples, count, sizeof(samples[0]), bench_compare_u32);
+
+    size_t index = (size_t)((percentile / 100.0) * (double)(count - 1) + 0.5);
+
+    return samples[index];
+}
+
+#endif // RP_BENCH_H
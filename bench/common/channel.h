@@ -0,0 +1,82 @@
+#ifndef RP_BENCH_CHANNEL_H
+#define RP_BENCH_CHANNEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+/**
+ * Binary symmetric channel: flips every bit independently with probability `ber`.
+ *
+ * @return size_t Number of bits flipped
+ */
+static inline size_t channel_flip_bits(bench_rng_t *rng, uint8_t *data, size_t size, double ber)
+{
+    size_t flipped = 0;
+
+    if (ber <= 0.0) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        for (unsigned bit = 0; bit < 8; bit++) {
+            if (bench_rng_uniform(rng) < ber) {
+                data[i] ^= (uint8_t)(1U << bit);
+                flipped++;
+            }
+        }
+    }
+
+    return flipped;
+}
+
+/**
+ * Erasure channel: loses a whole frame with probability `loss`.
+ *
+ * @return bool Whether the frame was lost
+ */
+static inline bool channel_drop(bench_rng_t *rng, double loss)
+{
+    return loss > 0.0 && bench_rng_uniform(rng) < loss;
+}
+
+/**
+ * Gilbert-Elliott fading channel, a two state Markov chain stepped once per byte. Bytes
+ * get through in the good state; in a fade every byte is replaced by noise, delimiters
+ * included, as when the receiver loses the signal.
+ */
+typedef struct channel_fade {
+    double fade_rate;  /**< Chance per byte of a fade starting */
+    double fade_bytes; /**< Mean length of a fade, in bytes */
+    bool fading;
+} channel_fade_t;
+
+/**
+ * Sends bytes through a fading channel, which keeps its state from one call to the next.
+ *
+ * @return size_t Number of bytes replaced
+ */
+static inline size_t channel_fade_bytes(bench_rng_t *rng, channel_fade_t *channel, uint8_t *data,
+                                        size_t size)
+{
+    size_t replaced = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        if (channel->fading) {
+            channel->fading = bench_rng_uniform(rng) >= 1.0 / channel->fade_bytes;
+        } else {
+            channel->fading = bench_rng_uniform(rng) < channel->fade_rate;
+        }
+
+        if (channel->fading) {
+            data[i] = (uint8_t)bench_rng_next(rng);
+            replaced++;
+        }
+    }
+
+    return replaced;
+}
+
+#endif // RP_BENCH_CHANNEL_H
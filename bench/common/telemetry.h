@@ -0,0 +1,109 @@
+#ifndef RP_BENCH_TELEMETRY_H
+#define RP_BENCH_TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "tvr/downlink.pb.h"
+
+// Time between frames of the synthetic capture
+#define BENCH_CAPTURE_PERIOD_MS (10)
+
+/**
+ * Steady hover telemetry at `now_ms`, every sub-message present, climbing 1 mm per ms so
+ * consecutive frames differ.
+ */
+static inline void bench_fill_telemetry(tvr_Downlink *downlink, uint32_t now_ms)
+{
+    tvr_TelemetryState *telemetry = &downlink->payload.telemetry;
+
+    *downlink = (tvr_Downlink)tvr_Downlink_init_zero;
+    downlink->which_payload = tvr_Downlink_telemetry_tag;
+
+    telemetry->timestamp_ms = now_ms;
+    telemetry->has_position = true;
+    telemetry->position = (tvr_Vec3){1.25f, -0.5f, 12.0f + (float)now_ms * 0.001f};
+    telemetry->has_velocity = true;
+    telemetry->velocity = (tvr_Vec3){0.01f, 0.02f, 0.75f};
+    telemetry->has_attitude = true;
+    telemetry->attitude = (tvr_Quaternion){0.99f, 0.01f, -0.02f, 0.1f};
+    telemetry->has_angular_rate = true;
+    telemetry->angular_rate = (tvr_Vec3){0.003f, -0.004f, 0.001f};
+    telemetry->flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    telemetry->thrust_cmd = 14.2f;
+    telemetry->gimbal_x = 0.012f;
+    telemetry->gimbal_y = -0.008f;
+}
+
+/**
+ * Healthy hover status at `now_ms`.
+ */
+static inline void bench_fill_status(tvr_Downlink *downlink, uint32_t now_ms)
+{
+    tvr_SystemStatus *status = &downlink->payload.status;
+
+    *downlink = (tvr_Downlink)tvr_Downlink_init_zero;
+    downlink->which_payload = tvr_Downlink_status_tag;
+
+    status->timestamp_ms = now_ms;
+    status->uptime_ms = now_ms;
+    status->flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    status->accel_ok = true;
+    status->gyro_ok = true;
+    status->radio_tx_count = now_ms / BENCH_CAPTURE_PERIOD_MS;
+}
+
+/**
+ * Frame `index` of the synthetic capture: ten `TelemetryState` for every `SystemStatus`,
+ * `BENCH_CAPTURE_PERIOD_MS` apart. Telemetry gets noise from `rng`, and the angular rate
+ * only every other frame, so the frames vary in content and size like a recording.
+ */
+static inline void bench_capture_downlink(bench_rng_t *rng, uint32_t index,
+                                          tvr_Downlink *downlink)
+{
+    uint32_t now_ms = index * BENCH_CAPTURE_PERIOD_MS;
+
+    if (index % 11 == 10) {
+        bench_fill_status(downlink, now_ms);
+        return;
+    }
+
+    tvr_TelemetryState *telemetry = &downlink->payload.telemetry;
+    float noise = (float)bench_rng_uniform(rng);
+
+    bench_fill_telemetry(downlink, now_ms);
+
+    telemetry->position = (tvr_Vec3){0.01f * (float)index, -0.5f * noise, 12.0f + noise};
+    telemetry->velocity.y = 0.02f * noise;
+    telemetry->attitude.y = -0.02f * noise;
+    telemetry->has_angular_rate = (index % 2) != 0;
+    telemetry->thrust_cmd = 14.2f + noise;
+}
+
+/**
+ * Encodes the first `count` frames of the synthetic capture back to back, as a raw
+ * downlink capture holds them.
+ *
+ * @return size_t Bytes written to `capture`
+ */
+static inline size_t bench_build_capture(uint8_t *capture, size_t capacity, uint32_t count)
+{
+    bench_rng_t rng = {.state = 0x2545F4914F6CDD1DULL};
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        tvr_Downlink downlink;
+
+        bench_capture_downlink(&rng, i, &downlink);
+
+        size += rp_packet_encode(&capture[size], capacity - size, tvr_Downlink_fields,
+                                 &downlink)
+                    .written;
+    }
+
+    return size;
+}
+
+#endif // RP_BENCH_TELEMETRY_H
@@ -0,0 +1,124 @@
+/**
+ * Throughput of the frame checksums.
+ *
+ * Each checksum is run over buffers from a small telemetry frame up to a large replay
+ * block, then the full `Downlink` decode path is timed with both codec checksums so
+ * the share of the checksum in a decode is visible.
+ *
+ * Output is CSV:
+ *
+ *     case,size,ns_per_call,mb_per_s
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/crc/crc.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define TARGET_BYTES (64ULL * 1024 * 1024)
+#define DECODE_ITERATIONS (200000)
+
+static const size_t sizes[] = {16, 64, 128, 256, 1024, 4096, 65536};
+
+static uint8_t buffer[65536];
+
+// Keeps the results alive so the calls are not optimized away
+static volatile uint32_t sink;
+
+static uint32_t run_crc16(const uint8_t *data, size_t size)
+{
+    return crc16_ccitt(data, size);
+}
+
+static uint32_t run_crc32c_software(const uint8_t *data, size_t size)
+{
+    return crc32c_software(data, size);
+}
+
+static uint32_t run_crc32c(const uint8_t *data, size_t size)
+{
+    return crc32c(data, size);
+}
+
+static void report(const char *name, size_t size, uint64_t iterations, uint64_t elapsed_ns)
+{
+    double ns_per_call = (double)elapsed_ns / (double)iterations;
+    double mb_per_s = (double)size * (double)iterations * 1000.0 / (double)elapsed_ns;
+
+    printf("%s,%u,%.1f,%.1f\n", name, (unsigned)size, ns_per_call, mb_per_s);
+}
+
+static void bench_checksum(const char *name, uint32_t (*checksum)(const uint8_t *, size_t))
+{
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        uint64_t iterations = TARGET_BYTES / sizes[s];
+        uint32_t accumulator = 0;
+
+        uint64_t start = bench_now_ns();
+
+        for (uint64_t i = 0; i < iterations; i++) {
+            accumulator += checksum(buffer, sizes[s]);
+        }
+
+        uint64_t elapsed = bench_now_ns() - start;
+
+        sink = accumulator;
+        report(name, sizes[s], iterations, elapsed);
+    }
+}
+
+static void bench_decode(const char *name, rp_codec_checksum_t checksum)
+{
+    const rp_codec_options_t options = {.checksum = checksum};
+    tvr_Downlink downlink;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    bench_fill_telemetry(&downlink, 123456);
+
+    rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+        packet, sizeof(packet), tvr_Downlink_fields, &downlink, &options);
+
+    if (encoded.status != RP_CODEC_OK) {
+        return;
+    }
+
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t i = 0; i < DECODE_ITERATIONS; i++) {
+        tvr_Downlink decoded = tvr_Downlink_init_zero;
+
+        rp_packet_decode_result_t result = rp_packet_decode_with_options(
+            packet, encoded.written, tvr_Downlink_fields, &decoded, &options);
+
+        sink += (uint32_t)result.status;
+    }
+
+    report(name, encoded.written, DECODE_ITERATIONS, bench_now_ns() - start);
+}
+
+int main(void)
+{
+    bench_rng_t rng = {.state = 0x2545F4914F6CDD1DULL};
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)bench_rng_next(&rng);
+    }
+
+    fprintf(stderr, "crc32c hardware: %s\n", crc32c_hardware_available() ? "yes" : "no");
+
+    printf("case,size,ns_per_call,mb_per_s\n");
+
+    bench_checksum("crc16_ccitt", run_crc16);
+    bench_checksum("crc32c_software", run_crc32c_software);
+    bench_checksum("crc32c", run_crc32c);
+
+    bench_decode("decode_crc16", RP_CODEC_CHECKSUM_CRC16);
+    bench_decode("decode_crc32c", RP_CODEC_CHECKSUM_CRC32C);
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * Throughput of multi-buffer CRC-16 verification for offline log validation.
+ *
+ * A recording of `Downlink` frames, ten `TelemetryState` for every `SystemStatus`, is
+ * split into frames with the deframer, and every frame is checked three ways:
+ *
+ * - `crc16`: `crc16_ccitt` over each already COBS decoded codeword, one at a time
+ * - `crc16_batch`: `crc16_ccitt_batch` over the same codewords
+ * - `verify`/`verify_batch`: `rp_packet_verify_batch` from the COBS frames, one frame per
+ *   call and the whole recording in one call
+ *
+ * For each row the benchmark prints frames and megabytes (of frame bytes) per second, the
+ * speedup over the one-at-a-time row it pairs with, and whether the batch gave the same
+ * result for every frame. With a path, the file is read as a raw downlink capture instead
+ * of the synthetic recording:
+ *
+ *     bench_crc_batch [capture.bin]
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/crc/crc.h"
+#include "rp/deframer/deframer.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define MAX_FRAMES (100000)
+#define SYNTHETIC_FRAMES (50000)
+#define REPEATS (5)
+
+static uint8_t frames[MAX_FRAMES][RP_PACKET_MAX_SIZE];
+static uint8_t codewords[MAX_FRAMES][RP_PACKET_MAX_SIZE];
+static const uint8_t *frame_pointers[MAX_FRAMES];
+static const uint8_t *codeword_pointers[MAX_FRAMES];
+static size_t frame_sizes[MAX_FRAMES];
+static size_t codeword_sizes[MAX_FRAMES];
+static uint16_t single_crcs[MAX_FRAMES];
+static uint16_t batch_crcs[MAX_FRAMES];
+static rp_codec_status_t single_statuses[MAX_FRAMES];
+static rp_codec_status_t batch_statuses[MAX_FRAMES];
+static rp_packet_verify_scratch_t verify_scratch;
+
+static size_t frame_count;
+static size_t frame_bytes;
+
+/**
+ * Keeps a frame split from the recording, and its COBS decoded codeword.
+ */
+static void add_frame(const uint8_t *frame, size_t size)
+{
+    if (frame_count == MAX_FRAMES || size > RP_PACKET_MAX_SIZE) {
+        return;
+    }
+
+    cobs_result_t decoded =
+        cobs_decode(frame, size, codewords[frame_count], sizeof(codewords[frame_count]));
+
+    if (decoded.status != COBS_OK) {
+        return;
+    }
+
+    memcpy(frames[frame_count], frame, size);
+    frame_pointers[frame_count] = frames[frame_count];
+    frame_sizes[frame_count] = size;
+    codeword_pointers[frame_count] = codewords[frame_count];
+    codeword_sizes[frame_count] = decoded.written;
+    frame_count++;
+    frame_bytes += size;
+}
+
+static void build_synthetic(void)
+{
+    bench_rng_t rng = {.state = 0x2545F4914F6CDD1DULL};
+
+    for (uint32_t i = 0; i < SYNTHETIC_FRAMES; i++) {
+        tvr_Downlink downlink;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        bench_capture_downlink(&rng, i, &downlink);
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(packet, sizeof(packet), tvr_Downlink_fields, &downlink);
+
+        // Some frames damaged on the link, so both outcomes are checked
+        if (bench_rng_next(&rng) % 100 == 0) {
+            packet[encoded.written / 2] ^= 0x04;
+        }
+
+        add_frame(packet, encoded.written);
+    }
+}
+
+static int read_capture(const char *path)
+{
+    FILE *capture = fopen(path, "rb");
+
+    if (capture == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    uint8_t chunk[4096];
+    rp_deframer_t deframer;
+    size_t count;
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    while ((count = fread(chunk, 1, sizeof(chunk), capture)) > 0) {
+        size_t offset = 0;
+
+        while (offset < count) {
+            rp_deframer_result_t rx = rp_deframer_feed(&deframer, &chunk[offset], count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status == RP_DEFRAMER_FRAME_READY) {
+                add_frame(deframer.buffer, deframer.size);
+            }
+        }
+    }
+
+    fclose(capture);
+
+    return 0;
+}
+
+static double run_crc16(void)
+{
+    uint64_t start = bench_now_ns();
+
+    for (size_t i = 0; i < frame_count; i++) {
+        single_crcs[i] = crc16_ccitt(codeword_pointers[i], codeword_sizes[i]);
+    }
+
+    return (double)(bench_now_ns() - start) * 1e-9;
+}
+
+static double run_crc16_batch(void)
+{
+    uint64_t start = bench_now_ns();
+
+    crc16_ccitt_batch(codeword_pointers, codeword_sizes, frame_count, batch_crcs);
+
+    return (double)(bench_now_ns() - start) * 1e-9;
+}
+
+static double run_verify(void)
+{
+    uint64_t start = bench_now_ns();
+
+    for (size_t i = 0; i < frame_count; i++) {
+        rp_packet_verify_batch(&frame_pointers[i], &frame_sizes[i], 1, &single_statuses[i],
+                               &verify_scratch, NULL);
+    }
+
+    return (double)(bench_now_ns() - start) * 1e-9;
+}
+
+static double run_verify_batch(void)
+{
+    uint64_t start = bench_now_ns();
+
+    rp_packet_verify_batch(frame_pointers, frame_sizes, frame_count, batch_statuses,
+                           &verify_scratch, NULL);
+
+    return (double)(bench_now_ns() - start) * 1e-9;
+}
+
+/**
+ * Best of `REPEATS` runs.
+ */
+static double best_of(double (*run)(void))
+{
+    double best = 0.0;
+
+    for (int r = 0; r < REPEATS; r++) {
+        double seconds = run();
+
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    return best;
+}
+
+static void report(const char *name, double seconds, double baseline_seconds, bool same)
+{
+    printf("%-13s %11.0f %8.1f %7.2f %6s\n", name, (double)frame_count / seconds,
+           (double)frame_bytes / seconds * 1e-6, baseline_seconds / seconds,
+           same ? "ok" : "FAIL");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        if (read_capture(argv[1]) != 0) {
+            return 1;
+        }
+    } else {
+        build_synthetic();
+    }
+
+    if (frame_count == 0) {
+        fprintf(stderr, "no frames\n");
+        return 1;
+    }
+
+    fprintf(stderr, "%zu frames, %.1f bytes on average\n", frame_count,
+            (double)frame_bytes / (double)frame_count);
+
+    printf("%-13s %11s %8s %7s %6s\n", "check", "frames/s", "MB/s", "speedup", "same");
+
+    double crc16_seconds = best_of(run_crc16);
+    double crc16_batch_seconds = best_of(run_crc16_batch);
+    bool crcs_same = memcmp(single_crcs, batch_crcs, frame_count * sizeof(uint16_t)) == 0;
+
+    report("crc16", crc16_seconds, crc16_seconds, true);
+    report("crc16_batch", crc16_batch_seconds, crc16_seconds, crcs_same);
+
+    double verify_seconds = best_of(run_verify);
+    double verify_batch_seconds = best_of(run_verify_batch);
+    bool statuses_same =
+        memcmp(single_statuses, batch_statuses, frame_count * sizeof(rp_codec_status_t)) == 0;
+
+    report("verify", verify_seconds, verify_seconds, true);
+    report("verify_batch", verify_batch_seconds, verify_seconds, statuses_same);
+
+    return 0;
+}
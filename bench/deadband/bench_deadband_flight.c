@@ -0,0 +1,257 @@
+/**
+ * Downlink bandwidth saved by dead-band suppression of `TelemetryState` with
+ * `tvr_TelemetryState_deadband`.
+ *
+ * Every telemetry frame is run through the sender-side filter. Sent frames are handed to
+ * a receiver-side filter, which rebuilds each suppressed frame at its timestamp; the
+ * rebuilt frame is compared with the one the vehicle produced. For each flight phase the
+ * benchmark prints the frames produced and sent, the encoded bytes with and without
+ * suppression, the saving, and the largest position (m) and attitude (rad) error of a
+ * rebuilt frame.
+ *
+ * Without arguments a synthetic 10 Hz flight is used: idle on the pad, rise, hover with a
+ * slow drift and yaw, lower and idle again, with estimator noise on every state. With a
+ * path, the file is read as a raw downlink capture, the byte stream the gateway reads
+ * from the ground radio, and its telemetry frames are reported as a single phase:
+ *
+ *     bench_deadband_flight [capture.bin]
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/deadband/deadband.h"
+#include "rp/deframer/deframer.h"
+#include "tvr/downlink.pb.h"
+#include "tvr/telemetry.deadband.h"
+
+#define PERIOD_MS (100)
+
+typedef struct phase {
+    const char *name;
+    tvr_FlightState state;
+    uint32_t duration_ms;
+    float climb_rate; /**< Vertical speed in m/s */
+    float yaw_rate;   /**< rad/s */
+    float drift;      /**< Amplitude of the horizontal wander in m */
+} phase_t;
+
+static const phase_t phases[] = {
+    {"idle", tvr_FlightState_FLIGHT_STATE_IDLE, 10000, 0.0f, 0.0f, 0.0f},
+    {"rise", tvr_FlightState_FLIGHT_STATE_RISE, 5000, 1.0f, 0.0f, 0.0f},
+    {"hover", tvr_FlightState_FLIGHT_STATE_HOVER, 20000, 0.0f, 0.1f, 0.2f},
+    {"lower", tvr_FlightState_FLIGHT_STATE_LOWER, 5000, -1.0f, 0.0f, 0.0f},
+    {"landed", tvr_FlightState_FLIGHT_STATE_IDLE, 10000, 0.0f, 0.0f, 0.0f},
+};
+
+typedef struct stream_stats {
+    uint32_t frames;
+    uint32_t sent;
+    uint64_t full_bytes;
+    uint64_t sent_bytes;
+    double position_error;
+    double attitude_error;
+} stream_stats_t;
+
+static tvr_TelemetryState sender_reference;
+static tvr_TelemetryState receiver_reference;
+
+static float noise(bench_rng_t *rng, float amplitude)
+{
+    return (float)(bench_rng_uniform(rng) - 0.5) * 2.0f * amplitude;
+}
+
+static size_t encoded_size(const tvr_TelemetryState *telemetry)
+{
+    tvr_Downlink downlink = tvr_Downlink_init_zero;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    downlink.which_payload = tvr_Downlink_telemetry_tag;
+    downlink.payload.telemetry = *telemetry;
+
+    return rp_packet_encode(packet, sizeof(packet), tvr_Downlink_fields, &downlink).written;
+}
+
+static double rotation_error(const tvr_Quaternion *a, const tvr_Quaternion *b)
+{
+    double dot = (double)a->w * b->w + (double)a->x * b->x + (double)a->y * b->y +
+                 (double)a->z * b->z;
+    double norms = sqrt(((double)a->w * a->w + (double)a->x * a->x + (double)a->y * a->y +
+                         (double)a->z * a->z) *
+                        ((double)b->w * b->w + (double)b->x * b->x + (double)b->y * b->y +
+                         (double)b->z * b->z));
+
+    return (norms > 0.0) ? 2.0 * acos(fmin(1.0, fabs(dot) / norms)) : 0.0;
+}
+
+/**
+ * Runs one telemetry frame through both ends of the link.
+ */
+static void transmit(rp_deadband_t *sender, rp_deadband_t *receiver,
+                     const tvr_TelemetryState *telemetry, stream_stats_t *stats)
+{
+    size_t size = encoded_size(telemetry);
+
+    stats->frames++;
+    stats->full_bytes += size;
+
+    if (rp_deadband_filter(sender, telemetry)) {
+        rp_deadband_received(receiver, telemetry);
+        stats->sent++;
+        stats->sent_bytes += size;
+        return;
+    }
+
+    tvr_TelemetryState rebuilt;
+
+    rp_deadband_reconstruct(receiver, telemetry->timestamp_ms, &rebuilt);
+
+    double dx = (double)rebuilt.position.x - telemetry->position.x;
+    double dy = (double)rebuilt.position.y - telemetry->position.y;
+    double dz = (double)rebuilt.position.z - telemetry->position.z;
+
+    stats->position_error = fmax(stats->position_error, sqrt(dx * dx + dy * dy + dz * dz));
+    stats->attitude_error =
+        fmax(stats->attitude_error, rotation_error(&rebuilt.attitude, &telemetry->attitude));
+}
+
+static void report(const char *name, const stream_stats_t *stats)
+{
+    double saved = (stats->full_bytes > 0)
+                       ? 100.0 * (1.0 - (double)stats->sent_bytes / (double)stats->full_bytes)
+                       : 0.0;
+
+    printf("%-9s %7u %7u %9llu %9llu %6.1f %9.4f %9.4f\n", name, (unsigned)stats->frames,
+           (unsigned)stats->sent, (unsigned long long)stats->full_bytes,
+           (unsigned long long)stats->sent_bytes, saved, stats->position_error,
+           stats->attitude_error);
+}
+
+static void run_synthetic(rp_deadband_t *sender, rp_deadband_t *receiver)
+{
+    bench_rng_t rng = {.state = 0x2545F4914F6CDD1DULL};
+    stream_stats_t total = {0};
+    uint32_t now_ms = 0;
+    float altitude = 0.0f;
+    float yaw = 0.0f;
+
+    for (size_t p = 0; p < sizeof(phases) / sizeof(phases[0]); p++) {
+        const phase_t *phase = &phases[p];
+        stream_stats_t stats = {0};
+
+        for (uint32_t t = 0; t < phase->duration_ms; t += PERIOD_MS, now_ms += PERIOD_MS) {
+            tvr_TelemetryState telemetry = tvr_TelemetryState_init_zero;
+            float s = (float)now_ms * 0.001f;
+            float wander = 2.0f * 3.14159265f / 8.0f;
+
+            altitude += phase->climb_rate * (float)PERIOD_MS * 0.001f;
+            yaw += phase->yaw_rate * (float)PERIOD_MS * 0.001f;
+
+            telemetry.timestamp_ms = now_ms;
+            telemetry.has_position = true;
+            telemetry.position = (tvr_Vec3){phase->drift * sinf(wander * s) + noise(&rng, 0.01f),
+                                            phase->drift * cosf(wander * s) + noise(&rng, 0.01f),
+                                            altitude + noise(&rng, 0.01f)};
+            telemetry.has_velocity = true;
+            telemetry.velocity = (tvr_Vec3){phase->drift * wander * cosf(wander * s),
+                                            -phase->drift * wander * sinf(wander * s),
+                                            phase->climb_rate + noise(&rng, 0.01f)};
+            telemetry.has_attitude = true;
+            telemetry.attitude = (tvr_Quaternion){cosf(0.5f * yaw), noise(&rng, 0.001f),
+                                                  noise(&rng, 0.001f), sinf(0.5f * yaw)};
+            telemetry.has_angular_rate = true;
+            telemetry.angular_rate = (tvr_Vec3){noise(&rng, 0.005f), noise(&rng, 0.005f),
+                                                phase->yaw_rate + noise(&rng, 0.005f)};
+            telemetry.flight_state = phase->state;
+            telemetry.thrust_cmd = (phase->state == tvr_FlightState_FLIGHT_STATE_IDLE)
+                                       ? 0.0f
+                                       : 14.2f + 0.4f * phase->climb_rate + noise(&rng, 0.05f);
+            telemetry.gimbal_x = noise(&rng, 0.0005f);
+            telemetry.gimbal_y = noise(&rng, 0.0005f);
+
+            transmit(sender, receiver, &telemetry, &stats);
+        }
+
+        report(phase->name, &stats);
+
+        total.frames += stats.frames;
+        total.sent += stats.sent;
+        total.full_bytes += stats.full_bytes;
+        total.sent_bytes += stats.sent_bytes;
+        total.position_error = fmax(total.position_error, stats.position_error);
+        total.attitude_error = fmax(total.attitude_error, stats.attitude_error);
+    }
+
+    report("total", &total);
+}
+
+static int run_capture(rp_deadband_t *sender, rp_deadband_t *receiver, const char *path)
+{
+    FILE *capture = fopen(path, "rb");
+
+    if (capture == NULL) {
+        perror(path);
+        return 1;
+    }
+
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    uint8_t chunk[512];
+    rp_deframer_t deframer;
+    stream_stats_t stats = {0};
+    size_t count;
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    while ((count = fread(chunk, 1, sizeof(chunk), capture)) > 0) {
+        size_t offset = 0;
+
+        while (offset < count) {
+            rp_deframer_result_t rx = rp_deframer_feed(&deframer, &chunk[offset], count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+            if (decoded.status == RP_CODEC_OK &&
+                downlink.which_payload == tvr_Downlink_telemetry_tag) {
+                transmit(sender, receiver, &downlink.payload.telemetry, &stats);
+            }
+        }
+    }
+
+    fclose(capture);
+    report("capture", &stats);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    rp_deadband_t sender;
+    rp_deadband_t receiver;
+
+    rp_deadband_init(&sender, &tvr_TelemetryState_deadband, &sender_reference);
+    rp_deadband_init(&receiver, &tvr_TelemetryState_deadband, &receiver_reference);
+
+    printf("%-9s %7s %7s %9s %9s %6s %9s %9s\n", "phase", "frames", "sent", "full_B", "sent_B",
+           "saved%", "pos_err", "att_err");
+
+    if (argc > 1) {
+        return run_capture(&sender, &receiver, argv[1]);
+    }
+
+    run_synthetic(&sender, &receiver);
+
+    return 0;
+}
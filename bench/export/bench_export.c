@@ -0,0 +1,198 @@
+/**
+ * Throughput of exporting a downlink capture to CSV and NDJSON.
+ *
+ * A capture of `Downlink` frames, ten `TelemetryState` for every `SystemStatus`, is built
+ * in memory, then split, decoded and written out as telemetry rows to /dev/null in three
+ * ways:
+ *
+ * - `printf`: `fprintf` of every field with "%.9g", as the ad-hoc export scripts do
+ * - `csv`: `rp_export_t` CSV rows
+ * - `ndjson`: `rp_export_t` NDJSON lines
+ *
+ * For each row the benchmark prints capture megabytes and telemetry rows per second, and
+ * the speedup over `printf`. Capture throughput is the figure to compare with the rate
+ * captures need to be processed at.
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "export.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define FRAME_COUNT (200000)
+#define READ_SIZE (1 << 20)
+#define OUTPUT_SIZE (1 << 20)
+#define REPEATS (3)
+
+typedef enum exporter_kind {
+    EXPORT_PRINTF,
+    EXPORT_CSV,
+    EXPORT_NDJSON,
+} exporter_kind_t;
+
+typedef struct run_result {
+    double seconds;
+    uint64_t rows;
+} run_result_t;
+
+static uint8_t capture[FRAME_COUNT * RP_PACKET_MAX_SIZE];
+static char output[OUTPUT_SIZE];
+
+/**
+ * What an export script does for each row: one `fprintf` with every field.
+ */
+static void print_row(FILE *file, const tvr_TelemetryState *telemetry)
+{
+    fprintf(file, "%u,", (unsigned)telemetry->timestamp_ms);
+
+    if (telemetry->has_position) {
+        fprintf(file, "%.9g,%.9g,%.9g,", telemetry->position.x, telemetry->position.y,
+                telemetry->position.z);
+    } else {
+        fprintf(file, ",,,");
+    }
+
+    if (telemetry->has_velocity) {
+        fprintf(file, "%.9g,%.9g,%.9g,", telemetry->velocity.x, telemetry->velocity.y,
+                telemetry->velocity.z);
+    } else {
+        fprintf(file, ",,,");
+    }
+
+    if (telemetry->has_attitude) {
+        fprintf(file, "%.9g,%.9g,%.9g,%.9g,", telemetry->attitude.w, telemetry->attitude.x,
+                telemetry->attitude.y, telemetry->attitude.z);
+    } else {
+        fprintf(file, ",,,,");
+    }
+
+    if (telemetry->has_angular_rate) {
+        fprintf(file, "%.9g,%.9g,%.9g,", telemetry->angular_rate.x, telemetry->angular_rate.y,
+                telemetry->angular_rate.z);
+    } else {
+        fprintf(file, ",,,");
+    }
+
+    fprintf(file, "%d,%.9g,%.9g,%.9g\n", (int)telemetry->flight_state, telemetry->thrust_cmd,
+            telemetry->gimbal_x, telemetry->gimbal_y);
+}
+
+static run_result_t run(size_t size, exporter_kind_t kind, int fd, FILE *file)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    rp_export_t exporter;
+    run_result_t result = {0};
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+    rp_export_init(&exporter, (kind == EXPORT_NDJSON) ? RP_EXPORT_NDJSON : RP_EXPORT_CSV,
+                   tvr_Downlink_telemetry_tag, NULL, fd, output, sizeof(output));
+
+    uint64_t start = bench_now_ns();
+
+    if (kind != EXPORT_PRINTF) {
+        rp_export_header(&exporter);
+    }
+
+    for (size_t offset = 0; offset < size; offset += READ_SIZE) {
+        size_t length = (size - offset < READ_SIZE) ? size - offset : READ_SIZE;
+        size_t consumed = 0;
+
+        while (consumed < length) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(&deframer, &capture[offset + consumed], length - consumed);
+
+            consumed += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+            if (decoded.status != RP_CODEC_OK) {
+                continue;
+            }
+
+            if (kind != EXPORT_PRINTF) {
+                rp_export_downlink(&exporter, &downlink);
+            } else if (downlink.which_payload == tvr_Downlink_telemetry_tag) {
+                print_row(file, &downlink.payload.telemetry);
+                result.rows++;
+            }
+        }
+    }
+
+    if (kind != EXPORT_PRINTF) {
+        rp_export_flush(&exporter);
+        result.rows = exporter.rows;
+    } else {
+        fflush(file);
+    }
+
+    result.seconds = (double)(bench_now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+/**
+ * Best of `REPEATS` runs.
+ */
+static run_result_t best_of(size_t size, exporter_kind_t kind, int fd, FILE *file)
+{
+    run_result_t best = {0};
+
+    for (int r = 0; r < REPEATS; r++) {
+        run_result_t result = run(size, kind, fd, file);
+
+        if (r == 0 || result.seconds < best.seconds) {
+            best = result;
+        }
+    }
+
+    return best;
+}
+
+static void report(const char *name, size_t size, run_result_t result, double printf_seconds)
+{
+    printf("%-8s %9.1f %11.0f %7.2f\n", name, (double)size / result.seconds * 1e-6,
+           (double)result.rows / result.seconds, printf_seconds / result.seconds);
+}
+
+int main(void)
+{
+    size_t size = bench_build_capture(capture, sizeof(capture), FRAME_COUNT);
+    int fd = open("/dev/null", O_WRONLY);
+    FILE *file = fopen("/dev/null", "w");
+
+    if (fd < 0 || file == NULL) {
+        perror("/dev/null");
+        return 1;
+    }
+
+    // The same buffer size for both, so only the formatting differs
+    setvbuf(file, NULL, _IOFBF, OUTPUT_SIZE);
+
+    printf("%-8s %9s %11s %7s\n", "export", "MB/s", "rows/s", "speedup");
+
+    run_result_t printf_result = best_of(size, EXPORT_PRINTF, fd, file);
+
+    report("printf", size, printf_result, printf_result.seconds);
+    report("csv", size, best_of(size, EXPORT_CSV, fd, file), printf_result.seconds);
+    report("ndjson", size, best_of(size, EXPORT_NDJSON, fd, file), printf_result.seconds);
+
+    fclose(file);
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Goodput of the frame pipeline over a simulated bit-error channel.
+ *
+ * A stream of `Downlink` telemetry frames is sent through a binary symmetric channel,
+ * split back into frames with the deframer and decoded. Bit errors are free to hit
+ * COBS code bytes and delimiters, so frames can also be merged or split, as on a real
+ * radio. For each bit error rate the plain `rp_packet_encode` path is compared with
+ * Reed-Solomon parity of increasing strength.
+ *
+ * Output is CSV, ready to plot goodput against BER:
+ *
+ *     ber,scheme,frames_sent,frames_ok,frames_corrected,frame_success,goodput
+ *
+ * `goodput` is decoded protobuf payload bytes per byte sent on the wire.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "channel.h"
+#include "pb_encode.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "rp/fec/rs.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define FRAME_COUNT (20000)
+
+typedef struct scheme {
+    const char *name;
+    size_t parity_size; /**< 0 for the plain pipeline */
+} scheme_t;
+
+static const scheme_t schemes[] = {
+    {"plain", 0},
+    {"rs+8", 8},
+    {"rs+16", 16},
+    {"rs+32", 32},
+};
+
+static const double bit_error_rates[] = {
+    0.0, 1e-6, 3e-6, 1e-5, 3e-5, 1e-4, 3e-4, 1e-3, 2e-3, 5e-3, 1e-2,
+};
+
+static void run(const scheme_t *scheme, double ber)
+{
+    rs_codec_t fec;
+    rp_codec_options_t options = {.fec = NULL};
+
+    if (scheme->parity_size > 0) {
+        rs_codec_init(&fec, scheme->parity_size);
+        options.fec = &fec;
+    }
+
+    bench_rng_t rng = {.state = 0xD1B54A32D192ED03ULL};
+
+    uint8_t rx_buffer[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+
+    rp_deframer_init(&deframer, rx_buffer, sizeof(rx_buffer));
+
+    uint64_t wire_bytes = 0;
+    uint64_t payload_bytes = 0;
+    uint32_t frames_ok = 0;
+    uint32_t frames_corrected = 0;
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        tvr_Downlink downlink;
+        uint8_t wire[RP_PACKET_MAX_SIZE];
+
+        bench_fill_telemetry(&downlink, i * BENCH_CAPTURE_PERIOD_MS);
+
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            wire, sizeof(wire), tvr_Downlink_fields, &downlink, &options);
+
+        if (encoded.status != RP_CODEC_OK) {
+            fprintf(stderr, "encode failed: %d\n", encoded.status);
+            return;
+        }
+
+        wire_bytes += encoded.written;
+        channel_flip_bits(&rng, wire, encoded.written, ber);
+
+        size_t offset = 0;
+
+        while (offset < encoded.written) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(&deframer, &wire[offset], encoded.written - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink decoded_downlink = tvr_Downlink_init_zero;
+
+            rp_packet_decode_result_t decoded = rp_packet_decode_with_options(
+                deframer.buffer, deframer.size, tvr_Downlink_fields, &decoded_downlink,
+                &options);
+
+            if (decoded.status != RP_CODEC_OK) {
+                continue;
+            }
+
+            size_t payload_size = 0;
+
+            pb_get_encoded_size(&payload_size, tvr_Downlink_fields, &decoded_downlink);
+
+            frames_ok++;
+            frames_corrected += (decoded.corrected > 0);
+            payload_bytes += payload_size;
+        }
+    }
+
+    printf("%g,%s,%u,%u,%u,%.4f,%.4f\n", ber, scheme->name, (unsigned)FRAME_COUNT,
+           (unsigned)frames_ok, (unsigned)frames_corrected,
+           (double)frames_ok / (double)FRAME_COUNT,
+           (double)payload_bytes / (double)wire_bytes);
+}
+
+int main(void)
+{
+    printf("ber,scheme,frames_sent,frames_ok,frames_corrected,frame_success,goodput\n");
+
+    for (size_t b = 0; b < sizeof(bit_error_rates) / sizeof(bit_error_rates[0]); b++) {
+        for (size_t s = 0; s < sizeof(schemes) / sizeof(schemes[0]); s++) {
+            run(&schemes[s], bit_error_rates[b]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * Fan-out latency of the telemetry gateway.
+ *
+ * A publisher plays the gateway and publishes a decoded `tvr_Downlink` at a fixed
+ * rate, servicing consumer sockets between records as the gateway loop does. Each
+ * consumer is a thread blocked in `rp_fanout_receive` that records the time from
+ * publication to receipt. The run is repeated with 1, 8 and 64 consumers.
+ *
+ * Output is CSV:
+ *
+ *     consumers,records,publish_ns,p50_us,p99_us,max_us,dropped
+ */
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "fanout.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define MAX_CONSUMERS (64)
+#define RECORD_COUNT (2000)
+#define PERIOD_NS (200000ULL)
+
+typedef struct consumer {
+    pthread_t thread;
+    int fd;
+    size_t received;
+    uint32_t latencies_ns[RECORD_COUNT];
+} consumer_t;
+
+static rp_fanout_t fanout;
+static consumer_t consumers[MAX_CONSUMERS];
+static uint32_t all_latencies_ns[MAX_CONSUMERS * RECORD_COUNT];
+static char path[64];
+
+static void *consume(void *argument)
+{
+    consumer_t *consumer = argument;
+    rp_fanout_record_header_t header;
+    tvr_Downlink downlink;
+
+    while (rp_fanout_receive(consumer->fd, &header, &downlink, sizeof(downlink)) ==
+           RP_FANOUT_OK) {
+        uint64_t latency_ns = bench_now_ns() - header.received_ns;
+
+        if (consumer->received < RECORD_COUNT) {
+            consumer->latencies_ns[consumer->received++] =
+                (latency_ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)latency_ns;
+        }
+    }
+
+    return NULL;
+}
+
+static void service(void)
+{
+    struct pollfd fds[RP_FANOUT_POLL_FDS];
+
+    rp_fanout_poll_fds(&fanout, fds);
+
+    if (poll(fds, RP_FANOUT_POLL_FDS, 0) > 0) {
+        rp_fanout_handle(&fanout, fds);
+    }
+}
+
+static int run(size_t consumer_count)
+{
+    if (rp_fanout_open(&fanout, path, RP_FANOUT_DROP_OLDEST) != RP_FANOUT_OK) {
+        perror(path);
+        return -1;
+    }
+
+    for (size_t i = 0; i < consumer_count; i++) {
+        consumers[i].received = 0;
+        consumers[i].fd = rp_fanout_connect(path, RP_FANOUT_DROP_OLDEST);
+
+        if (consumers[i].fd < 0) {
+            perror("connect");
+            return -1;
+        }
+
+        rp_fanout_accept(&fanout);
+        pthread_create(&consumers[i].thread, NULL, consume, &consumers[i]);
+    }
+
+    while (fanout.consumer_count < consumer_count) {
+        service();
+    }
+
+    uint64_t publish_ns = 0;
+    uint64_t next_ns = bench_now_ns();
+
+    for (uint32_t r = 0; r < RECORD_COUNT; r++) {
+        tvr_Downlink downlink;
+
+        bench_fill_telemetry(&downlink, r);
+
+        // Pace the records and keep the consumer sockets serviced in between
+        while (bench_now_ns() < next_ns) {
+            service();
+        }
+
+        uint64_t start_ns = bench_now_ns();
+
+        rp_fanout_publish(&fanout, &downlink, sizeof(downlink), start_ns);
+        publish_ns += bench_now_ns() - start_ns;
+        next_ns += PERIOD_NS;
+    }
+
+    // Let the queues drain before the consumers are disconnected
+    uint64_t deadline_ns = bench_now_ns() + 100000000ULL;
+    bool pending = true;
+
+    while (pending && bench_now_ns() < deadline_ns) {
+        service();
+
+        pending = false;
+
+        for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+            pending = pending || fanout.consumers[i].count > 0;
+        }
+    }
+
+    uint64_t dropped = 0;
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        dropped += fanout.consumers[i].dropped;
+    }
+
+    rp_fanout_close(&fanout);
+
+    size_t sample_count = 0;
+
+    for (size_t i = 0; i < consumer_count; i++) {
+        pthread_join(consumers[i].thread, NULL);
+        close(consumers[i].fd);
+
+        memcpy(&all_latencies_ns[sample_count], consumers[i].latencies_ns,
+               consumers[i].received * sizeof(uint32_t));
+        sample_count += consumers[i].received;
+    }
+
+    uint32_t p50 = bench_percentile_u32(all_latencies_ns, sample_count, 50.0);
+    uint32_t p99 = bench_percentile_u32(all_latencies_ns, sample_count, 99.0);
+    uint32_t max = (sample_count > 0) ? all_latencies_ns[sample_count - 1] : 0;
+
+    printf("%u,%u,%.0f,%.1f,%.1f,%.1f,%llu\n", (unsigned)consumer_count, (unsigned)RECORD_COUNT,
+           (double)publish_ns / RECORD_COUNT, p50 / 1000.0, p99 / 1000.0, max / 1000.0,
+           (unsigned long long)dropped);
+
+    return 0;
+}
+
+int main(void)
+{
+    static const size_t consumer_counts[] = {1, 8, MAX_CONSUMERS};
+
+    snprintf(path, sizeof(path), "/tmp/rp_bench_fanout_%ld.sock", (long)getpid());
+
+    printf("consumers,records,publish_ns,p50_us,p99_us,max_us,dropped\n");
+
+    for (size_t i = 0; i < sizeof(consumer_counts) / sizeof(consumer_counts[0]); i++) {
+        if (run(consumer_counts[i]) != 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
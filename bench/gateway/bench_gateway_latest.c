@@ -0,0 +1,154 @@
+/**
+ * Reader cost and staleness of the seqlock latest-value table.
+ *
+ * One writer thread updates the `TelemetryState` slot every `PERIOD_NS`, as the
+ * gateway does at a high telemetry rate, while 1, 4 or 16 reader threads copy
+ * snapshots in a loop. For each read the time spent in `rp_latest_read` and the age of
+ * the copied value are recorded.
+ *
+ * Output is CSV:
+ *
+ *     readers,reads,read_p50_ns,read_p99_ns,read_max_ns,retry_rate,age_p99_us
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "latest.h"
+#include "tvr/downlink.pb.h"
+
+#define MAX_READERS (16)
+#define SAMPLES_PER_READER (100000)
+#define RUN_NS (200000000ULL)
+#define PERIOD_NS (10000ULL)
+
+typedef struct reader {
+    pthread_t thread;
+    size_t reads;
+    uint64_t retries;
+    uint32_t read_ns[SAMPLES_PER_READER];
+    uint32_t age_ns[SAMPLES_PER_READER];
+} reader_t;
+
+static rp_latest_table_t table;
+static reader_t readers[MAX_READERS];
+static uint32_t read_ns[MAX_READERS * SAMPLES_PER_READER];
+static uint32_t age_ns[MAX_READERS * SAMPLES_PER_READER];
+static atomic_bool running;
+
+static void *write_loop(void *argument)
+{
+    (void)argument;
+
+    tvr_TelemetryState telemetry = tvr_TelemetryState_init_zero;
+    uint64_t next_ns = bench_now_ns();
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        while (bench_now_ns() < next_ns) {
+        }
+
+        uint64_t now_ns = bench_now_ns();
+
+        telemetry.timestamp_ms = (uint32_t)(now_ns / 1000000);
+        telemetry.thrust_cmd += 0.001f;
+
+        rp_latest_write(&table, tvr_Downlink_telemetry_tag, &telemetry, sizeof(telemetry),
+                        now_ns);
+
+        next_ns += PERIOD_NS;
+    }
+
+    return NULL;
+}
+
+static void *read_loop(void *argument)
+{
+    reader_t *reader = argument;
+
+    while (atomic_load_explicit(&running, memory_order_relaxed) &&
+           reader->reads < SAMPLES_PER_READER) {
+        tvr_TelemetryState telemetry;
+        rp_latest_snapshot_t snapshot;
+
+        uint64_t start_ns = bench_now_ns();
+        rp_latest_status_t status = rp_latest_read(&table, tvr_Downlink_telemetry_tag,
+                                                   &telemetry, sizeof(telemetry), &snapshot);
+        uint64_t end_ns = bench_now_ns();
+
+        if (status != RP_LATEST_OK) {
+            continue;
+        }
+
+        reader->read_ns[reader->reads] = (uint32_t)(end_ns - start_ns);
+        reader->age_ns[reader->reads] = (uint32_t)(end_ns - snapshot.updated_ns);
+        reader->retries += snapshot.retries;
+        reader->reads++;
+    }
+
+    return NULL;
+}
+
+static void run(size_t reader_count)
+{
+    pthread_t writer;
+
+    rp_latest_init(&table);
+    atomic_store(&running, true);
+
+    pthread_create(&writer, NULL, write_loop, NULL);
+
+    for (size_t i = 0; i < reader_count; i++) {
+        readers[i].reads = 0;
+        readers[i].retries = 0;
+        pthread_create(&readers[i].thread, NULL, read_loop, &readers[i]);
+    }
+
+    uint64_t end_ns = bench_now_ns() + RUN_NS;
+
+    while (bench_now_ns() < end_ns) {
+    }
+
+    atomic_store(&running, false);
+    pthread_join(writer, NULL);
+
+    size_t sample_count = 0;
+    uint64_t retries = 0;
+
+    for (size_t i = 0; i < reader_count; i++) {
+        pthread_join(readers[i].thread, NULL);
+
+        for (size_t s = 0; s < readers[i].reads; s++) {
+            read_ns[sample_count] = readers[i].read_ns[s];
+            age_ns[sample_count] = readers[i].age_ns[s];
+            sample_count++;
+        }
+
+        retries += readers[i].retries;
+    }
+
+    uint32_t read_p50 = bench_percentile_u32(read_ns, sample_count, 50.0);
+    uint32_t read_p99 = bench_percentile_u32(read_ns, sample_count, 99.0);
+    uint32_t read_max = (sample_count > 0) ? read_ns[sample_count - 1] : 0;
+    uint32_t age_p99 = bench_percentile_u32(age_ns, sample_count, 99.0);
+
+    printf("%u,%u,%u,%u,%u,%.4f,%.1f\n", (unsigned)reader_count, (unsigned)sample_count,
+           (unsigned)read_p50, (unsigned)read_p99, (unsigned)read_max,
+           (sample_count > 0) ? (double)retries / (double)sample_count : 0.0, age_p99 / 1000.0);
+}
+
+int main(void)
+{
+    static const size_t reader_counts[] = {1, 4, MAX_READERS};
+
+    printf("readers,reads,read_p50_ns,read_p99_ns,read_max_ns,retry_rate,age_p99_us\n");
+
+    for (size_t i = 0; i < sizeof(reader_counts) / sizeof(reader_counts[0]); i++) {
+        run(reader_counts[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * Cost of building the summary pyramid of a capture, and of plotting from it.
+ *
+ * A capture of `Downlink` frames, ten `TelemetryState` for every `SystemStatus`, is built
+ * in memory and indexed once with every telemetry field. The benchmark then plots
+ * `position.z` over the whole capture and over its last hundredth, `PIXELS` wide, in two
+ * ways:
+ *
+ * - `decode`: split and decode every frame, keeping the min/max of each pixel's range
+ * - `index`: open the side file, pick a level and read its summaries
+ *
+ * It prints the build time and capture megabytes per second, then for each plot the best
+ * time in microseconds, the summaries or frames read, and the speedup of `index` over
+ * `decode`.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "index.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define FRAME_COUNT (200000)
+#define PIXELS (1000)
+#define REPEATS (5)
+
+typedef struct plot_result {
+    double seconds;
+    uint64_t reads; /**< Frames decoded or summaries read */
+} plot_result_t;
+
+static uint8_t capture[FRAME_COUNT * RP_PACKET_MAX_SIZE];
+static rp_index_builder_t builder;
+static rp_index_summary_t summaries[2 * PIXELS + 2];
+static float plot_min[PIXELS];
+static float plot_max[PIXELS];
+
+static void build_index(size_t size)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    size_t offset = 0;
+
+    rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag, NULL, 7);
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    while (offset < size) {
+        rp_deframer_result_t rx = rp_deframer_feed(&deframer, &capture[offset], size - offset);
+
+        offset += rx.consumed;
+
+        if (rx.status != RP_DEFRAMER_FRAME_READY) {
+            continue;
+        }
+
+        tvr_Downlink downlink = tvr_Downlink_init_zero;
+
+        if (rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink)
+                .status == RP_CODEC_OK) {
+            rp_index_add(&builder, &downlink);
+        }
+    }
+
+    rp_index_finish(&builder);
+}
+
+/**
+ * Plots from the capture itself: every frame is decoded, and the ones in range are binned.
+ */
+static plot_result_t plot_decode(size_t size, uint32_t start_ms, uint32_t end_ms)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    plot_result_t result = {0};
+    uint64_t span_ms = (uint64_t)end_ms - start_ms + 1;
+    size_t offset = 0;
+
+    for (size_t p = 0; p < PIXELS; p++) {
+        plot_min[p] = INFINITY;
+        plot_max[p] = -INFINITY;
+    }
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    uint64_t start = bench_now_ns();
+
+    while (offset < size) {
+        rp_deframer_result_t rx = rp_deframer_feed(&deframer, &capture[offset], size - offset);
+
+        offset += rx.consumed;
+
+        if (rx.status != RP_DEFRAMER_FRAME_READY) {
+            continue;
+        }
+
+        tvr_Downlink downlink = tvr_Downlink_init_zero;
+        rp_packet_decode_result_t decoded =
+            rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+        result.reads++;
+
+        if (decoded.status != RP_CODEC_OK ||
+            downlink.which_payload != tvr_Downlink_telemetry_tag) {
+            continue;
+        }
+
+        const tvr_TelemetryState *telemetry = &downlink.payload.telemetry;
+
+        if (!telemetry->has_position || telemetry->timestamp_ms < start_ms ||
+            telemetry->timestamp_ms > end_ms) {
+            continue;
+        }
+
+        size_t p = (size_t)((telemetry->timestamp_ms - start_ms) * PIXELS / span_ms);
+
+        plot_min[p] = fminf(plot_min[p], telemetry->position.z);
+        plot_max[p] = fmaxf(plot_max[p], telemetry->position.z);
+    }
+
+    result.seconds = (double)(bench_now_ns() - start) * 1e-9;
+
+    return result;
+}
+
+/**
+ * Plots from the side file, opened afresh as a plot tool would.
+ */
+static plot_result_t plot_index(int fd, uint32_t start_ms, uint32_t end_ms)
+{
+    rp_index_reader_t reader;
+    plot_result_t result = {0};
+    size_t count = 0;
+
+    uint64_t start = bench_now_ns();
+
+    if (rp_index_open(&reader, fd) == RP_INDEX_OK) {
+        size_t field = rp_index_find_field(&reader, "position.z");
+        size_t level = rp_index_choose_level(&reader, start_ms, end_ms, PIXELS);
+
+        rp_index_read(&reader, level, field, start_ms, end_ms, summaries,
+                      sizeof(summaries) / sizeof(summaries[0]), &count);
+    }
+
+    result.seconds = (double)(bench_now_ns() - start) * 1e-9;
+    result.reads = count;
+
+    return result;
+}
+
+static void report(const char *name, plot_result_t result, double decode_seconds)
+{
+    printf("%-16s %11.1f %9llu %9.1f\n", name, result.seconds * 1e6,
+           (unsigned long long)result.reads, decode_seconds / result.seconds);
+}
+
+static void compare(const char *name, size_t size, int fd, uint32_t start_ms, uint32_t end_ms)
+{
+    plot_result_t decode = {0};
+    plot_result_t index = {0};
+    char label[32];
+
+    for (int r = 0; r < REPEATS; r++) {
+        plot_result_t result = plot_decode(size, start_ms, end_ms);
+
+        if (r == 0 || result.seconds < decode.seconds) {
+            decode = result;
+        }
+
+        result = plot_index(fd, start_ms, end_ms);
+
+        if (r == 0 || result.seconds < index.seconds) {
+            index = result;
+        }
+    }
+
+    snprintf(label, sizeof(label), "%s decode", name);
+    report(label, decode, decode.seconds);
+    snprintf(label, sizeof(label), "%s index", name);
+    report(label, index, decode.seconds);
+}
+
+int main(void)
+{
+    size_t size = bench_build_capture(capture, sizeof(capture), FRAME_COUNT);
+    FILE *file = tmpfile();
+
+    if (file == NULL) {
+        perror("tmpfile");
+        return 1;
+    }
+
+    uint64_t start = bench_now_ns();
+
+    build_index(size);
+
+    double build_seconds = (double)(bench_now_ns() - start) * 1e-9;
+
+    if (rp_index_write(&builder, fileno(file)) != RP_INDEX_OK) {
+        perror("write");
+        return 1;
+    }
+
+    printf("build %.1f ms, %.1f MB/s, %zu fields, %zu level 0 buckets\n", build_seconds * 1e3,
+           (double)size / build_seconds * 1e-6, builder.field_count,
+           builder.levels[0].bucket_count);
+
+    uint32_t end_ms = (FRAME_COUNT - 1) * BENCH_CAPTURE_PERIOD_MS;
+
+    printf("%-16s %11s %9s %9s\n", "plot", "us", "reads", "speedup");
+    compare("full", size, fileno(file), 0, end_ms);
+    compare("zoom", size, fileno(file), end_ms - end_ms / 100, end_ms);
+
+    rp_index_builder_free(&builder);
+    fclose(file);
+
+    return 0;
+}
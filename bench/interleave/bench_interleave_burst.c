@@ -0,0 +1,202 @@
+/**
+ * Telemetry delivered through radio fades, with and without interleaving.
+ *
+ * A stream of `Downlink` telemetry frames is sent through a Gilbert-Elliott fading
+ * channel, where fades replace runs of consecutive bytes with noise, split back into
+ * frames with the deframer and decoded. The plain `rp_packet_encode` path and
+ * Reed-Solomon parity alone, which a fade longer than half the parity defeats, are
+ * compared with parity behind an interleaver of increasing depth, which spreads each fade
+ * over `depth` packets and corrects the frames it loses as erasures.
+ *
+ * Output is CSV, one row per channel and scheme:
+ *
+ *     fade_bytes,fade_rate,scheme,depth,latency_frames,frames_sent,frames_ok,delivery,goodput
+ *
+ * `latency_frames` is the delay the interleaver adds on the sending end, in packet
+ * periods. `goodput` is decoded protobuf payload bytes per byte sent on the wire.
+ *
+ * A fade costs the interleaved schemes a whole frame, so a block survives only while its
+ * lost frames carry no more bytes of each packet than the parity: interleaving pays off
+ * when fades are sparse next to the block, and costs more than it saves when they are not.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "channel.h"
+#include "pb_encode.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "rp/fec/rs.h"
+#include "rp/interleave/interleave.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define FRAME_COUNT (20000)
+
+// Interleaved frames go through the same deframer buffer as plain packets
+_Static_assert(RP_INTERLEAVE_FRAME_MAX_SIZE == RP_PACKET_MAX_SIZE, "frame must fit a packet");
+
+typedef struct scheme {
+    const char *name;
+    size_t parity_size; /**< 0 for no Reed-Solomon parity */
+    size_t depth;       /**< 0 for no interleaving */
+} scheme_t;
+
+/**
+ * Receiving end of a run, and its counters.
+ */
+typedef struct run_state {
+    const rp_codec_options_t *options;
+    bench_rng_t rng;
+    channel_fade_t channel;
+    rp_deframer_t deframer;
+    rp_deinterleaver_t deinterleaver;
+    bool interleaved;
+
+    uint64_t wire_bytes;
+    uint64_t payload_bytes;
+    uint32_t frames_ok;
+} run_state_t;
+
+static const scheme_t schemes[] = {
+    {"plain", 0, 0},         {"rs+16", 16, 0},       {"rs+32", 32, 0},
+    {"rs+16/il16", 16, 16},  {"rs+32/il4", 32, 4},   {"rs+32/il8", 32, 8},
+    {"rs+32/il16", 32, 16},
+};
+
+static const double fade_lengths[] = {4.0, 16.0, 64.0};
+static const double fade_rates[] = {1e-4, 1e-3, 3e-3};
+
+/**
+ * Decodes a packet, straight from the deframer or from the deinterleaver.
+ */
+static bool decode(void *context, const uint8_t *packet, size_t size)
+{
+    run_state_t *state = context;
+    tvr_Downlink downlink = tvr_Downlink_init_zero;
+    rp_packet_decode_result_t decoded =
+        rp_packet_decode_with_options(packet, size, tvr_Downlink_fields, &downlink, state->options);
+
+    if (decoded.status == RP_CODEC_OK) {
+        size_t payload_size = 0;
+
+        pb_get_encoded_size(&payload_size, tvr_Downlink_fields, &downlink);
+
+        state->frames_ok++;
+        state->payload_bytes += payload_size;
+    }
+
+    return true;
+}
+
+/**
+ * Sends a frame through the channel and hands what comes out of the deframer on.
+ */
+static bool transmit(void *context, const uint8_t *frame, size_t size)
+{
+    run_state_t *state = context;
+    uint8_t wire[RP_PACKET_MAX_SIZE];
+    size_t offset = 0;
+
+    memcpy(wire, frame, size);
+    state->wire_bytes += size;
+    channel_fade_bytes(&state->rng, &state->channel, wire, size);
+
+    while (offset < size) {
+        rp_deframer_result_t rx = rp_deframer_feed(&state->deframer, &wire[offset], size - offset);
+
+        offset += rx.consumed;
+
+        if (rx.status != RP_DEFRAMER_FRAME_READY) {
+            continue;
+        }
+
+        if (state->interleaved) {
+            rp_deinterleaver_push(&state->deinterleaver, state->deframer.buffer,
+                                  state->deframer.size);
+        } else {
+            decode(state, state->deframer.buffer, state->deframer.size);
+        }
+    }
+
+    return true;
+}
+
+static void run(const scheme_t *scheme, double fade_bytes, double fade_rate)
+{
+    rs_codec_t fec;
+    rp_codec_options_t options = {.fec = NULL};
+    uint8_t rx_buffer[RP_PACKET_MAX_SIZE];
+    rp_interleaver_t interleaver;
+    run_state_t state = {
+        .options = &options,
+        .rng = {.state = 0xD1B54A32D192ED03ULL},
+        .channel = {.fade_rate = fade_rate, .fade_bytes = fade_bytes},
+        .interleaved = scheme->depth > 0,
+    };
+
+    if (scheme->parity_size > 0) {
+        rs_codec_init(&fec, scheme->parity_size);
+        options.fec = &fec;
+    }
+
+    rp_deframer_init(&state.deframer, rx_buffer, sizeof(rx_buffer));
+    rp_deinterleaver_init(&state.deinterleaver, options.fec, decode, &state);
+
+    if (state.interleaved) {
+        rp_interleaver_init(&interleaver, scheme->depth, transmit, &state);
+    }
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        tvr_Downlink downlink;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        bench_fill_telemetry(&downlink, i * BENCH_CAPTURE_PERIOD_MS);
+
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            packet, sizeof(packet), tvr_Downlink_fields, &downlink, &options);
+
+        if (encoded.status != RP_CODEC_OK) {
+            fprintf(stderr, "encode failed: %d\n", encoded.status);
+            return;
+        }
+
+        if (state.interleaved) {
+            rp_interleaver_push(&interleaver, packet, encoded.written);
+        } else {
+            transmit(&state, packet, encoded.written);
+        }
+    }
+
+    if (state.interleaved) {
+        rp_interleaver_flush(&interleaver);
+        rp_deinterleaver_flush(&state.deinterleaver);
+    }
+
+    size_t latency = (scheme->depth > 0) ? scheme->depth - 1 : 0;
+
+    printf("%g,%g,%s,%zu,%zu,%u,%u,%.4f,%.4f\n", fade_bytes, fade_rate, scheme->name,
+           scheme->depth, latency, (unsigned)FRAME_COUNT, (unsigned)state.frames_ok,
+           (double)state.frames_ok / (double)FRAME_COUNT,
+           (double)state.payload_bytes / (double)state.wire_bytes);
+}
+
+int main(void)
+{
+    printf("fade_bytes,fade_rate,scheme,depth,latency_frames,frames_sent,frames_ok,delivery,"
+           "goodput\n");
+
+    for (size_t l = 0; l < sizeof(fade_lengths) / sizeof(fade_lengths[0]); l++) {
+        for (size_t r = 0; r < sizeof(fade_rates) / sizeof(fade_rates[0]); r++) {
+            for (size_t s = 0; s < sizeof(schemes) / sizeof(schemes[0]); s++) {
+                run(&schemes[s], fade_lengths[l], fade_rates[r]);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,608 @@
+/**
+ * End-to-end link simulator.
+ *
+ * A fake flight computer and a fake ground station run in their own threads and talk
+ * through socketpairs, the same byte-stream interface a serial port or pty gives them.
+ * A third thread plays the radio between them:
+ *
+ *     flight computer <-> radio <-> ground station
+ *
+ * The flight computer streams `TelemetryState` and `SystemStatus` at the configured
+ * rates and executes `FlightCommand`s; the ground station decodes the downlink and
+ * sends commands back. The radio forwards bytes in both directions at the configured
+ * baud rate (8N1), buffering up to `RADIO_BUFFER_SIZE` bytes per direction and losing
+ * whatever does not fit, flips bits with the configured bit error rate and loses whole
+ * frames with the configured probability. Every frame carries a link header so the
+ * receiver can measure latency from encode to decode.
+ *
+ * Without arguments a sweep of telemetry rates and baud rates is run. Options select a
+ * single run instead:
+ *
+ *     -r telemetry_hz  -s status_hz  -c command_hz  -b baud (0 = unlimited)
+ *     -e bit_error_rate  -d frame_drop_probability  -t seconds
+ *
+ * Output is CSV:
+ *
+ *     telemetry_hz,baud,ber,drop,sent_fps,received_fps,lost_pct,decode_errors,
+ *     fc_cpu_ns,gs_cpu_ns,latency_p50_us,latency_p99_us,commands,command_p99_us
+ *
+ * `fc_cpu_ns` and `gs_cpu_ns` are the CPU time of each endpoint thread divided by the
+ * number of frames it handled, including its polling overhead.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "channel.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "rp/link/link.h"
+#include "telemetry.h"
+#include "tvr/command.pb.h"
+#include "tvr/downlink.pb.h"
+
+#define RADIO_BUFFER_SIZE (4096)
+#define RADIO_TICK_NS (250000ULL)
+#define MAX_SAMPLES (1 << 20)
+#define READ_CHUNK (1024)
+
+typedef struct sim_config {
+    double telemetry_hz;
+    double status_hz;
+    double command_hz;
+    uint32_t baud;
+    double ber;
+    double drop;
+    double seconds;
+} sim_config_t;
+
+/**
+ * One direction of the radio.
+ */
+typedef struct radio_path {
+    int input;
+    int output;
+    uint8_t buffer[RADIO_BUFFER_SIZE];
+    size_t head;
+    size_t count;
+    uint64_t budget_milli; /**< Bytes the baud rate allows to send now, in milli-bytes */
+    bool in_frame;         /**< The next byte continues a frame */
+    bool dropping;         /**< The current frame is being lost */
+    bench_rng_t rng;
+    uint64_t overflow_bytes;
+} radio_path_t;
+
+typedef struct endpoint_stats {
+    uint64_t sent;
+    uint64_t received;
+    uint64_t decode_errors;
+    uint64_t cpu_ns;
+    size_t latency_count;
+    uint32_t *latencies_us;
+} endpoint_stats_t;
+
+static sim_config_t config;
+static atomic_bool running;
+static atomic_bool sending;
+
+static radio_path_t downlink_path;
+static radio_path_t uplink_path;
+static endpoint_stats_t fc_stats;
+static endpoint_stats_t gs_stats;
+
+static uint32_t now_us(void)
+{
+    return (uint32_t)(bench_now_ns() / 1000);
+}
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline_ns)
+{
+    struct timespec ts = {
+        .tv_sec = (time_t)(deadline_ns / 1000000000ULL),
+        .tv_nsec = (long)(deadline_ns % 1000000000ULL),
+    };
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+static uint64_t period_ns(double hz)
+{
+    return (hz > 0.0) ? (uint64_t)(1e9 / hz) : UINT64_MAX;
+}
+
+static void record_latency(endpoint_stats_t *stats, const rp_link_header_t *header)
+{
+    if (stats->latency_count < MAX_SAMPLES) {
+        stats->latencies_us[stats->latency_count++] = now_us() - header->timestamp_us;
+    }
+}
+
+// Sends a whole frame, or nothing when the line is backed up like a full UART FIFO
+static void send_frame(int fd, endpoint_stats_t *stats, const uint8_t *frame, size_t size)
+{
+    if (write(fd, frame, size) == (ssize_t)size) {
+        stats->sent++;
+    }
+}
+
+/**
+ * Feeds everything readable on `fd` to the deframer and decodes each frame.
+ */
+static void receive_frames(int fd, rp_deframer_t *deframer, endpoint_stats_t *stats,
+                           const pb_msgdesc_t *fields, void *message, size_t message_size)
+{
+    uint8_t chunk[READ_CHUNK];
+    ssize_t count;
+
+    while ((count = read(fd, chunk, sizeof(chunk))) > 0) {
+        size_t offset = 0;
+
+        while (offset < (size_t)count) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(deframer, &chunk[offset], (size_t)count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            rp_link_header_t header;
+            rp_codec_options_t options = {.link_header = &header};
+
+            memset(message, 0, message_size);
+
+            rp_packet_decode_result_t decoded = rp_packet_decode_with_options(
+                deframer->buffer, deframer->size, fields, message, &options);
+
+            if (decoded.status != RP_CODEC_OK) {
+                stats->decode_errors++;
+                continue;
+            }
+
+            stats->received++;
+            record_latency(stats, &header);
+        }
+    }
+}
+
+static size_t encode_downlink(uint8_t *frame, rp_link_sender_t *sender, bool status,
+                              uint32_t sequence)
+{
+    tvr_Downlink downlink;
+
+    if (status) {
+        bench_fill_status(&downlink, sequence);
+    } else {
+        bench_fill_telemetry(&downlink, sequence);
+    }
+
+    rp_link_header_t header = rp_link_sender_next(sender, now_us());
+    rp_codec_options_t options = {.link_header = &header};
+
+    rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+        frame, RP_PACKET_MAX_SIZE, tvr_Downlink_fields, &downlink, &options);
+
+    return encoded.status == RP_CODEC_OK ? encoded.written : 0;
+}
+
+static size_t encode_command(uint8_t *frame, rp_link_sender_t *sender, uint32_t sequence)
+{
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    command.which_payload = tvr_FlightCommand_state_cmd_tag;
+    command.payload.state_cmd.type = tvr_StateCommand_Type_CMD_ARM;
+    command.command_id = sequence;
+
+    rp_link_header_t header = rp_link_sender_next(sender, now_us());
+    rp_codec_options_t options = {.link_header = &header};
+
+    rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+        frame, RP_PACKET_MAX_SIZE, tvr_FlightCommand_fields, &command, &options);
+
+    return encoded.status == RP_CODEC_OK ? encoded.written : 0;
+}
+
+static void *flight_computer(void *argument)
+{
+    int fd = *(const int *)argument;
+    uint8_t rx_buffer[RP_PACKET_MAX_SIZE];
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    rp_link_sender_t sender;
+    tvr_FlightCommand command;
+
+    rp_deframer_init(&deframer, rx_buffer, sizeof(rx_buffer));
+    rp_link_sender_init(&sender, 0);
+
+    uint64_t telemetry_period = period_ns(config.telemetry_hz);
+    uint64_t status_period = period_ns(config.status_hz);
+    uint64_t start_ns = bench_now_ns();
+    uint64_t next_telemetry = start_ns;
+    uint64_t next_status = start_ns;
+    uint64_t cpu_start = thread_cpu_ns();
+    uint32_t sequence = 0;
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        uint64_t now = bench_now_ns();
+        bool active = atomic_load_explicit(&sending, memory_order_relaxed);
+
+        if (!active) {
+            next_telemetry = next_status = now + 1000000ULL;
+        }
+
+        if (now >= next_telemetry) {
+            size_t size = encode_downlink(frame, &sender, false, sequence++);
+
+            send_frame(fd, &fc_stats, frame, size);
+            next_telemetry += telemetry_period;
+        }
+
+        if (now >= next_status) {
+            size_t size = encode_downlink(frame, &sender, true, sequence++);
+
+            send_frame(fd, &fc_stats, frame, size);
+            next_status += status_period;
+        }
+
+        receive_frames(fd, &deframer, &fc_stats, tvr_FlightCommand_fields, &command,
+                       sizeof(command));
+
+        // Wake for the next frame, or within a millisecond to poll for commands
+        uint64_t wake = (next_telemetry < next_status) ? next_telemetry : next_status;
+
+        if (wake > now + 1000000ULL) {
+            wake = now + 1000000ULL;
+        }
+
+        sleep_until_ns(wake);
+    }
+
+    uint64_t frames = fc_stats.sent + fc_stats.received;
+
+    fc_stats.cpu_ns = (frames > 0) ? (thread_cpu_ns() - cpu_start) / frames : 0;
+
+    return NULL;
+}
+
+static void *ground_station(void *argument)
+{
+    int fd = *(const int *)argument;
+    uint8_t rx_buffer[RP_PACKET_MAX_SIZE];
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    rp_link_sender_t sender;
+    tvr_Downlink downlink;
+
+    rp_deframer_init(&deframer, rx_buffer, sizeof(rx_buffer));
+    rp_link_sender_init(&sender, 0);
+
+    uint64_t command_period = period_ns(config.command_hz);
+    uint64_t next_command = bench_now_ns() + command_period;
+    uint64_t cpu_start = thread_cpu_ns();
+    uint32_t sequence = 0;
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        struct pollfd fds = {.fd = fd, .events = POLLIN};
+
+        poll(&fds, 1, 1);
+
+        receive_frames(fd, &deframer, &gs_stats, tvr_Downlink_fields, &downlink,
+                       sizeof(downlink));
+
+        if (!atomic_load_explicit(&sending, memory_order_relaxed)) {
+            next_command = bench_now_ns() + command_period;
+        }
+
+        if (bench_now_ns() >= next_command) {
+            size_t size = encode_command(frame, &sender, sequence++);
+
+            send_frame(fd, &gs_stats, frame, size);
+            next_command += command_period;
+        }
+    }
+
+    uint64_t frames = gs_stats.sent + gs_stats.received;
+
+    gs_stats.cpu_ns = (frames > 0) ? (thread_cpu_ns() - cpu_start) / frames : 0;
+
+    return NULL;
+}
+
+static void radio_forward(radio_path_t *path, uint64_t elapsed_ns)
+{
+    uint8_t chunk[READ_CHUNK];
+    ssize_t count;
+
+    // Everything the sender wrote reaches the radio; what does not fit is lost
+    while ((count = read(path->input, chunk, sizeof(chunk))) > 0) {
+        for (ssize_t i = 0; i < count; i++) {
+            if (path->count == RADIO_BUFFER_SIZE) {
+                path->overflow_bytes++;
+                continue;
+            }
+
+            path->buffer[(path->head + path->count) % RADIO_BUFFER_SIZE] = chunk[i];
+            path->count++;
+        }
+    }
+
+    size_t allowed = path->count;
+
+    if (config.baud > 0) {
+        path->budget_milli += elapsed_ns * (config.baud / 10) / 1000000ULL;
+
+        // An idle radio does not bank more than one tick of airtime
+        uint64_t tick_milli = RADIO_TICK_NS * (config.baud / 10) / 1000000ULL;
+
+        if (path->count == 0 && path->budget_milli > tick_milli) {
+            path->budget_milli = tick_milli;
+        }
+
+        if (allowed > path->budget_milli / 1000) {
+            allowed = (size_t)(path->budget_milli / 1000);
+        }
+    }
+
+    size_t out = 0;
+
+    for (size_t i = 0; i < allowed && out < sizeof(chunk); i++) {
+        uint8_t byte = path->buffer[path->head];
+
+        path->head = (path->head + 1) % RADIO_BUFFER_SIZE;
+        path->count--;
+        path->budget_milli -= (config.baud > 0) ? 1000 : 0;
+
+        if (!path->in_frame) {
+            path->in_frame = true;
+            path->dropping = channel_drop(&path->rng, config.drop);
+        }
+
+        if (byte == 0x00) {
+            path->in_frame = false;
+        }
+
+        if (path->dropping) {
+            continue;
+        }
+
+        channel_flip_bits(&path->rng, &byte, 1, config.ber);
+        chunk[out++] = byte;
+    }
+
+    if (out > 0 && write(path->output, chunk, out) < 0) {
+        path->overflow_bytes += out;
+    }
+}
+
+static void *radio(void *argument)
+{
+    (void)argument;
+
+    uint64_t last_ns = bench_now_ns();
+
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        sleep_until_ns(last_ns + RADIO_TICK_NS);
+
+        uint64_t now_ns = bench_now_ns();
+
+        radio_forward(&downlink_path, now_ns - last_ns);
+        radio_forward(&uplink_path, now_ns - last_ns);
+
+        last_ns = now_ns;
+    }
+
+    return NULL;
+}
+
+static bool open_line(int *endpoint, int *radio_side)
+{
+    int fds[2];
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        perror("socketpair");
+        return false;
+    }
+
+    for (size_t i = 0; i < 2; i++) {
+        int flags = fcntl(fds[i], F_GETFL);
+
+        fcntl(fds[i], F_SETFL, flags | O_NONBLOCK);
+    }
+
+    *endpoint = fds[0];
+    *radio_side = fds[1];
+
+    return true;
+}
+
+static void radio_path_init(radio_path_t *path, int input, int output, uint64_t seed)
+{
+    memset(path, 0, sizeof(*path));
+
+    path->input = input;
+    path->output = output;
+    path->rng.state = seed;
+}
+
+static int run(void)
+{
+    int fc_fd;
+    int fc_radio;
+    int gs_fd;
+    int gs_radio;
+
+    if (!open_line(&fc_fd, &fc_radio) || !open_line(&gs_fd, &gs_radio)) {
+        return -1;
+    }
+
+    radio_path_init(&downlink_path, fc_radio, gs_radio, 0x9E3779B97F4A7C15ULL);
+    radio_path_init(&uplink_path, gs_radio, fc_radio, 0xD1B54A32D192ED03ULL);
+
+    uint32_t *fc_latencies = fc_stats.latencies_us;
+    uint32_t *gs_latencies = gs_stats.latencies_us;
+
+    memset(&fc_stats, 0, sizeof(fc_stats));
+    memset(&gs_stats, 0, sizeof(gs_stats));
+    fc_stats.latencies_us = fc_latencies;
+    gs_stats.latencies_us = gs_latencies;
+
+    pthread_t threads[3];
+
+    atomic_store(&running, true);
+    atomic_store(&sending, true);
+
+    pthread_create(&threads[0], NULL, radio, NULL);
+    pthread_create(&threads[1], NULL, ground_station, &gs_fd);
+    pthread_create(&threads[2], NULL, flight_computer, &fc_fd);
+
+    sleep_until_ns(bench_now_ns() + (uint64_t)(config.seconds * 1e9));
+
+    // Stop sending and give the radio time to deliver its buffered bytes
+    uint64_t drain_ns = 50000000ULL;
+
+    if (config.baud > 0) {
+        drain_ns += (uint64_t)RADIO_BUFFER_SIZE * 10 * 1000000000ULL / config.baud;
+    }
+
+    atomic_store(&sending, false);
+    sleep_until_ns(bench_now_ns() + drain_ns);
+    atomic_store(&running, false);
+
+    for (size_t i = 0; i < 3; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    close(fc_fd);
+    close(fc_radio);
+    close(gs_fd);
+    close(gs_radio);
+
+    double sent_fps = (double)fc_stats.sent / config.seconds;
+    double received_fps = (double)gs_stats.received / config.seconds;
+    double lost_pct =
+        (fc_stats.sent > 0)
+            ? 100.0 * (double)(fc_stats.sent - gs_stats.received) / (double)fc_stats.sent
+            : 0.0;
+
+    uint32_t p50 = bench_percentile_u32(gs_stats.latencies_us, gs_stats.latency_count, 50.0);
+    uint32_t p99 = bench_percentile_u32(gs_stats.latencies_us, gs_stats.latency_count, 99.0);
+    uint32_t command_p99 =
+        bench_percentile_u32(fc_stats.latencies_us, fc_stats.latency_count, 99.0);
+
+    printf("%g,%u,%g,%g,%.1f,%.1f,%.2f,%llu,%llu,%llu,%u,%u,%llu,%u\n", config.telemetry_hz,
+           (unsigned)config.baud, config.ber, config.drop, sent_fps, received_fps, lost_pct,
+           (unsigned long long)gs_stats.decode_errors, (unsigned long long)fc_stats.cpu_ns,
+           (unsigned long long)gs_stats.cpu_ns, (unsigned)p50, (unsigned)p99,
+           (unsigned long long)fc_stats.received, (unsigned)command_p99);
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const double telemetry_rates[] = {10, 100, 1000, 5000};
+    static const uint32_t baud_rates[] = {57600, 115200, 0};
+
+    config = (sim_config_t){
+        .telemetry_hz = 100,
+        .status_hz = 1,
+        .command_hz = 10,
+        .baud = 57600,
+        .ber = 0.0,
+        .drop = 0.0,
+        .seconds = 1.0,
+    };
+
+    bool single = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "r:s:c:b:e:d:t:")) != -1) {
+        single = true;
+
+        switch (option) {
+        case 'r':
+            config.telemetry_hz = atof(optarg);
+            break;
+        case 's':
+            config.status_hz = atof(optarg);
+            break;
+        case 'c':
+            config.command_hz = atof(optarg);
+            break;
+        case 'b':
+            config.baud = (uint32_t)strtoul(optarg, NULL, 10);
+            break;
+        case 'e':
+            config.ber = atof(optarg);
+            break;
+        case 'd':
+            config.drop = atof(optarg);
+            break;
+        case 't':
+            config.seconds = atof(optarg);
+            break;
+        default:
+            fprintf(stderr,
+                    "usage: %s [-r telemetry_hz] [-s status_hz] [-c command_hz] [-b baud] "
+                    "[-e ber] [-d drop] [-t seconds]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    fc_stats.latencies_us = malloc(MAX_SAMPLES * sizeof(uint32_t));
+    gs_stats.latencies_us = malloc(MAX_SAMPLES * sizeof(uint32_t));
+
+    if (fc_stats.latencies_us == NULL || gs_stats.latencies_us == NULL) {
+        return 1;
+    }
+
+    printf("telemetry_hz,baud,ber,drop,sent_fps,received_fps,lost_pct,decode_errors,"
+           "fc_cpu_ns,gs_cpu_ns,latency_p50_us,latency_p99_us,commands,command_p99_us\n");
+
+    if (single) {
+        return run() == 0 ? 0 : 1;
+    }
+
+    for (size_t b = 0; b < sizeof(baud_rates) / sizeof(baud_rates[0]); b++) {
+        for (size_t r = 0; r < sizeof(telemetry_rates) / sizeof(telemetry_rates[0]); r++) {
+            config.telemetry_hz = telemetry_rates[r];
+            config.baud = baud_rates[b];
+
+            if (run() != 0) {
+                return 1;
+            }
+        }
+    }
+
+    // A noisy, lossy link at a typical operating point
+    config.telemetry_hz = 100;
+    config.baud = 57600;
+    config.ber = 1e-5;
+    config.drop = 0.01;
+
+    return run() == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+/**
+ * Replay throughput of a recorded downlink through the ordered decode pipeline.
+ *
+ * A capture of `Downlink` frames, ten `TelemetryState` for every `SystemStatus`, is built
+ * in memory and replayed as fast as possible in 4 KiB reads, the way the gateway reads a
+ * pty at high replay speed. The `inline` row splits, decodes and delivers on one thread
+ * like `rp-gateway` does today; the other rows use `rp_pipeline_t` with 1, 2, 4, ...
+ * workers up to the number of online CPUs. For each run the benchmark prints frames and
+ * megabytes per second, the speedup over `inline`, and whether every frame reached the
+ * consumer decoded and in capture order.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "pipeline.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define FRAME_COUNT (200000)
+#define READ_SIZE (4096)
+#define REPEATS (3)
+
+typedef struct consumer {
+    uint64_t frames;
+    uint64_t errors;
+    uint32_t next_timestamp_ms;
+    bool in_order;
+} consumer_t;
+
+static uint8_t capture[FRAME_COUNT * RP_PACKET_MAX_SIZE];
+static rp_pipeline_t pipeline;
+
+/**
+ * Consumer callback: checks the frames come in capture order.
+ */
+static void consume(consumer_t *consumer, rp_codec_status_t status, const tvr_Downlink *downlink)
+{
+    consumer->frames++;
+
+    if (status != RP_CODEC_OK) {
+        consumer->errors++;
+        return;
+    }
+
+    uint32_t timestamp_ms = (downlink->which_payload == tvr_Downlink_telemetry_tag)
+                                ? downlink->payload.telemetry.timestamp_ms
+                                : downlink->payload.status.timestamp_ms;
+
+    consumer->in_order = consumer->in_order && timestamp_ms == consumer->next_timestamp_ms;
+    consumer->next_timestamp_ms = timestamp_ms + BENCH_CAPTURE_PERIOD_MS;
+}
+
+static void consume_result(void *context, const rp_pipeline_result_t *result)
+{
+    consume(context, result->status, result->message);
+}
+
+static double run_inline(size_t size, consumer_t *consumer)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    uint64_t start = bench_now_ns();
+
+    for (size_t offset = 0; offset < size; offset += READ_SIZE) {
+        size_t length = (size - offset < READ_SIZE) ? size - offset : READ_SIZE;
+        size_t consumed = 0;
+
+        while (consumed < length) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(&deframer, &capture[offset + consumed], length - consumed);
+
+            consumed += rx.consumed;
+
+            if (rx.status == RP_DEFRAMER_FRAME_READY) {
+                tvr_Downlink downlink = tvr_Downlink_init_zero;
+                rp_packet_decode_result_t decoded = rp_packet_decode(
+                    deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+                consume(consumer, decoded.status, &downlink);
+            }
+        }
+    }
+
+    return (double)(bench_now_ns() - start) * 1e-9;
+}
+
+static double run_pipeline(size_t size, size_t worker_count, consumer_t *consumer)
+{
+    const rp_pipeline_config_t config = {
+        .worker_count = worker_count,
+        .fields = tvr_Downlink_fields,
+        .message_size = sizeof(tvr_Downlink),
+        .callback = consume_result,
+        .context = consumer,
+    };
+
+    if (rp_pipeline_start(&pipeline, &config) != RP_PIPELINE_OK) {
+        fprintf(stderr, "could not start %zu workers\n", worker_count);
+        return 0.0;
+    }
+
+    uint64_t start = bench_now_ns();
+
+    for (size_t offset = 0; offset < size; offset += READ_SIZE) {
+        size_t length = (size - offset < READ_SIZE) ? size - offset : READ_SIZE;
+
+        rp_pipeline_feed(&pipeline, &capture[offset], length, 0);
+    }
+
+    rp_pipeline_flush(&pipeline);
+
+    double seconds = (double)(bench_now_ns() - start) * 1e-9;
+
+    rp_pipeline_stop(&pipeline);
+
+    return seconds;
+}
+
+/**
+ * Best of `REPEATS` runs, with 0 workers meaning the inline decoder.
+ */
+static double run(size_t size, size_t worker_count, bool *ok)
+{
+    double best = 0.0;
+
+    *ok = true;
+
+    for (int r = 0; r < REPEATS; r++) {
+        consumer_t consumer = {.in_order = true};
+        double seconds = (worker_count == 0) ? run_inline(size, &consumer)
+                                             : run_pipeline(size, worker_count, &consumer);
+
+        *ok = *ok && consumer.in_order && consumer.errors == 0 && consumer.frames == FRAME_COUNT;
+
+        if (r == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+
+    return best;
+}
+
+static void report(const char *name, size_t size, double seconds, double inline_seconds,
+                   bool ok)
+{
+    printf("%-8s %10.0f %8.1f %7.2f %6s\n", name, (double)FRAME_COUNT / seconds,
+           (double)size / seconds * 1e-6, inline_seconds / seconds, ok ? "ok" : "FAIL");
+}
+
+int main(void)
+{
+    size_t size = bench_build_capture(capture, sizeof(capture), FRAME_COUNT);
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_workers = (cpus > 1) ? (size_t)cpus : 1;
+    bool ok;
+
+    if (max_workers > RP_PIPELINE_MAX_WORKERS) {
+        max_workers = RP_PIPELINE_MAX_WORKERS;
+    }
+
+    printf("%-8s %10s %8s %7s %6s\n", "decoder", "frames/s", "MB/s", "speedup", "check");
+
+    double inline_seconds = run(size, 0, &ok);
+
+    report("inline", size, inline_seconds, inline_seconds, ok);
+
+    for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+        char name[16];
+        double seconds = run(size, workers, &ok);
+
+        snprintf(name, sizeof(name), "%zu", workers);
+        report(name, size, seconds, inline_seconds, ok);
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * Frame size and precision of `TelemetryState` downlink frames with and without the
+ * reduced-precision fields of `tvr_Downlink_quant`.
+ *
+ * Random but plausible hover telemetry is encoded both ways and decoded again. For each
+ * mode the benchmark prints the mean frame size, the telemetry rate that fits on common
+ * baud rates (8N1 framing), the encode/decode time per frame, and the largest error of
+ * every quantized field after the round trip.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "tvr/downlink.pb.h"
+#include "tvr/downlink.quant.h"
+
+#define FRAME_COUNT (100000)
+
+static const uint32_t baud_rates[] = {9600, 57600, 115200};
+
+static void random_telemetry(bench_rng_t *rng, tvr_Downlink *downlink, uint32_t now_ms)
+{
+    tvr_TelemetryState *telemetry = &downlink->payload.telemetry;
+
+    *downlink = (tvr_Downlink)tvr_Downlink_init_zero;
+    downlink->which_payload = tvr_Downlink_telemetry_tag;
+
+    // Small random tilt about a level attitude, normalized
+    float w = 1.0f;
+    float x = (float)(bench_rng_uniform(rng) - 0.5) * 0.2f;
+    float y = (float)(bench_rng_uniform(rng) - 0.5) * 0.2f;
+    float z = (float)(bench_rng_uniform(rng) - 0.5) * 2.0f;
+    float norm = sqrtf(w * w + x * x + y * y + z * z);
+
+    telemetry->timestamp_ms = now_ms;
+    telemetry->has_position = true;
+    telemetry->position = (tvr_Vec3){0.1f, -0.2f, 5.0f + (float)bench_rng_uniform(rng)};
+    telemetry->has_velocity = true;
+    telemetry->velocity = (tvr_Vec3){0.01f, -0.02f, (float)bench_rng_uniform(rng) - 0.5f};
+    telemetry->has_attitude = true;
+    telemetry->attitude = (tvr_Quaternion){w / norm, x / norm, y / norm, z / norm};
+    telemetry->has_angular_rate = true;
+    telemetry->angular_rate = (tvr_Vec3){(float)(bench_rng_uniform(rng) - 0.5),
+                                         (float)(bench_rng_uniform(rng) - 0.5),
+                                         (float)(bench_rng_uniform(rng) - 0.5) * 4.0f};
+    telemetry->flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    telemetry->thrust_cmd = 10.0f + (float)bench_rng_uniform(rng) * 10.0f;
+    telemetry->gimbal_x = (float)(bench_rng_uniform(rng) - 0.5) * 0.3f;
+    telemetry->gimbal_y = (float)(bench_rng_uniform(rng) - 0.5) * 0.3f;
+}
+
+static void run(const char *name, const rp_codec_options_t *options)
+{
+    const rp_quant_spec_t *spec = &tvr_Downlink_quant;
+    double max_error[RP_QUANT_MAX_FIELDS] = {0};
+    bench_rng_t rng = {.state = 0x9E3779B97F4A7C15ULL};
+    uint64_t total_bytes = 0;
+    uint64_t encode_ns = 0;
+    uint64_t decode_ns = 0;
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        tvr_Downlink sent;
+        tvr_Downlink received = tvr_Downlink_init_zero;
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        random_telemetry(&rng, &sent, i * 10);
+
+        uint64_t start = bench_now_ns();
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            packet, sizeof(packet), tvr_Downlink_fields, &sent, options);
+        uint64_t encoded_at = bench_now_ns();
+        rp_packet_decode_result_t decoded = rp_packet_decode_with_options(
+            packet, encoded.written, tvr_Downlink_fields, &received, options);
+
+        decode_ns += bench_now_ns() - encoded_at;
+        encode_ns += encoded_at - start;
+
+        if (encoded.status != RP_CODEC_OK || decoded.status != RP_CODEC_OK) {
+            fprintf(stderr, "%s: frame %u failed (%d, %d)\n", name, (unsigned)i,
+                    (int)encoded.status, (int)decoded.status);
+            return;
+        }
+
+        total_bytes += encoded.written;
+
+        const uint8_t *sent_bytes = (const uint8_t *)&sent;
+        const uint8_t *received_bytes = (const uint8_t *)&received;
+
+        for (size_t f = 0; f < spec->field_count; f++) {
+            float before;
+            float after;
+
+            memcpy(&before, &sent_bytes[spec->fields[f].offset], sizeof(before));
+            memcpy(&after, &received_bytes[spec->fields[f].offset], sizeof(after));
+
+            double error = fabs((double)before - (double)after);
+
+            if (error > max_error[f]) {
+                max_error[f] = error;
+            }
+        }
+    }
+
+    double mean_size = (double)total_bytes / FRAME_COUNT;
+
+    printf("%-6s %9.1f", name, mean_size);
+
+    for (size_t b = 0; b < sizeof(baud_rates) / sizeof(baud_rates[0]); b++) {
+        printf(" %9.1f", (double)baud_rates[b] / 10.0 / mean_size);
+    }
+
+    printf(" %9.0f %9.0f", (double)encode_ns / FRAME_COUNT, (double)decode_ns / FRAME_COUNT);
+
+    for (size_t f = 0; f < spec->field_count; f++) {
+        printf(" %.1e", max_error[f]);
+    }
+
+    printf("\n");
+}
+
+int main(void)
+{
+    const rp_codec_options_t plain = {0};
+    const rp_codec_options_t quantized = {.quant = &tvr_Downlink_quant};
+
+    printf("%-6s %9s %9s %9s %9s %9s %9s %s\n", "mode", "bytes", "fps_9600", "fps_57600",
+           "fps_115k", "enc_ns", "dec_ns", "max_error per quantized field");
+
+    run("float", &plain);
+    run("quant", &quantized);
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * Simulated downlink whose throughput changes over time, fed either at the fixed
+ * conventional rates or by the bandwidth budget scheduler.
+ *
+ * Every millisecond the flight computer may encode `TelemetryState` and `SystemStatus`
+ * frames and hand them to a modem with a small transmit buffer, which drains at the
+ * current link throughput. A frame that does not fit in the buffer is an overrun and is
+ * lost. The throughput steps through a clear, a degraded and a congested phase and back;
+ * the scheduler is told the new budget at each step, as a radio reporting its data rate
+ * would. For each policy and phase the benchmark prints the achieved rates, the link
+ * utilization, the overruns and the worst time a frame waited in the modem buffer.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rp/codec.h"
+#include "rp/sched/sched.h"
+#include "telemetry.h"
+#include "tvr/downlink.pb.h"
+
+#define PHASE_MS (15000)
+#define MODEM_BUFFER_BYTES (256)
+#define TELEMETRY (0)
+#define STATUS (1)
+
+typedef enum policy {
+    POLICY_FIXED,
+    POLICY_SCHED,
+} policy_t;
+
+static const char *const policy_names[] = {"fixed", "sched"};
+
+static const char *const phase_names[] = {"clear", "degraded", "congested", "recovered"};
+static const uint32_t phase_bytes_per_s[] = {4000, 900, 240, 4000};
+
+#define PHASE_COUNT (sizeof(phase_bytes_per_s) / sizeof(phase_bytes_per_s[0]))
+
+static const rp_sched_stream_config_t configs[] = {
+    [TELEMETRY] = {.min_mhz = 2000, .target_mhz = 10000, .max_mhz = 50000},
+    [STATUS] = {.min_mhz = 200, .target_mhz = 1000, .max_mhz = 2000},
+};
+
+typedef struct phase_result {
+    uint32_t sent[2];
+    uint32_t overruns;
+    uint64_t link_bytes;
+    uint32_t worst_wait_ms;
+} phase_result_t;
+
+typedef struct modem {
+    uint32_t buffered_milli; /**< Bytes waiting in the transmit buffer, in milli-bytes */
+} modem_t;
+
+static size_t encode_frame(size_t stream, uint32_t now_ms, uint8_t *packet)
+{
+    tvr_Downlink downlink;
+
+    if (stream == TELEMETRY) {
+        bench_fill_telemetry(&downlink, now_ms);
+    } else {
+        bench_fill_status(&downlink, now_ms);
+    }
+
+    return rp_packet_encode(packet, RP_PACKET_MAX_SIZE, tvr_Downlink_fields, &downlink).written;
+}
+
+/**
+ * Hands a frame to the modem, returns false on overrun.
+ */
+static bool modem_write(modem_t *modem, size_t size, uint32_t bytes_per_s,
+                        phase_result_t *result)
+{
+    uint32_t frame_milli = (uint32_t)size * 1000;
+
+    if (modem->buffered_milli + frame_milli > MODEM_BUFFER_BYTES * 1000) {
+        result->overruns++;
+        return false;
+    }
+
+    modem->buffered_milli += frame_milli;
+    result->link_bytes += size;
+
+    uint32_t wait_ms = modem->buffered_milli / bytes_per_s;
+
+    if (wait_ms > result->worst_wait_ms) {
+        result->worst_wait_ms = wait_ms;
+    }
+
+    return true;
+}
+
+static void run_policy(policy_t policy)
+{
+    rp_sched_t sched;
+    modem_t modem = {0};
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_sched_init(&sched, configs, 2, phase_bytes_per_s[0], MODEM_BUFFER_BYTES);
+    rp_sched_set_size(&sched, TELEMETRY, encode_frame(TELEMETRY, 0, packet));
+    rp_sched_set_size(&sched, STATUS, encode_frame(STATUS, 0, packet));
+
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        uint32_t bytes_per_s = phase_bytes_per_s[phase];
+        phase_result_t result = {0};
+
+        rp_sched_set_budget(&sched, bytes_per_s);
+
+        for (uint32_t i = 0; i < PHASE_MS; i++) {
+            uint32_t now = (uint32_t)phase * PHASE_MS + i;
+
+            if (policy == POLICY_FIXED) {
+                for (size_t stream = 0; stream < 2; stream++) {
+                    uint32_t period_ms = 1000000 / configs[stream].target_mhz;
+
+                    if (now % period_ms == 0 &&
+                        modem_write(&modem, encode_frame(stream, now, packet), bytes_per_s,
+                                    &result)) {
+                        result.sent[stream]++;
+                    }
+                }
+            } else {
+                size_t stream;
+
+                while ((stream = rp_sched_next(&sched, now)) != RP_SCHED_NONE) {
+                    size_t size = encode_frame(stream, now, packet);
+
+                    rp_sched_sent(&sched, stream, size, now);
+
+                    if (modem_write(&modem, size, bytes_per_s, &result)) {
+                        result.sent[stream]++;
+                    }
+                }
+            }
+
+            modem.buffered_milli =
+                (modem.buffered_milli > bytes_per_s) ? modem.buffered_milli - bytes_per_s : 0;
+        }
+
+        printf("%-6s %-10s %7u %8.2f %8.2f %6.1f %8u %8u\n", policy_names[policy],
+               phase_names[phase], (unsigned)bytes_per_s,
+               (double)result.sent[TELEMETRY] * 1000.0 / PHASE_MS,
+               (double)result.sent[STATUS] * 1000.0 / PHASE_MS,
+               100.0 * (double)result.link_bytes / ((double)bytes_per_s * PHASE_MS / 1000.0),
+               (unsigned)result.overruns, (unsigned)result.worst_wait_ms);
+    }
+}
+
+int main(void)
+{
+    printf("%-6s %-10s %7s %8s %8s %6s %8s %8s\n", "policy", "phase", "B/s", "telem_hz",
+           "stat_hz", "util%", "overruns", "wait_ms");
+
+    run_policy(POLICY_FIXED);
+    run_policy(POLICY_SCHED);
+
+    return 0;
+}
@@ -0,0 +1,226 @@
+/**
+ * Simulated-link benchmark for the priority transmit queue.
+ *
+ * A flight computer keeps the link saturated with `TelemetryState` frames while
+ * `CMD_ABORT` frames are injected at random times. The link drains the queue at the
+ * configured baud rate in 1 ms ticks, and a receiver deframes and decodes the byte
+ * stream. The latency of a command is the time from queuing it to decoding it on the
+ * far side. Each scenario is run against the same telemetry load:
+ *
+ * - fifo: a single class, commands wait behind the telemetry backlog
+ * - priority: commands in the abort class, served at frame boundaries
+ * - preempt: as above, and partially sent telemetry is cut off
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "rp/txq/txq.h"
+#include "telemetry.h"
+#include "tvr/command.pb.h"
+#include "tvr/downlink.pb.h"
+
+#define SLOT_COUNT (24)
+#define TELEMETRY_BACKLOG (16)
+#define COMMAND_COUNT (500)
+#define TELEMETRY_PERIOD_MS (5)
+
+typedef enum scenario {
+    SCENARIO_FIFO,
+    SCENARIO_PRIORITY,
+    SCENARIO_PREEMPT,
+} scenario_t;
+
+static const char *const scenario_names[] = {"fifo", "priority", "preempt"};
+
+typedef struct scenario_result {
+    uint32_t latencies_ms[COMMAND_COUNT];
+    size_t delivered;
+    uint32_t telemetry_frames;
+    uint32_t truncated_frames;
+    uint32_t elapsed_ms;
+} scenario_result_t;
+
+static rp_txq_slot_t slots[SLOT_COUNT];
+static scenario_result_t result;
+
+static size_t encode_telemetry(uint8_t *frame, size_t capacity, uint32_t now_ms)
+{
+    tvr_Downlink downlink;
+
+    bench_fill_telemetry(&downlink, now_ms);
+
+    rp_packet_encode_result_t encoded =
+        rp_packet_encode(frame, capacity, tvr_Downlink_fields, &downlink);
+
+    return encoded.status == RP_CODEC_OK ? encoded.written : 0;
+}
+
+static size_t encode_abort(uint8_t *frame, size_t capacity)
+{
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    command.which_payload = tvr_FlightCommand_state_cmd_tag;
+    command.payload.state_cmd.type = tvr_StateCommand_Type_CMD_ABORT;
+
+    rp_packet_encode_result_t encoded =
+        rp_packet_encode(frame, capacity, tvr_FlightCommand_fields, &command);
+
+    return encoded.status == RP_CODEC_OK ? encoded.written : 0;
+}
+
+static void run_scenario(scenario_t scenario, uint32_t baud)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+    rp_txq_t queue;
+
+    configs[RP_TXQ_CLASS_ABORT].preemptive = (scenario == SCENARIO_PREEMPT);
+
+    rp_txq_init(&queue, slots, SLOT_COUNT, configs);
+
+    rp_txq_class_t command_class =
+        (scenario == SCENARIO_FIFO) ? RP_TXQ_CLASS_TELEMETRY : RP_TXQ_CLASS_ABORT;
+
+    uint8_t abort_frame[RP_TXQ_FRAME_CAPACITY];
+    size_t abort_size = encode_abort(abort_frame, sizeof(abort_frame));
+
+    uint8_t rx_buffer[RP_TXQ_FRAME_CAPACITY];
+    rp_deframer_t deframer;
+
+    rp_deframer_init(&deframer, rx_buffer, sizeof(rx_buffer));
+
+    // Outstanding commands, in the order they were queued
+    uint32_t command_times[COMMAND_COUNT];
+    size_t commands_queued = 0;
+
+    bench_rng_t rng = {.state = 0x9E3779B97F4A7C15ULL};
+    uint32_t next_command_ms = 100;
+
+    // 8N1 framing: 10 bits on the wire per byte, tracked in milli-bytes
+    uint64_t bytes_per_ms_milli = baud / 10;
+    uint64_t budget_milli = 0;
+
+    memset(&result, 0, sizeof(result));
+
+    uint32_t now_ms = 0;
+
+    for (; result.delivered < COMMAND_COUNT; now_ms++) {
+        // Telemetry producer keeps a full backlog in front of the link
+        if (now_ms % TELEMETRY_PERIOD_MS == 0 &&
+            rp_txq_pending(&queue, RP_TXQ_CLASS_TELEMETRY) < TELEMETRY_BACKLOG) {
+            rp_txq_slot_t *slot = rp_txq_reserve(&queue, RP_TXQ_CLASS_TELEMETRY);
+
+            if (slot != NULL) {
+                size_t size = encode_telemetry(slot->frame, sizeof(slot->frame), now_ms);
+                rp_txq_commit(&queue, slot, size, now_ms);
+            }
+        }
+
+        if (now_ms == next_command_ms && commands_queued < COMMAND_COUNT) {
+            if (rp_txq_push(&queue, command_class, abort_frame, abort_size, now_ms) ==
+                RP_TXQ_OK) {
+                command_times[commands_queued++] = now_ms;
+            }
+
+            next_command_ms = now_ms + 200 + (uint32_t)(bench_rng_next(&rng) % 500);
+        }
+
+        budget_milli += bytes_per_ms_milli;
+
+        uint8_t wire[RP_TXQ_FRAME_CAPACITY];
+        size_t wire_size = (size_t)(budget_milli / 1000);
+
+        if (wire_size > sizeof(wire)) {
+            wire_size = sizeof(wire);
+        }
+
+        size_t requested = wire_size;
+
+        wire_size = rp_txq_read(&queue, now_ms, wire, requested);
+        budget_milli -= (uint64_t)wire_size * 1000;
+
+        // An idle link does not bank bandwidth
+        if (wire_size < requested) {
+            budget_milli %= 1000;
+        }
+
+        size_t offset = 0;
+
+        while (offset < wire_size) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(&deframer, &wire[offset], wire_size - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            if (deframer.size == abort_size &&
+                memcmp(deframer.buffer, abort_frame, abort_size) == 0) {
+                tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+                rp_packet_decode_result_t decoded = rp_packet_decode(
+                    deframer.buffer, deframer.size, tvr_FlightCommand_fields, &command);
+
+                if (decoded.status == RP_CODEC_OK) {
+                    result.latencies_ms[result.delivered] =
+                        now_ms - command_times[result.delivered];
+                    result.delivered++;
+                }
+
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+            if (decoded.status == RP_CODEC_OK) {
+                result.telemetry_frames++;
+            } else {
+                result.truncated_frames++;
+            }
+        }
+    }
+
+    result.elapsed_ms = now_ms;
+}
+
+int main(void)
+{
+    static const uint32_t baud_rates[] = {9600, 57600, 115200};
+
+    printf("%-9s %7s %9s %9s %9s %9s %11s %9s\n", "scenario", "baud", "mean_ms", "p99_ms",
+           "max_ms", "min_ms", "telem_fps", "truncated");
+
+    for (size_t b = 0; b < sizeof(baud_rates) / sizeof(baud_rates[0]); b++) {
+        for (scenario_t s = SCENARIO_FIFO; s <= SCENARIO_PREEMPT; s++) {
+            run_scenario(s, baud_rates[b]);
+
+            uint64_t sum = 0;
+
+            for (size_t i = 0; i < result.delivered; i++) {
+                sum += result.latencies_ms[i];
+            }
+
+            double mean = (double)sum / (double)result.delivered;
+            uint32_t p99 = bench_percentile_u32(result.latencies_ms, result.delivered, 99.0);
+            uint32_t max = result.latencies_ms[result.delivered - 1];
+            uint32_t min = result.latencies_ms[0];
+            double fps = (double)result.telemetry_frames * 1000.0 / (double)result.elapsed_ms;
+
+            printf("%-9s %7u %9.1f %9u %9u %9u %11.1f %9u\n", scenario_names[s],
+                   (unsigned)baud_rates[b], mean, (unsigned)p99, (unsigned)max, (unsigned)min,
+                   fps, (unsigned)result.truncated_frames);
+        }
+    }
+
+    return 0;
+}
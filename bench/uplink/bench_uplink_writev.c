@@ -0,0 +1,296 @@
+/**
+ * Ground uplink transmit over a pty, three ways of sending a batch of frames:
+ *
+ * - copy: encode every frame into a packet buffer, copy header and frame into a
+ *   transmit buffer, one `write` per batch
+ * - arena: `rp_uplink_batch_add` encodes in place behind the header, the batch goes
+ *   out with one `writev` entry
+ * - refs: headers and frames live in separate buffers and are referenced with
+ *   `rp_uplink_batch_append`, two `writev` entries per frame
+ *
+ * Each frame is a `FlightCommand` behind a 4 byte radio-modem header. A reader thread
+ * drains the slave side of the pty in raw mode. For each batch size the benchmark
+ * prints the sender CPU time per frame, the wall time per frame, the bytes copied per
+ * frame besides encoding and the iovec entries per frame.
+ */
+
+#define _XOPEN_SOURCE 600 // posix_openpt() and friends
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "tvr/command.pb.h"
+#include "uplink.h"
+
+#define FRAME_COUNT (20000)
+#define MAX_BATCH (64)
+#define HEADER_SIZE (4)
+
+typedef struct reader {
+    int fd;
+    uint64_t expected;
+    uint64_t received;
+} reader_t;
+
+typedef enum send_mode {
+    SEND_COPY,
+    SEND_ARENA,
+    SEND_REFS,
+} send_mode_t;
+
+static const char *const mode_names[] = {"copy", "arena", "refs"};
+
+static uint8_t arena[MAX_BATCH * RP_UPLINK_FRAME_RESERVE];
+static struct iovec iov[MAX_BATCH * 2];
+static uint8_t headers[MAX_BATCH][HEADER_SIZE];
+static uint8_t frames[MAX_BATCH][RP_PACKET_MAX_SIZE];
+static uint8_t tx_buffer[MAX_BATCH * (HEADER_SIZE + RP_PACKET_MAX_SIZE)];
+
+static uint64_t thread_cpu_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void *reader_main(void *argument)
+{
+    reader_t *reader = argument;
+    uint8_t buffer[4096];
+
+    while (reader->received < reader->expected) {
+        ssize_t count = read(reader->fd, buffer, sizeof(buffer));
+
+        if (count <= 0) {
+            break;
+        }
+
+        reader->received += (uint64_t)count;
+    }
+
+    return NULL;
+}
+
+static bool open_pty(int *master, int *slave)
+{
+    *master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (*master < 0 || grantpt(*master) != 0 || unlockpt(*master) != 0) {
+        return false;
+    }
+
+    *slave = open(ptsname(*master), O_RDWR | O_NOCTTY);
+
+    if (*slave < 0) {
+        return false;
+    }
+
+    // Raw mode: no echo back into the master, no line editing or CR/LF mapping
+    struct termios attributes;
+
+    if (tcgetattr(*slave, &attributes) != 0) {
+        return false;
+    }
+
+    attributes.c_iflag &= ~(tcflag_t)(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL |
+                                      IXON);
+    attributes.c_oflag &= ~(tcflag_t)OPOST;
+    attributes.c_lflag &= ~(tcflag_t)(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    attributes.c_cflag &= ~(tcflag_t)(CSIZE | PARENB);
+    attributes.c_cflag |= CS8;
+
+    return tcsetattr(*slave, TCSANOW, &attributes) == 0;
+}
+
+static tvr_FlightCommand command_for(uint32_t index)
+{
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    command.which_payload = tvr_FlightCommand_set_reference_tag;
+    command.payload.set_reference.z_ref = 2.0f + 0.01f * (float)(index % 100);
+    command.payload.set_reference.vz_ref = 0.25f;
+    command.payload.set_reference.has_q_ref = true;
+    command.payload.set_reference.q_ref = (tvr_Quaternion){0.99f, 0.01f, -0.02f, 0.1f};
+    command.command_id = index + 1;
+
+    return command;
+}
+
+static void fill_header(uint8_t *header, size_t frame_size, uint32_t index)
+{
+    header[0] = 0xA5;
+    header[1] = (uint8_t)index;
+    header[2] = (uint8_t)(frame_size >> 0);
+    header[3] = (uint8_t)(frame_size >> 8);
+}
+
+static size_t send_copy(int fd, uint32_t first, size_t batch_size)
+{
+    size_t size = 0;
+
+    for (size_t i = 0; i < batch_size; i++) {
+        tvr_FlightCommand command = command_for(first + (uint32_t)i);
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(packet, sizeof(packet), tvr_FlightCommand_fields, &command);
+
+        fill_header(&tx_buffer[size], encoded.written, first + (uint32_t)i);
+        memcpy(&tx_buffer[size + HEADER_SIZE], packet, encoded.written);
+        size += HEADER_SIZE + encoded.written;
+    }
+
+    size_t sent = 0;
+
+    while (sent < size) {
+        ssize_t count = write(fd, &tx_buffer[sent], size - sent);
+
+        if (count <= 0) {
+            perror("write");
+            exit(1);
+        }
+
+        sent += (size_t)count;
+    }
+
+    // Headers and frames were copied once more into the transmit buffer
+    return size;
+}
+
+static size_t send_arena(int fd, rp_uplink_batch_t *batch, uint32_t first, size_t batch_size)
+{
+    for (size_t i = 0; i < batch_size; i++) {
+        tvr_FlightCommand command = command_for(first + (uint32_t)i);
+
+        rp_uplink_add_result_t added = rp_uplink_batch_add(
+            batch, NULL, HEADER_SIZE, tvr_FlightCommand_fields, &command, NULL);
+
+        fill_header(added.header, added.frame_size, first + (uint32_t)i);
+    }
+
+    if (rp_uplink_batch_write(batch, fd) != RP_UPLINK_OK) {
+        perror("writev");
+        exit(1);
+    }
+
+    // Header bytes only, frames are encoded in place
+    return batch_size * HEADER_SIZE;
+}
+
+static size_t send_refs(int fd, rp_uplink_batch_t *batch, uint32_t first, size_t batch_size)
+{
+    for (size_t i = 0; i < batch_size; i++) {
+        tvr_FlightCommand command = command_for(first + (uint32_t)i);
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(frames[i], sizeof(frames[i]), tvr_FlightCommand_fields, &command);
+
+        fill_header(headers[i], encoded.written, first + (uint32_t)i);
+        rp_uplink_batch_append(batch, headers[i], HEADER_SIZE);
+        rp_uplink_batch_append(batch, frames[i], encoded.written);
+    }
+
+    if (rp_uplink_batch_write(batch, fd) != RP_UPLINK_OK) {
+        perror("writev");
+        exit(1);
+    }
+
+    return 0;
+}
+
+static void run(send_mode_t mode, size_t batch_size)
+{
+    int master;
+    int slave;
+
+    if (!open_pty(&master, &slave)) {
+        perror("pty");
+        exit(1);
+    }
+
+    rp_uplink_batch_t batch;
+
+    rp_uplink_batch_init(&batch, iov, sizeof(iov) / sizeof(iov[0]), arena, sizeof(arena));
+
+    // Frames have the same size in every mode, count the bytes up front for the reader
+    reader_t reader = {.fd = slave, .expected = 0, .received = 0};
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        tvr_FlightCommand command = command_for(i);
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(packet, sizeof(packet), tvr_FlightCommand_fields, &command);
+
+        reader.expected += HEADER_SIZE + encoded.written;
+    }
+
+    pthread_t thread;
+
+    pthread_create(&thread, NULL, reader_main, &reader);
+
+    uint64_t copied = 0;
+    uint64_t segments = 0;
+    uint64_t start_ns = bench_now_ns();
+    uint64_t start_cpu = thread_cpu_ns();
+
+    for (uint32_t first = 0; first < FRAME_COUNT; first += (uint32_t)batch_size) {
+        size_t count = (FRAME_COUNT - first < batch_size) ? FRAME_COUNT - first : batch_size;
+
+        if (mode == SEND_COPY) {
+            copied += send_copy(master, first, count);
+            segments++;
+            continue;
+        }
+
+        if (mode == SEND_ARENA) {
+            segments += 1;
+            copied += send_arena(master, &batch, first, count);
+        } else {
+            segments += 2 * count;
+            copied += send_refs(master, &batch, first, count);
+        }
+    }
+
+    uint64_t cpu_ns = thread_cpu_ns() - start_cpu;
+
+    pthread_join(thread, NULL);
+
+    uint64_t wall_ns = bench_now_ns() - start_ns;
+
+    printf("%-6s %5zu %10.0f %10.0f %10.1f %8.2f %s\n", mode_names[mode], batch_size,
+           (double)cpu_ns / FRAME_COUNT, (double)wall_ns / FRAME_COUNT,
+           (double)copied / FRAME_COUNT, (double)segments / FRAME_COUNT,
+           (reader.received == reader.expected) ? "ok" : "short");
+
+    close(slave);
+    close(master);
+}
+
+int main(void)
+{
+    static const size_t batch_sizes[] = {1, 4, 16, 64};
+
+    printf("%-6s %5s %10s %10s %10s %8s %s\n", "path", "batch", "cpu_ns", "wall_ns", "copied_b",
+           "iov", "check");
+
+    for (size_t b = 0; b < sizeof(batch_sizes) / sizeof(batch_sizes[0]); b++) {
+        for (send_mode_t mode = SEND_COPY; mode <= SEND_REFS; mode++) {
+            run(mode, batch_sizes[b]);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,674 @@
+/**
+ * Worst-case execution time of the flight-side codec and its primitives.
+ *
+ * Every case runs one call on an adversarial input: COBS blocks of all zeros, no zeros and
+ * a run of exactly 254 bytes (the longest block), checksums over the largest frame, the
+ * largest `Downlink` the flight computer encodes, and the largest, corrupted, truncated
+ * and garbage `FlightCommand` frames it decodes, with and without FEC. Each call is timed
+ * on its own in cycles, with the cost of reading the counter subtracted:
+ *
+ * - x86: `rdtsc` between `lfence`, in TSC reference cycles
+ * - AArch64: the virtual counter `cntvct_el0`, in counter ticks
+ * - `-p`: core cycles from `perf_event_open`, where the kernel allows it
+ * - otherwise nanoseconds from `bench_now_ns`
+ *
+ * A case runs `ROUNDS` rounds of `ITERATIONS` calls. `min`, `p50`, `p99.9` and `max` are over
+ * all calls, so `max` is the worst call observed. `max_round` is the smallest of the round
+ * maxima: an interrupt that hits one round does not move it. On a host that is not
+ * real-time, run pinned to an isolated core for maxima that mean anything.
+ *
+ * The table goes to stdout and, with `-o`, the same rows to a CSV report. With `-b` the
+ * run is compared with a previous report: the exit status is 1 if any case's p99.9 or
+ * max_round is more than the tolerance (`-t`, default 1.25) times its baseline, so CI can
+ * fail on a regression. `max` is reported but not compared, as one preemption moves it:
+ *
+ *     bench_wcet_codec [-p] [-o report.csv] [-b baseline.csv] [-t 1.25]
+ */
+
+// syscall() for perf_event_open, which _POSIX_C_SOURCE alone hides
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "bench.h"
+#include "rp/codec.h"
+#include "rp/cobs/cobs.h"
+#include "rp/crc/crc.h"
+#include "rp/fec/rs.h"
+#include "tvr/command.pb.h"
+#include "tvr/downlink.pb.h"
+
+#define ITERATIONS (20000)
+#define ROUNDS (5)
+#define MAX_CASES (32)
+#define DEFAULT_TOLERANCE (1.25)
+
+// Longest payload whose COBS encoding, with the delimiter, fits a packet
+#define PAYLOAD_MAX_SIZE (254)
+
+_Static_assert(PAYLOAD_MAX_SIZE + 2 == RP_PACKET_MAX_SIZE, "payload must fill one COBS block");
+
+typedef struct wcet_case {
+    const char *name;
+    uint32_t (*run)(void);
+} wcet_case_t;
+
+typedef struct wcet_result {
+    char name[32];
+    uint32_t min;
+    uint32_t p50;
+    uint32_t p999;
+    uint32_t max;
+    uint32_t max_round;
+} wcet_result_t;
+
+typedef enum counter {
+    COUNTER_TSC,
+    COUNTER_PERF,
+    COUNTER_CLOCK,
+} counter_t;
+
+static counter_t counter;
+static int perf_fd = -1;
+
+static uint32_t samples[ROUNDS * ITERATIONS];
+static wcet_result_t results[MAX_CASES];
+static wcet_result_t baseline[MAX_CASES];
+
+// Inputs, built once by `prepare`
+static uint8_t zeros[PAYLOAD_MAX_SIZE];
+static uint8_t no_zeros[PAYLOAD_MAX_SIZE - 1];
+static uint8_t run_254[PAYLOAD_MAX_SIZE];
+static uint8_t encoded_zeros[RP_PACKET_MAX_SIZE];
+static uint8_t encoded_no_zeros[RP_PACKET_MAX_SIZE];
+static uint8_t encoded_run_254[RP_PACKET_MAX_SIZE];
+static uint8_t encoded_overrun[RP_PACKET_MAX_SIZE];
+static size_t encoded_zeros_size;
+static size_t encoded_no_zeros_size;
+static size_t encoded_run_254_size;
+
+static tvr_Downlink downlink_max;
+static tvr_Downlink downlink_zeros;
+
+static uint8_t command_frame[RP_PACKET_MAX_SIZE];
+static uint8_t command_bad_crc[RP_PACKET_MAX_SIZE];
+static uint8_t command_fec_frame[RP_PACKET_MAX_SIZE];
+static uint8_t garbage[RP_PACKET_MAX_SIZE];
+static size_t command_frame_size;
+static size_t command_fec_frame_size;
+
+static rs_codec_t fec;
+static rp_codec_options_t fec_options;
+
+static uint8_t output[RP_PACKET_MAX_SIZE];
+
+/**
+ * Reads the counter, ordered with the code around it.
+ */
+static inline uint64_t counter_read(void)
+{
+    switch (counter) {
+#if defined(__x86_64__) || defined(__i386__)
+    case COUNTER_TSC: {
+        _mm_lfence();
+        uint64_t tsc = __rdtsc();
+        _mm_lfence();
+        return tsc;
+    }
+#elif defined(__aarch64__)
+    case COUNTER_TSC: {
+        uint64_t ticks;
+        __asm__ volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(ticks)::"memory");
+        return ticks;
+    }
+#endif
+#if defined(__linux__)
+    case COUNTER_PERF: {
+        uint64_t cycles = 0;
+
+        if (read(perf_fd, &cycles, sizeof(cycles)) != (ssize_t)sizeof(cycles)) {
+            return 0;
+        }
+
+        return cycles;
+    }
+#endif
+    default:
+        return bench_now_ns();
+    }
+}
+
+static const char *counter_unit(void)
+{
+    switch (counter) {
+    case COUNTER_TSC:
+#if defined(__aarch64__)
+        return "ticks";
+#else
+        return "TSC cycles";
+#endif
+    case COUNTER_PERF:
+        return "core cycles";
+    default:
+        return "ns";
+    }
+}
+
+static void select_counter(bool perf)
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    counter = COUNTER_TSC;
+#else
+    counter = COUNTER_CLOCK;
+#endif
+
+    if (!perf) {
+        return;
+    }
+
+#if defined(__linux__)
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+    if (perf_fd >= 0) {
+        counter = COUNTER_PERF;
+        return;
+    }
+#endif
+
+    fprintf(stderr, "perf_event_open unavailable, using %s\n", counter_unit());
+}
+
+/**
+ * Smallest time between two back to back counter reads, subtracted from every sample.
+ */
+static uint64_t counter_overhead(void)
+{
+    uint64_t overhead = UINT64_MAX;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        uint64_t start = counter_read();
+        uint64_t elapsed = counter_read() - start;
+
+        if (elapsed < overhead) {
+            overhead = elapsed;
+        }
+    }
+
+    return overhead;
+}
+
+static uint32_t run_cobs_encode_zeros(void)
+{
+    return (uint32_t)cobs_encode(zeros, sizeof(zeros), output, sizeof(output)).written;
+}
+
+static uint32_t run_cobs_encode_no_zeros(void)
+{
+    return (uint32_t)cobs_encode(no_zeros, sizeof(no_zeros), output, sizeof(output)).written;
+}
+
+static uint32_t run_cobs_encode_run_254(void)
+{
+    return (uint32_t)cobs_encode(run_254, sizeof(run_254), output, sizeof(output)).written;
+}
+
+static uint32_t run_cobs_decode_zeros(void)
+{
+    return (uint32_t)cobs_decode(encoded_zeros, encoded_zeros_size, output, sizeof(output))
+        .written;
+}
+
+static uint32_t run_cobs_decode_no_zeros(void)
+{
+    return (uint32_t)cobs_decode(encoded_no_zeros, encoded_no_zeros_size, output,
+                                 sizeof(output))
+        .written;
+}
+
+static uint32_t run_cobs_decode_run_254(void)
+{
+    return (uint32_t)cobs_decode(encoded_run_254, encoded_run_254_size, output, sizeof(output))
+        .written;
+}
+
+static uint32_t run_cobs_decode_overrun(void)
+{
+    return (uint32_t)cobs_decode(encoded_overrun, sizeof(encoded_overrun), output,
+                                 sizeof(output))
+        .status;
+}
+
+static uint32_t run_crc16_max(void)
+{
+    return crc16_ccitt(run_254, sizeof(run_254));
+}
+
+static uint32_t run_crc32c_max(void)
+{
+    return crc32c(run_254, sizeof(run_254));
+}
+
+static uint32_t run_encode_downlink_max(void)
+{
+    return (uint32_t)rp_packet_encode(output, sizeof(output), tvr_Downlink_fields,
+                                      &downlink_max)
+        .written;
+}
+
+static uint32_t run_encode_downlink_zeros(void)
+{
+    return (uint32_t)rp_packet_encode(output, sizeof(output), tvr_Downlink_fields,
+                                      &downlink_zeros)
+        .written;
+}
+
+static uint32_t run_encode_downlink_fec(void)
+{
+    return (uint32_t)rp_packet_encode_with_options(output, sizeof(output), tvr_Downlink_fields,
+                                                   &downlink_max, &fec_options)
+        .written;
+}
+
+static uint32_t decode_command(const uint8_t *frame, size_t size,
+                               const rp_codec_options_t *options)
+{
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    return (uint32_t)rp_packet_decode_with_options(frame, size, tvr_FlightCommand_fields,
+                                                   &command, options)
+        .status;
+}
+
+static uint32_t run_decode_command_max(void)
+{
+    return decode_command(command_frame, command_frame_size, NULL);
+}
+
+static uint32_t run_decode_command_bad_crc(void)
+{
+    return decode_command(command_bad_crc, command_frame_size, NULL);
+}
+
+static uint32_t run_decode_command_truncated(void)
+{
+    return decode_command(command_frame, command_frame_size / 2, NULL);
+}
+
+static uint32_t run_decode_garbage(void)
+{
+    return decode_command(garbage, sizeof(garbage), NULL);
+}
+
+static uint32_t run_decode_command_fec(void)
+{
+    return decode_command(command_fec_frame, command_fec_frame_size, &fec_options);
+}
+
+static const wcet_case_t cases[] = {
+    {"cobs_encode_zeros", run_cobs_encode_zeros},
+    {"cobs_encode_no_zeros", run_cobs_encode_no_zeros},
+    {"cobs_encode_run_254", run_cobs_encode_run_254},
+    {"cobs_decode_zeros", run_cobs_decode_zeros},
+    {"cobs_decode_no_zeros", run_cobs_decode_no_zeros},
+    {"cobs_decode_run_254", run_cobs_decode_run_254},
+    {"cobs_decode_overrun", run_cobs_decode_overrun},
+    {"crc16_max", run_crc16_max},
+    {"crc32c_max", run_crc32c_max},
+    {"encode_downlink_max", run_encode_downlink_max},
+    {"encode_downlink_zeros", run_encode_downlink_zeros},
+    {"encode_downlink_fec", run_encode_downlink_fec},
+    {"decode_command_max", run_decode_command_max},
+    {"decode_command_bad_crc", run_decode_command_bad_crc},
+    {"decode_command_trunc", run_decode_command_truncated},
+    {"decode_garbage", run_decode_garbage},
+    {"decode_command_fec", run_decode_command_fec},
+};
+
+_Static_assert(sizeof(cases) / sizeof(cases[0]) <= MAX_CASES, "too many cases");
+
+/**
+ * Flips one bit of every `stride`th byte that is neither a COBS code byte nor the
+ * delimiter, so the frame still splits and only its contents are damaged.
+ */
+static void corrupt_frame(uint8_t *frame, size_t size, size_t stride, size_t count)
+{
+    size_t next_code = 0;
+    size_t seen = 0;
+
+    for (size_t i = 0; i + 1 < size && count > 0; i++) {
+        if (i == next_code) {
+            next_code += frame[i];
+            continue;
+        }
+
+        if (seen++ % stride == 0) {
+            frame[i] ^= (frame[i] == 0x01) ? 0x02 : 0x01;
+            count--;
+        }
+    }
+}
+
+static void prepare(void)
+{
+    bench_rng_t rng = {.state = 0x2545F4914F6CDD1DULL};
+
+    for (size_t i = 0; i < sizeof(no_zeros); i++) {
+        no_zeros[i] = (uint8_t)(1 + i % 255);
+    }
+
+    for (size_t i = 0; i < sizeof(run_254); i++) {
+        run_254[i] = (uint8_t)(1 + (bench_rng_next(&rng) % 255));
+    }
+
+    encoded_zeros_size = cobs_encode(zeros, sizeof(zeros), encoded_zeros,
+                                     sizeof(encoded_zeros))
+                             .written;
+    encoded_no_zeros_size = cobs_encode(no_zeros, sizeof(no_zeros), encoded_no_zeros,
+                                        sizeof(encoded_no_zeros))
+                                .written;
+    encoded_run_254_size = cobs_encode(run_254, sizeof(run_254), encoded_run_254,
+                                       sizeof(encoded_run_254))
+                               .written;
+
+    // The most blocks a frame can hold, then a code byte that points past the delimiter
+    memset(encoded_overrun, 0x01, sizeof(encoded_overrun));
+    encoded_overrun[sizeof(encoded_overrun) - 2] = 0xFF;
+    encoded_overrun[sizeof(encoded_overrun) - 1] = COBS_DELIMITER_BYTE;
+
+    // Every field present with values that encode to the most bytes
+    downlink_max.which_payload = tvr_Downlink_telemetry_tag;
+    downlink_max.payload.telemetry = (tvr_TelemetryState){
+        .timestamp_ms = UINT32_MAX,
+        .has_position = true,
+        .position = {-1.5e3f, 2.5e3f, -3.5e3f},
+        .has_velocity = true,
+        .velocity = {-1.25f, 2.25f, -3.25f},
+        .has_attitude = true,
+        .attitude = {0.5f, -0.5f, 0.5f, -0.5f},
+        .has_angular_rate = true,
+        .angular_rate = {-0.125f, 0.25f, -0.375f},
+        .flight_state = _tvr_FlightState_MAX,
+        .thrust_cmd = 14.2f,
+        .gimbal_x = -0.1f,
+        .gimbal_y = 0.1f,
+    };
+    downlink_max.has_ack = true;
+    downlink_max.ack = (tvr_CommandAck){.latest_id = UINT32_MAX, .history = UINT32_MAX};
+
+    // Present but zero sub-messages, a payload full of zero bytes
+    downlink_zeros.which_payload = tvr_Downlink_telemetry_tag;
+    downlink_zeros.payload.telemetry = (tvr_TelemetryState){
+        .has_position = true,
+        .has_velocity = true,
+        .has_attitude = true,
+        .has_angular_rate = true,
+    };
+    downlink_zeros.has_ack = true;
+
+    tvr_FlightCommand command = tvr_FlightCommand_init_zero;
+
+    command.which_payload = tvr_FlightCommand_set_pid_gains_tag;
+    command.payload.set_pid_gains = (tvr_SetPidGains){
+        .has_attitude_kp = true,
+        .attitude_kp = {1.5f, 1.5f, 0.75f},
+        .has_attitude_kd = true,
+        .attitude_kd = {0.25f, 0.25f, 0.125f},
+        .z_kp = 2.0f,
+        .z_ki = 0.5f,
+        .z_kd = 1.0f,
+        .z_integral_limit = 5.0f,
+    };
+    command.command_id = UINT32_MAX;
+
+    command_frame_size = rp_packet_encode(command_frame, sizeof(command_frame),
+                                          tvr_FlightCommand_fields, &command)
+                             .written;
+
+    memcpy(command_bad_crc, command_frame, command_frame_size);
+    corrupt_frame(command_bad_crc, command_frame_size, 1, 1);
+
+    // Parity for 4 symbol errors, and exactly 4 errors: the slowest correctable frame
+    rs_codec_init(&fec, 8);
+    fec_options = (rp_codec_options_t){.fec = &fec};
+
+    command_fec_frame_size = rp_packet_encode_with_options(command_fec_frame,
+                                                           sizeof(command_fec_frame),
+                                                           tvr_FlightCommand_fields, &command,
+                                                           &fec_options)
+                                 .written;
+    corrupt_frame(command_fec_frame, command_fec_frame_size, 7, 4);
+
+    // Non-zero noise without a delimiter, the longest a receiver would buffer
+    for (size_t i = 0; i < sizeof(garbage); i++) {
+        garbage[i] = (uint8_t)(1 + (bench_rng_next(&rng) % 255));
+    }
+}
+
+static void measure(const wcet_case_t *wcet_case, uint64_t overhead, wcet_result_t *result)
+{
+    volatile uint32_t sink;
+    uint32_t max = 0;
+    uint32_t max_round = UINT32_MAX;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        uint32_t round_max = 0;
+
+        for (int i = 0; i < ITERATIONS; i++) {
+            uint64_t start = counter_read();
+
+            sink = wcet_case->run();
+            (void)sink;
+
+            uint64_t elapsed = counter_read() - start;
+            uint32_t sample = (elapsed > overhead) ? (uint32_t)(elapsed - overhead) : 0;
+
+            samples[r * ITERATIONS + i] = sample;
+
+            if (sample > round_max) {
+                round_max = sample;
+            }
+        }
+
+        if (round_max > max) {
+            max = round_max;
+        }
+
+        if (round_max < max_round) {
+            max_round = round_max;
+        }
+    }
+
+    snprintf(result->name, sizeof(result->name), "%s", wcet_case->name);
+    result->min = bench_percentile_u32(samples, ROUNDS * ITERATIONS, 0.0);
+    result->p50 = bench_percentile_u32(samples, ROUNDS * ITERATIONS, 50.0);
+    result->p999 = bench_percentile_u32(samples, ROUNDS * ITERATIONS, 99.9);
+    result->max = max;
+    result->max_round = max_round;
+}
+
+static bool write_report(const char *path, size_t count)
+{
+    FILE *report = fopen(path, "w");
+
+    if (report == NULL) {
+        perror(path);
+        return false;
+    }
+
+    fprintf(report, "case,min,p50,p99.9,max,max_round\n");
+
+    for (size_t i = 0; i < count; i++) {
+        fprintf(report, "%s,%u,%u,%u,%u,%u\n", results[i].name, (unsigned)results[i].min,
+                (unsigned)results[i].p50, (unsigned)results[i].p999, (unsigned)results[i].max,
+                (unsigned)results[i].max_round);
+    }
+
+    return fclose(report) == 0;
+}
+
+/**
+ * Reads a report written with `-o`.
+ *
+ * @return size_t Cases read
+ */
+static size_t read_baseline(const char *path)
+{
+    FILE *report = fopen(path, "r");
+    char line[128];
+    size_t count = 0;
+
+    if (report == NULL) {
+        perror(path);
+        return 0;
+    }
+
+    while (count < MAX_CASES && fgets(line, sizeof(line), report) != NULL) {
+        wcet_result_t *entry = &baseline[count];
+        unsigned min;
+        unsigned p50;
+        unsigned p999;
+        unsigned max;
+        unsigned max_round;
+
+        // The header line does not match and is skipped
+        if (sscanf(line, "%31[^,],%u,%u,%u,%u,%u", entry->name, &min, &p50, &p999, &max,
+                   &max_round) == 6) {
+            entry->min = min;
+            entry->p50 = p50;
+            entry->p999 = p999;
+            entry->max = max;
+            entry->max_round = max_round;
+            count++;
+        }
+    }
+
+    fclose(report);
+
+    return count;
+}
+
+/**
+ * Compares the results with the baseline.
+ *
+ * @return bool False if any case regressed past the tolerance
+ */
+static bool check_baseline(size_t count, size_t baseline_count, double tolerance)
+{
+    bool ok = true;
+
+    for (size_t i = 0; i < count; i++) {
+        const wcet_result_t *now = &results[i];
+
+        for (size_t b = 0; b < baseline_count; b++) {
+            const wcet_result_t *was = &baseline[b];
+
+            if (strcmp(now->name, was->name) != 0) {
+                continue;
+            }
+
+            bool p999_regressed = now->p999 > (double)was->p999 * tolerance;
+            bool max_regressed = now->max_round > (double)was->max_round * tolerance;
+
+            if (p999_regressed || max_regressed) {
+                fprintf(stderr, "%s regressed: p99.9 %u -> %u, max_round %u -> %u\n",
+                        now->name, (unsigned)was->p999, (unsigned)now->p999,
+                        (unsigned)was->max_round, (unsigned)now->max_round);
+                ok = false;
+            }
+        }
+    }
+
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    const char *report_path = NULL;
+    const char *baseline_path = NULL;
+    double tolerance = DEFAULT_TOLERANCE;
+    bool perf = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "po:b:t:")) != -1) {
+        switch (option) {
+        case 'p':
+            perf = true;
+            break;
+        case 'o':
+            report_path = optarg;
+            break;
+        case 'b':
+            baseline_path = optarg;
+            break;
+        case 't':
+            tolerance = strtod(optarg, NULL);
+            break;
+        default:
+            fprintf(stderr, "usage: %s [-p] [-o report.csv] [-b baseline.csv] [-t tolerance]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    select_counter(perf);
+    prepare();
+
+    uint64_t overhead = counter_overhead();
+    size_t count = sizeof(cases) / sizeof(cases[0]);
+
+    fprintf(stderr, "counter: %s, overhead %llu subtracted\n", counter_unit(),
+            (unsigned long long)overhead);
+
+    printf("%-24s %8s %8s %8s %8s %9s\n", "case", "min", "p50", "p99.9", "max", "max_round");
+
+    for (size_t i = 0; i < count; i++) {
+        measure(&cases[i], overhead, &results[i]);
+
+        printf("%-24s %8u %8u %8u %8u %9u\n", results[i].name, (unsigned)results[i].min,
+               (unsigned)results[i].p50, (unsigned)results[i].p999, (unsigned)results[i].max,
+               (unsigned)results[i].max_round);
+    }
+
+    if (report_path != NULL && !write_report(report_path, count)) {
+        return 2;
+    }
+
+    if (baseline_path != NULL) {
+        size_t baseline_count = read_baseline(baseline_path);
+
+        if (baseline_count == 0) {
+            fprintf(stderr, "no baseline cases in %s\n", baseline_path);
+            return 2;
+        }
+
+        if (!check_baseline(count, baseline_count, tolerance)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
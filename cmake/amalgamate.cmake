@@ -0,0 +1,125 @@
+#
+# Single header build of library sources.
+#
+# rp_amalgamate() concatenates headers and sources into one header in which every
+# function is `static inline`, so a translation unit that includes it sees the whole
+# frame pipeline and the compiler can inline and specialize across modules (e.g.
+# `crc16_ccitt` and `cobs_encode` into `rp_packet_encode`) without LTO.
+#
+# - `#include "rp/..."` lines are dropped, as the headers they name are part of the output
+# - Every function declared or defined at the start of a line becomes `static inline`
+# - Macros defined by a source are undefined after it, so they do not leak into the
+#   translation unit including the header
+#
+# The header is written at configure time and rewritten whenever an input changes.
+#
+# rp_amalgamate(
+#     TARGET <interface library to create>
+#     OUTPUT <generated header>
+#     HEADERS <headers, dependencies first>
+#     SOURCES <sources>
+# )
+#
+
+function(rp_amalgamate)
+    set(option_arguments)
+    set(single_arguments TARGET OUTPUT)
+    set(multi_arguments HEADERS SOURCES)
+
+    cmake_parse_arguments(rp_amalgamate
+        "${option_arguments}"
+        "${single_arguments}"
+        "${multi_arguments}"
+        ${ARGN}
+    )
+
+    if(NOT DEFINED rp_amalgamate_TARGET OR NOT DEFINED rp_amalgamate_OUTPUT)
+        message(SEND_ERROR "${CMAKE_CURRENT_FUNCTION}(...) called without a target or output")
+        return()
+    endif()
+
+    cmake_path(GET rp_amalgamate_OUTPUT FILENAME output_name)
+    cmake_path(GET rp_amalgamate_OUTPUT PARENT_PATH output_dir)
+
+    string(MAKE_C_IDENTIFIER "${output_name}" guard)
+    string(TOUPPER "${guard}" guard)
+
+    string(CONCAT amalgamation
+        "/*\n"
+        " * ${output_name}: generated by cmake/amalgamate.cmake, do not edit.\n"
+        " *\n"
+        " * Single header build of the rocket-protocol frame pipeline, with every function\n"
+        " * `static inline`. Include it instead of the rp/ headers, no library other than\n"
+        " * nanopb is needed.\n"
+        " */\n"
+        "\n"
+        "#ifndef ${guard}\n"
+        "#define ${guard}\n"
+    )
+
+    foreach(input IN LISTS rp_amalgamate_HEADERS rp_amalgamate_SOURCES)
+        file(READ "${input}" content)
+        file(RELATIVE_PATH input_name "${PROJECT_SOURCE_DIR}" "${input}")
+
+        string(REPLACE "\r\n" "\n" content "${content}")
+        set(content "\n${content}")
+
+        string(REGEX REPLACE "\n#include \"rp/[^\"\n]*\"[^\n]*" "" content "${content}")
+
+        # Set aside lines that are not function declarations before matching them
+        string(REPLACE "\nstatic const " "\n@RP_STATIC_CONST@" content "${content}")
+        string(REPLACE "\nstatic " "\n@RP_STATIC@" content "${content}")
+        string(REPLACE "\ntypedef " "\n@RP_TYPEDEF@" content "${content}")
+
+        string(REGEX REPLACE
+            "\n([A-Za-z_][A-Za-z0-9_ ]*[ *][A-Za-z_][A-Za-z0-9_]*\\()"
+            "\nstatic inline \\1"
+            content "${content}"
+        )
+        string(REGEX REPLACE
+            "\n@RP_STATIC@([A-Za-z_][A-Za-z0-9_ ]*[ *][A-Za-z_][A-Za-z0-9_]*\\()"
+            "\nstatic inline \\1"
+            content "${content}"
+        )
+        string(REGEX REPLACE
+            "\n(__attribute__\\(\\([^\n]*\\)\\)) static "
+            "\n\\1 static inline "
+            content "${content}"
+        )
+
+        string(REPLACE "\n@RP_STATIC_CONST@" "\nstatic const " content "${content}")
+        string(REPLACE "\n@RP_STATIC@" "\nstatic " content "${content}")
+        string(REPLACE "\n@RP_TYPEDEF@" "\ntypedef " content "${content}")
+
+        string(APPEND amalgamation "\n/* ---- ${input_name} ---- */\n${content}")
+
+        if(input IN_LIST rp_amalgamate_SOURCES)
+            string(REGEX MATCHALL "\n#define [A-Za-z_][A-Za-z0-9_]*" defines "${content}")
+
+            foreach(define IN LISTS defines)
+                string(REPLACE "\n#define " "\n#undef " undefine "${define}")
+                string(APPEND amalgamation "${undefine}")
+            endforeach()
+
+            if(defines)
+                string(APPEND amalgamation "\n")
+            endif()
+        endif()
+
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${input}")
+    endforeach()
+
+    string(APPEND amalgamation "\n#endif // ${guard}\n")
+
+    # Only touch the header when it changed, so dependents are not rebuilt on every
+    # configure
+    file(WRITE "${rp_amalgamate_OUTPUT}.tmp" "${amalgamation}")
+    configure_file("${rp_amalgamate_OUTPUT}.tmp" "${rp_amalgamate_OUTPUT}" COPYONLY)
+
+    add_library(${rp_amalgamate_TARGET} INTERFACE)
+
+    target_include_directories(${rp_amalgamate_TARGET}
+        INTERFACE
+            "${output_dir}"
+    )
+endfunction()
@@ -21,6 +21,9 @@ PB_BIND(tvr_SetReference, tvr_SetReference, AUTO)
 PB_BIND(tvr_SetConfig, tvr_SetConfig, AUTO)
 
 
+PB_BIND(tvr_CommandAck, tvr_CommandAck, AUTO)
+
+
 
 
 
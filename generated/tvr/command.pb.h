@@ -64,8 +64,16 @@ typedef struct _tvr_FlightCommand {
         tvr_SetReference set_reference;
         tvr_SetConfig set_config;
     } payload;
+    /* Non-zero to request an acknowledgement (see CommandAck) */
+    uint32_t command_id;
 } tvr_FlightCommand;
 
+/* FC → Ground acknowledgement, piggybacked on Downlink frames */
+typedef struct _tvr_CommandAck {
+    uint32_t latest_id; /* newest command_id received, 0 if none */
+    uint32_t history; /* bit i set if command latest_id - 1 - i was received */
+} tvr_CommandAck;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -84,16 +92,18 @@ extern "C" {
 
 
 /* Initializer values for message structs */
-#define tvr_FlightCommand_init_default           {0, {tvr_StateCommand_init_default}}
+#define tvr_FlightCommand_init_default           {0, {tvr_StateCommand_init_default}, 0}
 #define tvr_StateCommand_init_default            {_tvr_StateCommand_Type_MIN}
 #define tvr_SetPidGains_init_default             {false, tvr_Vec3_init_default, false, tvr_Vec3_init_default, 0, 0, 0, 0}
 #define tvr_SetReference_init_default            {0, 0, false, tvr_Quaternion_init_default}
 #define tvr_SetConfig_init_default               {0, 0, 0, 0, 0}
-#define tvr_FlightCommand_init_zero              {0, {tvr_StateCommand_init_zero}}
+#define tvr_CommandAck_init_default              {0, 0}
+#define tvr_FlightCommand_init_zero              {0, {tvr_StateCommand_init_zero}, 0}
 #define tvr_StateCommand_init_zero               {_tvr_StateCommand_Type_MIN}
 #define tvr_SetPidGains_init_zero                {false, tvr_Vec3_init_zero, false, tvr_Vec3_init_zero, 0, 0, 0, 0}
 #define tvr_SetReference_init_zero               {0, 0, false, tvr_Quaternion_init_zero}
 #define tvr_SetConfig_init_zero                  {0, 0, 0, 0, 0}
+#define tvr_CommandAck_init_zero                 {0, 0}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define tvr_StateCommand_type_tag                1
@@ -115,13 +125,17 @@ extern "C" {
 #define tvr_FlightCommand_set_pid_gains_tag      2
 #define tvr_FlightCommand_set_reference_tag      3
 #define tvr_FlightCommand_set_config_tag         4
+#define tvr_FlightCommand_command_id_tag         5
+#define tvr_CommandAck_latest_id_tag             1
+#define tvr_CommandAck_history_tag               2
 
 /* Struct field encoding specification for nanopb */
 #define tvr_FlightCommand_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,state_cmd,payload.state_cmd),   1) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,set_pid_gains,payload.set_pid_gains),   2) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,set_reference,payload.set_reference),   3) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,set_config,payload.set_config),   4)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,set_config,payload.set_config),   4) \
+X(a, STATIC,   SINGULAR, UINT32,   command_id,        5)
 #define tvr_FlightCommand_CALLBACK NULL
 #define tvr_FlightCommand_DEFAULT NULL
 #define tvr_FlightCommand_payload_state_cmd_MSGTYPE tvr_StateCommand
@@ -163,11 +177,18 @@ X(a, STATIC,   SINGULAR, FLOAT,    theta_max,         5)
 #define tvr_SetConfig_CALLBACK NULL
 #define tvr_SetConfig_DEFAULT NULL
 
+#define tvr_CommandAck_FIELDLIST(X, a) \
+X(a, STATIC,   SINGULAR, UINT32,   latest_id,         1) \
+X(a, STATIC,   SINGULAR, FIXED32,  history,           2)
+#define tvr_CommandAck_CALLBACK NULL
+#define tvr_CommandAck_DEFAULT NULL
+
 extern const pb_msgdesc_t tvr_FlightCommand_msg;
 extern const pb_msgdesc_t tvr_StateCommand_msg;
 extern const pb_msgdesc_t tvr_SetPidGains_msg;
 extern const pb_msgdesc_t tvr_SetReference_msg;
 extern const pb_msgdesc_t tvr_SetConfig_msg;
+extern const pb_msgdesc_t tvr_CommandAck_msg;
 
 /* Defines for backwards compatibility with code written before nanopb-0.4.0 */
 #define tvr_FlightCommand_fields &tvr_FlightCommand_msg
@@ -175,10 +196,12 @@ extern const pb_msgdesc_t tvr_SetConfig_msg;
 #define tvr_SetPidGains_fields &tvr_SetPidGains_msg
 #define tvr_SetReference_fields &tvr_SetReference_msg
 #define tvr_SetConfig_fields &tvr_SetConfig_msg
+#define tvr_CommandAck_fields &tvr_CommandAck_msg
 
 /* Maximum encoded size of messages (where known) */
 #define TVR_COMMAND_PB_H_MAX_SIZE                tvr_FlightCommand_size
-#define tvr_FlightCommand_size                   56
+#define tvr_CommandAck_size                      11
+#define tvr_FlightCommand_size                   62
 #define tvr_SetConfig_size                       25
 #define tvr_SetPidGains_size                     54
 #define tvr_SetReference_size                    32
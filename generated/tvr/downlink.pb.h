@@ -6,6 +6,7 @@
 #include <pb.h>
 #include "telemetry.pb.h"
 #include "status.pb.h"
+#include "command.pb.h"
 
 #if PB_PROTO_HEADER_VERSION != 40
 #error Regenerate this file with the current version of nanopb generator.
@@ -19,6 +20,8 @@ typedef struct _tvr_Downlink {
         tvr_TelemetryState telemetry;
         tvr_SystemStatus status;
     } payload;
+    bool has_ack;
+    tvr_CommandAck ack; /* set while command acknowledgements are pending */
 } tvr_Downlink;
 
 
@@ -27,21 +30,24 @@ extern "C" {
 #endif
 
 /* Initializer values for message structs */
-#define tvr_Downlink_init_default                {0, {tvr_TelemetryState_init_default}}
-#define tvr_Downlink_init_zero                   {0, {tvr_TelemetryState_init_zero}}
+#define tvr_Downlink_init_default                {0, {tvr_TelemetryState_init_default}, false, tvr_CommandAck_init_default}
+#define tvr_Downlink_init_zero                   {0, {tvr_TelemetryState_init_zero}, false, tvr_CommandAck_init_zero}
 
 /* Field tags (for use in manual encoding/decoding) */
 #define tvr_Downlink_telemetry_tag               1
 #define tvr_Downlink_status_tag                  2
+#define tvr_Downlink_ack_tag                     3
 
 /* Struct field encoding specification for nanopb */
 #define tvr_Downlink_FIELDLIST(X, a) \
 X(a, STATIC,   ONEOF,    MESSAGE,  (payload,telemetry,payload.telemetry),   1) \
-X(a, STATIC,   ONEOF,    MESSAGE,  (payload,status,payload.status),   2)
+X(a, STATIC,   ONEOF,    MESSAGE,  (payload,status,payload.status),   2) \
+X(a, STATIC,   OPTIONAL, MESSAGE,  ack,               3)
 #define tvr_Downlink_CALLBACK NULL
 #define tvr_Downlink_DEFAULT NULL
 #define tvr_Downlink_payload_telemetry_MSGTYPE tvr_TelemetryState
 #define tvr_Downlink_payload_status_MSGTYPE tvr_SystemStatus
+#define tvr_Downlink_ack_MSGTYPE tvr_CommandAck
 
 extern const pb_msgdesc_t tvr_Downlink_msg;
 
@@ -50,7 +56,7 @@ extern const pb_msgdesc_t tvr_Downlink_msg;
 
 /* Maximum encoded size of messages (where known) */
 #define TVR_DOWNLINK_PB_H_MAX_SIZE               tvr_Downlink_size
-#define tvr_Downlink_size                        98
+#define tvr_Downlink_size                        111
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -0,0 +1,120 @@
+#ifndef RP_ARQ_H
+#define RP_ARQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Same as `RP_PACKET_MAX_SIZE`, without pulling nanopb into users of the ARQ layer
+#ifndef RP_ARQ_FRAME_CAPACITY
+#define RP_ARQ_FRAME_CAPACITY (256)
+#endif
+
+// Commands awaiting confirmation at once
+#ifndef RP_ARQ_WINDOW_SIZE
+#define RP_ARQ_WINDOW_SIZE (8)
+#endif
+
+#define RP_ARQ_HISTORY_SIZE (32)  /**< Command IDs covered by `rp_arq_ack_t.history` */
+#define RP_ARQ_ACK_REPEATS (3)    /**< Downlink frames that carry each new acknowledgement */
+#define RP_ARQ_MAX_DROPOUT (1024) /**< Older IDs are taken as a sender restart */
+
+#if RP_ARQ_WINDOW_SIZE > RP_ARQ_HISTORY_SIZE
+#error "RP_ARQ_WINDOW_SIZE must not exceed RP_ARQ_HISTORY_SIZE"
+#endif
+
+typedef enum rp_arq_status {
+    RP_ARQ_OK,
+    RP_ARQ_NULL_POINTER,
+    RP_ARQ_INVALID_ARGUMENT,
+    RP_ARQ_FULL,
+} rp_arq_status_t;
+
+/**
+ * What the receiver should do with a command.
+ */
+typedef enum rp_arq_verdict {
+    RP_ARQ_EXECUTE,   /**< First copy of the command */
+    RP_ARQ_DUPLICATE, /**< Retransmission of a command already executed */
+    RP_ARQ_STALE,     /**< Too old to tell, the sender has given up on it */
+    RP_ARQ_UNTRACKED, /**< Command ID 0, execute without acknowledgement */
+} rp_arq_verdict_t;
+
+/**
+ * Acknowledgement state, mirrors `tvr_CommandAck`.
+ */
+typedef struct rp_arq_ack {
+    uint32_t latest_id; /**< Newest command ID received, 0 if none */
+    uint32_t history;   /**< Bit `i` set if command `latest_id - 1 - i` was received */
+} rp_arq_ack_t;
+
+typedef struct rp_arq_config {
+    uint32_t initial_rto_ms;   /**< Retransmit timeout before the first round trip sample */
+    uint32_t min_rto_ms;       /**< Lower bound of the adaptive timeout */
+    uint32_t max_rto_ms;       /**< Upper bound of the adaptive timeout, including backoff */
+    uint8_t max_transmissions; /**< Attempts before a command is given up */
+} rp_arq_config_t;
+
+typedef struct rp_arq_entry {
+    uint8_t frame[RP_ARQ_FRAME_CAPACITY]; /**< Encoded command, including the delimiter */
+    size_t size;                          /**< Number of bytes in the frame */
+    uint32_t command_id;                  /**< ID encoded in the frame */
+    uint32_t submitted_ms;                /**< Time the command was committed */
+    uint32_t sent_ms;                     /**< Time of the latest transmission */
+    uint32_t deadline_ms;                 /**< Time of the next (re)transmission */
+    uint8_t transmissions;                /**< Number of times the frame was sent */
+    bool in_use;                          /**< Awaiting confirmation */
+    bool reserved;                        /**< Handed out by `rp_arq_sender_reserve` */
+} rp_arq_entry_t;
+
+/**
+ * A command confirmed by `rp_arq_sender_on_ack`.
+ */
+typedef struct rp_arq_confirmation {
+    uint32_t command_id;
+    uint32_t elapsed_ms;   /**< From commit to confirmation */
+    uint8_t transmissions; /**< Number of times the frame was sent */
+} rp_arq_confirmation_t;
+
+typedef struct rp_arq_sender {
+    rp_arq_config_t config;
+    rp_arq_entry_t entries[RP_ARQ_WINDOW_SIZE];
+    uint32_t next_id;
+
+    bool has_rtt;
+    uint32_t srtt_ms;   /**< Smoothed round trip time */
+    uint32_t rttvar_ms; /**< Round trip time variation */
+    uint32_t rto_ms;    /**< Retransmit timeout, doubled per attempt for each command */
+
+    uint32_t transmissions;   /**< Frames sent, including retransmissions */
+    uint32_t retransmissions; /**< Frames sent again after a timeout */
+    uint32_t confirmed;       /**< Commands acknowledged */
+    uint32_t expired;         /**< Commands given up after `max_transmissions` */
+} rp_arq_sender_t;
+
+typedef struct rp_arq_receiver {
+    rp_arq_ack_t ack;
+    uint8_t repeats; /**< Downlink frames left to carry the current acknowledgement */
+
+    uint32_t executed;   /**< Commands accepted for execution */
+    uint32_t duplicates; /**< Retransmissions suppressed */
+} rp_arq_receiver_t;
+
+rp_arq_status_t rp_arq_sender_init(rp_arq_sender_t *sender, const rp_arq_config_t *config,
+                                   uint32_t first_id);
+
+rp_arq_entry_t *rp_arq_sender_reserve(rp_arq_sender_t *sender);
+rp_arq_status_t rp_arq_sender_commit(rp_arq_sender_t *sender, rp_arq_entry_t *entry, size_t size,
+                                     uint32_t now_ms);
+void rp_arq_sender_cancel(rp_arq_sender_t *sender, rp_arq_entry_t *entry);
+
+const rp_arq_entry_t *rp_arq_sender_poll(rp_arq_sender_t *sender, uint32_t now_ms);
+size_t rp_arq_sender_on_ack(rp_arq_sender_t *sender, const rp_arq_ack_t *ack, uint32_t now_ms,
+                            rp_arq_confirmation_t *confirmations, size_t capacity);
+size_t rp_arq_sender_in_flight(const rp_arq_sender_t *sender);
+
+void rp_arq_receiver_init(rp_arq_receiver_t *receiver);
+rp_arq_verdict_t rp_arq_receiver_accept(rp_arq_receiver_t *receiver, uint32_t command_id);
+bool rp_arq_receiver_take_ack(rp_arq_receiver_t *receiver, rp_arq_ack_t *ack);
+
+#endif // RP_ARQ_H
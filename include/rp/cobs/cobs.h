@@ -7,6 +7,7 @@
 
 #define COBS_DELIMITER_BYTE (0x00)
 #define COBS_ENCODED_MIN_SIZE (2)
+#define COBS_BLOCK_MAX_SIZE (255) /**< Code byte followed by up to 254 data bytes */
 
 typedef enum cobs_status {
     COBS_OK,
@@ -15,6 +16,7 @@ typedef enum cobs_status {
     COBS_INPUT_TOO_SHORT,
     COBS_UNEXPECTED_DELIMITER,
     COBS_MISSING_DELIMITER,
+    COBS_SINK_FAILED,
 } cobs_status_t;
 
 typedef struct cobs_result {
@@ -22,6 +24,26 @@ typedef struct cobs_result {
     cobs_status_t status; /**< Status of the operation */
 } cobs_result_t;
 
+/**
+ * Receives encoded bytes from a `cobs_encoder_t`, one complete block per call.
+ *
+ * @return bool False if the bytes could not be taken, which aborts the frame
+ */
+typedef bool (*cobs_sink_t)(void *context, const uint8_t *data, size_t size);
+
+/**
+ * Incremental COBS encoder that hands each block to a sink as soon as it is complete,
+ * so that only one block is ever buffered.
+ */
+typedef struct cobs_encoder {
+    cobs_sink_t sink;
+    void *context;
+    uint8_t block[COBS_BLOCK_MAX_SIZE + 1]; /**< Pending block, with room for the delimiter */
+    uint8_t code;                           /**< Code of the pending block, bytes in `block` */
+    size_t written;                         /**< Bytes of the current frame given to the sink */
+    cobs_status_t status;                   /**< First error of the current frame */
+} cobs_encoder_t;
+
 cobs_result_t cobs_encode(const uint8_t *data, size_t data_size, uint8_t *output,
                           size_t output_capacity);
 
@@ -30,4 +52,8 @@ cobs_result_t cobs_decode(const uint8_t *data, size_t data_size, uint8_t *output
 
 size_t cobs_get_max_encoded_size(size_t data_size);
 
+void cobs_encoder_init(cobs_encoder_t *encoder, cobs_sink_t sink, void *context);
+cobs_status_t cobs_encoder_write(cobs_encoder_t *encoder, const uint8_t *data, size_t data_size);
+cobs_result_t cobs_encoder_finish(cobs_encoder_t *encoder);
+
 #endif // RP_COBS_H
@@ -5,9 +5,19 @@
 #include <stdint.h>
 
 #include "pb.h"
+#include "rp/cobs/cobs.h"
+#include "rp/crc/crc.h"
+#include "rp/fec/rs.h"
+#include "rp/link/link.h"
+#include "rp/quant/quant.h"
 
 #define RP_PACKET_MAX_SIZE (256)
 
+// Frames `rp_packet_verify_batch` decodes before checking their checksums together
+#ifndef RP_PACKET_VERIFY_BATCH
+#define RP_PACKET_VERIFY_BATCH (64)
+#endif
+
 typedef enum rp_codec_status {
     RP_CODEC_OK,
     RP_CODEC_NULL_POINTER,
@@ -16,13 +26,75 @@ typedef enum rp_codec_status {
     RP_CODEC_ERROR,
 } rp_codec_status_t;
 
+/**
+ * Frame checksum appended (LE) after the protobuf payload.
+ */
+typedef enum rp_codec_checksum {
+    RP_CODEC_CHECKSUM_DEFAULT, /**< `RP_CODEC_DEFAULT_CHECKSUM`, chosen at compile time */
+    RP_CODEC_CHECKSUM_CRC16,   /**< CRC-16/KERMIT, 2 bytes */
+    RP_CODEC_CHECKSUM_CRC32C,  /**< CRC-32C, 4 bytes, hardware accelerated where available */
+} rp_codec_checksum_t;
+
+// Checksum used by `rp_packet_encode`/`rp_packet_decode` and zero-initialized options
+#ifndef RP_CODEC_DEFAULT_CHECKSUM
+#define RP_CODEC_DEFAULT_CHECKSUM RP_CODEC_CHECKSUM_CRC16
+#endif
+
+/**
+ * Optional stages of the frame pipeline. Both ends of a link must agree on them.
+ */
+typedef struct rp_codec_options {
+    rp_codec_checksum_t checksum;
+
+    /**
+     * Link header placed in front of the protobuf payload, covered by the checksum,
+     * or NULL to disable. Read when encoding and filled in when decoding.
+     */
+    rp_link_header_t *link_header;
+
+    /**
+     * Reed-Solomon code applied to the protobuf payload and checksum before COBS,
+     * or NULL to disable. The payload and parity must fit in `RS_SYMBOL_COUNT` bytes.
+     */
+    const rs_codec_t *fec;
+
+    /**
+     * Syndrome table used to repair frames that fail the checksum, or NULL to disable.
+     * Receiver only, CRC-16 checksums only. A repaired frame must still decode as
+     * `fields` to be accepted.
+     */
+    const crc16_repair_table_t *repair;
+    size_t repair_max_bits; /**< Largest number of flipped bits to repair, 1 or 2 */
+
+    /**
+     * Reduced-precision fields, or NULL to disable. Only applied to messages of type
+     * `quant->message`, which are carried as a packed block after the link header
+     * followed by the protobuf encoding of the remaining fields.
+     */
+    const rp_quant_spec_t *quant;
+} rp_codec_options_t;
+
 typedef struct rp_packet_encode_result {
     size_t written;
     rp_codec_status_t status;
 } rp_packet_encode_result_t;
 
+/**
+ * Working memory of `rp_packet_verify_batch`, about 17 KiB with the default batch size.
+ * Too large for the stack of a flight task: give it static or heap storage.
+ */
+typedef struct rp_packet_verify_scratch {
+    uint8_t decoded[RP_PACKET_VERIFY_BATCH][RP_PACKET_MAX_SIZE];
+    const uint8_t *codewords[RP_PACKET_VERIFY_BATCH];
+    size_t codeword_sizes[RP_PACKET_VERIFY_BATCH];
+    size_t indices[RP_PACKET_VERIFY_BATCH];
+    uint16_t residues[RP_PACKET_VERIFY_BATCH];
+} rp_packet_verify_scratch_t;
+
 typedef struct rp_packet_decode_result {
     rp_codec_status_t status;
+    size_t corrected;     /**< Symbols repaired by forward error correction */
+    size_t repaired_bits; /**< Bits repaired using the checksum syndrome */
 } rp_packet_decode_result_t;
 
 rp_packet_encode_result_t rp_packet_encode(uint8_t *packet, size_t packet_capacity,
@@ -30,4 +102,21 @@ rp_packet_encode_result_t rp_packet_encode(uint8_t *packet, size_t packet_capaci
 rp_packet_decode_result_t rp_packet_decode(const uint8_t *packet, size_t packet_size,
                                            const pb_msgdesc_t *fields, void *message);
 
+rp_packet_encode_result_t rp_packet_encode_with_options(uint8_t *packet, size_t packet_capacity,
+                                                        const pb_msgdesc_t *fields,
+                                                        const void *message,
+                                                        const rp_codec_options_t *options);
+rp_packet_decode_result_t rp_packet_decode_with_options(const uint8_t *packet, size_t packet_size,
+                                                        const pb_msgdesc_t *fields, void *message,
+                                                        const rp_codec_options_t *options);
+
+rp_packet_encode_result_t rp_packet_encode_to_sink(cobs_sink_t sink, void *context,
+                                                   const pb_msgdesc_t *fields, const void *message,
+                                                   const rp_codec_options_t *options);
+
+size_t rp_packet_verify_batch(const uint8_t *const *packets, const size_t *packet_sizes,
+                              size_t count, rp_codec_status_t *statuses,
+                              rp_packet_verify_scratch_t *scratch,
+                              const rp_codec_options_t *options);
+
 #endif // RP_CODEC_H
@@ -0,0 +1,337 @@
+#ifndef RP_CODEC_HPP
+#define RP_CODEC_HPP
+
+/*
+ * Typed C++20 wrapper around `rp_packet_encode_with_options` and
+ * `rp_packet_decode_with_options`.
+ *
+ * Message types are registered with `RP_MESSAGE_TRAITS(tvr_Downlink)`, which picks up
+ * the nanopb `<type>_fields` descriptor and `<type>_size` bound, so buffers can be
+ * sized at compile time (`rp/tvr.hpp` does this for the vehicle messages):
+ *
+ *     rp::codec<tvr_Downlink> codec;
+ *     rp::codec<tvr_Downlink>::buffer_type buffer;
+ *
+ *     auto frame = codec.encode(downlink, buffer);
+ *     auto decoded = codec.decode(*frame);
+ *
+ * Buffers are sized for the `rp::framing` given as second argument, plain frames by
+ * default; `rp::any_framing` covers every option.
+ *
+ * Everything here is inline; the C core is only inlined across the library boundary
+ * with link time optimization.
+ */
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+extern "C" {
+#include "rp/cobs/cobs.h"
+#include "rp/codec.h"
+#include "rp/fec/rs.h"
+#include "rp/link/link.h"
+#include "rp/quant/quant.h"
+}
+
+namespace rp {
+
+/**
+ * Compile-time description of a nanopb message, see `RP_MESSAGE_TRAITS`.
+ */
+template <typename Msg> struct message_traits;
+
+template <typename Msg>
+concept message = requires {
+    { message_traits<Msg>::fields } -> std::convertible_to<const pb_msgdesc_t *>;
+    { message_traits<Msg>::max_size } -> std::convertible_to<std::size_t>;
+};
+
+/**
+ * Same bound as `cobs_get_max_encoded_size`, usable in constant expressions.
+ */
+constexpr std::size_t cobs_max_encoded_size(std::size_t data_size) noexcept
+{
+    if (data_size == 0) {
+        return COBS_ENCODED_MIN_SIZE;
+    }
+
+    return data_size + (data_size + 254 - 1) / 254 + 1;
+}
+
+/**
+ * The codec options that add bytes to a frame, as known at compile time.
+ */
+struct framing {
+    bool link_header = false; /**< `rp_codec_options_t::link_header` is set */
+    bool quant = false;       /**< `rp_codec_options_t::quant` is set */
+    rp_codec_checksum_t checksum = RP_CODEC_CHECKSUM_DEFAULT;
+    std::size_t parity_size = 0; /**< Of `rp_codec_options_t::fec`, 0 without */
+
+    /**
+     * Bytes added to the protobuf payload before COBS. Quantized values never take more
+     * room than the protobuf fields they replace, so only the bitmap counts.
+     */
+    constexpr std::size_t overhead() const noexcept
+    {
+        rp_codec_checksum_t resolved =
+            (checksum == RP_CODEC_CHECKSUM_DEFAULT) ? RP_CODEC_DEFAULT_CHECKSUM : checksum;
+
+        return (link_header ? RP_LINK_HEADER_SIZE : 0) + (quant ? RP_QUANT_MAX_BITMAP_SIZE : 0) +
+               (resolved == RP_CODEC_CHECKSUM_CRC32C ? sizeof(std::uint32_t)
+                                                      : sizeof(std::uint16_t)) +
+               parity_size;
+    }
+};
+
+/**
+ * Every option at its largest: link header, quantization bitmap, CRC-32C and the
+ * strongest Reed-Solomon code. For options only known at run time.
+ */
+inline constexpr framing any_framing{true, true, RP_CODEC_CHECKSUM_CRC32C, RS_MAX_PARITY};
+
+/**
+ * Largest frame, including the delimiter, that `Msg` encodes to with the options of `F`.
+ */
+template <message Msg, framing F = framing{}>
+inline constexpr std::size_t frame_size =
+    cobs_max_encoded_size(message_traits<Msg>::max_size + F.overhead());
+
+/**
+ * Whether the largest `Msg` encodes with the options of `F`. The codec rejects a payload
+ * and checksum of `RP_PACKET_MAX_SIZE` bytes or more, and a Reed-Solomon codeword longer
+ * than `RS_SYMBOL_COUNT`.
+ */
+template <message Msg, framing F = framing{}>
+inline constexpr bool fits_packet =
+    message_traits<Msg>::max_size + F.overhead() < RP_PACKET_MAX_SIZE &&
+    (F.parity_size == 0 || message_traits<Msg>::max_size + F.overhead() <= RS_SYMBOL_COUNT);
+
+/**
+ * Error half of `result`, mirrors `std::unexpected`.
+ */
+template <typename E = rp_codec_status_t> class unexpected {
+  public:
+    constexpr explicit unexpected(E error) noexcept : error_{error}
+    {
+    }
+
+    constexpr E error() const noexcept
+    {
+        return error_;
+    }
+
+  private:
+    E error_;
+};
+
+/**
+ * Either a value or the error that prevented it, with the subset of the
+ * `std::expected` interface the codec needs (C++20 has no `std::expected`).
+ */
+template <typename T, typename E = rp_codec_status_t> class result {
+  public:
+    using value_type = T;
+    using error_type = E;
+
+    constexpr result(const T &value) noexcept(std::is_nothrow_copy_constructible_v<T>)
+        : value_{value}, error_{}, has_value_{true}
+    {
+    }
+
+    constexpr result(T &&value) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : value_{std::move(value)}, error_{}, has_value_{true}
+    {
+    }
+
+    constexpr result(unexpected<E> error) noexcept(std::is_nothrow_default_constructible_v<T>)
+        : value_{}, error_{error.error()}, has_value_{false}
+    {
+    }
+
+    constexpr bool has_value() const noexcept
+    {
+        return has_value_;
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return has_value();
+    }
+
+    constexpr T &value() & noexcept
+    {
+        return value_;
+    }
+
+    constexpr const T &value() const & noexcept
+    {
+        return value_;
+    }
+
+    constexpr T &&value() && noexcept
+    {
+        return std::move(value_);
+    }
+
+    constexpr T &operator*() & noexcept
+    {
+        return value_;
+    }
+
+    constexpr const T &operator*() const & noexcept
+    {
+        return value_;
+    }
+
+    constexpr T *operator->() noexcept
+    {
+        return &value_;
+    }
+
+    constexpr const T *operator->() const noexcept
+    {
+        return &value_;
+    }
+
+    template <typename U> constexpr T value_or(U &&fallback) const &
+    {
+        return has_value() ? value_ : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    /**
+     * @return E The error, value-initialized (`RP_CODEC_OK`) when a value is present
+     */
+    constexpr E error() const noexcept
+    {
+        return error_;
+    }
+
+  private:
+    T value_;
+    E error_;
+    bool has_value_;
+};
+
+/**
+ * What the decoder repaired on the way, see `rp_packet_decode_result_t`.
+ */
+struct decode_info {
+    std::size_t corrected = 0;
+    std::size_t repaired_bits = 0;
+};
+
+/**
+ * Codec for `Msg` with options of at most the size `F` describes. Options that go beyond
+ * `F` still work with caller-sized buffers, but may overflow `buffer_type`.
+ */
+template <message Msg, framing F = framing{}> class codec {
+  public:
+    using message_type = Msg;
+    using buffer_type = std::array<std::uint8_t, frame_size<Msg, F>>;
+
+    static constexpr std::size_t max_frame_size = frame_size<Msg, F>;
+
+    static_assert(F.parity_size <= RS_MAX_PARITY, "Reed-Solomon codes have at most RS_MAX_PARITY");
+    static_assert(message_traits<Msg>::max_size + F.overhead() < RP_PACKET_MAX_SIZE,
+                  "Message does not fit in RP_PACKET_MAX_SIZE with these codec options");
+    static_assert(F.parity_size == 0 ||
+                      message_traits<Msg>::max_size + F.overhead() <= RS_SYMBOL_COUNT,
+                  "Message and parity do not fit in one RS_SYMBOL_COUNT codeword");
+
+    constexpr codec() noexcept = default;
+
+    constexpr explicit codec(const rp_codec_options_t &options) noexcept : options_{options}
+    {
+    }
+
+    constexpr const rp_codec_options_t &options() const noexcept
+    {
+        return options_;
+    }
+
+    /**
+     * Encodes a message into a caller-provided buffer.
+     *
+     * @return result<std::span<const std::uint8_t>> The frame, a prefix of `output`
+     */
+    result<std::span<const std::uint8_t>> encode(const Msg &message,
+                                                 std::span<std::uint8_t> output) const noexcept
+    {
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            output.data(), output.size(), message_traits<Msg>::fields, &message, &options_);
+
+        if (encoded.status != RP_CODEC_OK) {
+            return unexpected{encoded.status};
+        }
+
+        return std::span<const std::uint8_t>{output.data(), encoded.written};
+    }
+
+    /**
+     * Encodes a message into a buffer that always has room for it.
+     */
+    result<std::span<const std::uint8_t>> encode(const Msg &message,
+                                                 buffer_type &output) const noexcept
+    {
+        return encode(message, std::span<std::uint8_t>{output});
+    }
+
+    /**
+     * Decodes one frame, including its delimiter, into `message`.
+     */
+    result<decode_info> decode(std::span<const std::uint8_t> frame, Msg &message) const noexcept
+    {
+        rp_packet_decode_result_t decoded = rp_packet_decode_with_options(
+            frame.data(), frame.size(), message_traits<Msg>::fields, &message, &options_);
+
+        if (decoded.status != RP_CODEC_OK) {
+            return unexpected{decoded.status};
+        }
+
+        return decode_info{decoded.corrected, decoded.repaired_bits};
+    }
+
+    /**
+     * Decodes one frame, including its delimiter.
+     */
+    result<Msg> decode(std::span<const std::uint8_t> frame) const noexcept
+    {
+        Msg message{};
+        result<decode_info> decoded = decode(frame, message);
+
+        if (!decoded) {
+            return unexpected{decoded.error()};
+        }
+
+        return message;
+    }
+
+  private:
+    rp_codec_options_t options_{};
+};
+
+} // namespace rp
+
+/**
+ * Registers a nanopb message with `rp::codec` at global scope, given its descriptor and
+ * maximum encoded size, e.g. `RP_MESSAGE_TRAITS_EX(my_msg_t, MY_MSG_FIELDS, MY_MSG_SIZE);`
+ * for code generated with `--c-style`.
+ */
+#define RP_MESSAGE_TRAITS_EX(type, type_fields, type_size)                                         \
+    template <> struct rp::message_traits<type> {                                                  \
+        static constexpr const pb_msgdesc_t *fields = type_fields;                                 \
+        static constexpr std::size_t max_size = type_size;                                         \
+    }
+
+/**
+ * Registers a nanopb message that uses the default naming, e.g.
+ * `RP_MESSAGE_TRAITS(tvr_Downlink);` for `tvr_Downlink_fields` and `tvr_Downlink_size`.
+ */
+#define RP_MESSAGE_TRAITS(type) RP_MESSAGE_TRAITS_EX(type, type##_fields, type##_size)
+
+#endif // RP_CODEC_HPP
@@ -1,12 +1,44 @@
 #ifndef RP_CRC_H
 #define RP_CRC_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #define CRC16_CCITT_INITIAL_VALUE (0x0000)
 #define CRC16_CCITT_RESIDUE (0x0000)
 
+#define CRC32C_RESIDUE (0x48674BC7) /**< CRC-32C of any codeword with its checksum appended LE */
+
+#define CRC16_BATCH_LANES (16) /**< Buffers `crc16_ccitt_batch` advances together */
+
+#define CRC16_REPAIR_MAX_LENGTH (256) /**< Longest codeword, in bytes, the repair table covers */
+#define CRC16_REPAIR_MAX_BITS (CRC16_REPAIR_MAX_LENGTH * 8)
+
+typedef struct crc16_syndrome_entry {
+    uint16_t syndrome; /**< Residue left by a single bit error */
+    uint16_t distance; /**< Bit position of the error, counted from the end of the codeword */
+} crc16_syndrome_entry_t;
+
+typedef struct crc16_repair_table {
+    uint16_t syndromes[CRC16_REPAIR_MAX_BITS];                 /**< Syndrome by bit distance */
+    crc16_syndrome_entry_t by_syndrome[CRC16_REPAIR_MAX_BITS]; /**< Sorted by syndrome */
+} crc16_repair_table_t;
+
 uint16_t crc16_ccitt(const uint8_t *data, size_t length);
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *data, size_t length);
+uint16_t crc16_ccitt_shift_operator(size_t length);
+uint16_t crc16_ccitt_shift(uint16_t crc, uint16_t shift_operator);
+void crc16_ccitt_batch(const uint8_t *const *data, const size_t *lengths, size_t count,
+                       uint16_t *crcs);
+
+uint32_t crc32c(const uint8_t *data, size_t length);
+uint32_t crc32c_update(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t crc32c_software(const uint8_t *data, size_t length);
+bool crc32c_hardware_available(void);
+
+void crc16_repair_table_init(crc16_repair_table_t *table);
+size_t crc16_repair(const crc16_repair_table_t *table, uint8_t *codeword, size_t length,
+                    uint16_t residue, size_t max_bits);
 
 #endif // RP_CRC_H
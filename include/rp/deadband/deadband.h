@@ -0,0 +1,91 @@
+#ifndef RP_DEADBAND_H
+#define RP_DEADBAND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RP_DEADBAND_MAX_FIELDS (16)
+
+// `rate_offset`/`present_offset` value for fields without one
+#define RP_DEADBAND_NONE (SIZE_MAX)
+
+typedef enum rp_deadband_kind {
+    RP_DEADBAND_VECTOR,   /**< 1 to 4 `float`s, extrapolated with a rate of the same size */
+    RP_DEADBAND_ROTATION, /**< Quaternion `w, x, y, z`, integrated with a body angular rate */
+    RP_DEADBAND_EXACT,    /**< Any change is sent, e.g. an enum */
+} rp_deadband_kind_t;
+
+typedef enum rp_deadband_status {
+    RP_DEADBAND_OK,
+    RP_DEADBAND_NULL_POINTER,
+    RP_DEADBAND_INVALID_SPEC,
+    RP_DEADBAND_NO_REFERENCE,
+} rp_deadband_status_t;
+
+/**
+ * A member of the message predicted from the last frame sent.
+ */
+typedef struct rp_deadband_field {
+    size_t offset; /**< Offset of the member in the message struct */
+    rp_deadband_kind_t kind;
+    uint8_t count; /**< `RP_DEADBAND_VECTOR`: number of `float`s, `RP_DEADBAND_EXACT`: bytes */
+
+    /**
+     * Offset of the member's rate of change per second, or `RP_DEADBAND_NONE` to hold the
+     * last value. `count` `float`s for a vector, a body-frame angular rate `x, y, z` in
+     * rad/s for a rotation.
+     */
+    size_t rate_offset;
+
+    /**
+     * Largest prediction error that is not sent: Euclidean distance for a vector, rotation
+     * angle in radians for a quaternion. Should exceed any quantization step.
+     */
+    float tolerance;
+
+    /**
+     * Offset of the `has_` flag of the enclosing submessage, or `RP_DEADBAND_NONE`. A
+     * change of the flag is always sent.
+     */
+    size_t present_offset;
+} rp_deadband_field_t;
+
+/**
+ * Predicted members of one message type. Members outside the spec are held at their last
+ * sent value and never trigger a frame.
+ */
+typedef struct rp_deadband_spec {
+    size_t message_size;      /**< `sizeof` the message struct */
+    size_t timestamp_offset;  /**< `uint32_t` millisecond timestamp of the message */
+    uint32_t max_interval_ms; /**< A frame is sent at least this often */
+    const rp_deadband_field_t *fields;
+    size_t field_count;
+} rp_deadband_spec_t;
+
+/**
+ * Last message sent, or received on the other end of the link, that predictions are
+ * made from.
+ */
+typedef struct rp_deadband {
+    const rp_deadband_spec_t *spec;
+    void *reference; /**< `message_size` bytes owned by the caller */
+    bool has_reference;
+
+    uint32_t sent;       /**< Messages `rp_deadband_filter` let through */
+    uint32_t suppressed; /**< Messages `rp_deadband_filter` held back */
+} rp_deadband_t;
+
+bool rp_deadband_spec_valid(const rp_deadband_spec_t *spec);
+
+rp_deadband_status_t rp_deadband_init(rp_deadband_t *deadband, const rp_deadband_spec_t *spec,
+                                      void *reference);
+void rp_deadband_reset(rp_deadband_t *deadband);
+
+bool rp_deadband_filter(rp_deadband_t *deadband, const void *message);
+
+void rp_deadband_received(rp_deadband_t *deadband, const void *message);
+rp_deadband_status_t rp_deadband_reconstruct(const rp_deadband_t *deadband,
+                                             uint32_t timestamp_ms, void *message);
+
+#endif // RP_DEADBAND_H
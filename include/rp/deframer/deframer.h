@@ -0,0 +1,33 @@
+#ifndef RP_DEFRAMER_H
+#define RP_DEFRAMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum rp_deframer_status {
+    RP_DEFRAMER_NEED_MORE,
+    RP_DEFRAMER_FRAME_READY,
+    RP_DEFRAMER_OVERFLOW,
+    RP_DEFRAMER_NULL_POINTER,
+} rp_deframer_status_t;
+
+typedef struct rp_deframer {
+    uint8_t *buffer;    /**< Storage for the frame being collected */
+    size_t capacity;    /**< Size of the storage in bytes */
+    size_t size;        /**< Number of bytes collected so far (including the delimiter once ready) */
+    bool ready;         /**< A complete frame is held in the buffer */
+    bool discarding;    /**< Skipping bytes of an oversized frame until the next delimiter */
+} rp_deframer_t;
+
+typedef struct rp_deframer_result {
+    size_t consumed;             /**< Number of input bytes consumed */
+    rp_deframer_status_t status; /**< Status of the operation */
+} rp_deframer_result_t;
+
+void rp_deframer_init(rp_deframer_t *deframer, uint8_t *buffer, size_t capacity);
+
+rp_deframer_result_t rp_deframer_feed(rp_deframer_t *deframer, const uint8_t *data,
+                                      size_t data_size);
+
+#endif // RP_DEFRAMER_H
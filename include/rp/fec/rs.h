@@ -0,0 +1,38 @@
+#ifndef RP_FEC_RS_H
+#define RP_FEC_RS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define RS_SYMBOL_COUNT (255) /**< Symbols in a full length GF(256) codeword */
+#define RS_MAX_PARITY (32)    /**< Parity symbols of RS(255,223) */
+
+typedef enum rs_status {
+    RS_OK,
+    RS_NULL_POINTER,
+    RS_INVALID_LENGTH,
+    RS_UNCORRECTABLE,
+} rs_status_t;
+
+typedef struct rs_result {
+    size_t corrected;   /**< Number of symbols corrected */
+    rs_status_t status; /**< Status of the operation */
+} rs_result_t;
+
+typedef struct rs_codec {
+    uint8_t parity_size;                      /**< Parity symbols per codeword (2t) */
+    uint8_t generator[RS_MAX_PARITY + 1];     /**< Generator coefficients, index i for x^i */
+} rs_codec_t;
+
+rs_status_t rs_codec_init(rs_codec_t *codec, size_t parity_size);
+
+rs_status_t rs_encode(const rs_codec_t *codec, const uint8_t *data, size_t data_size,
+                      uint8_t *parity);
+rs_status_t rs_encode_update(const rs_codec_t *codec, const uint8_t *data, size_t data_size,
+                             uint8_t *parity);
+
+rs_result_t rs_decode(const rs_codec_t *codec, uint8_t *codeword, size_t codeword_size);
+rs_result_t rs_decode_erasures(const rs_codec_t *codec, uint8_t *codeword, size_t codeword_size,
+                               const size_t *erasures, size_t erasure_count);
+
+#endif // RP_FEC_RS_H
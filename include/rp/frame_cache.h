@@ -0,0 +1,42 @@
+#ifndef RP_FRAME_CACHE_H
+#define RP_FRAME_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb.h"
+#include "rp/codec.h"
+#include "rp/link/link.h"
+
+/**
+ * Last frame encoded for one message type, reused while the message is unchanged.
+ *
+ * The message struct is compared byte for byte with a snapshot of the one that was last
+ * encoded, so padding or unused oneof members that differ only cost a re-encode. Messages
+ * with callback or pointer fields must not be cached, as only the pointers are compared.
+ */
+typedef struct rp_frame_cache {
+    const pb_msgdesc_t *fields;
+    void *snapshot;      /**< Copy of the message the cached frame was encoded from */
+    size_t message_size; /**< Size of the message struct in bytes */
+
+    rp_codec_options_t options;   /**< Options the cached frame was encoded with */
+    rp_link_header_t link_header; /**< Copy of `*options.link_header` */
+
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    size_t frame_size; /**< Bytes in `frame`, 0 when nothing is cached */
+
+    uint32_t hits;   /**< Encodes served from the cached frame */
+    uint32_t misses; /**< Encodes that ran the full pipeline */
+} rp_frame_cache_t;
+
+rp_codec_status_t rp_frame_cache_init(rp_frame_cache_t *cache, const pb_msgdesc_t *fields,
+                                      void *snapshot, size_t message_size);
+void rp_frame_cache_invalidate(rp_frame_cache_t *cache);
+
+rp_packet_encode_result_t rp_frame_cache_encode(rp_frame_cache_t *cache, uint8_t *packet,
+                                                size_t packet_capacity, const void *message,
+                                                const rp_codec_options_t *options);
+
+#endif // RP_FRAME_CACHE_H
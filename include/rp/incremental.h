@@ -0,0 +1,86 @@
+#ifndef RP_INCREMENTAL_H
+#define RP_INCREMENTAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb.h"
+#include "rp/codec.h"
+
+#define RP_INCREMENTAL_MAX_FIELDS (32)
+#define RP_INCREMENTAL_MAX_DEPTH (4)
+
+// `rp_incremental_slot_t.position` of fields missing from the previous frame
+#define RP_INCREMENTAL_ABSENT (UINT16_MAX)
+
+typedef enum rp_incremental_wire {
+    RP_INCREMENTAL_VARINT,  /**< `uint32_t` or non-negative enum member */
+    RP_INCREMENTAL_FIXED32, /**< `float`, `fixed32` or `sfixed32` member */
+    RP_INCREMENTAL_FIXED64, /**< `double`, `fixed64` or `sfixed64` member */
+} rp_incremental_wire_t;
+
+/**
+ * A scalar member that may be patched in place in the previous frame.
+ */
+typedef struct rp_incremental_field {
+    size_t offset; /**< Offset of the member in the message struct */
+    rp_incremental_wire_t wire;
+    uint8_t depth;                            /**< Number of entries in `tags` */
+    uint32_t tags[RP_INCREMENTAL_MAX_DEPTH]; /**< Field numbers from the message down */
+} rp_incremental_field_t;
+
+/**
+ * Patchable members of one message type, sorted by offset and not overlapping.
+ */
+typedef struct rp_incremental_spec {
+    const pb_msgdesc_t *message; /**< Message type the spec applies to */
+    size_t message_size;         /**< `sizeof` the message struct */
+    const rp_incremental_field_t *fields;
+    size_t field_count;
+} rp_incremental_spec_t;
+
+/**
+ * Where a spec field ended up in the previous frame.
+ */
+typedef struct rp_incremental_slot {
+    uint16_t position;       /**< Offset of the value before COBS, or `RP_INCREMENTAL_ABSENT` */
+    uint8_t size;            /**< Bytes of the encoded value */
+    uint16_t shift_operator; /**< Advances the CRC over the bytes after the value */
+} rp_incremental_slot_t;
+
+/**
+ * Previous frame of one message type and the layout of its spec fields.
+ */
+typedef struct rp_incremental_encoder {
+    const rp_incremental_spec_t *spec;
+    void *snapshot; /**< Copy of the message the previous frame was encoded from */
+
+    bool has_layout;      /**< Whether the previous frame can be patched */
+    bool has_link_header; /**< Whether the previous frame starts with a link header */
+    uint16_t header_shift_operator;
+    rp_incremental_slot_t slots[RP_INCREMENTAL_MAX_FIELDS];
+
+    uint8_t plain[RP_PACKET_MAX_SIZE];          /**< Previous frame before COBS */
+    size_t plain_size;                          /**< Including the checksum */
+    uint16_t cobs_position[RP_PACKET_MAX_SIZE]; /**< Where each byte of `plain` is in `frame` */
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    size_t frame_size;
+
+    uint32_t full_encodes;    /**< Frames encoded by the full pipeline */
+    uint32_t patched_encodes; /**< Frames produced by patching the previous one */
+    uint32_t cobs_reencodes;  /**< Patched frames where a zero byte appeared or disappeared */
+} rp_incremental_encoder_t;
+
+bool rp_incremental_spec_valid(const rp_incremental_spec_t *spec);
+
+rp_codec_status_t rp_incremental_init(rp_incremental_encoder_t *encoder,
+                                      const rp_incremental_spec_t *spec, void *snapshot);
+void rp_incremental_invalidate(rp_incremental_encoder_t *encoder);
+
+rp_packet_encode_result_t rp_incremental_encode(rp_incremental_encoder_t *encoder,
+                                                uint8_t *packet, size_t packet_capacity,
+                                                const void *message,
+                                                const rp_codec_options_t *options);
+
+#endif // RP_INCREMENTAL_H
@@ -0,0 +1,115 @@
+#ifndef RP_INTERLEAVE_H
+#define RP_INTERLEAVE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp/fec/rs.h"
+
+#define RP_INTERLEAVE_MAX_DEPTH (16) /**< Packets spread across each other in one block */
+
+// Largest transmitted frame, COBS encoded with its delimiter: `RP_PACKET_MAX_SIZE`, so a
+// receiver splits interleaved frames with the same deframer buffer as plain packets
+#define RP_INTERLEAVE_FRAME_MAX_SIZE (256)
+
+// Largest frame before COBS, one block of 254 bytes
+#define RP_INTERLEAVE_BODY_MAX_SIZE (RP_INTERLEAVE_FRAME_MAX_SIZE - 2)
+
+// Block sequence, row count and index, row sizes, CRC-16 of the header
+#define RP_INTERLEAVE_HEADER_SIZE(row_count) (2 + (row_count) + 2)
+
+// Largest packet, COBS decoded, that an interleaver of `depth` takes. A block of `r <= depth`
+// packets adds an `r + 4` byte header and pads the largest packet by at most `r - 1` bytes,
+// so every frame body fits `RP_INTERLEAVE_BODY_MAX_SIZE`
+#define RP_INTERLEAVE_PACKET_MAX_SIZE(depth) (RP_INTERLEAVE_BODY_MAX_SIZE - 2 * (depth) - 3)
+
+// Largest packet in any block, the limit at depth 1
+#define RP_INTERLEAVE_ROW_MAX_SIZE RP_INTERLEAVE_PACKET_MAX_SIZE(1)
+
+typedef enum rp_interleave_status {
+    RP_INTERLEAVE_OK,
+    RP_INTERLEAVE_NULL_POINTER,
+    RP_INTERLEAVE_INVALID_ARGUMENT,
+    RP_INTERLEAVE_BAD_PACKET, /**< Not a COBS frame, or larger than a row */
+    RP_INTERLEAVE_BAD_FRAME,  /**< Not an interleaved frame, or damaged in its header */
+    RP_INTERLEAVE_LATE,       /**< Frame of a block already delivered */
+    RP_INTERLEAVE_SINK_FAILED,
+} rp_interleave_status_t;
+
+/**
+ * Receives whole frames from the interleaver, or packets from the deinterleaver, COBS
+ * encoded with their delimiter.
+ *
+ * @return bool false to abandon the rest of the block
+ */
+typedef bool (*rp_interleave_sink_t)(void *context, const uint8_t *data, size_t size);
+
+/**
+ * Sending end. Collects `depth` packets, then sends them as `depth` frames that each
+ * carry every `depth`-th byte of every packet, so a fade that wipes out consecutive bytes
+ * on the radio costs each packet only `1/depth` of them, few enough for its Reed-Solomon
+ * parity to repair. A whole frame lost costs each packet `1/depth` of its bytes.
+ *
+ * Packets are delayed until their block is full: up to `depth - 1` packet periods. Call
+ * `rp_interleaver_flush` to bound the delay when packets stop coming.
+ *
+ * Each frame is one COBS frame of at most `RP_PACKET_MAX_SIZE` bytes, so the receiver's
+ * deframer splits the stream as usual, and the deinterleaver takes the frames it returns.
+ * In exchange, packets are limited to `RP_INTERLEAVE_PACKET_MAX_SIZE(depth)` bytes before
+ * COBS, less than the codec's largest packet: keep messages on an interleaved link below it.
+ */
+typedef struct rp_interleaver {
+    rp_interleave_sink_t sink;
+    void *context;
+    uint8_t depth;
+    uint8_t sequence; /**< Of the block being collected, wraps around */
+    uint8_t row_count;
+    uint8_t row_sizes[RP_INTERLEAVE_MAX_DEPTH];
+    uint8_t rows[RP_INTERLEAVE_MAX_DEPTH][RP_INTERLEAVE_ROW_MAX_SIZE];
+} rp_interleaver_t;
+
+/**
+ * Receiving end. Delivers the packets of a block as soon as all its frames are in, or
+ * when a frame of a newer block shows up.
+ *
+ * A fade usually breaks the COBS encoding of the frame it hits, so the whole frame is
+ * lost. Given the packets' Reed-Solomon code, the deinterleaver corrects the bytes of lost
+ * frames as erasures: their positions are known, so each costs one parity symbol instead
+ * of two. Otherwise they are delivered as zeros, for the codec to correct as errors.
+ */
+typedef struct rp_deinterleaver {
+    const rs_codec_t *fec; /**< Code of the packets, as in `rp_codec_options_t`, or NULL */
+    rp_interleave_sink_t sink;
+    void *context;
+
+    bool started;          /**< A block is being collected */
+    bool has_last;         /**< `last_sequence` is valid */
+    uint8_t sequence;      /**< Of the block being collected */
+    uint8_t last_sequence; /**< Of the last block delivered */
+    uint8_t row_count;
+    uint8_t column_count; /**< Bytes of each packet per frame */
+    uint32_t received;    /**< Bit `i` set if frame `i` of the block was received */
+    uint8_t row_sizes[RP_INTERLEAVE_MAX_DEPTH];
+    uint8_t rows[RP_INTERLEAVE_MAX_DEPTH][RP_INTERLEAVE_ROW_MAX_SIZE];
+
+    uint32_t blocks;    /**< Blocks delivered */
+    uint32_t frames;    /**< Frames accepted */
+    uint32_t lost;      /**< Frames missing from delivered blocks */
+    uint32_t rejected;  /**< Frames dropped as damaged or late */
+    uint32_t corrected; /**< Symbols corrected with `fec` */
+} rp_deinterleaver_t;
+
+rp_interleave_status_t rp_interleaver_init(rp_interleaver_t *interleaver, size_t depth,
+                                           rp_interleave_sink_t sink, void *context);
+rp_interleave_status_t rp_interleaver_push(rp_interleaver_t *interleaver, const uint8_t *packet,
+                                           size_t packet_size);
+rp_interleave_status_t rp_interleaver_flush(rp_interleaver_t *interleaver);
+
+void rp_deinterleaver_init(rp_deinterleaver_t *deinterleaver, const rs_codec_t *fec,
+                           rp_interleave_sink_t sink, void *context);
+rp_interleave_status_t rp_deinterleaver_push(rp_deinterleaver_t *deinterleaver,
+                                             const uint8_t *frame, size_t frame_size);
+rp_interleave_status_t rp_deinterleaver_flush(rp_deinterleaver_t *deinterleaver);
+
+#endif // RP_INTERLEAVE_H
@@ -0,0 +1,83 @@
+#ifndef RP_LINK_H
+#define RP_LINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RP_LINK_HEADER_SIZE (6)        /**< Sequence (2 bytes) and timestamp (4 bytes), LE */
+#define RP_LINK_HISTOGRAM_BUCKETS (24) /**< Power of two buckets, the last one is open ended */
+#define RP_LINK_WINDOW_SIZE (64)       /**< Sequence numbers remembered for duplicate detection */
+#define RP_LINK_MAX_DROPOUT (1024)     /**< Larger jumps are treated as a sender restart */
+
+typedef struct rp_link_header {
+    uint16_t sequence;     /**< Incremented for every frame sent, wraps around */
+    uint32_t timestamp_us; /**< Sender clock when the frame was encoded, wraps around */
+} rp_link_header_t;
+
+typedef enum rp_link_event {
+    RP_LINK_IN_ORDER,  /**< Next expected frame */
+    RP_LINK_GAP,       /**< Newer than expected, the frames in between are missing */
+    RP_LINK_REORDERED, /**< Older than the newest frame, fills an earlier gap */
+    RP_LINK_DUPLICATE, /**< Already received */
+    RP_LINK_LATE,      /**< Too old to tell apart from a duplicate */
+    RP_LINK_RESYNC,    /**< First frame, or the sender restarted its sequence */
+} rp_link_event_t;
+
+/**
+ * Histogram of microsecond durations. Bucket 0 counts values below 2 us and bucket `i`
+ * counts values in [2^i, 2^(i+1)) us.
+ */
+typedef struct rp_link_histogram {
+    uint32_t counts[RP_LINK_HISTOGRAM_BUCKETS];
+    uint32_t samples;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+} rp_link_histogram_t;
+
+typedef struct rp_link_sender {
+    uint16_t next_sequence;
+} rp_link_sender_t;
+
+typedef struct rp_link_stats {
+    bool started;
+    uint16_t highest; /**< Newest sequence number received */
+    uint64_t window;  /**< Bit `i` set if `highest - i` was received */
+
+    uint32_t received;   /**< Frames accepted, excluding duplicates and late frames */
+    uint32_t lost;       /**< Frames skipped over and not (yet) recovered by reordering */
+    uint32_t gaps;       /**< Number of times one or more frames went missing */
+    uint32_t reordered;  /**< Frames that arrived after a newer one */
+    uint32_t duplicates; /**< Frames received more than once */
+    uint32_t late;       /**< Frames older than the duplicate window */
+    uint32_t resyncs;    /**< Sequence restarts, including the first frame */
+
+    /**
+     * Subtracted from every transit time. Zero when both clocks are synchronized,
+     * otherwise the latency histogram includes the (constant) clock offset.
+     */
+    int32_t clock_offset_us;
+
+    bool has_transit;
+    uint32_t last_transit_us; /**< Receive minus send time of the previous frame */
+    uint32_t jitter_us;       /**< Smoothed interarrival jitter (RFC 3550) */
+
+    rp_link_histogram_t latency; /**< One-way latency */
+    rp_link_histogram_t jitter;  /**< Transit time difference between consecutive frames */
+} rp_link_stats_t;
+
+void rp_link_header_write(const rp_link_header_t *header, uint8_t *buffer);
+void rp_link_header_read(rp_link_header_t *header, const uint8_t *buffer);
+
+void rp_link_sender_init(rp_link_sender_t *sender, uint16_t first_sequence);
+rp_link_header_t rp_link_sender_next(rp_link_sender_t *sender, uint32_t now_us);
+
+void rp_link_stats_init(rp_link_stats_t *stats);
+rp_link_event_t rp_link_stats_update(rp_link_stats_t *stats, const rp_link_header_t *header,
+                                     uint32_t now_us);
+
+void rp_link_histogram_add(rp_link_histogram_t *histogram, uint32_t value_us);
+uint32_t rp_link_histogram_percentile(const rp_link_histogram_t *histogram, double percentile);
+
+#endif // RP_LINK_H
@@ -0,0 +1,96 @@
+#ifndef RP_QUANT_H
+#define RP_QUANT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb.h"
+
+#define RP_QUANT_MAX_FIELDS (32)
+#define RP_QUANT_MAX_BITMAP_SIZE (RP_QUANT_MAX_FIELDS / 8)
+#define RP_QUANT_MAX_BLOCK_SIZE (RP_QUANT_MAX_BITMAP_SIZE + RP_QUANT_MAX_FIELDS * sizeof(float))
+
+// Largest message struct a spec may describe, the codec quantizes a copy of it
+#define RP_QUANT_MAX_MESSAGE_SIZE (256)
+
+// `present_offset`/`which_offset` value for fields that are always present
+#define RP_QUANT_ALWAYS (SIZE_MAX)
+
+typedef enum rp_quant_kind {
+    RP_QUANT_HALF,   /**< IEEE 754 binary16, 16 bits, about 3 significant digits */
+    RP_QUANT_SCALED, /**< `min + code * resolution`, `bits` wide, saturating */
+} rp_quant_kind_t;
+
+typedef enum rp_quant_status {
+    RP_QUANT_OK,
+    RP_QUANT_NULL_POINTER,
+    RP_QUANT_INVALID_SPEC,
+    RP_QUANT_OVERFLOW,
+    RP_QUANT_TRUNCATED,
+} rp_quant_status_t;
+
+/**
+ * A `float` member carried at reduced precision.
+ */
+typedef struct rp_quant_field {
+    size_t offset; /**< Offset of the `float` in the message struct */
+    rp_quant_kind_t kind;
+    float min;        /**< `RP_QUANT_SCALED`: value of code 0 */
+    float resolution; /**< `RP_QUANT_SCALED`: value of one code step */
+    uint8_t bits;     /**< `RP_QUANT_SCALED`: code width, 1 to 32 */
+
+    /**
+     * Offset of the `has_` flag of the enclosing submessage, or `RP_QUANT_ALWAYS`. The
+     * field is only carried while the flag is set.
+     */
+    size_t present_offset;
+
+    /**
+     * Offset of the `which_` member of the enclosing oneof, or `RP_QUANT_ALWAYS`. The
+     * field is only carried while it equals `which_tag`.
+     */
+    size_t which_offset;
+    pb_size_t which_tag;
+} rp_quant_field_t;
+
+/**
+ * Reduced-precision fields of one message type.
+ */
+typedef struct rp_quant_spec {
+    const pb_msgdesc_t *message; /**< Message type the spec applies to */
+    size_t message_size;         /**< `sizeof` the message struct */
+    const rp_quant_field_t *fields;
+    size_t field_count;
+} rp_quant_spec_t;
+
+/**
+ * Values read from a block by `rp_quant_unpack`, bit `i` of `present` set for
+ * `values[i]`.
+ */
+typedef struct rp_quant_values {
+    uint32_t present;
+    float values[RP_QUANT_MAX_FIELDS];
+} rp_quant_values_t;
+
+typedef struct rp_quant_result {
+    rp_quant_status_t status;
+    size_t size; /**< Bytes of block written or consumed */
+} rp_quant_result_t;
+
+uint16_t rp_quant_half_from_float(float value);
+float rp_quant_half_to_float(uint16_t half);
+
+uint32_t rp_quant_scale(const rp_quant_field_t *field, float value);
+float rp_quant_unscale(const rp_quant_field_t *field, uint32_t code);
+
+bool rp_quant_spec_valid(const rp_quant_spec_t *spec);
+size_t rp_quant_max_block_size(const rp_quant_spec_t *spec);
+
+rp_quant_result_t rp_quant_pack(const rp_quant_spec_t *spec, void *message, uint8_t *block,
+                                size_t capacity);
+rp_quant_result_t rp_quant_unpack(const rp_quant_spec_t *spec, const uint8_t *block, size_t size,
+                                  rp_quant_values_t *values);
+void rp_quant_apply(const rp_quant_spec_t *spec, const rp_quant_values_t *values, void *message);
+
+#endif // RP_QUANT_H
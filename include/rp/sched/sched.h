@@ -0,0 +1,72 @@
+#ifndef RP_SCHED_H
+#define RP_SCHED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define RP_SCHED_MAX_STREAMS (8)
+#define RP_SCHED_NONE (SIZE_MAX) /**< `rp_sched_next` result when nothing is due */
+
+typedef enum rp_sched_status {
+    RP_SCHED_OK,
+    RP_SCHED_NULL_POINTER,
+    RP_SCHED_INVALID_ARGUMENT,
+} rp_sched_status_t;
+
+/**
+ * How much of the configured rates the link budget allows, see `rp_sched_t.level`.
+ */
+typedef enum rp_sched_level {
+    RP_SCHED_CONGESTED,    /**< Below the minimum rates, every stream is scaled down */
+    RP_SCHED_BELOW_TARGET, /**< Between the minimum and target rates */
+    RP_SCHED_ABOVE_TARGET, /**< Between the target and maximum rates */
+    RP_SCHED_MAXIMUM,      /**< Every stream at its maximum rate, bandwidth left over */
+} rp_sched_level_t;
+
+/**
+ * Rates of one periodic message, in millihertz. Streams are listed in priority order,
+ * the first one wins when several are due at the same time.
+ */
+typedef struct rp_sched_stream_config {
+    uint32_t min_mhz;    /**< Kept while the budget allows, 0 to let the stream stop */
+    uint32_t target_mhz; /**< Nominal rate, e.g. 10000 for 10 Hz */
+    uint32_t max_mhz;    /**< Used when bandwidth is left over */
+} rp_sched_stream_config_t;
+
+typedef struct rp_sched_stream {
+    rp_sched_stream_config_t config;
+    size_t size;          /**< Encoded size of the last frame, 0 until known */
+    uint32_t rate_mhz;    /**< Rate allocated from the budget */
+    uint64_t due_us;      /**< Scheduler time the next frame is due */
+    uint32_t sent;        /**< Frames reported by `rp_sched_sent` */
+    uint64_t sent_bytes;  /**< Bytes reported by `rp_sched_sent` */
+} rp_sched_stream_t;
+
+typedef struct rp_sched {
+    rp_sched_stream_t streams[RP_SCHED_MAX_STREAMS];
+    size_t stream_count;
+
+    uint32_t budget_bytes_per_s; /**< Sustained link throughput */
+    uint32_t burst_bytes;        /**< Depth of the token bucket */
+    uint64_t tokens;             /**< Token bucket fill in milli-bytes */
+
+    uint64_t now_us;     /**< Scheduler time, extended from the 32-bit millisecond clock */
+    uint32_t last_ms;    /**< Clock value of the previous call */
+    bool started;        /**< Whether `last_ms` is valid */
+    bool stale;          /**< Rates must be reallocated before the next decision */
+
+    rp_sched_level_t level;
+} rp_sched_t;
+
+rp_sched_status_t rp_sched_init(rp_sched_t *sched, const rp_sched_stream_config_t *configs,
+                                size_t stream_count, uint32_t budget_bytes_per_s,
+                                uint32_t burst_bytes);
+rp_sched_status_t rp_sched_set_budget(rp_sched_t *sched, uint32_t budget_bytes_per_s);
+rp_sched_status_t rp_sched_set_size(rp_sched_t *sched, size_t stream, size_t size);
+
+size_t rp_sched_next(rp_sched_t *sched, uint32_t now_ms);
+rp_sched_status_t rp_sched_sent(rp_sched_t *sched, size_t stream, size_t size, uint32_t now_ms);
+void rp_sched_consume(rp_sched_t *sched, size_t size, uint32_t now_ms);
+
+#endif // RP_SCHED_H
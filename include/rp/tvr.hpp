@@ -0,0 +1,22 @@
+#ifndef RP_TVR_HPP
+#define RP_TVR_HPP
+
+/*
+ * `rp::codec` traits for the TVR vehicle messages. Link against `rp_tvr`.
+ */
+
+#include "rp/codec.hpp"
+#include "tvr/command.pb.h"
+#include "tvr/downlink.pb.h"
+
+RP_MESSAGE_TRAITS(tvr_Downlink);
+RP_MESSAGE_TRAITS(tvr_FlightCommand);
+
+namespace rp::tvr {
+
+using downlink_codec = codec<tvr_Downlink>;
+using command_codec = codec<tvr_FlightCommand>;
+
+} // namespace rp::tvr
+
+#endif // RP_TVR_HPP
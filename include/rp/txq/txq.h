@@ -0,0 +1,89 @@
+#ifndef RP_TXQ_H
+#define RP_TXQ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Same as `RP_PACKET_MAX_SIZE`, without pulling nanopb into users of the queue
+#ifndef RP_TXQ_FRAME_CAPACITY
+#define RP_TXQ_FRAME_CAPACITY (256)
+#endif
+
+#define RP_TXQ_NO_SLOT (UINT16_MAX)
+
+/**
+ * Priority classes, highest priority first.
+ */
+typedef enum rp_txq_class {
+    RP_TXQ_CLASS_ABORT,     /**< Safety-critical frames, e.g. `CMD_ABORT` and its acknowledgement */
+    RP_TXQ_CLASS_COMMAND,   /**< Commands and command acknowledgements */
+    RP_TXQ_CLASS_STATUS,    /**< `SystemStatus` */
+    RP_TXQ_CLASS_TELEMETRY, /**< `TelemetryState` */
+    RP_TXQ_CLASS_COUNT,
+} rp_txq_class_t;
+
+typedef enum rp_txq_status {
+    RP_TXQ_OK,
+    RP_TXQ_NULL_POINTER,
+    RP_TXQ_INVALID_ARGUMENT,
+    RP_TXQ_FULL,
+} rp_txq_status_t;
+
+typedef struct rp_txq_class_config {
+    uint32_t rate_bytes_per_s; /**< Sustained rate limit, 0 for unlimited */
+    uint32_t burst_bytes;      /**< Depth of the token bucket when rate limited */
+    uint16_t max_queued;       /**< Maximum frames queued in this class, 0 for no limit */
+    bool drop_oldest;          /**< Evict the oldest queued frame instead of rejecting new ones */
+    bool preemptive;           /**< May cut off a lower class frame that is mid-transmission */
+} rp_txq_class_config_t;
+
+typedef struct rp_txq_slot {
+    uint8_t frame[RP_TXQ_FRAME_CAPACITY]; /**< Encoded frame, including the delimiter */
+    size_t size;                          /**< Number of bytes in the frame */
+    uint32_t enqueued_ms;                 /**< Time the frame was committed */
+    uint16_t next;                        /**< Next slot in the same list */
+    uint8_t class_id;                     /**< Priority class of the frame */
+} rp_txq_slot_t;
+
+typedef struct rp_txq_class_state {
+    rp_txq_class_config_t config;
+    uint16_t head;           /**< Oldest queued slot */
+    uint16_t tail;           /**< Newest queued slot */
+    uint16_t count;          /**< Number of queued frames */
+    uint64_t tokens;         /**< Token bucket fill in milli-bytes */
+    uint32_t last_refill_ms; /**< Time of the last token bucket refill */
+} rp_txq_class_state_t;
+
+typedef struct rp_txq {
+    rp_txq_slot_t *slots;
+    uint16_t slot_count;
+    uint16_t free_head; /**< First unused slot */
+    rp_txq_class_state_t classes[RP_TXQ_CLASS_COUNT];
+
+    uint16_t active;      /**< Slot being streamed by `rp_txq_read`, or `RP_TXQ_NO_SLOT` */
+    size_t active_offset; /**< Bytes of the active slot already streamed */
+
+    uint32_t dropped;     /**< Frames evicted by `drop_oldest` */
+    uint32_t preemptions; /**< Frames cut off mid-transmission */
+} rp_txq_t;
+
+rp_txq_status_t rp_txq_init(rp_txq_t *queue, rp_txq_slot_t *slots, size_t slot_count,
+                            const rp_txq_class_config_t *configs);
+
+rp_txq_slot_t *rp_txq_reserve(rp_txq_t *queue, rp_txq_class_t class_id);
+rp_txq_status_t rp_txq_commit(rp_txq_t *queue, rp_txq_slot_t *slot, size_t size,
+                              uint32_t now_ms);
+void rp_txq_cancel(rp_txq_t *queue, rp_txq_slot_t *slot);
+
+rp_txq_status_t rp_txq_push(rp_txq_t *queue, rp_txq_class_t class_id, const uint8_t *frame,
+                            size_t size, uint32_t now_ms);
+
+rp_txq_slot_t *rp_txq_pop(rp_txq_t *queue, uint32_t now_ms);
+void rp_txq_release(rp_txq_t *queue, rp_txq_slot_t *slot);
+
+size_t rp_txq_read(rp_txq_t *queue, uint32_t now_ms, uint8_t *output, size_t output_capacity);
+
+size_t rp_txq_pending(const rp_txq_t *queue, rp_txq_class_t class_id);
+
+#endif // RP_TXQ_H
@@ -0,0 +1,15 @@
+#ifndef TVR_DOWNLINK_INCREMENTAL_H
+#define TVR_DOWNLINK_INCREMENTAL_H
+
+#include "rp/incremental.h"
+#include "tvr/downlink.pb.h"
+
+/**
+ * Scalars of `TelemetryState` downlinks that the incremental encoder may patch in the
+ * previous frame: the timestamp, every vector and quaternion component, the flight state
+ * and the control outputs. Pass to `rp_incremental_init` on the sender; the receiver
+ * decodes the frames as usual.
+ */
+extern const rp_incremental_spec_t tvr_Downlink_incremental;
+
+#endif // TVR_DOWNLINK_INCREMENTAL_H
@@ -0,0 +1,14 @@
+#ifndef TVR_DOWNLINK_QUANT_H
+#define TVR_DOWNLINK_QUANT_H
+
+#include "rp/quant/quant.h"
+#include "tvr/downlink.pb.h"
+
+/**
+ * Reduced-precision encoding of `TelemetryState` downlinks: attitude components and gimbal
+ * angles scaled to 16 and 14 bits, body rates and thrust as half floats. Pass as
+ * `rp_codec_options_t.quant` on both ends of the link.
+ */
+extern const rp_quant_spec_t tvr_Downlink_quant;
+
+#endif // TVR_DOWNLINK_QUANT_H
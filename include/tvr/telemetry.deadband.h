@@ -0,0 +1,15 @@
+#ifndef TVR_TELEMETRY_DEADBAND_H
+#define TVR_TELEMETRY_DEADBAND_H
+
+#include "rp/deadband/deadband.h"
+#include "tvr/telemetry.pb.h"
+
+/**
+ * Dead-band prediction of `TelemetryState`: position extrapolated with the velocity,
+ * attitude integrated with the body rate, everything else held, and a frame at least
+ * every second. Pass to `rp_deadband_init` on both ends of the link, with a
+ * `tvr_TelemetryState` as the reference.
+ */
+extern const rp_deadband_spec_t tvr_TelemetryState_deadband;
+
+#endif // TVR_TELEMETRY_DEADBAND_H
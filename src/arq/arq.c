@@ -0,0 +1,459 @@
+#include "rp/arq/arq.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static const rp_arq_config_t default_config = {
+    .initial_rto_ms = 500,
+    .min_rto_ms = 50,
+    .max_rto_ms = 4000,
+    .max_transmissions = 8,
+};
+
+static uint32_t oldest_in_flight(const rp_arq_sender_t *sender, bool *found);
+static bool is_acknowledged(const rp_arq_ack_t *ack, uint32_t command_id);
+static void update_rto(rp_arq_sender_t *sender, uint32_t rtt_ms);
+static uint32_t backoff(const rp_arq_sender_t *sender, uint8_t transmissions);
+
+/**
+ * Initializes the sending (ground) side of the command ARQ.
+ *
+ * IDs are allocated sequentially from `first_id`, skipping 0 which marks an
+ * unacknowledged command. After a restart the sender should continue from a
+ * different ID than the previous session, or the receiver should be reset as well.
+ *
+ * @param sender Sender to initialize
+ * @param config Timeouts and retry limit, or NULL for defaults
+ * @param first_id ID of the first command
+ * @return rp_arq_status_t
+ */
+rp_arq_status_t rp_arq_sender_init(rp_arq_sender_t *sender, const rp_arq_config_t *config,
+                                   uint32_t first_id)
+{
+    if (sender == NULL) {
+        return RP_ARQ_NULL_POINTER;
+    }
+
+    if (config == NULL) {
+        config = &default_config;
+    }
+
+    if (config->max_transmissions == 0 || config->min_rto_ms == 0 ||
+        config->min_rto_ms > config->max_rto_ms) {
+        return RP_ARQ_INVALID_ARGUMENT;
+    }
+
+    memset(sender, 0, sizeof(*sender));
+
+    sender->config = *config;
+    sender->next_id = (first_id != 0) ? first_id : 1;
+    sender->rto_ms = config->initial_rto_ms;
+
+    return RP_ARQ_OK;
+}
+
+/**
+ * Reserves a window entry to encode a command into.
+ *
+ * The caller copies `entry->command_id` into `tvr_FlightCommand.command_id`, encodes the
+ * command into `entry->frame` and commits it. Only one entry can be reserved at a time.
+ *
+ * @param sender Sender state
+ * @return rp_arq_entry_t* The reserved entry, or NULL when the window is full
+ */
+rp_arq_entry_t *rp_arq_sender_reserve(rp_arq_sender_t *sender)
+{
+    if (sender == NULL) {
+        return NULL;
+    }
+
+    bool found;
+    uint32_t oldest = oldest_in_flight(sender, &found);
+
+    // Every command in flight must stay within reach of an acknowledgement's history
+    if (found && sender->next_id - oldest >= RP_ARQ_HISTORY_SIZE) {
+        return NULL;
+    }
+
+    rp_arq_entry_t *free_entry = NULL;
+
+    for (size_t i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        rp_arq_entry_t *entry = &sender->entries[i];
+
+        if (entry->reserved) {
+            return NULL;
+        }
+
+        if (!entry->in_use && free_entry == NULL) {
+            free_entry = entry;
+        }
+    }
+
+    if (free_entry == NULL) {
+        return NULL;
+    }
+
+    free_entry->reserved = true;
+    free_entry->command_id = sender->next_id;
+    free_entry->size = 0;
+
+    return free_entry;
+}
+
+/**
+ * Submits a reserved entry once its frame has been written. It is returned by the next
+ * call to `rp_arq_sender_poll`.
+ *
+ * @param sender Sender state
+ * @param entry Entry returned by `rp_arq_sender_reserve`
+ * @param size Number of bytes written to `entry->frame`
+ * @param now_ms Current time
+ * @return rp_arq_status_t
+ */
+rp_arq_status_t rp_arq_sender_commit(rp_arq_sender_t *sender, rp_arq_entry_t *entry, size_t size,
+                                     uint32_t now_ms)
+{
+    if (sender == NULL || entry == NULL) {
+        return RP_ARQ_NULL_POINTER;
+    }
+
+    if (!entry->reserved) {
+        return RP_ARQ_INVALID_ARGUMENT;
+    }
+
+    if (size == 0 || size > sizeof(entry->frame)) {
+        rp_arq_sender_cancel(sender, entry);
+        return RP_ARQ_INVALID_ARGUMENT;
+    }
+
+    entry->reserved = false;
+    entry->in_use = true;
+    entry->size = size;
+    entry->submitted_ms = now_ms;
+    entry->sent_ms = now_ms;
+    entry->deadline_ms = now_ms;
+    entry->transmissions = 0;
+
+    sender->next_id++;
+
+    if (sender->next_id == 0) {
+        sender->next_id = 1;
+    }
+
+    return RP_ARQ_OK;
+}
+
+/**
+ * Releases a reserved entry without sending it.
+ *
+ * @param sender Sender state
+ * @param entry Entry returned by `rp_arq_sender_reserve`
+ */
+void rp_arq_sender_cancel(rp_arq_sender_t *sender, rp_arq_entry_t *entry)
+{
+    if (sender == NULL || entry == NULL) {
+        return;
+    }
+
+    entry->reserved = false;
+}
+
+/**
+ * Returns the next frame due for transmission, if any.
+ *
+ * New commands are due immediately. A command that has not been acknowledged within
+ * its timeout is due again, with the timeout doubled on every attempt (up to
+ * `max_rto_ms`), until `max_transmissions` is reached and it is given up. Call this
+ * repeatedly until it returns NULL.
+ *
+ * @param sender Sender state
+ * @param now_ms Current time
+ * @return const rp_arq_entry_t* Entry whose frame should be sent now, or NULL
+ */
+const rp_arq_entry_t *rp_arq_sender_poll(rp_arq_sender_t *sender, uint32_t now_ms)
+{
+    if (sender == NULL) {
+        return NULL;
+    }
+
+    rp_arq_entry_t *due = NULL;
+
+    for (size_t i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        rp_arq_entry_t *entry = &sender->entries[i];
+
+        if (!entry->in_use || (int32_t)(now_ms - entry->deadline_ms) < 0) {
+            continue;
+        }
+
+        if (entry->transmissions >= sender->config.max_transmissions) {
+            entry->in_use = false;
+            sender->expired++;
+            continue;
+        }
+
+        // Oldest command first
+        if (due == NULL || (int32_t)(entry->command_id - due->command_id) < 0) {
+            due = entry;
+        }
+    }
+
+    if (due == NULL) {
+        return NULL;
+    }
+
+    if (due->transmissions > 0) {
+        sender->retransmissions++;
+    }
+
+    due->transmissions++;
+    due->sent_ms = now_ms;
+    due->deadline_ms = now_ms + backoff(sender, due->transmissions);
+
+    sender->transmissions++;
+
+    return due;
+}
+
+/**
+ * Processes an acknowledgement received from the vehicle.
+ *
+ * The round trip time is only sampled from commands that were sent once (Karn's
+ * algorithm), and feeds the smoothed estimate of RFC 6298.
+ *
+ * @param sender Sender state
+ * @param ack Acknowledgement copied from `tvr_Downlink.ack`
+ * @param now_ms Current time
+ * @param confirmations Output for the confirmed commands, or NULL
+ * @param capacity Number of entries in `confirmations`
+ * @return size_t Number of commands confirmed by this acknowledgement
+ */
+size_t rp_arq_sender_on_ack(rp_arq_sender_t *sender, const rp_arq_ack_t *ack, uint32_t now_ms,
+                            rp_arq_confirmation_t *confirmations, size_t capacity)
+{
+    if (sender == NULL || ack == NULL || ack->latest_id == 0) {
+        return 0;
+    }
+
+    size_t confirmed = 0;
+
+    for (size_t i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        rp_arq_entry_t *entry = &sender->entries[i];
+
+        if (!entry->in_use || entry->transmissions == 0 ||
+            !is_acknowledged(ack, entry->command_id)) {
+            continue;
+        }
+
+        if (entry->transmissions == 1) {
+            update_rto(sender, now_ms - entry->sent_ms);
+        }
+
+        if (confirmations != NULL && confirmed < capacity) {
+            confirmations[confirmed].command_id = entry->command_id;
+            confirmations[confirmed].elapsed_ms = now_ms - entry->submitted_ms;
+            confirmations[confirmed].transmissions = entry->transmissions;
+        }
+
+        entry->in_use = false;
+        sender->confirmed++;
+        confirmed++;
+    }
+
+    return confirmed;
+}
+
+/**
+ * Counts the commands awaiting confirmation.
+ *
+ * @param sender Sender state
+ * @return size_t Number of committed, unconfirmed commands
+ */
+size_t rp_arq_sender_in_flight(const rp_arq_sender_t *sender)
+{
+    size_t count = 0;
+
+    if (sender == NULL) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        count += sender->entries[i].in_use ? 1 : 0;
+    }
+
+    return count;
+}
+
+/**
+ * Initializes the receiving (vehicle) side of the command ARQ.
+ *
+ * @param receiver Receiver to initialize
+ */
+void rp_arq_receiver_init(rp_arq_receiver_t *receiver)
+{
+    if (receiver == NULL) {
+        return;
+    }
+
+    memset(receiver, 0, sizeof(*receiver));
+}
+
+/**
+ * Records a received command and decides whether to execute it.
+ *
+ * Both new commands and duplicates schedule an acknowledgement, since a duplicate
+ * means the previous acknowledgement was lost.
+ *
+ * @param receiver Receiver state
+ * @param command_id `tvr_FlightCommand.command_id` of the decoded command
+ * @return rp_arq_verdict_t
+ */
+rp_arq_verdict_t rp_arq_receiver_accept(rp_arq_receiver_t *receiver, uint32_t command_id)
+{
+    if (receiver == NULL) {
+        return RP_ARQ_STALE;
+    }
+
+    if (command_id == 0) {
+        return RP_ARQ_UNTRACKED;
+    }
+
+    rp_arq_ack_t *ack = &receiver->ack;
+    int32_t delta = (int32_t)(command_id - ack->latest_id);
+    rp_arq_verdict_t verdict;
+
+    if (ack->latest_id == 0 || delta < -RP_ARQ_MAX_DROPOUT) {
+        ack->latest_id = command_id;
+        ack->history = 0;
+        verdict = RP_ARQ_EXECUTE;
+    } else if (delta > 0) {
+        // Bit i tracks `latest_id - 1 - i`, the old latest ID lands on bit delta - 1
+        uint32_t shift = (uint32_t)delta;
+
+        ack->history = (shift >= RP_ARQ_HISTORY_SIZE) ? 0 : (ack->history << shift);
+
+        if (shift <= RP_ARQ_HISTORY_SIZE) {
+            ack->history |= (uint32_t)1 << (shift - 1);
+        }
+
+        ack->latest_id = command_id;
+        verdict = RP_ARQ_EXECUTE;
+    } else if (delta == 0) {
+        verdict = RP_ARQ_DUPLICATE;
+    } else if (-delta > RP_ARQ_HISTORY_SIZE) {
+        return RP_ARQ_STALE;
+    } else {
+        uint32_t bit = (uint32_t)1 << (-delta - 1);
+
+        verdict = (ack->history & bit) ? RP_ARQ_DUPLICATE : RP_ARQ_EXECUTE;
+        ack->history |= bit;
+    }
+
+    if (verdict == RP_ARQ_EXECUTE) {
+        receiver->executed++;
+    } else {
+        receiver->duplicates++;
+    }
+
+    receiver->repeats = RP_ARQ_ACK_REPEATS;
+
+    return verdict;
+}
+
+/**
+ * Provides the acknowledgement to piggyback on the next `tvr_Downlink` frame.
+ *
+ * Each change is repeated on `RP_ARQ_ACK_REPEATS` frames so a single lost downlink
+ * frame does not force a retransmission.
+ *
+ * @param receiver Receiver state
+ * @param ack Filled in when an acknowledgement is pending
+ * @return bool Whether to set `tvr_Downlink.has_ack`
+ */
+bool rp_arq_receiver_take_ack(rp_arq_receiver_t *receiver, rp_arq_ack_t *ack)
+{
+    if (receiver == NULL || ack == NULL || receiver->repeats == 0) {
+        return false;
+    }
+
+    *ack = receiver->ack;
+    receiver->repeats--;
+
+    return true;
+}
+
+static uint32_t oldest_in_flight(const rp_arq_sender_t *sender, bool *found)
+{
+    uint32_t oldest = 0;
+
+    *found = false;
+
+    for (size_t i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        const rp_arq_entry_t *entry = &sender->entries[i];
+
+        if (!entry->in_use) {
+            continue;
+        }
+
+        if (!*found || (int32_t)(entry->command_id - oldest) < 0) {
+            oldest = entry->command_id;
+            *found = true;
+        }
+    }
+
+    return oldest;
+}
+
+static bool is_acknowledged(const rp_arq_ack_t *ack, uint32_t command_id)
+{
+    uint32_t distance = ack->latest_id - command_id;
+
+    if (distance == 0) {
+        return true;
+    }
+
+    if (distance > RP_ARQ_HISTORY_SIZE) {
+        return false;
+    }
+
+    return (ack->history >> (distance - 1)) & 1U;
+}
+
+static void update_rto(rp_arq_sender_t *sender, uint32_t rtt_ms)
+{
+    if (!sender->has_rtt) {
+        sender->srtt_ms = rtt_ms;
+        sender->rttvar_ms = rtt_ms / 2;
+        sender->has_rtt = true;
+    } else {
+        uint32_t error =
+            (sender->srtt_ms > rtt_ms) ? sender->srtt_ms - rtt_ms : rtt_ms - sender->srtt_ms;
+
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+        sender->rttvar_ms = (3 * sender->rttvar_ms + error) / 4;
+        sender->srtt_ms = (7 * sender->srtt_ms + rtt_ms) / 8;
+    }
+
+    uint32_t variation = 4 * sender->rttvar_ms;
+    uint32_t rto = sender->srtt_ms + ((variation > 0) ? variation : 1);
+
+    if (rto < sender->config.min_rto_ms) {
+        rto = sender->config.min_rto_ms;
+    }
+
+    if (rto > sender->config.max_rto_ms) {
+        rto = sender->config.max_rto_ms;
+    }
+
+    sender->rto_ms = rto;
+}
+
+static uint32_t backoff(const rp_arq_sender_t *sender, uint8_t transmissions)
+{
+    uint32_t timeout = sender->rto_ms;
+
+    for (uint8_t i = 1; i < transmissions && timeout < sender->config.max_rto_ms; i++) {
+        timeout *= 2;
+    }
+
+    return (timeout < sender->config.max_rto_ms) ? timeout : sender->config.max_rto_ms;
+}
@@ -1,7 +1,10 @@
 #include "rp/cobs/cobs.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
+static bool encoder_flush(cobs_encoder_t *encoder, size_t size);
+
 /**
  * Encodes the input data using COBS.
  *
@@ -182,3 +185,112 @@ size_t cobs_get_max_encoded_size(size_t data_size)
 
     return data_size + overhead;
 }
+
+/**
+ * Initializes an incremental encoder. The encoder is reusable: after
+ * `cobs_encoder_finish` it starts the next frame.
+ *
+ * @param encoder Encoder to initialize
+ * @param sink Callback receiving the encoded bytes
+ * @param context Passed to every call of the sink
+ */
+void cobs_encoder_init(cobs_encoder_t *encoder, cobs_sink_t sink, void *context)
+{
+    if (encoder == NULL) {
+        return;
+    }
+
+    encoder->sink = sink;
+    encoder->context = context;
+    encoder->code = 0x01;
+    encoder->written = 0;
+    encoder->status = (sink == NULL) ? COBS_NULL_POINTER : COBS_OK;
+}
+
+/**
+ * Encodes more bytes of the current frame. Every block that is completed, by a zero
+ * byte or by reaching 254 data bytes, is passed to the sink before returning; the
+ * output is identical to `cobs_encode` of all the bytes written.
+ *
+ * @param encoder Encoder state
+ * @param data Buffer of bytes to encode
+ * @param data_size Number of bytes to encode
+ * @return cobs_status_t `COBS_SINK_FAILED` once the sink has refused a block
+ */
+cobs_status_t cobs_encoder_write(cobs_encoder_t *encoder, const uint8_t *data, size_t data_size)
+{
+    if (encoder == NULL || (data == NULL && data_size > 0)) {
+        return COBS_NULL_POINTER;
+    }
+
+    if (encoder->status != COBS_OK) {
+        return encoder->status;
+    }
+
+    for (size_t i = 0; i < data_size; i++) {
+        uint8_t byte = data[i];
+
+        if (byte == COBS_DELIMITER_BYTE || encoder->code == 0xFF) {
+            if (!encoder_flush(encoder, encoder->code)) {
+                return encoder->status;
+            }
+
+            if (byte == COBS_DELIMITER_BYTE) {
+                continue;
+            }
+        }
+
+        encoder->block[encoder->code++] = byte;
+    }
+
+    return COBS_OK;
+}
+
+/**
+ * Ends the current frame: passes the last block and the delimiter to the sink, in a
+ * single call, and prepares the encoder for the next frame.
+ *
+ * @param encoder Encoder state
+ * @return cobs_result_t Size of the whole encoded frame on success
+ */
+cobs_result_t cobs_encoder_finish(cobs_encoder_t *encoder)
+{
+    cobs_result_t result = {
+        .written = 0,
+        .status = COBS_OK,
+    };
+
+    if (encoder == NULL) {
+        result.status = COBS_NULL_POINTER;
+        return result;
+    }
+
+    if (encoder->status == COBS_OK) {
+        encoder->block[encoder->code] = COBS_DELIMITER_BYTE;
+        encoder_flush(encoder, (size_t)encoder->code + 1);
+    }
+
+    result.status = encoder->status;
+    result.written = (result.status == COBS_OK) ? encoder->written : 0;
+
+    encoder->code = 0x01;
+    encoder->written = 0;
+    encoder->status = (encoder->sink == NULL) ? COBS_NULL_POINTER : COBS_OK;
+
+    return result;
+}
+
+static bool encoder_flush(cobs_encoder_t *encoder, size_t size)
+{
+    encoder->block[0] = encoder->code;
+
+    if (!encoder->sink(encoder->context, encoder->block, size)) {
+        encoder->status = COBS_SINK_FAILED;
+        return false;
+    }
+
+    encoder->written += size;
+    encoder->code = 0x01;
+
+    return true;
+}
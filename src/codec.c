@@ -1,18 +1,93 @@
 #include "rp/codec.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "pb.h"
 #include "pb_decode.h"
 #include "pb_encode.h"
 
 #include "rp/cobs/cobs.h"
 #include "rp/crc/crc.h"
+#include "rp/fec/rs.h"
+#include "rp/link/link.h"
+#include "rp/quant/quant.h"
 
+/**
+ * Frame being streamed by `rp_packet_encode_to_sink`.
+ */
+typedef struct stream_state {
+    cobs_encoder_t cobs;
+    rp_codec_checksum_t checksum_kind;
+    uint32_t checksum;
+    const rs_codec_t *fec;
+    uint8_t parity[RS_MAX_PARITY];
+} stream_state_t;
+
+// Link header and quantization block, the only parts of a frame not produced by protobuf
+#define PREFIX_MAX_SIZE (RP_LINK_HEADER_SIZE + RP_QUANT_MAX_BLOCK_SIZE)
+
+// Keeps the quantized copy of the message out of the stack frame of the default path
+#if defined(__GNUC__) || defined(__clang__)
+#define CODEC_NOINLINE __attribute__((noinline))
+#else
+#define CODEC_NOINLINE
+#endif
+
+static const rp_codec_options_t default_options = {
+    .checksum = RP_CODEC_CHECKSUM_DEFAULT,
+    .link_header = NULL,
+    .fec = NULL,
+    .repair = NULL,
+    .repair_max_bits = 0,
+    .quant = NULL,
+};
+
+static rp_codec_status_t verified_status(bool matches, size_t codeword_size, size_t min_size);
 static rp_codec_status_t cobs_to_codec_status(cobs_status_t status);
+static rp_codec_checksum_t resolve_checksum(rp_codec_checksum_t checksum);
+static size_t get_checksum_size(rp_codec_checksum_t checksum);
+static bool quant_applies(const rp_codec_options_t *options, const pb_msgdesc_t *fields);
+static rp_codec_status_t quantize(const rp_quant_spec_t *spec, const void *message,
+                                  void *quantized, uint8_t *block, size_t block_capacity,
+                                  size_t *block_size);
+static rp_packet_encode_result_t encode_frame(uint8_t *packet, size_t packet_capacity,
+                                              const pb_msgdesc_t *fields, const void *message,
+                                              const rp_codec_options_t *options,
+                                              uint8_t *pb_encoded, size_t header_size);
+static CODEC_NOINLINE rp_packet_encode_result_t
+encode_quantized_frame(uint8_t *packet, size_t packet_capacity, const pb_msgdesc_t *fields,
+                       const void *message, const rp_codec_options_t *options,
+                       uint8_t *pb_encoded, size_t header_size);
+static rp_packet_encode_result_t encode_frame_to_sink(cobs_sink_t sink, void *context,
+                                                      const pb_msgdesc_t *fields,
+                                                      const void *message,
+                                                      const rp_codec_options_t *options,
+                                                      const uint8_t *prefix, size_t prefix_size);
+static CODEC_NOINLINE rp_packet_encode_result_t
+encode_quantized_frame_to_sink(cobs_sink_t sink, void *context, const pb_msgdesc_t *fields,
+                               const void *message, const rp_codec_options_t *options,
+                               uint8_t *prefix, size_t prefix_size);
+static bool stream_write(stream_state_t *state, const uint8_t *data, size_t size);
+static bool stream_write_callback(pb_ostream_t *stream, const pb_byte_t *buf, size_t count);
 
 rp_packet_encode_result_t rp_packet_encode(uint8_t *packet, size_t packet_capacity,
                                            const pb_msgdesc_t *fields, const void *message)
+{
+    return rp_packet_encode_with_options(packet, packet_capacity, fields, message, NULL);
+}
+
+rp_packet_decode_result_t rp_packet_decode(const uint8_t *packet, size_t packet_size,
+                                           const pb_msgdesc_t *fields, void *message)
+{
+    return rp_packet_decode_with_options(packet, packet_size, fields, message, NULL);
+}
+
+rp_packet_encode_result_t rp_packet_encode_with_options(uint8_t *packet, size_t packet_capacity,
+                                                        const pb_msgdesc_t *fields,
+                                                        const void *message,
+                                                        const rp_codec_options_t *options)
 {
     rp_packet_encode_result_t result = {
         .written = 0,
@@ -24,46 +99,86 @@ rp_packet_encode_result_t rp_packet_encode(uint8_t *packet, size_t packet_capaci
         return result;
     }
 
+    if (options == NULL) {
+        options = &default_options;
+    }
+
     uint8_t pb_encoded[RP_PACKET_MAX_SIZE];
-    pb_ostream_t pb_encode_stream = pb_ostream_from_buffer(pb_encoded, sizeof(pb_encoded));
+    size_t header_size = 0;
 
-    if (!pb_encode(&pb_encode_stream, fields, message)) {
-        result.status = RP_CODEC_ERROR;
-        return result;
+    if (options->link_header != NULL) {
+        rp_link_header_write(options->link_header, pb_encoded);
+        header_size = RP_LINK_HEADER_SIZE;
     }
 
-    size_t pb_encoded_size = pb_encode_stream.bytes_written;
+    if (quant_applies(options, fields)) {
+        return encode_quantized_frame(packet, packet_capacity, fields, message, options,
+                                      pb_encoded, header_size);
+    }
 
-    // Do we have enough room for the checksum?
-    if (pb_encoded_size >= (sizeof(pb_encoded) - 2)) {
-        result.status = RP_CODEC_OVERFLOW;
+    return encode_frame(packet, packet_capacity, fields, message, options, pb_encoded, header_size);
+}
+
+/**
+ * Encodes a message like `rp_packet_encode_with_options`, without a packet buffer: the
+ * frame is COBS encoded while protobuf produces it and each COBS block is handed to
+ * `sink` as soon as it is complete, so transmission can start before the message has
+ * been fully encoded. Checksum and parity are computed on the fly.
+ *
+ * The sink receives the same bytes `rp_packet_encode_with_options` would write, in
+ * blocks of at most `COBS_BLOCK_MAX_SIZE + 1` bytes, the last one ending with the
+ * delimiter. If the sink fails, the frame is abandoned without its delimiter and the
+ * caller should send one to resynchronize the receiver.
+ *
+ * @param sink Callback receiving the encoded frame
+ * @param context Passed to every call of the sink
+ * @param fields Message descriptor
+ * @param message Message to encode
+ * @param options Codec options, or NULL for the defaults
+ * @return rp_packet_encode_result_t Total bytes given to the sink on success
+ */
+rp_packet_encode_result_t rp_packet_encode_to_sink(cobs_sink_t sink, void *context,
+                                                   const pb_msgdesc_t *fields, const void *message,
+                                                   const rp_codec_options_t *options)
+{
+    rp_packet_encode_result_t result = {
+        .written = 0,
+        .status = RP_CODEC_ERROR,
+    };
+
+    if (sink == NULL || fields == NULL || message == NULL) {
+        result.status = RP_CODEC_NULL_POINTER;
         return result;
     }
 
-    uint16_t checksum = crc16_ccitt(pb_encoded, pb_encoded_size);
+    if (options == NULL) {
+        options = &default_options;
+    }
 
-    // Append checksum as LE
-    pb_encoded[pb_encoded_size++] = (checksum >> 0) & 0xFF;
-    pb_encoded[pb_encoded_size++] = (checksum >> 8) & 0xFF;
+    uint8_t prefix[PREFIX_MAX_SIZE];
+    size_t prefix_size = 0;
 
-    cobs_result_t cobs_result = cobs_encode(pb_encoded, pb_encoded_size, packet, packet_capacity);
-
-    if (cobs_result.status != COBS_OK) {
-        result.status = cobs_to_codec_status(cobs_result.status);
-        return result;
+    if (options->link_header != NULL) {
+        rp_link_header_write(options->link_header, prefix);
+        prefix_size = RP_LINK_HEADER_SIZE;
     }
 
-    result.written = cobs_result.written;
-    result.status = RP_CODEC_OK;
+    if (quant_applies(options, fields)) {
+        return encode_quantized_frame_to_sink(sink, context, fields, message, options, prefix,
+                                              prefix_size);
+    }
 
-    return result;
+    return encode_frame_to_sink(sink, context, fields, message, options, prefix, prefix_size);
 }
 
-rp_packet_decode_result_t rp_packet_decode(const uint8_t *packet, size_t packet_size,
-                                           const pb_msgdesc_t *fields, void *message)
+rp_packet_decode_result_t rp_packet_decode_with_options(const uint8_t *packet, size_t packet_size,
+                                                        const pb_msgdesc_t *fields, void *message,
+                                                        const rp_codec_options_t *options)
 {
     rp_packet_decode_result_t result = {
         .status = RP_CODEC_ERROR,
+        .corrected = 0,
+        .repaired_bits = 0,
     };
 
     if (packet == NULL || fields == NULL || message == NULL) {
@@ -71,6 +186,10 @@ rp_packet_decode_result_t rp_packet_decode(const uint8_t *packet, size_t packet_
         return result;
     }
 
+    if (options == NULL) {
+        options = &default_options;
+    }
+
     uint8_t cobs_decoded[RP_PACKET_MAX_SIZE];
 
     cobs_result_t cobs_result =
@@ -82,31 +201,218 @@ rp_packet_decode_result_t rp_packet_decode(const uint8_t *packet, size_t packet_
         return result;
     }
 
+    rp_codec_checksum_t checksum_kind = resolve_checksum(options->checksum);
+    size_t checksum_size = get_checksum_size(checksum_kind);
+
+    if (options->fec != NULL) {
+        size_t parity_size = options->fec->parity_size;
+
+        // Expect data to have a checksum and parity
+        if (cobs_decoded_size < checksum_size + parity_size) {
+            result.status = RP_CODEC_ERROR;
+            return result;
+        }
+
+        // An uncorrectable codeword is left as received and the checksum decides
+        rs_result_t rs_result = rs_decode(options->fec, cobs_decoded, cobs_decoded_size);
+
+        if (rs_result.status == RS_OK) {
+            result.corrected = rs_result.corrected;
+        }
+
+        cobs_decoded_size -= parity_size;
+    }
+
     // Expect data to have a checksum
-    if (cobs_decoded_size < 2) {
+    if (cobs_decoded_size < checksum_size) {
         result.status = RP_CODEC_ERROR;
         return result;
     }
 
-    uint16_t checksum = crc16_ccitt(cobs_decoded, cobs_decoded_size);
+    if (checksum_kind == RP_CODEC_CHECKSUM_CRC32C) {
+        if (crc32c(cobs_decoded, cobs_decoded_size) != CRC32C_RESIDUE) {
+            result.status = RP_CODEC_CHECKSUM_MISMATCH;
+            return result;
+        }
+    } else {
+        uint16_t residue = crc16_ccitt(cobs_decoded, cobs_decoded_size);
 
-    if (checksum != CRC16_CCITT_RESIDUE) {
-        result.status = RP_CODEC_CHECKSUM_MISMATCH;
-        return result;
+        if (residue != CRC16_CCITT_RESIDUE) {
+            if (options->repair == NULL) {
+                result.status = RP_CODEC_CHECKSUM_MISMATCH;
+                return result;
+            }
+
+            result.repaired_bits = crc16_repair(options->repair, cobs_decoded, cobs_decoded_size,
+                                                residue, options->repair_max_bits);
+
+            if (result.repaired_bits == 0) {
+                result.status = RP_CODEC_CHECKSUM_MISMATCH;
+                return result;
+            }
+        }
+    }
+
+    size_t header_size = 0;
+
+    if (options->link_header != NULL) {
+        if (cobs_decoded_size < checksum_size + RP_LINK_HEADER_SIZE) {
+            result.status = RP_CODEC_ERROR;
+            return result;
+        }
+
+        rp_link_header_read(options->link_header, cobs_decoded);
+        header_size = RP_LINK_HEADER_SIZE;
+    }
+
+    bool quantized = quant_applies(options, fields);
+    rp_quant_values_t quant_values;
+
+    if (quantized) {
+        rp_quant_result_t unpacked =
+            rp_quant_unpack(options->quant, &cobs_decoded[header_size],
+                            cobs_decoded_size - checksum_size - header_size, &quant_values);
+
+        if (unpacked.status != RP_QUANT_OK) {
+            result.status = (result.repaired_bits > 0) ? RP_CODEC_CHECKSUM_MISMATCH
+                                                       : RP_CODEC_ERROR;
+            return result;
+        }
+
+        header_size += unpacked.size;
     }
 
-    pb_istream_t pb_decode_stream = pb_istream_from_buffer(cobs_decoded, cobs_decoded_size - 2);
+    pb_istream_t pb_decode_stream = pb_istream_from_buffer(
+        &cobs_decoded[header_size], cobs_decoded_size - checksum_size - header_size);
 
     if (!pb_decode(&pb_decode_stream, fields, message)) {
-        result.status = RP_CODEC_ERROR;
+        // A repair that does not parse was most likely a miscorrection
+        result.status =
+            (result.repaired_bits > 0) ? RP_CODEC_CHECKSUM_MISMATCH : RP_CODEC_ERROR;
         return result;
     }
 
+    if (quantized) {
+        rp_quant_apply(options->quant, &quant_values, message);
+    }
+
     result.status = RP_CODEC_OK;
 
     return result;
 }
 
+/**
+ * Checks the checksums of many received frames without decoding their messages, for
+ * validating recorded downlink offline. The frames are COBS decoded (and corrected, with
+ * FEC) into `scratch` `RP_PACKET_VERIFY_BATCH` at a time, and CRC-16 frames of a block
+ * are checked together with `crc16_ccitt_batch`.
+ *
+ * Each frame gets the status `rp_packet_decode_with_options` would return before decoding
+ * the message. Failed frames are not repaired, so a frame reported as
+ * `RP_CODEC_CHECKSUM_MISMATCH` may still be accepted by a decode with `options->repair`.
+ *
+ * @param packets Received frames, as given to `rp_packet_decode`
+ * @param packet_sizes Size of each frame in bytes
+ * @param count Number of frames
+ * @param statuses Receives the status of each frame, `RP_CODEC_OK` if its checksum matches
+ * @param scratch Working memory, see `rp_packet_verify_scratch_t`
+ * @param options Codec options, or NULL for the defaults
+ * @return size_t Number of frames whose checksum matches
+ */
+size_t rp_packet_verify_batch(const uint8_t *const *packets, const size_t *packet_sizes,
+                              size_t count, rp_codec_status_t *statuses,
+                              rp_packet_verify_scratch_t *scratch,
+                              const rp_codec_options_t *options)
+{
+    if (packets == NULL || packet_sizes == NULL || statuses == NULL || scratch == NULL) {
+        return 0;
+    }
+
+    if (options == NULL) {
+        options = &default_options;
+    }
+
+    rp_codec_checksum_t checksum_kind = resolve_checksum(options->checksum);
+    size_t checksum_size = get_checksum_size(checksum_kind);
+    size_t parity_size = (options->fec != NULL) ? options->fec->parity_size : 0;
+    // Shortest codeword the decoder reads past its checksum
+    size_t min_size = checksum_size + ((options->link_header != NULL) ? RP_LINK_HEADER_SIZE : 0);
+    size_t verified = 0;
+
+    for (size_t start = 0; start < count; start += RP_PACKET_VERIFY_BATCH) {
+        size_t end =
+            (count - start < RP_PACKET_VERIFY_BATCH) ? count : start + RP_PACKET_VERIFY_BATCH;
+        size_t pending = 0;
+
+        for (size_t i = start; i < end; i++) {
+            uint8_t *codeword = scratch->decoded[i - start];
+
+            if (packets[i] == NULL) {
+                statuses[i] = RP_CODEC_NULL_POINTER;
+                continue;
+            }
+
+            cobs_result_t cobs_result =
+                cobs_decode(packets[i], packet_sizes[i], codeword, RP_PACKET_MAX_SIZE);
+
+            if (cobs_result.status != COBS_OK) {
+                statuses[i] = cobs_to_codec_status(cobs_result.status);
+                continue;
+            }
+
+            if (cobs_result.written < checksum_size + parity_size) {
+                statuses[i] = RP_CODEC_ERROR;
+                continue;
+            }
+
+            if (options->fec != NULL) {
+                rs_decode(options->fec, codeword, cobs_result.written);
+            }
+
+            size_t codeword_size = cobs_result.written - parity_size;
+
+            if (checksum_kind == RP_CODEC_CHECKSUM_CRC32C) {
+                statuses[i] = verified_status(crc32c(codeword, codeword_size) == CRC32C_RESIDUE,
+                                              codeword_size, min_size);
+                verified += (statuses[i] == RP_CODEC_OK);
+                continue;
+            }
+
+            scratch->codewords[pending] = codeword;
+            scratch->codeword_sizes[pending] = codeword_size;
+            scratch->indices[pending] = i;
+            pending++;
+        }
+
+        crc16_ccitt_batch(scratch->codewords, scratch->codeword_sizes, pending,
+                          scratch->residues);
+
+        for (size_t p = 0; p < pending; p++) {
+            rp_codec_status_t status =
+                verified_status(scratch->residues[p] == CRC16_CCITT_RESIDUE,
+                                scratch->codeword_sizes[p], min_size);
+
+            statuses[scratch->indices[p]] = status;
+            verified += (status == RP_CODEC_OK);
+        }
+    }
+
+    return verified;
+}
+
+/**
+ * Status of a frame that `rp_packet_decode_with_options` reaches the checksum of: a
+ * matching codeword too short for the link header is rejected after the check.
+ */
+static rp_codec_status_t verified_status(bool matches, size_t codeword_size, size_t min_size)
+{
+    if (!matches) {
+        return RP_CODEC_CHECKSUM_MISMATCH;
+    }
+
+    return (codeword_size < min_size) ? RP_CODEC_ERROR : RP_CODEC_OK;
+}
+
 static rp_codec_status_t cobs_to_codec_status(cobs_status_t status)
 {
     switch (status) {
@@ -120,3 +426,276 @@ static rp_codec_status_t cobs_to_codec_status(cobs_status_t status)
         return RP_CODEC_ERROR;
     }
 }
+
+static rp_codec_checksum_t resolve_checksum(rp_codec_checksum_t checksum)
+{
+    return (checksum == RP_CODEC_CHECKSUM_DEFAULT) ? RP_CODEC_DEFAULT_CHECKSUM : checksum;
+}
+
+static size_t get_checksum_size(rp_codec_checksum_t checksum)
+{
+    return (checksum == RP_CODEC_CHECKSUM_CRC32C) ? sizeof(uint32_t) : sizeof(uint16_t);
+}
+
+static bool quant_applies(const rp_codec_options_t *options, const pb_msgdesc_t *fields)
+{
+    return options->quant != NULL && options->quant->message == fields;
+}
+
+/**
+ * Encodes a message after the `header_size` bytes already in `pb_encoded`, a buffer of
+ * `RP_PACKET_MAX_SIZE` bytes, and frames it into `packet`.
+ */
+static rp_packet_encode_result_t encode_frame(uint8_t *packet, size_t packet_capacity,
+                                              const pb_msgdesc_t *fields, const void *message,
+                                              const rp_codec_options_t *options,
+                                              uint8_t *pb_encoded, size_t header_size)
+{
+    rp_packet_encode_result_t result = {
+        .written = 0,
+        .status = RP_CODEC_ERROR,
+    };
+
+    pb_ostream_t pb_encode_stream =
+        pb_ostream_from_buffer(&pb_encoded[header_size], RP_PACKET_MAX_SIZE - header_size);
+
+    if (!pb_encode(&pb_encode_stream, fields, message)) {
+        result.status = RP_CODEC_ERROR;
+        return result;
+    }
+
+    size_t pb_encoded_size = header_size + pb_encode_stream.bytes_written;
+    rp_codec_checksum_t checksum_kind = resolve_checksum(options->checksum);
+
+    // Do we have enough room for the checksum?
+    if (pb_encoded_size >= (RP_PACKET_MAX_SIZE - get_checksum_size(checksum_kind))) {
+        result.status = RP_CODEC_OVERFLOW;
+        return result;
+    }
+
+    // Append checksum as LE
+    if (checksum_kind == RP_CODEC_CHECKSUM_CRC32C) {
+        uint32_t checksum = crc32c(pb_encoded, pb_encoded_size);
+
+        pb_encoded[pb_encoded_size++] = (checksum >> 0) & 0xFF;
+        pb_encoded[pb_encoded_size++] = (checksum >> 8) & 0xFF;
+        pb_encoded[pb_encoded_size++] = (checksum >> 16) & 0xFF;
+        pb_encoded[pb_encoded_size++] = (checksum >> 24) & 0xFF;
+    } else {
+        uint16_t checksum = crc16_ccitt(pb_encoded, pb_encoded_size);
+
+        pb_encoded[pb_encoded_size++] = (checksum >> 0) & 0xFF;
+        pb_encoded[pb_encoded_size++] = (checksum >> 8) & 0xFF;
+    }
+
+    // Parity protects the payload and checksum, so the checksum still has the final say
+    if (options->fec != NULL) {
+        size_t parity_size = options->fec->parity_size;
+
+        if (pb_encoded_size + parity_size > RS_SYMBOL_COUNT ||
+            pb_encoded_size + parity_size > RP_PACKET_MAX_SIZE) {
+            result.status = RP_CODEC_OVERFLOW;
+            return result;
+        }
+
+        if (rs_encode(options->fec, pb_encoded, pb_encoded_size, &pb_encoded[pb_encoded_size]) !=
+            RS_OK) {
+            result.status = RP_CODEC_ERROR;
+            return result;
+        }
+
+        pb_encoded_size += parity_size;
+    }
+
+    cobs_result_t cobs_result = cobs_encode(pb_encoded, pb_encoded_size, packet, packet_capacity);
+
+    if (cobs_result.status != COBS_OK) {
+        result.status = cobs_to_codec_status(cobs_result.status);
+        return result;
+    }
+
+    result.written = cobs_result.written;
+    result.status = RP_CODEC_OK;
+
+    return result;
+}
+
+/**
+ * Streams a frame of the `prefix_size` bytes of `prefix` followed by the encoded message.
+ */
+static rp_packet_encode_result_t encode_frame_to_sink(cobs_sink_t sink, void *context,
+                                                      const pb_msgdesc_t *fields,
+                                                      const void *message,
+                                                      const rp_codec_options_t *options,
+                                                      const uint8_t *prefix, size_t prefix_size)
+{
+    rp_packet_encode_result_t result = {
+        .written = 0,
+        .status = RP_CODEC_ERROR,
+    };
+
+    // Sized up front, so that nothing reaches the sink for a frame that cannot be sent
+    size_t pb_size;
+
+    if (!pb_get_encoded_size(&pb_size, fields, message)) {
+        result.status = RP_CODEC_ERROR;
+        return result;
+    }
+
+    rp_codec_checksum_t checksum_kind = resolve_checksum(options->checksum);
+    size_t payload_size = prefix_size + pb_size + get_checksum_size(checksum_kind);
+
+    // Same limits as the buffered encoder
+    if (payload_size >= RP_PACKET_MAX_SIZE ||
+        (options->fec != NULL && payload_size + options->fec->parity_size > RS_SYMBOL_COUNT)) {
+        result.status = RP_CODEC_OVERFLOW;
+        return result;
+    }
+
+    stream_state_t state = {
+        .checksum_kind = checksum_kind,
+        .checksum = 0,
+        .fec = options->fec,
+    };
+
+    cobs_encoder_init(&state.cobs, sink, context);
+    memset(state.parity, 0, sizeof(state.parity));
+
+    pb_ostream_t pb_stream = {
+        .callback = stream_write_callback,
+        .state = &state,
+        .max_size = pb_size,
+        .bytes_written = 0,
+    };
+
+    // Fails only when the sink does, the message was already sized
+    if (!stream_write(&state, prefix, prefix_size) || !pb_encode(&pb_stream, fields, message)) {
+        result.status = RP_CODEC_ERROR;
+        return result;
+    }
+
+    // Append checksum as LE
+    uint8_t checksum[sizeof(uint32_t)] = {
+        (state.checksum >> 0) & 0xFF,
+        (state.checksum >> 8) & 0xFF,
+        (state.checksum >> 16) & 0xFF,
+        (state.checksum >> 24) & 0xFF,
+    };
+
+    if (!stream_write(&state, checksum, get_checksum_size(checksum_kind))) {
+        result.status = RP_CODEC_ERROR;
+        return result;
+    }
+
+    if (state.fec != NULL &&
+        cobs_encoder_write(&state.cobs, state.parity, state.fec->parity_size) != COBS_OK) {
+        result.status = RP_CODEC_ERROR;
+        return result;
+    }
+
+    cobs_result_t cobs_result = cobs_encoder_finish(&state.cobs);
+
+    if (cobs_result.status != COBS_OK) {
+        result.status = cobs_to_codec_status(cobs_result.status);
+        return result;
+    }
+
+    result.written = cobs_result.written;
+    result.status = RP_CODEC_OK;
+
+    return result;
+}
+
+/**
+ * Packs the quantized fields of a message into a block and leaves a copy of the message
+ * in `quantized`, with those fields zeroed for protobuf.
+ */
+static rp_codec_status_t quantize(const rp_quant_spec_t *spec, const void *message,
+                                  void *quantized, uint8_t *block, size_t block_capacity,
+                                  size_t *block_size)
+{
+    if (!rp_quant_spec_valid(spec)) {
+        return RP_CODEC_ERROR;
+    }
+
+    memcpy(quantized, message, spec->message_size);
+
+    rp_quant_result_t packed = rp_quant_pack(spec, quantized, block, block_capacity);
+
+    if (packed.status != RP_QUANT_OK) {
+        return (packed.status == RP_QUANT_OVERFLOW) ? RP_CODEC_OVERFLOW : RP_CODEC_ERROR;
+    }
+
+    *block_size = packed.size;
+
+    return RP_CODEC_OK;
+}
+
+/**
+ * `encode_frame` with the quantization block after the header, out of line so that only
+ * quantized messages pay for the copy on the stack.
+ */
+static CODEC_NOINLINE rp_packet_encode_result_t
+encode_quantized_frame(uint8_t *packet, size_t packet_capacity, const pb_msgdesc_t *fields,
+                       const void *message, const rp_codec_options_t *options,
+                       uint8_t *pb_encoded, size_t header_size)
+{
+    _Alignas(max_align_t) uint8_t quantized[RP_QUANT_MAX_MESSAGE_SIZE];
+    size_t block_size = 0;
+    rp_codec_status_t status =
+        quantize(options->quant, message, quantized, &pb_encoded[header_size],
+                 RP_PACKET_MAX_SIZE - header_size, &block_size);
+
+    if (status != RP_CODEC_OK) {
+        return (rp_packet_encode_result_t){.written = 0, .status = status};
+    }
+
+    return encode_frame(packet, packet_capacity, fields, quantized, options, pb_encoded,
+                        header_size + block_size);
+}
+
+/**
+ * `encode_frame_to_sink` with the quantization block after the link header, out of line
+ * like `encode_quantized_frame`.
+ */
+static CODEC_NOINLINE rp_packet_encode_result_t
+encode_quantized_frame_to_sink(cobs_sink_t sink, void *context, const pb_msgdesc_t *fields,
+                               const void *message, const rp_codec_options_t *options,
+                               uint8_t *prefix, size_t prefix_size)
+{
+    _Alignas(max_align_t) uint8_t quantized[RP_QUANT_MAX_MESSAGE_SIZE];
+    size_t block_size = 0;
+    rp_codec_status_t status =
+        quantize(options->quant, message, quantized, &prefix[prefix_size],
+                 PREFIX_MAX_SIZE - prefix_size, &block_size);
+
+    if (status != RP_CODEC_OK) {
+        return (rp_packet_encode_result_t){.written = 0, .status = status};
+    }
+
+    return encode_frame_to_sink(sink, context, fields, quantized, options, prefix,
+                                prefix_size + block_size);
+}
+
+/**
+ * Adds payload bytes to the running checksum and parity and passes them to COBS.
+ */
+static bool stream_write(stream_state_t *state, const uint8_t *data, size_t size)
+{
+    if (state->checksum_kind == RP_CODEC_CHECKSUM_CRC32C) {
+        state->checksum = crc32c_update(state->checksum, data, size);
+    } else {
+        state->checksum = crc16_ccitt_update((uint16_t)state->checksum, data, size);
+    }
+
+    if (state->fec != NULL) {
+        rs_encode_update(state->fec, data, size, state->parity);
+    }
+
+    return cobs_encoder_write(&state->cobs, data, size) == COBS_OK;
+}
+
+static bool stream_write_callback(pb_ostream_t *stream, const pb_byte_t *buf, size_t count)
+{
+    return stream_write(stream->state, buf, count);
+}
@@ -2,6 +2,11 @@
 
 #include <stdint.h>
 
+// CRC-16/KERMIT polynomial, bit reversed
+#define CRC16_CCITT_POLYNOMIAL (0x8408)
+
+static uint16_t multiply_modulo(uint16_t a, uint16_t b);
+
 /**
  * Computes the checksum of the data using the CRC-16/KERMIT (CCITT) algorithm.
  *
@@ -14,7 +19,20 @@
  */
 uint16_t crc16_ccitt(const uint8_t *data, size_t length)
 {
-    uint16_t crc = CRC16_CCITT_INITIAL_VALUE;
+    return crc16_ccitt_update(CRC16_CCITT_INITIAL_VALUE, data, length);
+}
+
+/**
+ * Continues a CRC-16/KERMIT over more data, so that
+ * `crc16_ccitt_update(crc16_ccitt(a), b)` is the checksum of `a` followed by `b`.
+ *
+ * @param crc Checksum of the data so far, `CRC16_CCITT_INITIAL_VALUE` for none
+ * @param data Buffer of bytes to add to the checksum
+ * @param length Number of bytes in the data buffer
+ * @return uint16_t
+ */
+uint16_t crc16_ccitt_update(uint16_t crc, const uint8_t *data, size_t length)
+{
     uint8_t e;
     uint8_t f;
 
@@ -31,3 +49,65 @@ uint16_t crc16_ccitt(const uint8_t *data, size_t length)
 
     return crc;
 }
+
+/**
+ * Computes the operator that advances a CRC-16/KERMIT over `length` zero bytes, see
+ * `crc16_ccitt_shift`. Applying it costs the same for any length.
+ *
+ * @param length Number of zero bytes
+ * @return uint16_t x^(8 * length) modulo the polynomial
+ */
+uint16_t crc16_ccitt_shift_operator(size_t length)
+{
+    uint16_t result = 0x8000; // x^0
+    uint16_t square = 0x4000; // x^1, squared for every bit of the length
+
+    for (size_t bits = length * 8; bits > 0; bits >>= 1) {
+        if (bits & 1) {
+            result = multiply_modulo(square, result);
+        }
+
+        square = multiply_modulo(square, square);
+    }
+
+    return result;
+}
+
+/**
+ * Advances a CRC-16/KERMIT over zero bytes, so that
+ * `crc16_ccitt_shift(crc, crc16_ccitt_shift_operator(n))` equals
+ * `crc16_ccitt_update(crc, zeros, n)`.
+ *
+ * As the CRC has no initial value or final XOR it is linear, and this updates a checksum
+ * after bytes in the middle of the data have changed: with `delta` the XOR of the old
+ * and new bytes and `after` the number of bytes following them, the new checksum is
+ * `crc ^ crc16_ccitt_shift(crc16_ccitt(delta, n), crc16_ccitt_shift_operator(after))`.
+ *
+ * @param crc Checksum to advance
+ * @param shift_operator Result of `crc16_ccitt_shift_operator`
+ * @return uint16_t
+ */
+uint16_t crc16_ccitt_shift(uint16_t crc, uint16_t shift_operator)
+{
+    return multiply_modulo(shift_operator, crc);
+}
+
+/**
+ * Multiplies two polynomials modulo the CRC polynomial, in the bit reversed
+ * representation used by the CRC (bit 15 is x^0).
+ *
+ * @param a Multiplicand
+ * @param b Multiplier
+ * @return uint16_t
+ */
+static uint16_t multiply_modulo(uint16_t a, uint16_t b)
+{
+    uint16_t product = 0;
+
+    for (int bit = 15; bit >= 0; bit--) {
+        product ^= b & (uint16_t)-((a >> bit) & 1);
+        b = (b >> 1) ^ (CRC16_CCITT_POLYNOMIAL & (uint16_t)-(b & 1));
+    }
+
+    return product;
+}
@@ -0,0 +1,208 @@
+#include "rp/crc/crc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Multi-buffer CRC-16/KERMIT: the checksums of up to `CRC16_BATCH_LANES` independent
+ * buffers advance together, one buffer per lane of a vector, so the serial dependency of
+ * each byte on the previous one is spread across lanes instead of stalling the CPU.
+ *
+ * A lane that reaches the end of its buffer is refilled with the next one right away, so
+ * buffers of mixed lengths keep the lanes busy. As the CRC starts from 0, zero bytes in
+ * front of a buffer leave its checksum unchanged: each buffer is padded at the front to a
+ * whole number of blocks, so every lane ends its buffer on a block boundary and all lanes
+ * always advance a full block. Bytes are moved into a lane-major block
+ * (`block[byte][lane]`) before each step, as the buffers are not next to each other.
+ *
+ * With GCC 9+ and Clang the lanes are a `vector_size` vector, which the compiler maps to
+ * whatever SIMD registers the target has (two SSE2 or one AVX2 register on x86, NEON on
+ * ARM). Other compilers, or `RP_CRC16_BATCH_SCALAR`, use a plain loop over the lanes.
+ */
+
+#if (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9)) &&                           \
+    !defined(RP_CRC16_BATCH_SCALAR)
+#define CRC16_BATCH_HAVE_VECTOR (1)
+typedef uint8_t bytes_t __attribute__((vector_size(CRC16_BATCH_LANES)));
+typedef uint16_t lanes_t __attribute__((vector_size(sizeof(uint16_t) * CRC16_BATCH_LANES)));
+#endif
+
+// Bytes of every lane processed per step, between refills
+#define BLOCK_SIZE (8)
+
+// Below this many busy lanes the remaining buffers are finished one at a time
+#define MIN_BUSY_LANES (4)
+
+/**
+ * Buffer being checksummed in one lane.
+ */
+typedef struct lane {
+    const uint8_t *data; /**< Next byte after the padding */
+    size_t remaining;    /**< Bytes left including the padding, a multiple of `BLOCK_SIZE` */
+    size_t padding;      /**< Zero bytes to feed before `data` */
+    size_t index;        /**< Buffer number, `count` for an idle lane */
+} lane_t;
+
+// Fed to idle lanes, whose checksums are discarded
+static const uint8_t idle_data[BLOCK_SIZE];
+
+static bool refill(lane_t *lane, uint16_t *crc, const uint8_t *const *data,
+                   const size_t *lengths, size_t count, size_t *next, uint16_t *crcs);
+static void advance(uint16_t crcs[CRC16_BATCH_LANES],
+                    const uint8_t block[BLOCK_SIZE][CRC16_BATCH_LANES]);
+
+/**
+ * Computes the CRC-16/KERMIT of many buffers at once. Gives the same checksums as calling
+ * `crc16_ccitt` on each buffer, faster when there are at least a few times
+ * `CRC16_BATCH_LANES` of them.
+ *
+ * @param data Buffers to compute the checksums for, may be NULL where the length is 0
+ * @param lengths Number of bytes in each buffer
+ * @param count Number of buffers
+ * @param crcs Receives the checksum of each buffer
+ */
+void crc16_ccitt_batch(const uint8_t *const *data, const size_t *lengths, size_t count,
+                       uint16_t *crcs)
+{
+    if (data == NULL || lengths == NULL || crcs == NULL) {
+        return;
+    }
+
+    lane_t lanes[CRC16_BATCH_LANES];
+    uint16_t lane_crcs[CRC16_BATCH_LANES];
+    uint8_t block[BLOCK_SIZE][CRC16_BATCH_LANES];
+    size_t next = 0;
+    size_t busy = 0;
+
+    for (size_t l = 0; l < CRC16_BATCH_LANES; l++) {
+        busy += refill(&lanes[l], &lane_crcs[l], data, lengths, count, &next, crcs);
+    }
+
+    while (busy >= MIN_BUSY_LANES) {
+        for (size_t l = 0; l < CRC16_BATCH_LANES; l++) {
+            const uint8_t *bytes = lanes[l].data;
+            size_t k = 0;
+
+            if (lanes[l].padding == 0) {
+                for (; k < BLOCK_SIZE; k++) {
+                    block[k][l] = bytes[k];
+                }
+            } else {
+                for (; k < lanes[l].padding; k++) {
+                    block[k][l] = 0;
+                }
+
+                for (; k < BLOCK_SIZE; k++) {
+                    block[k][l] = bytes[k - lanes[l].padding];
+                }
+            }
+
+            lanes[l].data = &bytes[BLOCK_SIZE - lanes[l].padding];
+            lanes[l].padding = 0;
+        }
+
+        advance(lane_crcs, (const uint8_t(*)[CRC16_BATCH_LANES])block);
+
+        for (size_t l = 0; l < CRC16_BATCH_LANES; l++) {
+            if (lanes[l].index == count) {
+                lanes[l].data = idle_data;
+                continue;
+            }
+
+            lanes[l].remaining -= BLOCK_SIZE;
+
+            if (lanes[l].remaining == 0) {
+                crcs[lanes[l].index] = lane_crcs[l];
+                busy -= !refill(&lanes[l], &lane_crcs[l], data, lengths, count, &next, crcs);
+            }
+        }
+    }
+
+    // Too few buffers left to fill the lanes
+    for (size_t l = 0; l < CRC16_BATCH_LANES; l++) {
+        if (lanes[l].index != count) {
+            crcs[lanes[l].index] = crc16_ccitt_update(lane_crcs[l], lanes[l].data,
+                                                      lanes[l].remaining - lanes[l].padding);
+        }
+    }
+}
+
+/**
+ * Moves the next non-empty buffer into a lane, or makes the lane idle when there is none
+ * left. Empty buffers on the way are finished here.
+ *
+ * @param lane Lane to refill
+ * @param crc Checksum of the lane, reset for the new buffer
+ * @param data Buffers
+ * @param lengths Number of bytes in each buffer
+ * @param count Number of buffers
+ * @param next Next buffer not yet given to a lane, advanced
+ * @param crcs Checksum of each buffer
+ * @return bool True if the lane has a buffer
+ */
+static bool refill(lane_t *lane, uint16_t *crc, const uint8_t *const *data,
+                   const size_t *lengths, size_t count, size_t *next, uint16_t *crcs)
+{
+    *crc = CRC16_CCITT_INITIAL_VALUE;
+
+    for (; *next < count; (*next)++) {
+        if (lengths[*next] == 0 || data[*next] == NULL) {
+            crcs[*next] = CRC16_CCITT_INITIAL_VALUE;
+            continue;
+        }
+
+        lane->padding = (BLOCK_SIZE - lengths[*next] % BLOCK_SIZE) % BLOCK_SIZE;
+        lane->data = data[*next];
+        lane->remaining = lengths[*next] + lane->padding;
+        lane->index = (*next)++;
+
+        return true;
+    }
+
+    lane->data = idle_data;
+    lane->remaining = 0;
+    lane->padding = 0;
+    lane->index = count;
+
+    return false;
+}
+
+/**
+ * Advances the checksum of every lane over a block, with the same byte step as
+ * `crc16_ccitt_update` applied to all lanes at once.
+ *
+ * @param crcs Checksum of each lane
+ * @param block Next bytes of each lane, `block[byte][lane]`
+ */
+static void advance(uint16_t crcs[CRC16_BATCH_LANES],
+                    const uint8_t block[BLOCK_SIZE][CRC16_BATCH_LANES])
+{
+#if defined(CRC16_BATCH_HAVE_VECTOR)
+    lanes_t crc;
+    bytes_t bytes;
+
+    memcpy(&crc, crcs, sizeof(crc));
+
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        memcpy(&bytes, block[k], sizeof(bytes));
+
+        lanes_t byte = __builtin_convertvector(bytes, lanes_t);
+        lanes_t e = (crc ^ byte) & 0xFF;
+        lanes_t f = (e ^ (e << 4)) & 0xFF;
+
+        crc = (crc >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4);
+    }
+
+    memcpy(crcs, &crc, sizeof(crc));
+#else
+    for (size_t k = 0; k < BLOCK_SIZE; k++) {
+        for (size_t l = 0; l < CRC16_BATCH_LANES; l++) {
+            uint16_t e = (crcs[l] ^ block[k][l]) & 0xFF;
+            uint16_t f = (e ^ (e << 4)) & 0xFF;
+
+            crcs[l] = (uint16_t)((crcs[l] >> 8) ^ (f << 8) ^ (f << 3) ^ (f >> 4));
+        }
+    }
+#endif
+}
@@ -0,0 +1,183 @@
+#include "rp/crc/crc.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/*
+ * CRC-16/KERMIT has no initial value or final XOR, so it is linear: the residue of a
+ * received codeword is the CRC of the error pattern alone. Leading zero bytes do not
+ * change a CRC with a zero initial value either, so the residue of a single bit error
+ * only depends on how far the bit is from the end of the codeword. One table indexed
+ * by that distance therefore serves every frame length up to `CRC16_REPAIR_MAX_LENGTH`.
+ *
+ * The generator is (x + 1) times a primitive polynomial of degree 15, so single bit
+ * syndromes are distinct for codewords of up to 32767 bits and all have odd weight,
+ * while double bit syndromes have even weight.
+ */
+
+static bool has_odd_weight(uint16_t syndrome);
+static int compare_entries(const void *a, const void *b);
+static bool find_distance(const crc16_repair_table_t *table, uint16_t syndrome, size_t bits,
+                          size_t *distance);
+static void flip_bit(uint8_t *codeword, size_t length, size_t distance);
+
+/**
+ * Precomputes the single bit error syndromes used by `crc16_repair`.
+ *
+ * @param table Table to fill (about 12 KiB)
+ */
+void crc16_repair_table_init(crc16_repair_table_t *table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    static const uint8_t zero = 0x00;
+
+    for (unsigned bit = 0; bit < 8; bit++) {
+        uint8_t error = (uint8_t)(1U << bit);
+        uint16_t syndrome = crc16_ccitt_update(CRC16_CCITT_INITIAL_VALUE, &error, 1);
+
+        for (size_t trailing = 0; trailing < CRC16_REPAIR_MAX_LENGTH; trailing++) {
+            size_t distance = trailing * 8 + bit;
+
+            table->syndromes[distance] = syndrome;
+            table->by_syndrome[distance].syndrome = syndrome;
+            table->by_syndrome[distance].distance = (uint16_t)distance;
+
+            syndrome = crc16_ccitt_update(syndrome, &zero, 1);
+        }
+    }
+
+    qsort(table->by_syndrome, CRC16_REPAIR_MAX_BITS, sizeof(table->by_syndrome[0]),
+          compare_entries);
+}
+
+/**
+ * Attempts to repair a codeword that failed its checksum.
+ *
+ * A single bit error is located directly from the residue. With `max_bits` of 2, a pair
+ * of bit errors is also accepted, but only when exactly one pair explains the residue.
+ * Every repair spends detection capability: a heavier error that happens to share a
+ * syndrome with a correctable one is "repaired" into the wrong data, so callers should
+ * validate the result further (e.g. by decoding it) and keep `max_bits` low for long
+ * codewords.
+ *
+ * @param table Table prepared with `crc16_repair_table_init`
+ * @param codeword Data followed by its checksum, repaired in place
+ * @param length Number of bytes in the codeword
+ * @param residue `crc16_ccitt` of the codeword as received
+ * @param max_bits Largest number of bit errors to repair, 1 or 2
+ * @return size_t Number of bits flipped, 0 if the codeword could not be repaired
+ */
+size_t crc16_repair(const crc16_repair_table_t *table, uint8_t *codeword, size_t length,
+                    uint16_t residue, size_t max_bits)
+{
+    if (table == NULL || codeword == NULL || residue == CRC16_CCITT_RESIDUE || max_bits == 0) {
+        return 0;
+    }
+
+    if (length == 0 || length > CRC16_REPAIR_MAX_LENGTH) {
+        return 0;
+    }
+
+    size_t bits = length * 8;
+    size_t distance;
+
+    // Odd weight residue: only an odd number of bit errors can produce it, so not a pair
+    if (has_odd_weight(residue)) {
+        if (!find_distance(table, residue, bits, &distance)) {
+            return 0;
+        }
+
+        flip_bit(codeword, length, distance);
+        return 1;
+    }
+
+    if (max_bits < 2) {
+        return 0;
+    }
+
+    size_t first = 0;
+    size_t second = 0;
+    size_t candidates = 0;
+
+    for (size_t d = 0; d < bits; d++) {
+        uint16_t remainder = residue ^ table->syndromes[d];
+
+        if (find_distance(table, remainder, bits, &distance) && distance > d) {
+            first = d;
+            second = distance;
+            candidates++;
+
+            if (candidates > 1) {
+                return 0;
+            }
+        }
+    }
+
+    if (candidates != 1) {
+        return 0;
+    }
+
+    flip_bit(codeword, length, first);
+    flip_bit(codeword, length, second);
+
+    return 2;
+}
+
+static bool has_odd_weight(uint16_t syndrome)
+{
+    syndrome ^= syndrome >> 8;
+    syndrome ^= syndrome >> 4;
+    syndrome ^= syndrome >> 2;
+    syndrome ^= syndrome >> 1;
+
+    return (syndrome & 1) != 0;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+    const crc16_syndrome_entry_t *lhs = a;
+    const crc16_syndrome_entry_t *rhs = b;
+
+    return (lhs->syndrome > rhs->syndrome) - (lhs->syndrome < rhs->syndrome);
+}
+
+static bool find_distance(const crc16_repair_table_t *table, uint16_t syndrome, size_t bits,
+                          size_t *distance)
+{
+    size_t low = 0;
+    size_t high = CRC16_REPAIR_MAX_BITS;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+
+        if (table->by_syndrome[mid].syndrome < syndrome) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (low == CRC16_REPAIR_MAX_BITS || table->by_syndrome[low].syndrome != syndrome) {
+        return false;
+    }
+
+    // Syndromes are unique within the table, but the bit must lie inside this codeword
+    if (table->by_syndrome[low].distance >= bits) {
+        return false;
+    }
+
+    *distance = table->by_syndrome[low].distance;
+
+    return true;
+}
+
+static void flip_bit(uint8_t *codeword, size_t length, size_t distance)
+{
+    size_t byte = length - 1 - distance / 8;
+
+    codeword[byte] ^= (uint8_t)(1U << (distance % 8));
+}
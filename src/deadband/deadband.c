@@ -0,0 +1,402 @@
+#include "rp/deadband/deadband.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define VECTOR_MAX_COUNT (4)
+#define QUATERNION_COUNT (4)
+#define ANGULAR_RATE_COUNT (3)
+
+static bool fits(size_t offset, size_t size, size_t message_size);
+static bool field_valid(const rp_deadband_field_t *field, size_t message_size);
+static uint32_t load_timestamp(const rp_deadband_spec_t *spec, const void *message);
+static bool load_present(const rp_deadband_field_t *field, const uint8_t *message);
+static void predict(const rp_deadband_field_t *field, const uint8_t *reference, float dt_s,
+                    float *predicted);
+static bool within_tolerance(const rp_deadband_field_t *field, const uint8_t *reference,
+                             const uint8_t *message, float dt_s);
+
+/**
+ * Checks that every field of a spec lies within the message struct.
+ *
+ * @param spec Spec to check
+ * @return bool
+ */
+bool rp_deadband_spec_valid(const rp_deadband_spec_t *spec)
+{
+    if (spec == NULL || spec->message_size == 0 || spec->max_interval_ms == 0 ||
+        spec->field_count > RP_DEADBAND_MAX_FIELDS ||
+        (spec->fields == NULL && spec->field_count > 0)) {
+        return false;
+    }
+
+    if (!fits(spec->timestamp_offset, sizeof(uint32_t), spec->message_size)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        if (!field_valid(&spec->fields[i], spec->message_size)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Initializes a dead-band filter, used on the sending end to suppress predictable
+ * messages and on the receiving end to rebuild them.
+ *
+ * @param deadband Filter to initialize
+ * @param spec Predicted members of the message type, must stay valid
+ * @param reference Storage for the last message, `spec->message_size` bytes
+ * @return rp_deadband_status_t
+ */
+rp_deadband_status_t rp_deadband_init(rp_deadband_t *deadband, const rp_deadband_spec_t *spec,
+                                      void *reference)
+{
+    if (deadband == NULL || spec == NULL || reference == NULL) {
+        return RP_DEADBAND_NULL_POINTER;
+    }
+
+    if (!rp_deadband_spec_valid(spec)) {
+        return RP_DEADBAND_INVALID_SPEC;
+    }
+
+    memset(deadband, 0, sizeof(*deadband));
+    deadband->spec = spec;
+    deadband->reference = reference;
+
+    return RP_DEADBAND_OK;
+}
+
+/**
+ * Forgets the last message so the next one is sent, e.g. after the link was lost.
+ *
+ * @param deadband Filter
+ */
+void rp_deadband_reset(rp_deadband_t *deadband)
+{
+    if (deadband != NULL) {
+        deadband->has_reference = false;
+    }
+}
+
+/**
+ * Decides whether a message must be sent.
+ *
+ * The predicted members are extrapolated from the last message sent to the timestamp of
+ * this one. The message is sent when any of them is further from its prediction than the
+ * field tolerance, when an exact member or a presence flag changed, or when
+ * `max_interval_ms` passed since the last message sent. A sent message becomes the new
+ * reference.
+ *
+ * @param deadband Filter
+ * @param message Message about to be sent
+ * @return bool True if the message must be sent, false if the receiver can predict it
+ */
+bool rp_deadband_filter(rp_deadband_t *deadband, const void *message)
+{
+    if (deadband == NULL || message == NULL) {
+        return true;
+    }
+
+    const rp_deadband_spec_t *spec = deadband->spec;
+    bool send = !deadband->has_reference;
+
+    if (!send) {
+        uint32_t elapsed_ms =
+            load_timestamp(spec, message) - load_timestamp(spec, deadband->reference);
+        float dt_s = (float)elapsed_ms * 0.001f;
+
+        send = elapsed_ms >= spec->max_interval_ms;
+
+        for (size_t i = 0; !send && i < spec->field_count; i++) {
+            send = !within_tolerance(&spec->fields[i], deadband->reference, message, dt_s);
+        }
+    }
+
+    if (!send) {
+        deadband->suppressed++;
+        return false;
+    }
+
+    rp_deadband_received(deadband, message);
+    deadband->sent++;
+
+    return true;
+}
+
+/**
+ * Takes a message received on the other end of the link as the new reference.
+ *
+ * @param deadband Filter
+ * @param message Decoded message
+ */
+void rp_deadband_received(rp_deadband_t *deadband, const void *message)
+{
+    if (deadband == NULL || message == NULL) {
+        return;
+    }
+
+    memcpy(deadband->reference, message, deadband->spec->message_size);
+    deadband->has_reference = true;
+}
+
+/**
+ * Rebuilds a suppressed message: the last message received with the predicted members
+ * extrapolated to `timestamp_ms`. A receiver calls this at the nominal rate whenever no
+ * frame arrived, and gets the stream the sender saw to within the field tolerances.
+ *
+ * @param deadband Filter
+ * @param timestamp_ms Time to predict, written to the timestamp member
+ * @param message Output message
+ * @return rp_deadband_status_t
+ */
+rp_deadband_status_t rp_deadband_reconstruct(const rp_deadband_t *deadband,
+                                             uint32_t timestamp_ms, void *message)
+{
+    if (deadband == NULL || message == NULL) {
+        return RP_DEADBAND_NULL_POINTER;
+    }
+
+    if (!deadband->has_reference) {
+        return RP_DEADBAND_NO_REFERENCE;
+    }
+
+    const rp_deadband_spec_t *spec = deadband->spec;
+    uint8_t *bytes = (uint8_t *)message;
+    int32_t elapsed_ms = (int32_t)(timestamp_ms - load_timestamp(spec, deadband->reference));
+    float dt_s = (elapsed_ms > 0) ? (float)elapsed_ms * 0.001f : 0.0f;
+
+    memcpy(message, deadband->reference, spec->message_size);
+    memcpy(&bytes[spec->timestamp_offset], &timestamp_ms, sizeof(timestamp_ms));
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_deadband_field_t *field = &spec->fields[i];
+        float predicted[VECTOR_MAX_COUNT];
+
+        if (field->kind == RP_DEADBAND_EXACT || !load_present(field, bytes)) {
+            continue;
+        }
+
+        predict(field, deadband->reference, dt_s, predicted);
+        memcpy(&bytes[field->offset], predicted,
+               ((field->kind == RP_DEADBAND_ROTATION) ? QUATERNION_COUNT : field->count) *
+                   sizeof(float));
+    }
+
+    return RP_DEADBAND_OK;
+}
+
+/**
+ * @param offset Offset of a member
+ * @param size Size of the member
+ * @param message_size Size of the message struct
+ * @return bool Whether the member lies within the message
+ */
+static bool fits(size_t offset, size_t size, size_t message_size)
+{
+    return offset <= message_size && size <= message_size - offset;
+}
+
+/**
+ * @param field Field to check
+ * @param message_size Size of the message struct
+ * @return bool
+ */
+static bool field_valid(const rp_deadband_field_t *field, size_t message_size)
+{
+    if (!(field->tolerance >= 0.0f)) {
+        return false;
+    }
+
+    if (field->present_offset != RP_DEADBAND_NONE &&
+        !fits(field->present_offset, sizeof(bool), message_size)) {
+        return false;
+    }
+
+    size_t rate_count = 0;
+
+    switch (field->kind) {
+    case RP_DEADBAND_VECTOR:
+        if (field->count == 0 || field->count > VECTOR_MAX_COUNT ||
+            !fits(field->offset, field->count * sizeof(float), message_size)) {
+            return false;
+        }
+
+        rate_count = field->count;
+        break;
+
+    case RP_DEADBAND_ROTATION:
+        if (!fits(field->offset, QUATERNION_COUNT * sizeof(float), message_size)) {
+            return false;
+        }
+
+        rate_count = ANGULAR_RATE_COUNT;
+        break;
+
+    case RP_DEADBAND_EXACT:
+        return field->count > 0 && fits(field->offset, field->count, message_size);
+
+    default:
+        return false;
+    }
+
+    return field->rate_offset == RP_DEADBAND_NONE ||
+           fits(field->rate_offset, rate_count * sizeof(float), message_size);
+}
+
+/**
+ * @param spec Spec of the message type
+ * @param message Message
+ * @return uint32_t Millisecond timestamp of the message
+ */
+static uint32_t load_timestamp(const rp_deadband_spec_t *spec, const void *message)
+{
+    uint32_t timestamp;
+
+    memcpy(&timestamp, (const uint8_t *)message + spec->timestamp_offset, sizeof(timestamp));
+
+    return timestamp;
+}
+
+/**
+ * @param field Field
+ * @param message Message
+ * @return bool Whether the field's submessage is present
+ */
+static bool load_present(const rp_deadband_field_t *field, const uint8_t *message)
+{
+    bool present = true;
+
+    if (field->present_offset != RP_DEADBAND_NONE) {
+        memcpy(&present, &message[field->present_offset], sizeof(present));
+    }
+
+    return present;
+}
+
+/**
+ * Extrapolates a vector or rotation field of the reference by `dt_s` seconds.
+ *
+ * A rotation is advanced by the body-frame angular rate held constant over the interval,
+ * `q * exp(w * dt / 2)`.
+ *
+ * @param field Vector or rotation field
+ * @param reference Last message sent
+ * @param dt_s Time since the reference
+ * @param predicted Output values, `count` floats or a quaternion
+ */
+static void predict(const rp_deadband_field_t *field, const uint8_t *reference, float dt_s,
+                    float *predicted)
+{
+    size_t count = (field->kind == RP_DEADBAND_ROTATION) ? QUATERNION_COUNT : field->count;
+    float rate[VECTOR_MAX_COUNT] = {0};
+
+    memcpy(predicted, &reference[field->offset], count * sizeof(float));
+
+    if (field->rate_offset == RP_DEADBAND_NONE) {
+        return;
+    }
+
+    if (field->kind == RP_DEADBAND_VECTOR) {
+        memcpy(rate, &reference[field->rate_offset], count * sizeof(float));
+
+        for (size_t i = 0; i < count; i++) {
+            predicted[i] += rate[i] * dt_s;
+        }
+
+        return;
+    }
+
+    memcpy(rate, &reference[field->rate_offset], ANGULAR_RATE_COUNT * sizeof(float));
+
+    float magnitude = sqrtf(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+    float half_angle = 0.5f * magnitude * dt_s;
+
+    if (half_angle == 0.0f) {
+        return;
+    }
+
+    float scale = sinf(half_angle) / magnitude;
+    float dw = cosf(half_angle);
+    float dx = rate[0] * scale;
+    float dy = rate[1] * scale;
+    float dz = rate[2] * scale;
+    float w = predicted[0];
+    float x = predicted[1];
+    float y = predicted[2];
+    float z = predicted[3];
+
+    predicted[0] = w * dw - x * dx - y * dy - z * dz;
+    predicted[1] = w * dx + x * dw + y * dz - z * dy;
+    predicted[2] = w * dy - x * dz + y * dw + z * dx;
+    predicted[3] = w * dz + x * dy - y * dx + z * dw;
+}
+
+/**
+ * @param field Field
+ * @param reference Last message sent
+ * @param message Message about to be sent
+ * @param dt_s Time between the two messages
+ * @return bool Whether the receiver's prediction of the field is close enough
+ */
+static bool within_tolerance(const rp_deadband_field_t *field, const uint8_t *reference,
+                             const uint8_t *message, float dt_s)
+{
+    bool present = load_present(field, message);
+
+    if (present != load_present(field, reference)) {
+        return false;
+    }
+
+    if (!present) {
+        return true;
+    }
+
+    if (field->kind == RP_DEADBAND_EXACT) {
+        return memcmp(&reference[field->offset], &message[field->offset], field->count) == 0;
+    }
+
+    size_t count = (field->kind == RP_DEADBAND_ROTATION) ? QUATERNION_COUNT : field->count;
+    float predicted[VECTOR_MAX_COUNT];
+    float actual[VECTOR_MAX_COUNT];
+
+    predict(field, reference, dt_s, predicted);
+    memcpy(actual, &message[field->offset], count * sizeof(float));
+
+    if (field->kind == RP_DEADBAND_VECTOR) {
+        float error = 0.0f;
+
+        for (size_t i = 0; i < count; i++) {
+            float difference = actual[i] - predicted[i];
+
+            error += difference * difference;
+        }
+
+        return error <= field->tolerance * field->tolerance;
+    }
+
+    // Rotation angle between the quaternions is 2 * acos(|dot|) once normalized
+    float dot = 0.0f;
+    float predicted_norm = 0.0f;
+    float actual_norm = 0.0f;
+
+    for (size_t i = 0; i < QUATERNION_COUNT; i++) {
+        dot += predicted[i] * actual[i];
+        predicted_norm += predicted[i] * predicted[i];
+        actual_norm += actual[i] * actual[i];
+    }
+
+    if (predicted_norm == 0.0f || actual_norm == 0.0f) {
+        return predicted_norm == actual_norm;
+    }
+
+    float cosine = fabsf(dot) / sqrtf(predicted_norm * actual_norm);
+
+    return cosine >= cosf(0.5f * field->tolerance);
+}
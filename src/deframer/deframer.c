@@ -0,0 +1,102 @@
+#include "rp/deframer/deframer.h"
+
+#include <stdint.h>
+
+#include "rp/cobs/cobs.h"
+
+/**
+ * Initializes a deframer that splits a byte stream into COBS frames.
+ *
+ * @param deframer Deframer to initialize
+ * @param buffer Storage for one frame (including the delimiter)
+ * @param capacity Size of the storage in bytes
+ */
+void rp_deframer_init(rp_deframer_t *deframer, uint8_t *buffer, size_t capacity)
+{
+    if (deframer == NULL) {
+        return;
+    }
+
+    deframer->buffer = buffer;
+    deframer->capacity = capacity;
+    deframer->size = 0;
+    deframer->ready = false;
+    deframer->discarding = false;
+}
+
+/**
+ * Consumes bytes from a stream until a complete frame has been collected.
+ *
+ * When the result is `RP_DEFRAMER_FRAME_READY` the frame occupies the first
+ * `deframer->size` bytes of the buffer, including its delimiter, and can be passed
+ * directly to `rp_packet_decode`. The frame stays valid until the next call. Empty
+ * frames (back-to-back delimiters) are skipped. A frame that does not fit in the
+ * buffer is reported once with `RP_DEFRAMER_OVERFLOW` and dropped up to its delimiter.
+ *
+ * @param deframer Deframer state
+ * @param data Buffer of received bytes
+ * @param data_size Number of received bytes
+ * @return rp_deframer_result_t
+ */
+rp_deframer_result_t rp_deframer_feed(rp_deframer_t *deframer, const uint8_t *data,
+                                      size_t data_size)
+{
+    rp_deframer_result_t result = {
+        .consumed = 0,
+        .status = RP_DEFRAMER_NEED_MORE,
+    };
+
+    if (deframer == NULL || deframer->buffer == NULL || (data == NULL && data_size > 0)) {
+        result.status = RP_DEFRAMER_NULL_POINTER;
+        return result;
+    }
+
+    // The previous frame has been handed out, start collecting a new one
+    if (deframer->ready) {
+        deframer->ready = false;
+        deframer->size = 0;
+    }
+
+    for (size_t i = 0; i < data_size; i++) {
+        uint8_t byte = data[i];
+
+        if (byte == COBS_DELIMITER_BYTE) {
+            if (deframer->discarding) {
+                deframer->discarding = false;
+                continue;
+            }
+
+            // Idle fill or the terminator of an aborted frame
+            if (deframer->size == 0) {
+                continue;
+            }
+
+            deframer->buffer[deframer->size++] = byte;
+            deframer->ready = true;
+
+            result.consumed = i + 1;
+            result.status = RP_DEFRAMER_FRAME_READY;
+            return result;
+        }
+
+        if (deframer->discarding) {
+            continue;
+        }
+
+        // Keep one byte of room for the delimiter
+        if (deframer->size + 1 >= deframer->capacity) {
+            deframer->size = 0;
+            deframer->discarding = true;
+
+            result.consumed = i + 1;
+            result.status = RP_DEFRAMER_OVERFLOW;
+            return result;
+        }
+
+        deframer->buffer[deframer->size++] = byte;
+    }
+
+    result.consumed = data_size;
+
+    return result;
+}
@@ -0,0 +1,426 @@
+#include "rp/fec/rs.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Reed-Solomon code over GF(2^8) with the field polynomial
+ * x^8 + x^4 + x^3 + x^2 + 1 (0x11D) and generator roots alpha^1 .. alpha^(2t).
+ *
+ * Codewords are systematic: the data symbols followed by the parity symbols. Any
+ * codeword shorter than 255 symbols is a shortened code, i.e. the full length code
+ * with implicit leading zeros, so one implementation covers every frame size.
+ */
+
+#define GF_ORDER (255)
+
+/** alpha^i, repeated so the sum of two logarithms can index it without a modulo */
+static const uint8_t gf_exp[2 * 256] = {
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26,
+    0x4C, 0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0,
+    0x9D, 0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23,
+    0x46, 0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1,
+    0x5F, 0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0,
+    0xFD, 0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2,
+    0xD9, 0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE,
+    0x81, 0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC,
+    0x85, 0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54,
+    0xA8, 0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73,
+    0xE6, 0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF,
+    0xE3, 0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41,
+    0x82, 0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6,
+    0x51, 0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09,
+    0x12, 0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16,
+    0x2C, 0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01,
+    0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1D, 0x3A, 0x74, 0xE8, 0xCD, 0x87, 0x13, 0x26, 0x4C,
+    0x98, 0x2D, 0x5A, 0xB4, 0x75, 0xEA, 0xC9, 0x8F, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xC0, 0x9D,
+    0x27, 0x4E, 0x9C, 0x25, 0x4A, 0x94, 0x35, 0x6A, 0xD4, 0xB5, 0x77, 0xEE, 0xC1, 0x9F, 0x23, 0x46,
+    0x8C, 0x05, 0x0A, 0x14, 0x28, 0x50, 0xA0, 0x5D, 0xBA, 0x69, 0xD2, 0xB9, 0x6F, 0xDE, 0xA1, 0x5F,
+    0xBE, 0x61, 0xC2, 0x99, 0x2F, 0x5E, 0xBC, 0x65, 0xCA, 0x89, 0x0F, 0x1E, 0x3C, 0x78, 0xF0, 0xFD,
+    0xE7, 0xD3, 0xBB, 0x6B, 0xD6, 0xB1, 0x7F, 0xFE, 0xE1, 0xDF, 0xA3, 0x5B, 0xB6, 0x71, 0xE2, 0xD9,
+    0xAF, 0x43, 0x86, 0x11, 0x22, 0x44, 0x88, 0x0D, 0x1A, 0x34, 0x68, 0xD0, 0xBD, 0x67, 0xCE, 0x81,
+    0x1F, 0x3E, 0x7C, 0xF8, 0xED, 0xC7, 0x93, 0x3B, 0x76, 0xEC, 0xC5, 0x97, 0x33, 0x66, 0xCC, 0x85,
+    0x17, 0x2E, 0x5C, 0xB8, 0x6D, 0xDA, 0xA9, 0x4F, 0x9E, 0x21, 0x42, 0x84, 0x15, 0x2A, 0x54, 0xA8,
+    0x4D, 0x9A, 0x29, 0x52, 0xA4, 0x55, 0xAA, 0x49, 0x92, 0x39, 0x72, 0xE4, 0xD5, 0xB7, 0x73, 0xE6,
+    0xD1, 0xBF, 0x63, 0xC6, 0x91, 0x3F, 0x7E, 0xFC, 0xE5, 0xD7, 0xB3, 0x7B, 0xF6, 0xF1, 0xFF, 0xE3,
+    0xDB, 0xAB, 0x4B, 0x96, 0x31, 0x62, 0xC4, 0x95, 0x37, 0x6E, 0xDC, 0xA5, 0x57, 0xAE, 0x41, 0x82,
+    0x19, 0x32, 0x64, 0xC8, 0x8D, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xDD, 0xA7, 0x53, 0xA6, 0x51,
+    0xA2, 0x59, 0xB2, 0x79, 0xF2, 0xF9, 0xEF, 0xC3, 0x9B, 0x2B, 0x56, 0xAC, 0x45, 0x8A, 0x09, 0x12,
+    0x24, 0x48, 0x90, 0x3D, 0x7A, 0xF4, 0xF5, 0xF7, 0xF3, 0xFB, 0xEB, 0xCB, 0x8B, 0x0B, 0x16, 0x2C,
+    0x58, 0xB0, 0x7D, 0xFA, 0xE9, 0xCF, 0x83, 0x1B, 0x36, 0x6C, 0xD8, 0xAD, 0x47, 0x8E, 0x01, 0x02,
+};
+
+/** log_alpha(i), gf_log[0] is undefined */
+static const uint8_t gf_log[256] = {
+    0x00, 0x00, 0x01, 0x19, 0x02, 0x32, 0x1A, 0xC6, 0x03, 0xDF, 0x33, 0xEE, 0x1B, 0x68, 0xC7, 0x4B,
+    0x04, 0x64, 0xE0, 0x0E, 0x34, 0x8D, 0xEF, 0x81, 0x1C, 0xC1, 0x69, 0xF8, 0xC8, 0x08, 0x4C, 0x71,
+    0x05, 0x8A, 0x65, 0x2F, 0xE1, 0x24, 0x0F, 0x21, 0x35, 0x93, 0x8E, 0xDA, 0xF0, 0x12, 0x82, 0x45,
+    0x1D, 0xB5, 0xC2, 0x7D, 0x6A, 0x27, 0xF9, 0xB9, 0xC9, 0x9A, 0x09, 0x78, 0x4D, 0xE4, 0x72, 0xA6,
+    0x06, 0xBF, 0x8B, 0x62, 0x66, 0xDD, 0x30, 0xFD, 0xE2, 0x98, 0x25, 0xB3, 0x10, 0x91, 0x22, 0x88,
+    0x36, 0xD0, 0x94, 0xCE, 0x8F, 0x96, 0xDB, 0xBD, 0xF1, 0xD2, 0x13, 0x5C, 0x83, 0x38, 0x46, 0x40,
+    0x1E, 0x42, 0xB6, 0xA3, 0xC3, 0x48, 0x7E, 0x6E, 0x6B, 0x3A, 0x28, 0x54, 0xFA, 0x85, 0xBA, 0x3D,
+    0xCA, 0x5E, 0x9B, 0x9F, 0x0A, 0x15, 0x79, 0x2B, 0x4E, 0xD4, 0xE5, 0xAC, 0x73, 0xF3, 0xA7, 0x57,
+    0x07, 0x70, 0xC0, 0xF7, 0x8C, 0x80, 0x63, 0x0D, 0x67, 0x4A, 0xDE, 0xED, 0x31, 0xC5, 0xFE, 0x18,
+    0xE3, 0xA5, 0x99, 0x77, 0x26, 0xB8, 0xB4, 0x7C, 0x11, 0x44, 0x92, 0xD9, 0x23, 0x20, 0x89, 0x2E,
+    0x37, 0x3F, 0xD1, 0x5B, 0x95, 0xBC, 0xCF, 0xCD, 0x90, 0x87, 0x97, 0xB2, 0xDC, 0xFC, 0xBE, 0x61,
+    0xF2, 0x56, 0xD3, 0xAB, 0x14, 0x2A, 0x5D, 0x9E, 0x84, 0x3C, 0x39, 0x53, 0x47, 0x6D, 0x41, 0xA2,
+    0x1F, 0x2D, 0x43, 0xD8, 0xB7, 0x7B, 0xA4, 0x76, 0xC4, 0x17, 0x49, 0xEC, 0x7F, 0x0C, 0x6F, 0xF6,
+    0x6C, 0xA1, 0x3B, 0x52, 0x29, 0x9D, 0x55, 0xAA, 0xFB, 0x60, 0x86, 0xB1, 0xBB, 0xCC, 0x3E, 0x5A,
+    0xCB, 0x59, 0x5F, 0xB0, 0x9C, 0xA9, 0xA0, 0x51, 0x0B, 0xF5, 0x16, 0xEB, 0x7A, 0x75, 0x2C, 0xD7,
+    0x4F, 0xAE, 0xD5, 0xE9, 0xE6, 0xE7, 0xAD, 0xE8, 0x74, 0xD6, 0xF4, 0xEA, 0xA8, 0x50, 0x58, 0xAF,
+};
+
+static uint8_t gf_mul(uint8_t a, uint8_t b);
+static uint8_t gf_div(uint8_t a, uint8_t b);
+static uint8_t gf_pow_alpha(int exponent);
+static uint8_t poly_eval(const uint8_t *poly, size_t degree, uint8_t x);
+
+/**
+ * Prepares the generator polynomial for a code with the given number of parity symbols.
+ *
+ * The code corrects up to `parity_size / 2` symbol errors per codeword, e.g. 32 parity
+ * symbols give RS(255,223).
+ *
+ * @param codec Codec to initialize
+ * @param parity_size Number of parity symbols, 2 to `RS_MAX_PARITY`
+ * @return rs_status_t
+ */
+rs_status_t rs_codec_init(rs_codec_t *codec, size_t parity_size)
+{
+    if (codec == NULL) {
+        return RS_NULL_POINTER;
+    }
+
+    if (parity_size < 2 || parity_size > RS_MAX_PARITY) {
+        return RS_INVALID_LENGTH;
+    }
+
+    uint8_t generator[RS_MAX_PARITY + 1] = {1};
+
+    // g(x) = (x + alpha^1)(x + alpha^2)...(x + alpha^2t), coefficient i is for x^i
+    for (size_t root = 1; root <= parity_size; root++) {
+        uint8_t alpha = gf_pow_alpha((int)root);
+
+        for (size_t i = root; i > 0; i--) {
+            generator[i] = generator[i - 1] ^ gf_mul(generator[i], alpha);
+        }
+
+        generator[0] = gf_mul(generator[0], alpha);
+    }
+
+    codec->parity_size = (uint8_t)parity_size;
+    memcpy(codec->generator, generator, sizeof(codec->generator));
+
+    return RS_OK;
+}
+
+/**
+ * Computes the parity symbols for a block of data.
+ *
+ * @param codec Initialized codec
+ * @param data Data symbols
+ * @param data_size Number of data symbols, at most `255 - codec->parity_size`
+ * @param parity Output buffer for `codec->parity_size` parity symbols
+ * @return rs_status_t
+ */
+rs_status_t rs_encode(const rs_codec_t *codec, const uint8_t *data, size_t data_size,
+                      uint8_t *parity)
+{
+    if (codec == NULL || data == NULL || parity == NULL) {
+        return RS_NULL_POINTER;
+    }
+
+    size_t parity_size = codec->parity_size;
+
+    if (data_size + parity_size > RS_SYMBOL_COUNT) {
+        return RS_INVALID_LENGTH;
+    }
+
+    memset(parity, 0, parity_size);
+
+    return rs_encode_update(codec, data, data_size, parity);
+}
+
+/**
+ * Feeds more data symbols into parity computed so far, for data that is produced in
+ * pieces. Start from `parity_size` zeroed symbols; after the last piece `parity` holds
+ * what `rs_encode` returns for all of the data. The caller keeps the total data within
+ * `255 - codec->parity_size` symbols.
+ *
+ * @param codec Initialized codec
+ * @param data Next data symbols
+ * @param data_size Number of data symbols
+ * @param parity Parity so far, updated in place
+ * @return rs_status_t
+ */
+rs_status_t rs_encode_update(const rs_codec_t *codec, const uint8_t *data, size_t data_size,
+                             uint8_t *parity)
+{
+    if (codec == NULL || (data == NULL && data_size > 0) || parity == NULL) {
+        return RS_NULL_POINTER;
+    }
+
+    size_t parity_size = codec->parity_size;
+
+    // Polynomial division by g(x) with a shift register, parity[0] is the highest degree
+    for (size_t i = 0; i < data_size; i++) {
+        uint8_t feedback = data[i] ^ parity[0];
+
+        memmove(&parity[0], &parity[1], parity_size - 1);
+        parity[parity_size - 1] = 0;
+
+        if (feedback == 0) {
+            continue;
+        }
+
+        for (size_t j = 0; j < parity_size; j++) {
+            parity[j] ^= gf_mul(feedback, codec->generator[parity_size - 1 - j]);
+        }
+    }
+
+    return RS_OK;
+}
+
+/**
+ * Corrects symbol errors in a codeword in place.
+ *
+ * Up to `parity_size / 2` erroneous symbols are located with Berlekamp-Massey and a
+ * Chien search and repaired with Forney's algorithm. If the errors cannot be located
+ * consistently the codeword is left untouched and `RS_UNCORRECTABLE` is returned.
+ *
+ * @param codec Initialized codec
+ * @param codeword Data symbols followed by parity symbols
+ * @param codeword_size Total number of symbols, at most 255
+ * @return rs_result_t
+ */
+rs_result_t rs_decode(const rs_codec_t *codec, uint8_t *codeword, size_t codeword_size)
+{
+    return rs_decode_erasures(codec, codeword, codeword_size, NULL, 0);
+}
+
+/**
+ * Corrects symbol errors in a codeword in place, some of them at known positions.
+ *
+ * An erasure is a symbol known to be unreliable, e.g. one that was never received. Its
+ * position costs one parity symbol instead of two, so `e` erasures and `v` errors are
+ * corrected as long as `2v + e <= parity_size`. Erased symbols may hold any value.
+ *
+ * @param codec Initialized codec
+ * @param codeword Data symbols followed by parity symbols
+ * @param codeword_size Total number of symbols, at most 255
+ * @param erasures Distinct positions of erased symbols in `codeword`
+ * @param erasure_count Number of erasures, at most `parity_size`
+ * @return rs_result_t Symbols corrected, erasures included, when they held a wrong value
+ */
+rs_result_t rs_decode_erasures(const rs_codec_t *codec, uint8_t *codeword, size_t codeword_size,
+                               const size_t *erasures, size_t erasure_count)
+{
+    rs_result_t result = {
+        .corrected = 0,
+        .status = RS_OK,
+    };
+
+    if (codec == NULL || codeword == NULL) {
+        result.status = RS_NULL_POINTER;
+        return result;
+    }
+
+    size_t parity_size = codec->parity_size;
+
+    if (codeword_size <= parity_size || codeword_size > RS_SYMBOL_COUNT ||
+        erasure_count > parity_size) {
+        result.status = RS_INVALID_LENGTH;
+        return result;
+    }
+
+    if (erasures == NULL && erasure_count > 0) {
+        result.status = RS_NULL_POINTER;
+        return result;
+    }
+
+    for (size_t k = 0; k < erasure_count; k++) {
+        if (erasures[k] >= codeword_size) {
+            result.status = RS_INVALID_LENGTH;
+            return result;
+        }
+    }
+
+    // Syndromes S_j = c(alpha^(j + 1))
+    uint8_t syndromes[RS_MAX_PARITY];
+    bool has_errors = false;
+
+    for (size_t j = 0; j < parity_size; j++) {
+        uint8_t s = 0;
+
+        for (size_t i = 0; i < codeword_size; i++) {
+            s = (s == 0) ? codeword[i] : (gf_exp[gf_log[s] + j + 1] ^ codeword[i]);
+        }
+
+        syndromes[j] = s;
+        has_errors |= (s != 0);
+    }
+
+    if (!has_errors) {
+        return result;
+    }
+
+    // Erasure locator Gamma(x) = (1 + X_1 x)(1 + X_2 x)..., X_k = alpha^(degree of erasure k)
+    uint8_t locator[RS_MAX_PARITY + 1] = {1};
+
+    for (size_t k = 0; k < erasure_count; k++) {
+        uint8_t x = gf_pow_alpha((int)(codeword_size - 1 - erasures[k]));
+
+        for (size_t i = k + 1; i > 0; i--) {
+            locator[i] ^= gf_mul(locator[i - 1], x);
+        }
+    }
+
+    // Berlekamp-Massey for the errata locator polynomial, starting from the erasures
+    uint8_t previous[RS_MAX_PARITY + 1];
+    size_t locator_degree = erasure_count;
+    size_t shift = 1;
+    uint8_t previous_discrepancy = 1;
+
+    memcpy(previous, locator, sizeof(previous));
+
+    for (size_t n = erasure_count; n < parity_size; n++) {
+        uint8_t discrepancy = syndromes[n];
+
+        for (size_t i = 1; i <= locator_degree; i++) {
+            discrepancy ^= gf_mul(locator[i], syndromes[n - i]);
+        }
+
+        if (discrepancy == 0) {
+            shift++;
+            continue;
+        }
+
+        uint8_t scale = gf_div(discrepancy, previous_discrepancy);
+        uint8_t saved[RS_MAX_PARITY + 1];
+
+        memcpy(saved, locator, sizeof(saved));
+
+        for (size_t i = 0; i + shift <= parity_size; i++) {
+            locator[i + shift] ^= gf_mul(scale, previous[i]);
+        }
+
+        if (2 * locator_degree <= n + erasure_count) {
+            locator_degree = n + 1 + erasure_count - locator_degree;
+            memcpy(previous, saved, sizeof(previous));
+            previous_discrepancy = discrepancy;
+            shift = 1;
+        } else {
+            shift++;
+        }
+    }
+
+    if (locator_degree == 0 || 2 * locator_degree > parity_size + erasure_count) {
+        result.status = RS_UNCORRECTABLE;
+        return result;
+    }
+
+    // Error evaluator Omega(x) = S(x) Lambda(x) mod x^2t
+    uint8_t evaluator[RS_MAX_PARITY];
+
+    for (size_t k = 0; k < parity_size; k++) {
+        uint8_t value = 0;
+
+        for (size_t i = 0; i <= k && i <= locator_degree; i++) {
+            value ^= gf_mul(locator[i], syndromes[k - i]);
+        }
+
+        evaluator[k] = value;
+    }
+
+    // Formal derivative of Lambda(x), only odd powers survive in GF(2^m)
+    uint8_t derivative[RS_MAX_PARITY] = {0};
+
+    for (size_t i = 1; i <= locator_degree; i += 2) {
+        derivative[i - 1] = locator[i];
+    }
+
+    // Chien search over the symbols that exist in the shortened codeword
+    size_t positions[RS_MAX_PARITY];
+    uint8_t magnitudes[RS_MAX_PARITY];
+    size_t found = 0;
+
+    for (size_t i = 0; i < codeword_size; i++) {
+        int degree = (int)(codeword_size - 1 - i);
+        uint8_t x_inverse = gf_pow_alpha(-degree);
+
+        if (poly_eval(locator, locator_degree, x_inverse) != 0) {
+            continue;
+        }
+
+        if (found == locator_degree) {
+            result.status = RS_UNCORRECTABLE;
+            return result;
+        }
+
+        uint8_t numerator = poly_eval(evaluator, parity_size - 1, x_inverse);
+        uint8_t denominator = poly_eval(derivative, locator_degree - 1, x_inverse);
+
+        if (denominator == 0) {
+            result.status = RS_UNCORRECTABLE;
+            return result;
+        }
+
+        positions[found] = i;
+        magnitudes[found] = gf_div(numerator, denominator);
+        found++;
+    }
+
+    // Roots outside the shortened codeword mean more errors than the code can locate
+    if (found != locator_degree) {
+        result.status = RS_UNCORRECTABLE;
+        return result;
+    }
+
+    for (size_t k = 0; k < found; k++) {
+        codeword[positions[k]] ^= magnitudes[k];
+        result.corrected += (magnitudes[k] != 0);
+    }
+
+    return result;
+}
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+
+    return gf_exp[gf_log[a] + gf_log[b]];
+}
+
+static uint8_t gf_div(uint8_t a, uint8_t b)
+{
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+
+    return gf_exp[gf_log[a] + GF_ORDER - gf_log[b]];
+}
+
+static uint8_t gf_pow_alpha(int exponent)
+{
+    exponent %= GF_ORDER;
+
+    if (exponent < 0) {
+        exponent += GF_ORDER;
+    }
+
+    return gf_exp[exponent];
+}
+
+static uint8_t poly_eval(const uint8_t *poly, size_t degree, uint8_t x)
+{
+    uint8_t value = poly[degree];
+
+    for (size_t i = degree; i > 0; i--) {
+        value = gf_mul(value, x) ^ poly[i - 1];
+    }
+
+    return value;
+}
@@ -0,0 +1,173 @@
+#include "rp/frame_cache.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/codec.h"
+#include "rp/link/link.h"
+
+static bool options_match(const rp_frame_cache_t *cache, const rp_codec_options_t *options);
+static void store_options(rp_frame_cache_t *cache, const rp_codec_options_t *options);
+
+/**
+ * Initializes an empty frame cache for one message type.
+ *
+ * @param cache Cache to initialize
+ * @param fields Message type, as passed to `rp_packet_encode`
+ * @param snapshot Storage for a copy of the message, `message_size` bytes
+ * @param message_size Size of the message struct, e.g. `sizeof(tvr_Downlink)`
+ * @return rp_codec_status_t
+ */
+rp_codec_status_t rp_frame_cache_init(rp_frame_cache_t *cache, const pb_msgdesc_t *fields,
+                                      void *snapshot, size_t message_size)
+{
+    if (cache == NULL || fields == NULL || snapshot == NULL) {
+        return RP_CODEC_NULL_POINTER;
+    }
+
+    if (message_size == 0) {
+        return RP_CODEC_ERROR;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+
+    cache->fields = fields;
+    cache->snapshot = snapshot;
+    cache->message_size = message_size;
+
+    return RP_CODEC_OK;
+}
+
+/**
+ * Drops the cached frame, so the next encode runs the full pipeline. Needed after
+ * changing anything the byte comparison cannot see, such as the contents of a FEC codec
+ * or quantization spec passed in the options.
+ *
+ * @param cache Cache to invalidate
+ */
+void rp_frame_cache_invalidate(rp_frame_cache_t *cache)
+{
+    if (cache == NULL) {
+        return;
+    }
+
+    cache->frame_size = 0;
+}
+
+/**
+ * Encodes a message like `rp_packet_encode_with_options`, copying the cached frame
+ * instead when the message and options are the same as for the previous call.
+ *
+ * A link header in the options is part of the frame, so a cached frame is only reused
+ * for the same sequence number and timestamp, e.g. when retransmitting.
+ *
+ * @param cache Cache for the message type
+ * @param packet Buffer for the frame
+ * @param packet_capacity Size of the buffer in bytes
+ * @param message Message of the cached type
+ * @param options Pipeline options, or NULL for the defaults
+ * @return rp_packet_encode_result_t
+ */
+rp_packet_encode_result_t rp_frame_cache_encode(rp_frame_cache_t *cache, uint8_t *packet,
+                                                size_t packet_capacity, const void *message,
+                                                const rp_codec_options_t *options)
+{
+    rp_packet_encode_result_t result = {
+        .written = 0,
+        .status = RP_CODEC_ERROR,
+    };
+
+    if (cache == NULL || cache->snapshot == NULL || packet == NULL || message == NULL) {
+        result.status = RP_CODEC_NULL_POINTER;
+        return result;
+    }
+
+    bool hit = cache->frame_size > 0 && options_match(cache, options) &&
+               memcmp(cache->snapshot, message, cache->message_size) == 0;
+
+    if (hit) {
+        cache->hits++;
+    } else {
+        cache->frame_size = 0;
+        cache->misses++;
+
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            cache->frame, sizeof(cache->frame), cache->fields, message, options);
+
+        if (encoded.status != RP_CODEC_OK) {
+            return encoded;
+        }
+
+        memcpy(cache->snapshot, message, cache->message_size);
+        store_options(cache, options);
+        cache->frame_size = encoded.written;
+    }
+
+    if (cache->frame_size > packet_capacity) {
+        result.status = RP_CODEC_OVERFLOW;
+        return result;
+    }
+
+    memcpy(packet, cache->frame, cache->frame_size);
+
+    result.written = cache->frame_size;
+    result.status = RP_CODEC_OK;
+
+    return result;
+}
+
+/**
+ * @param cache Cache holding a frame
+ * @param options Options of the current encode, or NULL for the defaults
+ * @return bool Whether the options produce the same frame as the cached ones
+ */
+static bool options_match(const rp_frame_cache_t *cache, const rp_codec_options_t *options)
+{
+    rp_codec_options_t defaults = {0};
+
+    if (options == NULL) {
+        options = &defaults;
+    }
+
+    const rp_codec_options_t *cached = &cache->options;
+
+    if (options->checksum != cached->checksum || options->fec != cached->fec ||
+        options->quant != cached->quant) {
+        return false;
+    }
+
+    if ((options->link_header == NULL) != (cached->link_header == NULL)) {
+        return false;
+    }
+
+    return options->link_header == NULL ||
+           (options->link_header->sequence == cache->link_header.sequence &&
+            options->link_header->timestamp_us == cache->link_header.timestamp_us);
+}
+
+/**
+ * Remembers the encoder side options of the cached frame. The link header is copied
+ * because callers update it in place between frames.
+ *
+ * @param cache Cache that was just filled
+ * @param options Options the frame was encoded with, or NULL for the defaults
+ */
+static void store_options(rp_frame_cache_t *cache, const rp_codec_options_t *options)
+{
+    memset(&cache->options, 0, sizeof(cache->options));
+
+    if (options == NULL) {
+        return;
+    }
+
+    cache->options.checksum = options->checksum;
+    cache->options.fec = options->fec;
+    cache->options.quant = options->quant;
+
+    if (options->link_header != NULL) {
+        cache->link_header = *options->link_header;
+        cache->options.link_header = &cache->link_header;
+    }
+}
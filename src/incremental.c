@@ -0,0 +1,663 @@
+#include "rp/incremental.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+#include "rp/codec.h"
+#include "rp/crc/crc.h"
+#include "rp/link/link.h"
+
+#define CHECKSUM_SIZE (2)
+#define CHECKSUM_TERMS_MAX (RP_INCREMENTAL_MAX_FIELDS + 1)
+
+// `crc16_ccitt_shift` costs about as much as running the CRC over this many bytes
+#define SHIFT_COST_BYTES (10)
+#define VARINT32_MAX_SIZE (5)
+
+// Protobuf wire types
+#define WIRE_VARINT (0)
+#define WIRE_FIXED64 (1)
+#define WIRE_LENGTH_DELIMITED (2)
+#define WIRE_FIXED32 (5)
+
+static bool options_patchable(const rp_incremental_spec_t *spec,
+                              const rp_codec_options_t *options);
+static size_t member_size(rp_incremental_wire_t wire);
+static bool outside_fields_unchanged(const rp_incremental_encoder_t *encoder,
+                                     const uint8_t *message);
+static uint64_t load_member(rp_incremental_wire_t wire, const uint8_t *member);
+static size_t varint_size(uint64_t value);
+static size_t encode_member(rp_incremental_wire_t wire, uint64_t value, uint8_t *output);
+static void patch_bytes(rp_incremental_encoder_t *encoder, bool *zero_changed, size_t position,
+                        const uint8_t *data, size_t size, uint8_t *delta);
+static bool patch_frame(rp_incremental_encoder_t *encoder, const uint8_t *message,
+                        const rp_codec_options_t *options);
+static bool map_cobs_positions(rp_incremental_encoder_t *encoder);
+static void learn_layout(rp_incremental_encoder_t *encoder, bool has_link_header);
+static bool read_varint(const uint8_t *data, size_t size, size_t *offset, uint64_t *value);
+static bool find_field(const uint8_t *payload, size_t payload_size,
+                       const rp_incremental_field_t *field, size_t *position, size_t *size);
+
+/**
+ * Checks that a spec can be used by `rp_incremental_init`.
+ *
+ * @param spec Spec to check
+ * @return bool
+ */
+bool rp_incremental_spec_valid(const rp_incremental_spec_t *spec)
+{
+    if (spec == NULL || spec->message == NULL || spec->message_size == 0 ||
+        spec->field_count > RP_INCREMENTAL_MAX_FIELDS ||
+        (spec->fields == NULL && spec->field_count > 0)) {
+        return false;
+    }
+
+    size_t end = 0;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_incremental_field_t *field = &spec->fields[i];
+
+        if (field->wire > RP_INCREMENTAL_FIXED64 || field->depth == 0 ||
+            field->depth > RP_INCREMENTAL_MAX_DEPTH || field->offset < end) {
+            return false;
+        }
+
+        for (size_t d = 0; d < field->depth; d++) {
+            if (field->tags[d] == 0) {
+                return false;
+            }
+        }
+
+        end = field->offset + member_size(field->wire);
+
+        if (end > spec->message_size) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Initializes an incremental encoder without a previous frame.
+ *
+ * @param encoder Encoder to initialize
+ * @param spec Message type and its patchable members
+ * @param snapshot Storage for a copy of the message, `spec->message_size` bytes
+ * @return rp_codec_status_t
+ */
+rp_codec_status_t rp_incremental_init(rp_incremental_encoder_t *encoder,
+                                      const rp_incremental_spec_t *spec, void *snapshot)
+{
+    if (encoder == NULL || spec == NULL || snapshot == NULL) {
+        return RP_CODEC_NULL_POINTER;
+    }
+
+    if (!rp_incremental_spec_valid(spec)) {
+        return RP_CODEC_ERROR;
+    }
+
+    memset(encoder, 0, sizeof(*encoder));
+
+    encoder->spec = spec;
+    encoder->snapshot = snapshot;
+
+    return RP_CODEC_OK;
+}
+
+/**
+ * Forgets the previous frame, so the next encode runs the full pipeline.
+ *
+ * @param encoder Encoder to reset
+ */
+void rp_incremental_invalidate(rp_incremental_encoder_t *encoder)
+{
+    if (encoder == NULL) {
+        return;
+    }
+
+    encoder->has_layout = false;
+    encoder->frame_size = 0;
+}
+
+/**
+ * Encodes a message like `rp_packet_encode_with_options`, by patching the previous frame
+ * when possible.
+ *
+ * The previous frame is patched when only spec members changed, each of them stays
+ * present with an encoding of the same length, and the options are the same apart from
+ * the link header contents. The changed bytes are overwritten, the CRC-16 is updated
+ * from the changed bytes alone, and COBS is only re-run if a byte became zero or stopped
+ * being zero. Everything else, including CRC-32C, FEC and quantization, runs the full
+ * pipeline and learns the layout of the new frame.
+ *
+ * @param encoder Encoder of the message type
+ * @param packet Buffer for the frame
+ * @param packet_capacity Size of the buffer in bytes
+ * @param message Message of the spec type
+ * @param options Pipeline options, or NULL for the defaults
+ * @return rp_packet_encode_result_t
+ */
+rp_packet_encode_result_t rp_incremental_encode(rp_incremental_encoder_t *encoder,
+                                                uint8_t *packet, size_t packet_capacity,
+                                                const void *message,
+                                                const rp_codec_options_t *options)
+{
+    rp_packet_encode_result_t result = {
+        .written = 0,
+        .status = RP_CODEC_ERROR,
+    };
+
+    if (encoder == NULL || encoder->spec == NULL || packet == NULL || message == NULL) {
+        result.status = RP_CODEC_NULL_POINTER;
+        return result;
+    }
+
+    const rp_incremental_spec_t *spec = encoder->spec;
+    bool patchable = options_patchable(spec, options);
+    bool has_link_header = options != NULL && options->link_header != NULL;
+
+    if (patchable && encoder->has_layout && encoder->has_link_header == has_link_header &&
+        outside_fields_unchanged(encoder, message) && patch_frame(encoder, message, options)) {
+        encoder->patched_encodes++;
+    } else {
+        encoder->has_layout = false;
+        encoder->frame_size = 0;
+        encoder->full_encodes++;
+
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            encoder->frame, sizeof(encoder->frame), spec->message, message, options);
+
+        if (encoded.status != RP_CODEC_OK) {
+            return encoded;
+        }
+
+        encoder->frame_size = encoded.written;
+
+        if (patchable) {
+            learn_layout(encoder, has_link_header);
+        }
+    }
+
+    memcpy(encoder->snapshot, message, spec->message_size);
+
+    if (encoder->frame_size > packet_capacity) {
+        result.status = RP_CODEC_OVERFLOW;
+        return result;
+    }
+
+    memcpy(packet, encoder->frame, encoder->frame_size);
+
+    result.written = encoder->frame_size;
+    result.status = RP_CODEC_OK;
+
+    return result;
+}
+
+/**
+ * @param spec Spec of the encoder
+ * @param options Options of the current encode, or NULL for the defaults
+ * @return bool Whether frames encoded with the options can be patched
+ */
+static bool options_patchable(const rp_incremental_spec_t *spec,
+                              const rp_codec_options_t *options)
+{
+    rp_codec_checksum_t checksum =
+        (options != NULL) ? options->checksum : RP_CODEC_CHECKSUM_DEFAULT;
+
+    if (checksum == RP_CODEC_CHECKSUM_DEFAULT) {
+        checksum = RP_CODEC_DEFAULT_CHECKSUM;
+    }
+
+    if (checksum != RP_CODEC_CHECKSUM_CRC16) {
+        return false;
+    }
+
+    return options == NULL || (options->fec == NULL && (options->quant == NULL ||
+                                                        options->quant->message != spec->message));
+}
+
+/**
+ * @param wire Wire type of a spec member
+ * @return size_t Size of the member in the message struct
+ */
+static size_t member_size(rp_incremental_wire_t wire)
+{
+    return (wire == RP_INCREMENTAL_FIXED64) ? sizeof(uint64_t) : sizeof(uint32_t);
+}
+
+/**
+ * @param encoder Encoder holding the snapshot
+ * @param message Message being encoded
+ * @return bool Whether every byte outside the spec members equals the snapshot
+ */
+static bool outside_fields_unchanged(const rp_incremental_encoder_t *encoder,
+                                     const uint8_t *message)
+{
+    const rp_incremental_spec_t *spec = encoder->spec;
+    const uint8_t *snapshot = encoder->snapshot;
+    size_t start = 0;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        size_t offset = spec->fields[i].offset;
+
+        if (memcmp(&message[start], &snapshot[start], offset - start) != 0) {
+            return false;
+        }
+
+        start = offset + member_size(spec->fields[i].wire);
+    }
+
+    return memcmp(&message[start], &snapshot[start], spec->message_size - start) == 0;
+}
+
+/**
+ * @param wire Wire type of the member
+ * @param member Member in the message struct
+ * @return uint64_t Value of the member, zero extended
+ */
+static uint64_t load_member(rp_incremental_wire_t wire, const uint8_t *member)
+{
+    if (wire == RP_INCREMENTAL_FIXED64) {
+        uint64_t value;
+
+        memcpy(&value, member, sizeof(value));
+        return value;
+    }
+
+    uint32_t value;
+
+    memcpy(&value, member, sizeof(value));
+    return value;
+}
+
+/**
+ * @param value Value of a varint member
+ * @return size_t Bytes of its encoding
+ */
+static size_t varint_size(uint64_t value)
+{
+    size_t size = 1;
+
+    for (; value > 0x7F; value >>= 7) {
+        size++;
+    }
+
+    return size;
+}
+
+/**
+ * Writes the protobuf encoding of a member's value, without its key.
+ *
+ * @param wire Wire type of the member
+ * @param value Value from `load_member`
+ * @param output Buffer of at least 8 bytes
+ * @return size_t Bytes written
+ */
+static size_t encode_member(rp_incremental_wire_t wire, uint64_t value, uint8_t *output)
+{
+    if (wire == RP_INCREMENTAL_VARINT) {
+        size_t size = 0;
+
+        do {
+            output[size++] = (uint8_t)((value & 0x7F) | ((value > 0x7F) ? 0x80 : 0));
+            value >>= 7;
+        } while (value != 0);
+
+        return size;
+    }
+
+    size_t size = member_size(wire);
+
+    for (size_t i = 0; i < size; i++) {
+        output[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    return size;
+}
+
+/**
+ * Overwrites bytes of the previous frame, before and after COBS.
+ *
+ * @param encoder Encoder holding the previous frame
+ * @param zero_changed Set if a byte became zero or stopped being zero
+ * @param position Offset of the bytes before COBS
+ * @param data New bytes, at most 8
+ * @param size Number of bytes
+ * @param delta Receives the XOR of the old and new bytes, or NULL
+ */
+static void patch_bytes(rp_incremental_encoder_t *encoder, bool *zero_changed, size_t position,
+                        const uint8_t *data, size_t size, uint8_t *delta)
+{
+    for (size_t i = 0; i < size; i++) {
+        uint8_t old = encoder->plain[position + i];
+
+        if (delta != NULL) {
+            delta[i] = old ^ data[i];
+        }
+
+        if ((old == 0) != (data[i] == 0)) {
+            *zero_changed = true;
+        } else if (data[i] != 0) {
+            encoder->frame[encoder->cobs_position[position + i]] = data[i];
+        }
+
+        encoder->plain[position + i] = data[i];
+    }
+}
+
+/**
+ * Turns the previous frame into the frame of `message`.
+ *
+ * @param encoder Encoder with a layout, whose snapshot differs from the message in spec
+ *                members only
+ * @param message Message being encoded
+ * @param options Options of the current encode
+ * @return bool False if the layout no longer fits
+ */
+static bool patch_frame(rp_incremental_encoder_t *encoder, const uint8_t *message,
+                        const rp_codec_options_t *options)
+{
+    const rp_incremental_spec_t *spec = encoder->spec;
+    const uint8_t *snapshot = encoder->snapshot;
+
+    uint8_t changed[RP_INCREMENTAL_MAX_FIELDS];
+    uint64_t values[RP_INCREMENTAL_MAX_FIELDS];
+    size_t changed_count = 0;
+    size_t linear_cost = encoder->has_link_header ? RP_LINK_HEADER_SIZE + SHIFT_COST_BYTES : 0;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_incremental_field_t *field = &spec->fields[i];
+        uint64_t value = load_member(field->wire, &message[field->offset]);
+
+        if (value == load_member(field->wire, &snapshot[field->offset])) {
+            continue;
+        }
+
+        // proto3 leaves out zero values, so the field would appear or disappear
+        if (encoder->slots[i].position == RP_INCREMENTAL_ABSENT || value == 0) {
+            return false;
+        }
+
+        if (field->wire == RP_INCREMENTAL_VARINT &&
+            varint_size(value) != encoder->slots[i].size) {
+            return false;
+        }
+
+        changed[changed_count] = (uint8_t)i;
+        values[changed_count++] = value;
+        linear_cost += encoder->slots[i].size + SHIFT_COST_BYTES;
+    }
+
+    size_t covered = encoder->plain_size - CHECKSUM_SIZE;
+    uint16_t checksum = (uint16_t)(encoder->plain[covered] | (encoder->plain[covered + 1] << 8));
+    bool zero_changed = false;
+    uint8_t delta[sizeof(uint64_t)];
+
+    // The linear update only pays off while most of the frame is unchanged
+    bool linear = linear_cost < covered;
+
+    if (encoder->has_link_header) {
+        uint8_t header[RP_LINK_HEADER_SIZE];
+
+        rp_link_header_write(options->link_header, header);
+        patch_bytes(encoder, &zero_changed, 0, header, sizeof(header), linear ? delta : NULL);
+
+        if (linear) {
+            checksum ^= crc16_ccitt_shift(crc16_ccitt(delta, sizeof(header)),
+                                          encoder->header_shift_operator);
+        }
+    }
+
+    for (size_t c = 0; c < changed_count; c++) {
+        const rp_incremental_slot_t *slot = &encoder->slots[changed[c]];
+        uint8_t encoded[sizeof(uint64_t) + VARINT32_MAX_SIZE];
+
+        encode_member(spec->fields[changed[c]].wire, values[c], encoded);
+        patch_bytes(encoder, &zero_changed, slot->position, encoded, slot->size,
+                    linear ? delta : NULL);
+
+        if (linear) {
+            checksum ^=
+                crc16_ccitt_shift(crc16_ccitt(delta, slot->size), slot->shift_operator);
+        }
+    }
+
+    if (!linear) {
+        checksum = crc16_ccitt(encoder->plain, covered);
+    }
+
+    const uint8_t checksum_bytes[CHECKSUM_SIZE] = {(uint8_t)(checksum & 0xFF),
+                                                   (uint8_t)(checksum >> 8)};
+
+    patch_bytes(encoder, &zero_changed, covered, checksum_bytes, CHECKSUM_SIZE, NULL);
+
+    if (zero_changed) {
+        cobs_result_t cobs_result = cobs_encode(encoder->plain, encoder->plain_size,
+                                                encoder->frame, sizeof(encoder->frame));
+
+        if (cobs_result.status != COBS_OK) {
+            return false;
+        }
+
+        encoder->frame_size = cobs_result.written;
+        encoder->cobs_reencodes++;
+
+        return map_cobs_positions(encoder);
+    }
+
+    return true;
+}
+
+/**
+ * Records where each byte before COBS ended up in the encoded frame. Zero bytes map to
+ * the code byte that replaced them.
+ *
+ * @param encoder Encoder holding both forms of the previous frame
+ * @return bool Whether the frame matched its decoded form
+ */
+static bool map_cobs_positions(rp_incremental_encoder_t *encoder)
+{
+    size_t position = 0;
+    size_t index = 0;
+
+    while (position < encoder->frame_size && encoder->frame[position] != COBS_DELIMITER_BYTE) {
+        uint8_t code = encoder->frame[position];
+
+        for (size_t i = 1; i < code; i++) {
+            if (index >= encoder->plain_size) {
+                return false;
+            }
+
+            encoder->cobs_position[index++] = (uint16_t)(position + i);
+        }
+
+        position += code;
+
+        // Blocks shorter than the maximum stand for a zero, except the last one
+        if (code < COBS_BLOCK_MAX_SIZE && position < encoder->frame_size &&
+            encoder->frame[position] != COBS_DELIMITER_BYTE) {
+            if (index >= encoder->plain_size) {
+                return false;
+            }
+
+            encoder->cobs_position[index++] = (uint16_t)position;
+        }
+    }
+
+    return index == encoder->plain_size;
+}
+
+/**
+ * Finds the spec members in a freshly encoded frame.
+ *
+ * @param encoder Encoder whose frame was just encoded with patchable options
+ * @param has_link_header Whether the frame starts with a link header
+ */
+static void learn_layout(rp_incremental_encoder_t *encoder, bool has_link_header)
+{
+    const rp_incremental_spec_t *spec = encoder->spec;
+    size_t header_size = has_link_header ? RP_LINK_HEADER_SIZE : 0;
+
+    cobs_result_t decoded = cobs_decode(encoder->frame, encoder->frame_size, encoder->plain,
+                                        sizeof(encoder->plain));
+
+    if (decoded.status != COBS_OK || decoded.written < header_size + CHECKSUM_SIZE) {
+        return;
+    }
+
+    encoder->plain_size = decoded.written;
+
+    if (!map_cobs_positions(encoder)) {
+        return;
+    }
+
+    size_t covered = encoder->plain_size - CHECKSUM_SIZE;
+
+    encoder->has_link_header = has_link_header;
+    encoder->header_shift_operator = crc16_ccitt_shift_operator(covered - header_size);
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        rp_incremental_slot_t *slot = &encoder->slots[i];
+        size_t position;
+        size_t size;
+
+        slot->position = RP_INCREMENTAL_ABSENT;
+
+        if (find_field(&encoder->plain[header_size], covered - header_size, &spec->fields[i],
+                       &position, &size)) {
+            slot->position = (uint16_t)(header_size + position);
+            slot->size = (uint8_t)size;
+            slot->shift_operator = crc16_ccitt_shift_operator(covered - slot->position - size);
+        }
+    }
+
+    encoder->has_layout = true;
+}
+
+/**
+ * @param data Buffer holding the varint
+ * @param size Bytes in the buffer
+ * @param offset Offset of the varint, advanced past it
+ * @param value Decoded value
+ * @return bool False if the varint is truncated or longer than 10 bytes
+ */
+static bool read_varint(const uint8_t *data, size_t size, size_t *offset, uint64_t *value)
+{
+    *value = 0;
+
+    for (size_t shift = 0; shift < 64; shift += 7) {
+        if (*offset >= size) {
+            return false;
+        }
+
+        uint8_t byte = data[(*offset)++];
+
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Locates the value of a spec member in a protobuf encoding, following `field->tags`
+ * through the enclosing submessages.
+ *
+ * @param payload Protobuf encoding of the message
+ * @param payload_size Bytes in the encoding
+ * @param field Member to find
+ * @param position Offset of the value in the payload
+ * @param size Bytes of the value
+ * @return bool False if the member is not encoded exactly once
+ */
+static bool find_field(const uint8_t *payload, size_t payload_size,
+                       const rp_incremental_field_t *field, size_t *position, size_t *size)
+{
+    static const uint8_t wire_types[] = {
+        [RP_INCREMENTAL_VARINT] = WIRE_VARINT,
+        [RP_INCREMENTAL_FIXED32] = WIRE_FIXED32,
+        [RP_INCREMENTAL_FIXED64] = WIRE_FIXED64,
+    };
+
+    size_t start = 0;
+    size_t end = payload_size;
+
+    for (size_t depth = 0; depth < field->depth; depth++) {
+        bool last = (depth + 1 == field->depth);
+        bool found = false;
+        size_t found_start = 0;
+        size_t found_end = 0;
+        size_t offset = start;
+
+        while (offset < end) {
+            uint64_t key;
+            uint64_t length;
+
+            if (!read_varint(payload, end, &offset, &key)) {
+                return false;
+            }
+
+            uint8_t wire = key & 0x07;
+            size_t value_start = offset;
+
+            switch (wire) {
+            case WIRE_VARINT:
+                if (!read_varint(payload, end, &offset, &length)) {
+                    return false;
+                }
+                break;
+            case WIRE_FIXED64:
+                offset += 8;
+                break;
+            case WIRE_FIXED32:
+                offset += 4;
+                break;
+            case WIRE_LENGTH_DELIMITED:
+                if (!read_varint(payload, end, &offset, &length) || length > end - offset) {
+                    return false;
+                }
+                value_start = offset;
+                offset += (size_t)length;
+                break;
+            default:
+                return false;
+            }
+
+            if (offset > end) {
+                return false;
+            }
+
+            if ((key >> 3) != field->tags[depth]) {
+                continue;
+            }
+
+            // Repeated occurrences are merged by the receiver, patching one is not enough
+            if (found || wire != (last ? wire_types[field->wire] : WIRE_LENGTH_DELIMITED)) {
+                return false;
+            }
+
+            found = true;
+            found_start = value_start;
+            found_end = offset;
+        }
+
+        if (!found) {
+            return false;
+        }
+
+        start = found_start;
+        end = found_end;
+    }
+
+    *position = start;
+    *size = end - start;
+
+    return true;
+}
@@ -0,0 +1,430 @@
+#include "rp/interleave/interleave.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+#include "rp/crc/crc.h"
+#include "rp/fec/rs.h"
+
+/*
+ * A block of `r` packets is sent as `r` frames. Each frame is COBS encoded on its own,
+ * at most `RP_PACKET_MAX_SIZE` bytes with its delimiter, and carries:
+ *
+ *     sequence                  block sequence, wraps around
+ *     (r - 1) << 4 | index      packets in the block, frame number within it
+ *     size of each packet       r bytes, COBS decoded
+ *     CRC-16 of the above       LE, so a damaged header cannot misplace bytes
+ *     payload                   c * r bytes
+ *
+ * where `c = ceil(largest packet / r)`. Frame `j` carries byte `k * r + j` of packet `i`
+ * at `payload[k * r + i]`, or 0 past the end of the packet. Consecutive payload bytes
+ * belong to different packets, so a fade of `b` bytes costs each packet `ceil(b / r)`.
+ *
+ * The payload is not covered by the header CRC: damaged bytes are left for the packets'
+ * own Reed-Solomon parity to correct, and so are the bytes of lost frames.
+ */
+
+#define HEADER_CHECKSUM_SIZE (2)
+
+// Blocks this far behind are late frames, further ones a sender restart
+#define LATE_WINDOW (16)
+
+// A packet COBS encoded again, with its delimiter
+#define ROW_ENCODED_MAX_SIZE (RP_INTERLEAVE_ROW_MAX_SIZE + RP_INTERLEAVE_ROW_MAX_SIZE / 254 + 2)
+
+static size_t column_count(const uint8_t *row_sizes, size_t row_count);
+static bool header_valid(const uint8_t *body, size_t body_size);
+static bool is_late(uint8_t sequence, uint8_t reference, bool same_is_late);
+static void correct_erasures(rp_deinterleaver_t *deinterleaver, size_t row);
+static rp_interleave_status_t deliver(rp_deinterleaver_t *deinterleaver);
+
+/**
+ * Initializes the sending end.
+ *
+ * @param interleaver Interleaver to initialize
+ * @param depth Packets per block, 1 to `RP_INTERLEAVE_MAX_DEPTH`. Each step of depth
+ * spreads a fade thinner and delays packets by one more packet period
+ * @param sink Receives the frames to transmit
+ * @param context Passed to every call of the sink
+ * @return rp_interleave_status_t Status
+ */
+rp_interleave_status_t rp_interleaver_init(rp_interleaver_t *interleaver, size_t depth,
+                                           rp_interleave_sink_t sink, void *context)
+{
+    if (interleaver == NULL || sink == NULL) {
+        return RP_INTERLEAVE_NULL_POINTER;
+    }
+
+    if (depth == 0 || depth > RP_INTERLEAVE_MAX_DEPTH) {
+        return RP_INTERLEAVE_INVALID_ARGUMENT;
+    }
+
+    interleaver->sink = sink;
+    interleaver->context = context;
+    interleaver->depth = (uint8_t)depth;
+    interleaver->sequence = 0;
+    interleaver->row_count = 0;
+
+    return RP_INTERLEAVE_OK;
+}
+
+/**
+ * Adds a packet to the block, and sends the block once it holds `depth` packets.
+ *
+ * @param interleaver Interleaver
+ * @param packet Packet as written by the codec, COBS encoded with its delimiter
+ * @param packet_size Size of the packet
+ * @return rp_interleave_status_t Status, `RP_INTERLEAVE_BAD_PACKET` if the packet is more
+ * than `RP_INTERLEAVE_PACKET_MAX_SIZE(depth)` bytes COBS decoded
+ */
+rp_interleave_status_t rp_interleaver_push(rp_interleaver_t *interleaver, const uint8_t *packet,
+                                           size_t packet_size)
+{
+    if (interleaver == NULL || packet == NULL) {
+        return RP_INTERLEAVE_NULL_POINTER;
+    }
+
+    uint8_t *row = interleaver->rows[interleaver->row_count];
+    cobs_result_t decoded =
+        cobs_decode(packet, packet_size, row, RP_INTERLEAVE_PACKET_MAX_SIZE(interleaver->depth));
+
+    if (decoded.status != COBS_OK || decoded.written == 0) {
+        return RP_INTERLEAVE_BAD_PACKET;
+    }
+
+    interleaver->row_sizes[interleaver->row_count++] = (uint8_t)decoded.written;
+
+    if (interleaver->row_count < interleaver->depth) {
+        return RP_INTERLEAVE_OK;
+    }
+
+    return rp_interleaver_flush(interleaver);
+}
+
+/**
+ * Sends the packets collected so far as a shorter block.
+ *
+ * @param interleaver Interleaver
+ * @return rp_interleave_status_t Status, `RP_INTERLEAVE_OK` if there was nothing to send
+ */
+rp_interleave_status_t rp_interleaver_flush(rp_interleaver_t *interleaver)
+{
+    if (interleaver == NULL) {
+        return RP_INTERLEAVE_NULL_POINTER;
+    }
+
+    size_t row_count = interleaver->row_count;
+
+    if (row_count == 0) {
+        return RP_INTERLEAVE_OK;
+    }
+
+    size_t columns = column_count(interleaver->row_sizes, row_count);
+    size_t header_size = RP_INTERLEAVE_HEADER_SIZE(row_count);
+    uint8_t body[RP_INTERLEAVE_BODY_MAX_SIZE];
+    uint8_t frame[RP_INTERLEAVE_FRAME_MAX_SIZE];
+    rp_interleave_status_t status = RP_INTERLEAVE_OK;
+
+    body[0] = interleaver->sequence;
+    memcpy(&body[2], interleaver->row_sizes, row_count);
+
+    for (size_t j = 0; j < row_count && status == RP_INTERLEAVE_OK; j++) {
+        body[1] = (uint8_t)(((row_count - 1) << 4) | j);
+
+        uint16_t checksum = crc16_ccitt(body, header_size - HEADER_CHECKSUM_SIZE);
+
+        body[header_size - 2] = (checksum >> 0) & 0xFF;
+        body[header_size - 1] = (checksum >> 8) & 0xFF;
+
+        uint8_t *payload = &body[header_size];
+
+        for (size_t k = 0; k < columns; k++) {
+            size_t position = k * row_count + j;
+
+            for (size_t i = 0; i < row_count; i++) {
+                payload[k * row_count + i] = (position < interleaver->row_sizes[i])
+                                                 ? interleaver->rows[i][position]
+                                                 : 0;
+            }
+        }
+
+        cobs_result_t encoded =
+            cobs_encode(body, header_size + columns * row_count, frame, sizeof(frame));
+
+        if (encoded.status != COBS_OK ||
+            !interleaver->sink(interleaver->context, frame, encoded.written)) {
+            status = RP_INTERLEAVE_SINK_FAILED;
+        }
+    }
+
+    interleaver->sequence++;
+    interleaver->row_count = 0;
+
+    return status;
+}
+
+/**
+ * Initializes the receiving end. The block size is read from the frames, so it does not
+ * need to match the sender's depth.
+ *
+ * @param deinterleaver Deinterleaver to initialize
+ * @param fec Reed-Solomon code of the packets, to correct the bytes of lost frames as
+ * erasures, or NULL
+ * @param sink Receives the packets, ready for the codec
+ * @param context Passed to every call of the sink
+ */
+void rp_deinterleaver_init(rp_deinterleaver_t *deinterleaver, const rs_codec_t *fec,
+                           rp_interleave_sink_t sink, void *context)
+{
+    if (deinterleaver == NULL) {
+        return;
+    }
+
+    memset(deinterleaver, 0, sizeof(*deinterleaver));
+    deinterleaver->fec = fec;
+    deinterleaver->sink = sink;
+    deinterleaver->context = context;
+}
+
+/**
+ * Places the bytes of a received frame, and delivers the packets of a block once all its
+ * frames are in, or before starting a newer block.
+ *
+ * @param deinterleaver Deinterleaver
+ * @param frame Frame from the deframer, COBS encoded
+ * @param frame_size Size of the frame
+ * @return rp_interleave_status_t Status, the frame is dropped unless `RP_INTERLEAVE_OK`
+ * or `RP_INTERLEAVE_SINK_FAILED`
+ */
+rp_interleave_status_t rp_deinterleaver_push(rp_deinterleaver_t *deinterleaver,
+                                             const uint8_t *frame, size_t frame_size)
+{
+    if (deinterleaver == NULL || frame == NULL || deinterleaver->sink == NULL) {
+        return RP_INTERLEAVE_NULL_POINTER;
+    }
+
+    uint8_t body[RP_INTERLEAVE_BODY_MAX_SIZE];
+    cobs_result_t decoded = cobs_decode(frame, frame_size, body, sizeof(body));
+
+    if (decoded.status != COBS_OK || !header_valid(body, decoded.written)) {
+        deinterleaver->rejected++;
+        return RP_INTERLEAVE_BAD_FRAME;
+    }
+
+    uint8_t sequence = body[0];
+    size_t row_count = (size_t)(body[1] >> 4) + 1;
+    size_t index = body[1] & 0x0F;
+    size_t header_size = RP_INTERLEAVE_HEADER_SIZE(row_count);
+    size_t columns = (decoded.written - header_size) / row_count;
+    rp_interleave_status_t status = RP_INTERLEAVE_OK;
+
+    if (deinterleaver->started && sequence != deinterleaver->sequence) {
+        if (is_late(sequence, deinterleaver->sequence, false)) {
+            deinterleaver->rejected++;
+            return RP_INTERLEAVE_LATE;
+        }
+
+        status = deliver(deinterleaver);
+    } else if (!deinterleaver->started && deinterleaver->has_last &&
+               is_late(sequence, deinterleaver->last_sequence, true)) {
+        deinterleaver->rejected++;
+        return RP_INTERLEAVE_LATE;
+    }
+
+    if (!deinterleaver->started) {
+        deinterleaver->started = true;
+        deinterleaver->sequence = sequence;
+        deinterleaver->row_count = (uint8_t)row_count;
+        deinterleaver->column_count = (uint8_t)columns;
+        deinterleaver->received = 0;
+        memcpy(deinterleaver->row_sizes, &body[2], row_count);
+
+        for (size_t i = 0; i < row_count; i++) {
+            memset(deinterleaver->rows[i], 0, deinterleaver->row_sizes[i]);
+        }
+    } else if (row_count != deinterleaver->row_count ||
+               columns != deinterleaver->column_count ||
+               memcmp(deinterleaver->row_sizes, &body[2], row_count) != 0) {
+        // Same sequence, different block: only a damaged header gets here
+        deinterleaver->rejected++;
+        return RP_INTERLEAVE_BAD_FRAME;
+    }
+
+    if ((deinterleaver->received & (1U << index)) != 0) {
+        return status;
+    }
+
+    const uint8_t *payload = &body[header_size];
+
+    for (size_t k = 0; k < columns; k++) {
+        size_t position = k * row_count + index;
+
+        for (size_t i = 0; i < row_count; i++) {
+            if (position < deinterleaver->row_sizes[i]) {
+                deinterleaver->rows[i][position] = payload[k * row_count + i];
+            }
+        }
+    }
+
+    deinterleaver->received |= 1U << index;
+    deinterleaver->frames++;
+
+    if (deinterleaver->received == (1U << row_count) - 1) {
+        rp_interleave_status_t delivered = deliver(deinterleaver);
+
+        if (status == RP_INTERLEAVE_OK) {
+            status = delivered;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Delivers the block being collected with the frames received so far, e.g. when frames
+ * stop coming and its last frames are presumed lost.
+ *
+ * @param deinterleaver Deinterleaver
+ * @return rp_interleave_status_t Status
+ */
+rp_interleave_status_t rp_deinterleaver_flush(rp_deinterleaver_t *deinterleaver)
+{
+    if (deinterleaver == NULL || deinterleaver->sink == NULL) {
+        return RP_INTERLEAVE_NULL_POINTER;
+    }
+
+    if (!deinterleaver->started) {
+        return RP_INTERLEAVE_OK;
+    }
+
+    return deliver(deinterleaver);
+}
+
+/**
+ * Bytes of each packet per frame, for the largest packet of the block to fit.
+ */
+static size_t column_count(const uint8_t *row_sizes, size_t row_count)
+{
+    size_t largest = 0;
+
+    for (size_t i = 0; i < row_count; i++) {
+        if (row_sizes[i] > largest) {
+            largest = row_sizes[i];
+        }
+    }
+
+    return (largest + row_count - 1) / row_count;
+}
+
+/**
+ * Checks the header checksum, and that the payload is the size the header implies.
+ */
+static bool header_valid(const uint8_t *body, size_t body_size)
+{
+    if (body_size < RP_INTERLEAVE_HEADER_SIZE(1)) {
+        return false;
+    }
+
+    size_t row_count = (size_t)(body[1] >> 4) + 1;
+    size_t index = body[1] & 0x0F;
+    size_t header_size = RP_INTERLEAVE_HEADER_SIZE(row_count);
+
+    if (index >= row_count || body_size < header_size) {
+        return false;
+    }
+
+    uint16_t checksum = (uint16_t)(body[header_size - 2] | (body[header_size - 1] << 8));
+
+    if (crc16_ccitt(body, header_size - HEADER_CHECKSUM_SIZE) != checksum) {
+        return false;
+    }
+
+    for (size_t i = 0; i < row_count; i++) {
+        if (body[2 + i] == 0 || body[2 + i] > RP_INTERLEAVE_ROW_MAX_SIZE) {
+            return false;
+        }
+    }
+
+    return body_size - header_size == column_count(&body[2], row_count) * row_count;
+}
+
+/**
+ * Whether a block is at most `LATE_WINDOW` blocks behind `reference`, the sequence
+ * wrapping around.
+ */
+static bool is_late(uint8_t sequence, uint8_t reference, bool same_is_late)
+{
+    uint8_t behind = (uint8_t)(reference - sequence);
+
+    return (behind == 0) ? same_is_late : behind <= LATE_WINDOW;
+}
+
+/**
+ * Corrects a packet with the bytes of the frames lost as erasures. A packet that cannot be
+ * corrected is left for the codec to reject.
+ */
+static void correct_erasures(rp_deinterleaver_t *deinterleaver, size_t row)
+{
+    size_t erasures[RS_MAX_PARITY];
+    size_t erasure_count = 0;
+    size_t row_size = deinterleaver->row_sizes[row];
+    size_t parity_size = deinterleaver->fec->parity_size;
+
+    for (size_t position = 0; position < row_size; position++) {
+        if (((deinterleaver->received >> (position % deinterleaver->row_count)) & 1) != 0) {
+            continue;
+        }
+
+        if (erasure_count == parity_size) {
+            return;
+        }
+
+        erasures[erasure_count++] = position;
+    }
+
+    rs_result_t result = rs_decode_erasures(deinterleaver->fec, deinterleaver->rows[row],
+                                            row_size, erasures, erasure_count);
+
+    if (result.status == RS_OK) {
+        deinterleaver->corrected += (uint32_t)result.corrected;
+    }
+}
+
+/**
+ * Hands the packets of the block being collected to the sink, COBS encoded again.
+ */
+static rp_interleave_status_t deliver(rp_deinterleaver_t *deinterleaver)
+{
+    uint8_t packet[ROW_ENCODED_MAX_SIZE];
+    rp_interleave_status_t status = RP_INTERLEAVE_OK;
+    size_t row_count = deinterleaver->row_count;
+
+    for (size_t i = 0; i < row_count; i++) {
+        deinterleaver->lost += ((deinterleaver->received >> i) & 1) == 0;
+    }
+
+    for (size_t i = 0; i < row_count && status == RP_INTERLEAVE_OK; i++) {
+        if (deinterleaver->fec != NULL &&
+            deinterleaver->received != (1U << row_count) - 1) {
+            correct_erasures(deinterleaver, i);
+        }
+
+        cobs_result_t encoded = cobs_encode(deinterleaver->rows[i], deinterleaver->row_sizes[i],
+                                            packet, sizeof(packet));
+
+        if (encoded.status != COBS_OK ||
+            !deinterleaver->sink(deinterleaver->context, packet, encoded.written)) {
+            status = RP_INTERLEAVE_SINK_FAILED;
+        }
+    }
+
+    deinterleaver->started = false;
+    deinterleaver->has_last = true;
+    deinterleaver->last_sequence = deinterleaver->sequence;
+    deinterleaver->blocks++;
+
+    return status;
+}
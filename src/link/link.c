@@ -0,0 +1,256 @@
+#include "rp/link/link.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+static void record_timing(rp_link_stats_t *stats, const rp_link_header_t *header,
+                          uint32_t now_us);
+static size_t bucket_index(uint32_t value_us);
+
+/**
+ * Serializes a link header as little endian.
+ *
+ * @param header Header to serialize
+ * @param buffer Output, at least `RP_LINK_HEADER_SIZE` bytes
+ */
+void rp_link_header_write(const rp_link_header_t *header, uint8_t *buffer)
+{
+    buffer[0] = (header->sequence >> 0) & 0xFF;
+    buffer[1] = (header->sequence >> 8) & 0xFF;
+    buffer[2] = (header->timestamp_us >> 0) & 0xFF;
+    buffer[3] = (header->timestamp_us >> 8) & 0xFF;
+    buffer[4] = (header->timestamp_us >> 16) & 0xFF;
+    buffer[5] = (header->timestamp_us >> 24) & 0xFF;
+}
+
+/**
+ * Deserializes a link header written by `rp_link_header_write`.
+ *
+ * @param header Parsed header
+ * @param buffer Input, at least `RP_LINK_HEADER_SIZE` bytes
+ */
+void rp_link_header_read(rp_link_header_t *header, const uint8_t *buffer)
+{
+    header->sequence = (uint16_t)(buffer[0] | (buffer[1] << 8));
+    header->timestamp_us = (uint32_t)buffer[2] | ((uint32_t)buffer[3] << 8) |
+                           ((uint32_t)buffer[4] << 16) | ((uint32_t)buffer[5] << 24);
+}
+
+/**
+ * Initializes the sending side of a link.
+ *
+ * @param sender Sender state
+ * @param first_sequence Sequence number of the first frame
+ */
+void rp_link_sender_init(rp_link_sender_t *sender, uint16_t first_sequence)
+{
+    if (sender == NULL) {
+        return;
+    }
+
+    sender->next_sequence = first_sequence;
+}
+
+/**
+ * Stamps the next outgoing frame.
+ *
+ * @param sender Sender state
+ * @param now_us Current time of the sender clock
+ * @return rp_link_header_t Header to pass to the codec
+ */
+rp_link_header_t rp_link_sender_next(rp_link_sender_t *sender, uint32_t now_us)
+{
+    rp_link_header_t header = {
+        .sequence = sender->next_sequence,
+        .timestamp_us = now_us,
+    };
+
+    sender->next_sequence++;
+
+    return header;
+}
+
+/**
+ * Initializes the receiving side statistics of a link.
+ *
+ * @param stats Statistics to reset
+ */
+void rp_link_stats_init(rp_link_stats_t *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+}
+
+/**
+ * Accounts for a received frame.
+ *
+ * Sequence numbers are compared with serial number arithmetic, so the counter may
+ * wrap. A jump of more than `RP_LINK_MAX_DROPOUT` frames in either direction is
+ * taken as a sender restart rather than a huge loss. Duplicates and late frames are
+ * not counted as received and do not contribute to the timing histograms.
+ *
+ * @param stats Receiver statistics
+ * @param header Header decoded from the frame
+ * @param now_us Current time of the receiver clock
+ * @return rp_link_event_t How the frame relates to the ones before it
+ */
+rp_link_event_t rp_link_stats_update(rp_link_stats_t *stats, const rp_link_header_t *header,
+                                     uint32_t now_us)
+{
+    int16_t delta = (int16_t)(uint16_t)(header->sequence - stats->highest);
+    rp_link_event_t event;
+
+    if (!stats->started || delta > RP_LINK_MAX_DROPOUT || delta < -RP_LINK_MAX_DROPOUT) {
+        stats->started = true;
+        stats->highest = header->sequence;
+        stats->window = 1;
+        stats->resyncs++;
+
+        // Transit times across a restart are unrelated
+        stats->has_transit = false;
+
+        event = RP_LINK_RESYNC;
+    } else if (delta > 0) {
+        uint32_t missing = (uint32_t)delta - 1;
+
+        stats->window = (delta >= RP_LINK_WINDOW_SIZE) ? 0 : (stats->window << delta);
+        stats->window |= 1;
+        stats->highest = header->sequence;
+
+        if (missing > 0) {
+            stats->lost += missing;
+            stats->gaps++;
+            event = RP_LINK_GAP;
+        } else {
+            event = RP_LINK_IN_ORDER;
+        }
+    } else if (delta == 0) {
+        stats->duplicates++;
+        return RP_LINK_DUPLICATE;
+    } else if (-delta >= RP_LINK_WINDOW_SIZE) {
+        stats->late++;
+        return RP_LINK_LATE;
+    } else {
+        uint64_t bit = (uint64_t)1 << -delta;
+
+        if (stats->window & bit) {
+            stats->duplicates++;
+            return RP_LINK_DUPLICATE;
+        }
+
+        // The frame was counted as lost when the gap opened
+        stats->window |= bit;
+        stats->reordered++;
+
+        if (stats->lost > 0) {
+            stats->lost--;
+        }
+
+        event = RP_LINK_REORDERED;
+    }
+
+    stats->received++;
+
+    record_timing(stats, header, now_us);
+
+    return event;
+}
+
+/**
+ * Adds a sample to a histogram.
+ *
+ * @param histogram Histogram to update
+ * @param value_us Sample in microseconds
+ */
+void rp_link_histogram_add(rp_link_histogram_t *histogram, uint32_t value_us)
+{
+    if (histogram->samples == 0 || value_us < histogram->min_us) {
+        histogram->min_us = value_us;
+    }
+
+    if (value_us > histogram->max_us) {
+        histogram->max_us = value_us;
+    }
+
+    histogram->counts[bucket_index(value_us)]++;
+    histogram->samples++;
+    histogram->sum_us += value_us;
+}
+
+/**
+ * Estimates a percentile from a histogram.
+ *
+ * @param histogram Histogram to query
+ * @param percentile Percentile in [0, 100]
+ * @return uint32_t Upper bound of the bucket holding the percentile, capped to the
+ * largest sample, or 0 when the histogram is empty
+ */
+uint32_t rp_link_histogram_percentile(const rp_link_histogram_t *histogram, double percentile)
+{
+    if (histogram == NULL || histogram->samples == 0) {
+        return 0;
+    }
+
+    // Rank of the sample, counting from 1
+    uint64_t rank = (uint64_t)(percentile / 100.0 * (double)histogram->samples + 0.5);
+
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < RP_LINK_HISTOGRAM_BUCKETS - 1; i++) {
+        seen += histogram->counts[i];
+
+        if (seen >= rank) {
+            uint32_t upper = ((uint32_t)2 << i) - 1;
+
+            return (upper < histogram->max_us) ? upper : histogram->max_us;
+        }
+    }
+
+    return histogram->max_us;
+}
+
+static void record_timing(rp_link_stats_t *stats, const rp_link_header_t *header,
+                          uint32_t now_us)
+{
+    uint32_t transit = now_us - header->timestamp_us - (uint32_t)stats->clock_offset_us;
+
+    // Clock skew can make a frame appear to arrive before it was sent
+    uint32_t latency = ((int32_t)transit < 0) ? 0 : transit;
+
+    rp_link_histogram_add(&stats->latency, latency);
+
+    if (stats->has_transit) {
+        int32_t difference = (int32_t)(transit - stats->last_transit_us);
+        uint32_t magnitude = (difference < 0) ? (uint32_t)0 - (uint32_t)difference
+                                              : (uint32_t)difference;
+
+        rp_link_histogram_add(&stats->jitter, magnitude);
+
+        // J += (|D| - J) / 16
+        int64_t step = ((int64_t)magnitude - (int64_t)stats->jitter_us) / 16;
+        stats->jitter_us = (uint32_t)((int64_t)stats->jitter_us + step);
+    }
+
+    stats->last_transit_us = transit;
+    stats->has_transit = true;
+}
+
+static size_t bucket_index(uint32_t value_us)
+{
+    size_t index = 0;
+
+    while (value_us > 1 && index < RP_LINK_HISTOGRAM_BUCKETS - 1) {
+        value_us >>= 1;
+        index++;
+    }
+
+    return index;
+}
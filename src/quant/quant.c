@@ -0,0 +1,445 @@
+#include "rp/quant/quant.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct bit_writer {
+    uint8_t *buffer;
+    size_t capacity;
+    size_t bit_offset;
+} bit_writer_t;
+
+typedef struct bit_reader {
+    const uint8_t *buffer;
+    size_t size;
+    size_t bit_offset;
+} bit_reader_t;
+
+static bool field_present(const rp_quant_field_t *field, const uint8_t *message);
+static uint8_t field_bits(const rp_quant_field_t *field);
+static size_t bitmap_size(const rp_quant_spec_t *spec);
+static bool write_bits(bit_writer_t *writer, uint32_t value, uint8_t bits);
+static bool read_bits(bit_reader_t *reader, uint32_t *value, uint8_t bits);
+
+/**
+ * Converts to IEEE 754 binary16, rounding to nearest even. Values beyond the half range
+ * become infinity, NaN stays NaN.
+ *
+ * @param value Single precision value
+ * @return uint16_t Half precision bit pattern
+ */
+uint16_t rp_quant_half_from_float(float value)
+{
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        return (uint16_t)(sign | 0x7C00 | (mantissa != 0 ? 0x200 | (mantissa >> 13) : 0));
+    }
+
+    int32_t half_exponent = (int32_t)exponent - 127 + 15;
+
+    if (half_exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    if (half_exponent <= 0) {
+        // Subnormal half, anything below half the smallest one rounds to zero
+        if (half_exponent < -10) {
+            return (uint16_t)sign;
+        }
+
+        mantissa |= 0x800000;
+
+        uint32_t shift = (uint32_t)(14 - half_exponent);
+        uint32_t half_mantissa = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1U << shift) - 1);
+        uint32_t halfway = 1U << (shift - 1);
+
+        if (remainder > halfway || (remainder == halfway && (half_mantissa & 1))) {
+            half_mantissa++;
+        }
+
+        return (uint16_t)(sign | half_mantissa);
+    }
+
+    uint32_t half = sign | ((uint32_t)half_exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+
+    // A carry out of the mantissa correctly bumps the exponent, up to infinity
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+
+    return (uint16_t)half;
+}
+
+/**
+ * Converts IEEE 754 binary16 to single precision, exactly.
+ *
+ * @param half Half precision bit pattern
+ * @return float
+ */
+float rp_quant_half_to_float(uint16_t half)
+{
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        // Zero or subnormal, 2^-24 per mantissa step
+        float magnitude = (float)mantissa * 5.9604644775390625e-8f;
+
+        return (sign != 0) ? -magnitude : magnitude;
+    }
+
+    if (exponent == 0x1F) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+/**
+ * Maps a value to the nearest code of a scaled field. Values outside the range saturate
+ * and NaN maps to code 0.
+ *
+ * @param field Scaled field
+ * @param value Value to quantize
+ * @return uint32_t Code, below `2^bits`
+ */
+uint32_t rp_quant_scale(const rp_quant_field_t *field, float value)
+{
+    double max_code = (field->bits >= 32) ? 4294967295.0 : (double)((1ULL << field->bits) - 1);
+    double code = ((double)value - (double)field->min) / (double)field->resolution + 0.5;
+
+    // Also catches NaN
+    if (!(code >= 0.0)) {
+        return 0;
+    }
+
+    if (code >= max_code) {
+        return (uint32_t)max_code;
+    }
+
+    return (uint32_t)code;
+}
+
+/**
+ * @param field Scaled field
+ * @param code Code produced by `rp_quant_scale`
+ * @return float Value the code stands for
+ */
+float rp_quant_unscale(const rp_quant_field_t *field, uint32_t code)
+{
+    return (float)((double)field->min + (double)code * (double)field->resolution);
+}
+
+/**
+ * Checks that a spec describes floats inside its message and fits the limits.
+ *
+ * @param spec Spec to check
+ * @return bool
+ */
+bool rp_quant_spec_valid(const rp_quant_spec_t *spec)
+{
+    if (spec == NULL || spec->message == NULL || (spec->fields == NULL && spec->field_count > 0) ||
+        spec->field_count > RP_QUANT_MAX_FIELDS ||
+        spec->message_size > RP_QUANT_MAX_MESSAGE_SIZE) {
+        return false;
+    }
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_quant_field_t *field = &spec->fields[i];
+
+        if (field->offset + sizeof(float) > spec->message_size) {
+            return false;
+        }
+
+        if (field->present_offset != RP_QUANT_ALWAYS &&
+            field->present_offset + sizeof(bool) > spec->message_size) {
+            return false;
+        }
+
+        if (field->which_offset != RP_QUANT_ALWAYS &&
+            field->which_offset + sizeof(pb_size_t) > spec->message_size) {
+            return false;
+        }
+
+        if (field->kind == RP_QUANT_SCALED &&
+            (field->bits == 0 || field->bits > 32 || !(field->resolution > 0.0f))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @param spec Valid spec
+ * @return size_t Block size with every field present
+ */
+size_t rp_quant_max_block_size(const rp_quant_spec_t *spec)
+{
+    size_t bits = 0;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        bits += field_bits(&spec->fields[i]);
+    }
+
+    return bitmap_size(spec) + (bits + 7) / 8;
+}
+
+/**
+ * Moves the reduced-precision fields of a message into a block and zeroes them in the
+ * message, so that protobuf leaves them out of the encoding (proto3 skips zero scalars).
+ *
+ * The block is a presence bitmap, one bit per spec field (LSB first), followed by the
+ * codes of the present fields in spec order, packed LSB first and padded to a byte.
+ *
+ * @param spec Quantization spec
+ * @param message Message struct, modified in place
+ * @param block Output for the block
+ * @param capacity Size of the block output
+ * @return rp_quant_result_t
+ */
+rp_quant_result_t rp_quant_pack(const rp_quant_spec_t *spec, void *message, uint8_t *block,
+                                size_t capacity)
+{
+    rp_quant_result_t result = {
+        .status = RP_QUANT_OK,
+        .size = 0,
+    };
+
+    if (spec == NULL || message == NULL || block == NULL) {
+        result.status = RP_QUANT_NULL_POINTER;
+        return result;
+    }
+
+    if (!rp_quant_spec_valid(spec)) {
+        result.status = RP_QUANT_INVALID_SPEC;
+        return result;
+    }
+
+    size_t map_size = bitmap_size(spec);
+
+    if (capacity < map_size) {
+        result.status = RP_QUANT_OVERFLOW;
+        return result;
+    }
+
+    memset(block, 0, map_size);
+
+    bit_writer_t writer = {
+        .buffer = &block[map_size],
+        .capacity = capacity - map_size,
+        .bit_offset = 0,
+    };
+
+    uint8_t *bytes = message;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_quant_field_t *field = &spec->fields[i];
+
+        if (!field_present(field, bytes)) {
+            continue;
+        }
+
+        float value;
+
+        memcpy(&value, &bytes[field->offset], sizeof(value));
+
+        uint32_t code = (field->kind == RP_QUANT_HALF) ? rp_quant_half_from_float(value)
+                                                       : rp_quant_scale(field, value);
+
+        if (!write_bits(&writer, code, field_bits(field))) {
+            result.status = RP_QUANT_OVERFLOW;
+            return result;
+        }
+
+        block[i / 8] |= (uint8_t)(1U << (i % 8));
+        memset(&bytes[field->offset], 0, sizeof(float));
+    }
+
+    result.size = map_size + (writer.bit_offset + 7) / 8;
+
+    return result;
+}
+
+/**
+ * Reads a block written by `rp_quant_pack`.
+ *
+ * @param spec Quantization spec
+ * @param block Block, possibly followed by other data
+ * @param size Bytes available
+ * @param values Output for the decoded values
+ * @return rp_quant_result_t Bytes consumed on success
+ */
+rp_quant_result_t rp_quant_unpack(const rp_quant_spec_t *spec, const uint8_t *block, size_t size,
+                                  rp_quant_values_t *values)
+{
+    rp_quant_result_t result = {
+        .status = RP_QUANT_OK,
+        .size = 0,
+    };
+
+    if (spec == NULL || block == NULL || values == NULL) {
+        result.status = RP_QUANT_NULL_POINTER;
+        return result;
+    }
+
+    if (!rp_quant_spec_valid(spec)) {
+        result.status = RP_QUANT_INVALID_SPEC;
+        return result;
+    }
+
+    size_t map_size = bitmap_size(spec);
+
+    if (size < map_size) {
+        result.status = RP_QUANT_TRUNCATED;
+        return result;
+    }
+
+    bit_reader_t reader = {
+        .buffer = &block[map_size],
+        .size = size - map_size,
+        .bit_offset = 0,
+    };
+
+    values->present = 0;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        const rp_quant_field_t *field = &spec->fields[i];
+        uint32_t code;
+
+        if ((block[i / 8] & (1U << (i % 8))) == 0) {
+            continue;
+        }
+
+        if (!read_bits(&reader, &code, field_bits(field))) {
+            result.status = RP_QUANT_TRUNCATED;
+            return result;
+        }
+
+        values->present |= 1UL << i;
+        values->values[i] = (field->kind == RP_QUANT_HALF) ? rp_quant_half_to_float((uint16_t)code)
+                                                           : rp_quant_unscale(field, code);
+    }
+
+    result.size = map_size + (reader.bit_offset + 7) / 8;
+
+    return result;
+}
+
+/**
+ * Stores unpacked values into a decoded message.
+ *
+ * @param spec Quantization spec
+ * @param values Values from `rp_quant_unpack`
+ * @param message Message struct
+ */
+void rp_quant_apply(const rp_quant_spec_t *spec, const rp_quant_values_t *values, void *message)
+{
+    uint8_t *bytes = message;
+
+    for (size_t i = 0; i < spec->field_count; i++) {
+        if (values->present & (1UL << i)) {
+            memcpy(&bytes[spec->fields[i].offset], &values->values[i], sizeof(float));
+        }
+    }
+}
+
+static bool field_present(const rp_quant_field_t *field, const uint8_t *message)
+{
+    if (field->which_offset != RP_QUANT_ALWAYS) {
+        pb_size_t which;
+
+        memcpy(&which, &message[field->which_offset], sizeof(which));
+
+        if (which != field->which_tag) {
+            return false;
+        }
+    }
+
+    if (field->present_offset != RP_QUANT_ALWAYS) {
+        bool present;
+
+        memcpy(&present, &message[field->present_offset], sizeof(present));
+
+        if (!present) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static uint8_t field_bits(const rp_quant_field_t *field)
+{
+    return (field->kind == RP_QUANT_HALF) ? 16 : field->bits;
+}
+
+static size_t bitmap_size(const rp_quant_spec_t *spec)
+{
+    return (spec->field_count + 7) / 8;
+}
+
+static bool write_bits(bit_writer_t *writer, uint32_t value, uint8_t bits)
+{
+    if (writer->bit_offset + bits > writer->capacity * 8) {
+        return false;
+    }
+
+    // Fill the current byte, then whole bytes
+    while (bits > 0) {
+        size_t byte = writer->bit_offset / 8;
+        uint8_t shift = (uint8_t)(writer->bit_offset % 8);
+        uint8_t count = (uint8_t)((8 - shift < bits) ? 8 - shift : bits);
+        uint8_t chunk = (uint8_t)((value & ((1U << count) - 1)) << shift);
+
+        writer->buffer[byte] = (shift == 0) ? chunk : (uint8_t)(writer->buffer[byte] | chunk);
+
+        value >>= count;
+        bits -= count;
+        writer->bit_offset += count;
+    }
+
+    return true;
+}
+
+static bool read_bits(bit_reader_t *reader, uint32_t *value, uint8_t bits)
+{
+    if (reader->bit_offset + bits > reader->size * 8) {
+        return false;
+    }
+
+    uint8_t done = 0;
+
+    *value = 0;
+
+    while (done < bits) {
+        size_t byte = reader->bit_offset / 8;
+        uint8_t shift = (uint8_t)(reader->bit_offset % 8);
+        uint8_t count = (uint8_t)((8 - shift < bits - done) ? 8 - shift : bits - done);
+        uint32_t chunk = (uint32_t)(reader->buffer[byte] >> shift) & ((1U << count) - 1);
+
+        *value |= chunk << done;
+        done += count;
+        reader->bit_offset += count;
+    }
+
+    return true;
+}
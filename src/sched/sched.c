@@ -0,0 +1,338 @@
+#include "rp/sched/sched.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define MILLI (1000)
+#define FRACTION_BITS (16)
+#define NEVER (UINT64_MAX)
+
+static void advance(rp_sched_t *sched, uint32_t now_ms);
+static void allocate(rp_sched_t *sched);
+static uint32_t interpolate(uint32_t from, uint32_t to, uint64_t fraction);
+static uint64_t period_us(uint32_t rate_mhz);
+
+/**
+ * Initializes a scheduler that spreads a link budget over periodic messages.
+ *
+ * Each stream is a message type sent at a rate between its minimum and maximum. The
+ * rates are chosen so that, with the encoded size of each message, the streams use the
+ * whole budget: all streams move together from their minimum through their target to
+ * their maximum rate as the budget grows. Below the sum of the minimum rates every
+ * stream is slowed down in proportion. A token bucket refilled at the budget keeps
+ * bursts below `burst_bytes`.
+ *
+ * @param sched Scheduler to initialize
+ * @param configs Rates of each stream, in priority order
+ * @param stream_count Number of streams, at most `RP_SCHED_MAX_STREAMS`
+ * @param budget_bytes_per_s Sustained link throughput
+ * @param burst_bytes Largest burst, at least the largest frame
+ * @return rp_sched_status_t
+ */
+rp_sched_status_t rp_sched_init(rp_sched_t *sched, const rp_sched_stream_config_t *configs,
+                                size_t stream_count, uint32_t budget_bytes_per_s,
+                                uint32_t burst_bytes)
+{
+    if (sched == NULL || configs == NULL) {
+        return RP_SCHED_NULL_POINTER;
+    }
+
+    if (stream_count == 0 || stream_count > RP_SCHED_MAX_STREAMS || burst_bytes == 0) {
+        return RP_SCHED_INVALID_ARGUMENT;
+    }
+
+    for (size_t i = 0; i < stream_count; i++) {
+        if (configs[i].min_mhz > configs[i].target_mhz ||
+            configs[i].target_mhz > configs[i].max_mhz || configs[i].max_mhz == 0) {
+            return RP_SCHED_INVALID_ARGUMENT;
+        }
+    }
+
+    memset(sched, 0, sizeof(*sched));
+
+    for (size_t i = 0; i < stream_count; i++) {
+        sched->streams[i].config = configs[i];
+    }
+
+    sched->stream_count = stream_count;
+    sched->budget_bytes_per_s = budget_bytes_per_s;
+    sched->burst_bytes = burst_bytes;
+    sched->tokens = (uint64_t)burst_bytes * MILLI;
+    sched->stale = true;
+
+    return RP_SCHED_OK;
+}
+
+/**
+ * Changes the link budget, e.g. after the radio reported a different data rate or the
+ * measured throughput dropped. Rates are reallocated on the next decision.
+ *
+ * @param sched Scheduler
+ * @param budget_bytes_per_s Sustained link throughput
+ * @return rp_sched_status_t
+ */
+rp_sched_status_t rp_sched_set_budget(rp_sched_t *sched, uint32_t budget_bytes_per_s)
+{
+    if (sched == NULL) {
+        return RP_SCHED_NULL_POINTER;
+    }
+
+    sched->budget_bytes_per_s = budget_bytes_per_s;
+    sched->stale = true;
+
+    return RP_SCHED_OK;
+}
+
+/**
+ * Sets the encoded size of a stream's frames before any has been sent, typically the
+ * `written` result of encoding a representative message.
+ *
+ * @param sched Scheduler
+ * @param stream Index of the stream
+ * @param size Bytes of one frame on the wire
+ * @return rp_sched_status_t
+ */
+rp_sched_status_t rp_sched_set_size(rp_sched_t *sched, size_t stream, size_t size)
+{
+    if (sched == NULL) {
+        return RP_SCHED_NULL_POINTER;
+    }
+
+    if (stream >= sched->stream_count) {
+        return RP_SCHED_INVALID_ARGUMENT;
+    }
+
+    if (sched->streams[stream].size != size) {
+        sched->streams[stream].size = size;
+        sched->stale = true;
+    }
+
+    return RP_SCHED_OK;
+}
+
+/**
+ * Picks the stream to encode and send next.
+ *
+ * The stream that has been due the longest is chosen, ties going to the first stream.
+ * Nothing is returned while its frame would overrun the token bucket, so smaller frames
+ * cannot starve larger ones.
+ *
+ * @param sched Scheduler
+ * @param now_ms Current time
+ * @return size_t Index of the stream, or `RP_SCHED_NONE` if nothing may be sent now
+ */
+size_t rp_sched_next(rp_sched_t *sched, uint32_t now_ms)
+{
+    if (sched == NULL) {
+        return RP_SCHED_NONE;
+    }
+
+    advance(sched, now_ms);
+
+    if (sched->stale) {
+        allocate(sched);
+    }
+
+    size_t best = RP_SCHED_NONE;
+
+    for (size_t i = 0; i < sched->stream_count; i++) {
+        const rp_sched_stream_t *stream = &sched->streams[i];
+
+        if (stream->due_us > sched->now_us) {
+            continue;
+        }
+
+        if (best == RP_SCHED_NONE || stream->due_us < sched->streams[best].due_us) {
+            best = i;
+        }
+    }
+
+    if (best == RP_SCHED_NONE) {
+        return RP_SCHED_NONE;
+    }
+
+    uint64_t capacity = (uint64_t)sched->burst_bytes * MILLI;
+    uint64_t cost = (uint64_t)sched->streams[best].size * MILLI;
+
+    return (sched->tokens >= (cost < capacity ? cost : capacity)) ? best : RP_SCHED_NONE;
+}
+
+/**
+ * Records a frame of a stream handed to the link, scheduled or not. A frame sent ahead
+ * of time, e.g. `SystemStatus` on a state change, restarts the stream's period.
+ *
+ * @param sched Scheduler
+ * @param stream Index of the stream
+ * @param size Exact encoded size of the frame
+ * @param now_ms Current time
+ * @return rp_sched_status_t
+ */
+rp_sched_status_t rp_sched_sent(rp_sched_t *sched, size_t stream, size_t size, uint32_t now_ms)
+{
+    if (sched == NULL) {
+        return RP_SCHED_NULL_POINTER;
+    }
+
+    if (stream >= sched->stream_count) {
+        return RP_SCHED_INVALID_ARGUMENT;
+    }
+
+    rp_sched_consume(sched, size, now_ms);
+
+    rp_sched_stream_t *state = &sched->streams[stream];
+
+    if (state->size != size) {
+        state->size = size;
+        sched->stale = true;
+    }
+
+    state->sent++;
+    state->sent_bytes += size;
+
+    uint64_t period = period_us(state->rate_mhz);
+
+    if (period == NEVER) {
+        state->due_us = NEVER;
+    } else if (state->due_us <= sched->now_us) {
+        // On schedule, keep the phase unless the stream fell a whole period behind
+        state->due_us += period;
+
+        if (state->due_us < sched->now_us) {
+            state->due_us = sched->now_us;
+        }
+    } else {
+        state->due_us = sched->now_us + period;
+    }
+
+    return RP_SCHED_OK;
+}
+
+/**
+ * Takes bytes sent outside the scheduled streams, such as command acknowledgements, from
+ * the token bucket.
+ *
+ * @param sched Scheduler
+ * @param size Bytes handed to the link
+ * @param now_ms Current time
+ */
+void rp_sched_consume(rp_sched_t *sched, size_t size, uint32_t now_ms)
+{
+    if (sched == NULL) {
+        return;
+    }
+
+    advance(sched, now_ms);
+
+    uint64_t cost = (uint64_t)size * MILLI;
+
+    sched->tokens = (sched->tokens > cost) ? sched->tokens - cost : 0;
+}
+
+/**
+ * Moves the scheduler clock to `now_ms` and refills the token bucket. The 32-bit
+ * millisecond clock may wrap around between calls.
+ *
+ * @param sched Scheduler
+ * @param now_ms Current time
+ */
+static void advance(rp_sched_t *sched, uint32_t now_ms)
+{
+    if (!sched->started) {
+        sched->started = true;
+        sched->last_ms = now_ms;
+        return;
+    }
+
+    uint32_t elapsed_ms = now_ms - sched->last_ms;
+    uint64_t capacity = (uint64_t)sched->burst_bytes * MILLI;
+
+    sched->last_ms = now_ms;
+    sched->now_us += (uint64_t)elapsed_ms * MILLI;
+    sched->tokens += (uint64_t)elapsed_ms * sched->budget_bytes_per_s;
+
+    if (sched->tokens > capacity) {
+        sched->tokens = capacity;
+    }
+}
+
+/**
+ * Chooses the rate of every stream from the budget and the frame sizes. Streams whose
+ * size is not known yet do not count against the budget.
+ *
+ * @param sched Scheduler
+ */
+static void allocate(rp_sched_t *sched)
+{
+    // Link usage at each configured rate, in milli-bytes per second
+    uint64_t at_min = 0;
+    uint64_t at_target = 0;
+    uint64_t at_max = 0;
+
+    for (size_t i = 0; i < sched->stream_count; i++) {
+        const rp_sched_stream_t *stream = &sched->streams[i];
+
+        at_min += (uint64_t)stream->config.min_mhz * stream->size;
+        at_target += (uint64_t)stream->config.target_mhz * stream->size;
+        at_max += (uint64_t)stream->config.max_mhz * stream->size;
+    }
+
+    uint64_t budget = (uint64_t)sched->budget_bytes_per_s * MILLI;
+
+    for (size_t i = 0; i < sched->stream_count; i++) {
+        rp_sched_stream_t *stream = &sched->streams[i];
+        const rp_sched_stream_config_t *config = &stream->config;
+        uint32_t rate;
+
+        if (budget < at_min) {
+            sched->level = RP_SCHED_CONGESTED;
+            rate = interpolate(0, config->min_mhz, (budget << FRACTION_BITS) / at_min);
+        } else if (budget < at_target) {
+            sched->level = RP_SCHED_BELOW_TARGET;
+            rate = interpolate(config->min_mhz, config->target_mhz,
+                               ((budget - at_min) << FRACTION_BITS) / (at_target - at_min));
+        } else if (budget < at_max) {
+            sched->level = RP_SCHED_ABOVE_TARGET;
+            rate = interpolate(config->target_mhz, config->max_mhz,
+                               ((budget - at_target) << FRACTION_BITS) / (at_max - at_target));
+        } else {
+            sched->level = RP_SCHED_MAXIMUM;
+            rate = config->max_mhz;
+        }
+
+        // A faster rate should take effect now, not after the old period
+        uint64_t period = period_us(rate);
+
+        if (period != NEVER && (stream->due_us == NEVER ||
+                                stream->due_us > sched->now_us + period)) {
+            stream->due_us = sched->now_us + period;
+        } else if (period == NEVER) {
+            stream->due_us = NEVER;
+        }
+
+        stream->rate_mhz = rate;
+    }
+
+    sched->stale = false;
+}
+
+/**
+ * @param from Rate at fraction 0
+ * @param to Rate at fraction 1
+ * @param fraction Position between them, `FRACTION_BITS` fixed point
+ * @return uint32_t
+ */
+static uint32_t interpolate(uint32_t from, uint32_t to, uint64_t fraction)
+{
+    return from + (uint32_t)(((uint64_t)(to - from) * fraction) >> FRACTION_BITS);
+}
+
+/**
+ * @param rate_mhz Rate in millihertz
+ * @return uint64_t Period in microseconds, `NEVER` for a stopped stream
+ */
+static uint64_t period_us(uint32_t rate_mhz)
+{
+    return (rate_mhz == 0) ? NEVER : 1000000000ULL / rate_mhz;
+}
@@ -0,0 +1,46 @@
+#include "tvr/downlink.incremental.h"
+
+#include <stddef.h>
+
+#define TELEMETRY(member) offsetof(tvr_Downlink, payload.telemetry.member)
+
+// Scalar of the TelemetryState payload, `Downlink.telemetry` is field 1
+#define SCALAR(member, kind, tag) \
+    {.offset = TELEMETRY(member), .wire = (kind), .depth = 2, .tags = {1, (tag)}}
+
+// Component of a Vec3 or Quaternion submessage of the payload
+#define COMPONENT(member, tag, component_tag) \
+    {.offset = TELEMETRY(member), \
+     .wire = RP_INCREMENTAL_FIXED32, \
+     .depth = 3, \
+     .tags = {1, (tag), (component_tag)}}
+
+// Sorted by offset in tvr_Downlink
+static const rp_incremental_field_t tvr_Downlink_incremental_fields[] = {
+    SCALAR(timestamp_ms, RP_INCREMENTAL_VARINT, 1),
+    COMPONENT(position.x, 2, 1),
+    COMPONENT(position.y, 2, 2),
+    COMPONENT(position.z, 2, 3),
+    COMPONENT(velocity.x, 3, 1),
+    COMPONENT(velocity.y, 3, 2),
+    COMPONENT(velocity.z, 3, 3),
+    COMPONENT(attitude.w, 4, 1),
+    COMPONENT(attitude.x, 4, 2),
+    COMPONENT(attitude.y, 4, 3),
+    COMPONENT(attitude.z, 4, 4),
+    COMPONENT(angular_rate.x, 5, 1),
+    COMPONENT(angular_rate.y, 5, 2),
+    COMPONENT(angular_rate.z, 5, 3),
+    SCALAR(flight_state, RP_INCREMENTAL_VARINT, 6),
+    SCALAR(thrust_cmd, RP_INCREMENTAL_FIXED32, 7),
+    SCALAR(gimbal_x, RP_INCREMENTAL_FIXED32, 8),
+    SCALAR(gimbal_y, RP_INCREMENTAL_FIXED32, 9),
+};
+
+const rp_incremental_spec_t tvr_Downlink_incremental = {
+    .message = tvr_Downlink_fields,
+    .message_size = sizeof(tvr_Downlink),
+    .fields = tvr_Downlink_incremental_fields,
+    .field_count =
+        sizeof(tvr_Downlink_incremental_fields) / sizeof(tvr_Downlink_incremental_fields[0]),
+};
@@ -0,0 +1,42 @@
+#include "tvr/downlink.quant.h"
+
+#include <stddef.h>
+
+// The codec quantizes a copy of the message on the stack
+_Static_assert(sizeof(tvr_Downlink) <= RP_QUANT_MAX_MESSAGE_SIZE, "tvr_Downlink too large");
+
+#define TELEMETRY(member) offsetof(tvr_Downlink, payload.telemetry.member)
+
+// Fields of the TelemetryState payload, carried while `which` selects it
+#define TELEMETRY_FIELD(member, present, ...) \
+    {.offset = TELEMETRY(member), \
+     .present_offset = (present), \
+     .which_offset = offsetof(tvr_Downlink, which_payload), \
+     .which_tag = tvr_Downlink_telemetry_tag, \
+     __VA_ARGS__}
+
+// Unit quaternion components in [-1, 1], 16 bits: 3.1e-5 steps
+#define UNIT_SCALED .kind = RP_QUANT_SCALED, .min = -1.0f, .resolution = 2.0f / 65535.0f, .bits = 16
+
+// Gimbal angles in [-0.8192, 0.8192) rad, 14 bits: 1e-4 rad steps
+#define GIMBAL_SCALED .kind = RP_QUANT_SCALED, .min = -0.8192f, .resolution = 1e-4f, .bits = 14
+
+static const rp_quant_field_t tvr_Downlink_quant_fields[] = {
+    TELEMETRY_FIELD(attitude.w, TELEMETRY(has_attitude), UNIT_SCALED),
+    TELEMETRY_FIELD(attitude.x, TELEMETRY(has_attitude), UNIT_SCALED),
+    TELEMETRY_FIELD(attitude.y, TELEMETRY(has_attitude), UNIT_SCALED),
+    TELEMETRY_FIELD(attitude.z, TELEMETRY(has_attitude), UNIT_SCALED),
+    TELEMETRY_FIELD(angular_rate.x, TELEMETRY(has_angular_rate), .kind = RP_QUANT_HALF),
+    TELEMETRY_FIELD(angular_rate.y, TELEMETRY(has_angular_rate), .kind = RP_QUANT_HALF),
+    TELEMETRY_FIELD(angular_rate.z, TELEMETRY(has_angular_rate), .kind = RP_QUANT_HALF),
+    TELEMETRY_FIELD(thrust_cmd, RP_QUANT_ALWAYS, .kind = RP_QUANT_HALF),
+    TELEMETRY_FIELD(gimbal_x, RP_QUANT_ALWAYS, GIMBAL_SCALED),
+    TELEMETRY_FIELD(gimbal_y, RP_QUANT_ALWAYS, GIMBAL_SCALED),
+};
+
+const rp_quant_spec_t tvr_Downlink_quant = {
+    .message = tvr_Downlink_fields,
+    .message_size = sizeof(tvr_Downlink),
+    .fields = tvr_Downlink_quant_fields,
+    .field_count = sizeof(tvr_Downlink_quant_fields) / sizeof(tvr_Downlink_quant_fields[0]),
+};
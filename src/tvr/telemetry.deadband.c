@@ -0,0 +1,67 @@
+#include "tvr/telemetry.deadband.h"
+
+#include <stddef.h>
+
+#define MEMBER(member) offsetof(tvr_TelemetryState, member)
+
+// The gimbal angles are predicted as one two-component vector
+_Static_assert(MEMBER(gimbal_y) == MEMBER(gimbal_x) + sizeof(float),
+               "gimbal_y must follow gimbal_x");
+
+// Tolerances sit well above the quantization steps of downlink.quant.c
+static const rp_deadband_field_t tvr_TelemetryState_deadband_fields[] = {
+    // Position extrapolated with the velocity, 5 cm
+    {.offset = MEMBER(position),
+     .kind = RP_DEADBAND_VECTOR,
+     .count = 3,
+     .rate_offset = MEMBER(velocity),
+     .tolerance = 0.05f,
+     .present_offset = MEMBER(has_position)},
+    // Velocity held, 5 cm/s
+    {.offset = MEMBER(velocity),
+     .kind = RP_DEADBAND_VECTOR,
+     .count = 3,
+     .rate_offset = RP_DEADBAND_NONE,
+     .tolerance = 0.05f,
+     .present_offset = MEMBER(has_velocity)},
+    // Attitude integrated with the body rate, 0.01 rad
+    {.offset = MEMBER(attitude),
+     .kind = RP_DEADBAND_ROTATION,
+     .rate_offset = MEMBER(angular_rate),
+     .tolerance = 0.01f,
+     .present_offset = MEMBER(has_attitude)},
+    // Body rate held, 0.02 rad/s
+    {.offset = MEMBER(angular_rate),
+     .kind = RP_DEADBAND_VECTOR,
+     .count = 3,
+     .rate_offset = RP_DEADBAND_NONE,
+     .tolerance = 0.02f,
+     .present_offset = MEMBER(has_angular_rate)},
+    {.offset = MEMBER(flight_state),
+     .kind = RP_DEADBAND_EXACT,
+     .count = sizeof(tvr_FlightState),
+     .rate_offset = RP_DEADBAND_NONE,
+     .present_offset = RP_DEADBAND_NONE},
+    // Control outputs held, 0.1 N and 1e-3 rad
+    {.offset = MEMBER(thrust_cmd),
+     .kind = RP_DEADBAND_VECTOR,
+     .count = 1,
+     .rate_offset = RP_DEADBAND_NONE,
+     .tolerance = 0.1f,
+     .present_offset = RP_DEADBAND_NONE},
+    {.offset = MEMBER(gimbal_x),
+     .kind = RP_DEADBAND_VECTOR,
+     .count = 2,
+     .rate_offset = RP_DEADBAND_NONE,
+     .tolerance = 1e-3f,
+     .present_offset = RP_DEADBAND_NONE},
+};
+
+const rp_deadband_spec_t tvr_TelemetryState_deadband = {
+    .message_size = sizeof(tvr_TelemetryState),
+    .timestamp_offset = MEMBER(timestamp_ms),
+    .max_interval_ms = 1000,
+    .fields = tvr_TelemetryState_deadband_fields,
+    .field_count = sizeof(tvr_TelemetryState_deadband_fields) /
+                   sizeof(tvr_TelemetryState_deadband_fields[0]),
+};
@@ -0,0 +1,514 @@
+#include "rp/txq/txq.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+
+#define MILLI (1000U)
+
+static void list_push_back(rp_txq_t *queue, rp_txq_class_state_t *state, uint16_t index);
+static void list_push_front(rp_txq_t *queue, rp_txq_class_state_t *state, uint16_t index);
+static uint16_t list_pop_front(rp_txq_t *queue, rp_txq_class_state_t *state);
+static uint16_t list_pop_back(rp_txq_t *queue, rp_txq_class_state_t *state);
+static void free_slot(rp_txq_t *queue, uint16_t index);
+static bool evict_oldest(rp_txq_t *queue, rp_txq_class_t min_class);
+static void refill(rp_txq_class_state_t *state, uint32_t now_ms);
+static bool has_tokens(const rp_txq_class_state_t *state, size_t size);
+static void charge(rp_txq_class_state_t *state, size_t size);
+static void refund(rp_txq_class_state_t *state, size_t size);
+static void requeue(rp_txq_t *queue, uint16_t index, size_t sent);
+static bool can_preempt(rp_txq_t *queue, uint8_t active_class, uint32_t now_ms);
+
+/**
+ * Initializes a transmit queue over caller-provided frame slots.
+ *
+ * Frames are dequeued in strict priority order: a class is only served when every
+ * higher class is empty or held back by its rate limit.
+ *
+ * @param queue Queue to initialize
+ * @param slots Preallocated frame slots
+ * @param slot_count Number of slots, at most `RP_TXQ_NO_SLOT - 1`
+ * @param configs Array of `RP_TXQ_CLASS_COUNT` class configurations, or NULL for no limits
+ * @return rp_txq_status_t
+ */
+rp_txq_status_t rp_txq_init(rp_txq_t *queue, rp_txq_slot_t *slots, size_t slot_count,
+                            const rp_txq_class_config_t *configs)
+{
+    if (queue == NULL || slots == NULL) {
+        return RP_TXQ_NULL_POINTER;
+    }
+
+    if (slot_count == 0 || slot_count >= RP_TXQ_NO_SLOT) {
+        return RP_TXQ_INVALID_ARGUMENT;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+
+    queue->slots = slots;
+    queue->slot_count = (uint16_t)slot_count;
+    queue->active = RP_TXQ_NO_SLOT;
+
+    for (uint16_t i = 0; i < queue->slot_count; i++) {
+        slots[i].size = 0;
+        slots[i].next = (i + 1 < queue->slot_count) ? (uint16_t)(i + 1) : RP_TXQ_NO_SLOT;
+    }
+
+    queue->free_head = 0;
+
+    for (size_t c = 0; c < RP_TXQ_CLASS_COUNT; c++) {
+        rp_txq_class_state_t *state = &queue->classes[c];
+
+        if (configs != NULL) {
+            state->config = configs[c];
+        }
+
+        state->head = RP_TXQ_NO_SLOT;
+        state->tail = RP_TXQ_NO_SLOT;
+        state->tokens = (uint64_t)state->config.burst_bytes * MILLI;
+    }
+
+    return RP_TXQ_OK;
+}
+
+/**
+ * Reserves a slot to encode a frame into, e.g. with `rp_packet_encode`.
+ *
+ * When no slot is free, the oldest frame of the lowest priority class at or below
+ * `class_id` that allows `drop_oldest` is evicted, so a frame of a high class can
+ * always displace queued telemetry.
+ *
+ * @param queue Queue state
+ * @param class_id Priority class the frame will be queued in
+ * @return rp_txq_slot_t* The reserved slot, or NULL if none could be freed
+ */
+rp_txq_slot_t *rp_txq_reserve(rp_txq_t *queue, rp_txq_class_t class_id)
+{
+    if (queue == NULL || class_id >= RP_TXQ_CLASS_COUNT) {
+        return NULL;
+    }
+
+    rp_txq_class_state_t *state = &queue->classes[class_id];
+
+    if (state->config.max_queued != 0 && state->count >= state->config.max_queued) {
+        if (!state->config.drop_oldest) {
+            return NULL;
+        }
+
+        free_slot(queue, list_pop_front(queue, state));
+        queue->dropped++;
+    }
+
+    if (queue->free_head == RP_TXQ_NO_SLOT && !evict_oldest(queue, class_id)) {
+        return NULL;
+    }
+
+    uint16_t index = queue->free_head;
+    rp_txq_slot_t *slot = &queue->slots[index];
+
+    queue->free_head = slot->next;
+
+    slot->next = RP_TXQ_NO_SLOT;
+    slot->size = 0;
+    slot->class_id = (uint8_t)class_id;
+
+    return slot;
+}
+
+/**
+ * Queues a reserved slot once its frame has been written.
+ *
+ * @param queue Queue state
+ * @param slot Slot returned by `rp_txq_reserve`
+ * @param size Number of bytes written to `slot->frame`
+ * @param now_ms Current time
+ * @return rp_txq_status_t
+ */
+rp_txq_status_t rp_txq_commit(rp_txq_t *queue, rp_txq_slot_t *slot, size_t size,
+                              uint32_t now_ms)
+{
+    if (queue == NULL || slot == NULL) {
+        return RP_TXQ_NULL_POINTER;
+    }
+
+    if (size == 0 || size > sizeof(slot->frame)) {
+        rp_txq_cancel(queue, slot);
+        return RP_TXQ_INVALID_ARGUMENT;
+    }
+
+    slot->size = size;
+    slot->enqueued_ms = now_ms;
+
+    list_push_back(queue, &queue->classes[slot->class_id], (uint16_t)(slot - queue->slots));
+
+    return RP_TXQ_OK;
+}
+
+/**
+ * Returns a reserved slot without queuing it.
+ *
+ * @param queue Queue state
+ * @param slot Slot returned by `rp_txq_reserve`
+ */
+void rp_txq_cancel(rp_txq_t *queue, rp_txq_slot_t *slot)
+{
+    if (queue == NULL || slot == NULL) {
+        return;
+    }
+
+    free_slot(queue, (uint16_t)(slot - queue->slots));
+}
+
+/**
+ * Copies an already encoded frame into the queue.
+ *
+ * @param queue Queue state
+ * @param class_id Priority class of the frame
+ * @param frame Encoded frame, including the delimiter
+ * @param size Number of bytes in the frame
+ * @param now_ms Current time
+ * @return rp_txq_status_t
+ */
+rp_txq_status_t rp_txq_push(rp_txq_t *queue, rp_txq_class_t class_id, const uint8_t *frame,
+                            size_t size, uint32_t now_ms)
+{
+    if (queue == NULL || frame == NULL) {
+        return RP_TXQ_NULL_POINTER;
+    }
+
+    if (class_id >= RP_TXQ_CLASS_COUNT || size == 0 || size > RP_TXQ_FRAME_CAPACITY) {
+        return RP_TXQ_INVALID_ARGUMENT;
+    }
+
+    rp_txq_slot_t *slot = rp_txq_reserve(queue, class_id);
+
+    if (slot == NULL) {
+        return RP_TXQ_FULL;
+    }
+
+    memcpy(slot->frame, frame, size);
+
+    return rp_txq_commit(queue, slot, size, now_ms);
+}
+
+/**
+ * Dequeues the next whole frame to transmit.
+ *
+ * The caller owns the slot until it is handed back with `rp_txq_release`.
+ *
+ * @param queue Queue state
+ * @param now_ms Current time, used for rate limiting
+ * @return rp_txq_slot_t* The next frame, or NULL if nothing may be sent now
+ */
+rp_txq_slot_t *rp_txq_pop(rp_txq_t *queue, uint32_t now_ms)
+{
+    if (queue == NULL) {
+        return NULL;
+    }
+
+    for (size_t c = 0; c < RP_TXQ_CLASS_COUNT; c++) {
+        rp_txq_class_state_t *state = &queue->classes[c];
+
+        if (state->count == 0) {
+            continue;
+        }
+
+        refill(state, now_ms);
+
+        rp_txq_slot_t *head = &queue->slots[state->head];
+
+        if (!has_tokens(state, head->size)) {
+            continue;
+        }
+
+        charge(state, head->size);
+        list_pop_front(queue, state);
+
+        return head;
+    }
+
+    return NULL;
+}
+
+/**
+ * Hands a transmitted slot back to the queue.
+ *
+ * @param queue Queue state
+ * @param slot Slot returned by `rp_txq_pop`
+ */
+void rp_txq_release(rp_txq_t *queue, rp_txq_slot_t *slot)
+{
+    rp_txq_cancel(queue, slot);
+}
+
+/**
+ * Streams queued frames as a byte stream, e.g. to fill a UART FIFO or DMA chunk.
+ *
+ * If a frame of a `preemptive` class is queued while a lower class frame is partially
+ * sent, the partial frame is cut off with a delimiter and put back at the head of its
+ * class. The receiver drops the truncated frame, and the preempting frame starts
+ * immediately instead of waiting for the rest of the lower class frame. The class is
+ * refunded the tokens of the bytes that were never sent, and its `max_queued` limit holds
+ * as if the frame had never left the queue.
+ *
+ * @param queue Queue state
+ * @param now_ms Current time, used for rate limiting
+ * @param output Buffer to write bytes to
+ * @param output_capacity Maximum number of bytes to write
+ * @return size_t Number of bytes written
+ */
+size_t rp_txq_read(rp_txq_t *queue, uint32_t now_ms, uint8_t *output, size_t output_capacity)
+{
+    size_t written = 0;
+
+    if (queue == NULL || output == NULL) {
+        return 0;
+    }
+
+    while (written < output_capacity) {
+        if (queue->active == RP_TXQ_NO_SLOT) {
+            rp_txq_slot_t *next = rp_txq_pop(queue, now_ms);
+
+            if (next == NULL) {
+                break;
+            }
+
+            queue->active = (uint16_t)(next - queue->slots);
+            queue->active_offset = 0;
+        }
+
+        rp_txq_slot_t *slot = &queue->slots[queue->active];
+
+        if (queue->active_offset > 0 && can_preempt(queue, slot->class_id, now_ms)) {
+            output[written++] = COBS_DELIMITER_BYTE;
+
+            requeue(queue, queue->active, queue->active_offset + 1);
+            queue->active = RP_TXQ_NO_SLOT;
+            queue->preemptions++;
+
+            continue;
+        }
+
+        size_t remaining = slot->size - queue->active_offset;
+        size_t chunk = output_capacity - written;
+
+        if (chunk > remaining) {
+            chunk = remaining;
+        }
+
+        memcpy(&output[written], &slot->frame[queue->active_offset], chunk);
+        written += chunk;
+        queue->active_offset += chunk;
+
+        if (queue->active_offset == slot->size) {
+            free_slot(queue, queue->active);
+            queue->active = RP_TXQ_NO_SLOT;
+        }
+    }
+
+    return written;
+}
+
+/**
+ * Returns the number of frames queued in a class.
+ *
+ * @param queue Queue state
+ * @param class_id Priority class
+ * @return size_t
+ */
+size_t rp_txq_pending(const rp_txq_t *queue, rp_txq_class_t class_id)
+{
+    if (queue == NULL || class_id >= RP_TXQ_CLASS_COUNT) {
+        return 0;
+    }
+
+    return queue->classes[class_id].count;
+}
+
+static void list_push_back(rp_txq_t *queue, rp_txq_class_state_t *state, uint16_t index)
+{
+    queue->slots[index].next = RP_TXQ_NO_SLOT;
+
+    if (state->tail == RP_TXQ_NO_SLOT) {
+        state->head = index;
+    } else {
+        queue->slots[state->tail].next = index;
+    }
+
+    state->tail = index;
+    state->count++;
+}
+
+static void list_push_front(rp_txq_t *queue, rp_txq_class_state_t *state, uint16_t index)
+{
+    queue->slots[index].next = state->head;
+
+    if (state->head == RP_TXQ_NO_SLOT) {
+        state->tail = index;
+    }
+
+    state->head = index;
+    state->count++;
+}
+
+static uint16_t list_pop_front(rp_txq_t *queue, rp_txq_class_state_t *state)
+{
+    uint16_t index = state->head;
+
+    state->head = queue->slots[index].next;
+
+    if (state->head == RP_TXQ_NO_SLOT) {
+        state->tail = RP_TXQ_NO_SLOT;
+    }
+
+    state->count--;
+
+    return index;
+}
+
+static uint16_t list_pop_back(rp_txq_t *queue, rp_txq_class_state_t *state)
+{
+    uint16_t index = state->tail;
+
+    if (state->head == index) {
+        state->head = RP_TXQ_NO_SLOT;
+        state->tail = RP_TXQ_NO_SLOT;
+    } else {
+        uint16_t previous = state->head;
+
+        while (queue->slots[previous].next != index) {
+            previous = queue->slots[previous].next;
+        }
+
+        queue->slots[previous].next = RP_TXQ_NO_SLOT;
+        state->tail = previous;
+    }
+
+    state->count--;
+
+    return index;
+}
+
+static void free_slot(rp_txq_t *queue, uint16_t index)
+{
+    queue->slots[index].size = 0;
+    queue->slots[index].next = queue->free_head;
+    queue->free_head = index;
+}
+
+static bool evict_oldest(rp_txq_t *queue, rp_txq_class_t min_class)
+{
+    for (size_t c = RP_TXQ_CLASS_COUNT; c-- > (size_t)min_class;) {
+        rp_txq_class_state_t *state = &queue->classes[c];
+
+        if (state->count > 0 && state->config.drop_oldest) {
+            free_slot(queue, list_pop_front(queue, state));
+            queue->dropped++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void refill(rp_txq_class_state_t *state, uint32_t now_ms)
+{
+    if (state->config.rate_bytes_per_s == 0) {
+        return;
+    }
+
+    uint64_t capacity = (uint64_t)state->config.burst_bytes * MILLI;
+    uint32_t elapsed_ms = now_ms - state->last_refill_ms;
+
+    state->last_refill_ms = now_ms;
+    state->tokens += (uint64_t)elapsed_ms * state->config.rate_bytes_per_s;
+
+    if (state->tokens > capacity) {
+        state->tokens = capacity;
+    }
+}
+
+static bool has_tokens(const rp_txq_class_state_t *state, size_t size)
+{
+    if (state->config.rate_bytes_per_s == 0) {
+        return true;
+    }
+
+    uint64_t cost = (uint64_t)size * MILLI;
+    uint64_t capacity = (uint64_t)state->config.burst_bytes * MILLI;
+
+    // A frame larger than the bucket may go once the bucket is full
+    return state->tokens >= (cost < capacity ? cost : capacity);
+}
+
+static void charge(rp_txq_class_state_t *state, size_t size)
+{
+    if (state->config.rate_bytes_per_s == 0) {
+        return;
+    }
+
+    uint64_t cost = (uint64_t)size * MILLI;
+
+    state->tokens = (state->tokens > cost) ? state->tokens - cost : 0;
+}
+
+static void refund(rp_txq_class_state_t *state, size_t size)
+{
+    if (state->config.rate_bytes_per_s == 0) {
+        return;
+    }
+
+    uint64_t capacity = (uint64_t)state->config.burst_bytes * MILLI;
+
+    state->tokens += (uint64_t)size * MILLI;
+
+    if (state->tokens > capacity) {
+        state->tokens = capacity;
+    }
+}
+
+/**
+ * Puts a frame cut off after `sent` bytes, its delimiter included, back at the head of its
+ * class. If the class filled up meanwhile, the frame that would have been turned away had
+ * this one stayed queued is dropped: this one, the oldest, under `drop_oldest`, the newest
+ * otherwise.
+ */
+static void requeue(rp_txq_t *queue, uint16_t index, size_t sent)
+{
+    rp_txq_slot_t *slot = &queue->slots[index];
+    rp_txq_class_state_t *state = &queue->classes[slot->class_id];
+
+    refund(state, slot->size - sent);
+
+    if (state->config.max_queued != 0 && state->count >= state->config.max_queued) {
+        queue->dropped++;
+
+        if (state->config.drop_oldest) {
+            free_slot(queue, index);
+            return;
+        }
+
+        free_slot(queue, list_pop_back(queue, state));
+    }
+
+    list_push_front(queue, state, index);
+}
+
+static bool can_preempt(rp_txq_t *queue, uint8_t active_class, uint32_t now_ms)
+{
+    for (size_t c = 0; c < active_class; c++) {
+        rp_txq_class_state_t *state = &queue->classes[c];
+
+        if (!state->config.preemptive || state->count == 0) {
+            continue;
+        }
+
+        refill(state, now_ms);
+
+        if (has_tokens(state, queue->slots[state->head].size)) {
+            return true;
+        }
+    }
+
+    return false;
+}
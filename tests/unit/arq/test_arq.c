@@ -0,0 +1,277 @@
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/arq/arq.h"
+
+static rp_arq_sender_t sender;
+static rp_arq_receiver_t receiver;
+
+static const rp_arq_config_t config = {
+    .initial_rto_ms = 100,
+    .min_rto_ms = 20,
+    .max_rto_ms = 800,
+    .max_transmissions = 4,
+};
+
+static uint32_t submit(uint32_t now_ms)
+{
+    rp_arq_entry_t *entry = rp_arq_sender_reserve(&sender);
+    TEST_ASSERT_NOT_NULL(entry);
+
+    // Stand-in for an encoded FlightCommand
+    memcpy(entry->frame, &entry->command_id, sizeof(entry->command_id));
+    TEST_ASSERT_EQUAL(RP_ARQ_OK,
+                      rp_arq_sender_commit(&sender, entry, sizeof(entry->command_id), now_ms));
+
+    return entry->command_id;
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(RP_ARQ_OK, rp_arq_sender_init(&sender, &config, 1));
+    rp_arq_receiver_init(&receiver);
+}
+
+void tearDown(void)
+{
+}
+
+void test_arq_sender_init_rejects_invalid_config(void)
+{
+    rp_arq_config_t invalid = config;
+    invalid.min_rto_ms = invalid.max_rto_ms + 1;
+
+    TEST_ASSERT_EQUAL(RP_ARQ_INVALID_ARGUMENT, rp_arq_sender_init(&sender, &invalid, 1));
+    TEST_ASSERT_EQUAL(RP_ARQ_NULL_POINTER, rp_arq_sender_init(NULL, &config, 1));
+}
+
+void test_arq_new_command_is_sent_once_until_timeout(void)
+{
+    uint32_t id = submit(0);
+
+    const rp_arq_entry_t *entry = rp_arq_sender_poll(&sender, 0);
+
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_UINT32(id, entry->command_id);
+    TEST_ASSERT_NULL(rp_arq_sender_poll(&sender, 0));
+    TEST_ASSERT_NULL(rp_arq_sender_poll(&sender, 99));
+
+    entry = rp_arq_sender_poll(&sender, 100);
+
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_UINT8(2, entry->transmissions);
+    TEST_ASSERT_EQUAL_UINT32(1, sender.retransmissions);
+
+    // Backoff doubles the timeout for the next attempt
+    TEST_ASSERT_NULL(rp_arq_sender_poll(&sender, 299));
+    TEST_ASSERT_NOT_NULL(rp_arq_sender_poll(&sender, 300));
+}
+
+void test_arq_command_expires_after_max_transmissions(void)
+{
+    submit(0);
+
+    uint32_t now = 0;
+
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_NOT_NULL(rp_arq_sender_poll(&sender, now));
+        now += 1000;
+    }
+
+    TEST_ASSERT_NULL(rp_arq_sender_poll(&sender, now));
+    TEST_ASSERT_EQUAL_UINT32(1, sender.expired);
+    TEST_ASSERT_EQUAL(0, rp_arq_sender_in_flight(&sender));
+}
+
+void test_arq_ack_confirms_and_samples_rtt(void)
+{
+    uint32_t id = submit(0);
+    rp_arq_sender_poll(&sender, 0);
+
+    TEST_ASSERT_EQUAL(RP_ARQ_EXECUTE, rp_arq_receiver_accept(&receiver, id));
+
+    rp_arq_ack_t ack;
+    TEST_ASSERT_TRUE(rp_arq_receiver_take_ack(&receiver, &ack));
+
+    rp_arq_confirmation_t confirmations[RP_ARQ_WINDOW_SIZE];
+    size_t count = rp_arq_sender_on_ack(&sender, &ack, 40, confirmations, RP_ARQ_WINDOW_SIZE);
+
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL_UINT32(id, confirmations[0].command_id);
+    TEST_ASSERT_EQUAL_UINT32(40, confirmations[0].elapsed_ms);
+    TEST_ASSERT_EQUAL_UINT32(40, sender.srtt_ms);
+    TEST_ASSERT_EQUAL_UINT32(20, sender.rttvar_ms);
+    TEST_ASSERT_EQUAL_UINT32(120, sender.rto_ms);
+    TEST_ASSERT_EQUAL(0, rp_arq_sender_in_flight(&sender));
+}
+
+void test_arq_retransmitted_command_does_not_sample_rtt(void)
+{
+    uint32_t id = submit(0);
+    rp_arq_sender_poll(&sender, 0);
+    rp_arq_sender_poll(&sender, 100);
+
+    rp_arq_receiver_accept(&receiver, id);
+
+    rp_arq_ack_t ack;
+    rp_arq_receiver_take_ack(&receiver, &ack);
+
+    TEST_ASSERT_EQUAL(1, rp_arq_sender_on_ack(&sender, &ack, 130, NULL, 0));
+    TEST_ASSERT_FALSE(sender.has_rtt);
+    TEST_ASSERT_EQUAL_UINT32(100, sender.rto_ms);
+}
+
+void test_arq_selective_ack_confirms_out_of_order(void)
+{
+    uint32_t first = submit(0);
+    uint32_t second = submit(0);
+    uint32_t third = submit(0);
+
+    while (rp_arq_sender_poll(&sender, 0) != NULL) {
+    }
+
+    // The second command is lost
+    rp_arq_receiver_accept(&receiver, first);
+    rp_arq_receiver_accept(&receiver, third);
+
+    rp_arq_ack_t ack;
+    rp_arq_receiver_take_ack(&receiver, &ack);
+
+    TEST_ASSERT_EQUAL_UINT32(third, ack.latest_id);
+    TEST_ASSERT_EQUAL_UINT32(0x2, ack.history);
+
+    TEST_ASSERT_EQUAL(2, rp_arq_sender_on_ack(&sender, &ack, 10, NULL, 0));
+    TEST_ASSERT_EQUAL(1, rp_arq_sender_in_flight(&sender));
+
+    const rp_arq_entry_t *entry = rp_arq_sender_poll(&sender, 100);
+
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_EQUAL_UINT32(second, entry->command_id);
+}
+
+void test_arq_receiver_suppresses_duplicates_and_repeats_ack(void)
+{
+    rp_arq_ack_t ack;
+
+    TEST_ASSERT_EQUAL(RP_ARQ_EXECUTE, rp_arq_receiver_accept(&receiver, 5));
+    TEST_ASSERT_EQUAL(RP_ARQ_EXECUTE, rp_arq_receiver_accept(&receiver, 7));
+    TEST_ASSERT_EQUAL(RP_ARQ_EXECUTE, rp_arq_receiver_accept(&receiver, 6));
+    TEST_ASSERT_EQUAL(RP_ARQ_DUPLICATE, rp_arq_receiver_accept(&receiver, 5));
+    TEST_ASSERT_EQUAL(RP_ARQ_DUPLICATE, rp_arq_receiver_accept(&receiver, 7));
+    TEST_ASSERT_EQUAL(RP_ARQ_STALE,
+                      rp_arq_receiver_accept(&receiver, 7 - RP_ARQ_HISTORY_SIZE - 1));
+    TEST_ASSERT_EQUAL(RP_ARQ_UNTRACKED, rp_arq_receiver_accept(&receiver, 0));
+
+    for (int i = 0; i < RP_ARQ_ACK_REPEATS; i++) {
+        TEST_ASSERT_TRUE(rp_arq_receiver_take_ack(&receiver, &ack));
+    }
+
+    TEST_ASSERT_FALSE(rp_arq_receiver_take_ack(&receiver, &ack));
+    TEST_ASSERT_EQUAL_UINT32(3, receiver.executed);
+    TEST_ASSERT_EQUAL_UINT32(2, receiver.duplicates);
+}
+
+void test_arq_window_is_bounded(void)
+{
+    for (int i = 0; i < RP_ARQ_WINDOW_SIZE; i++) {
+        submit(0);
+    }
+
+    TEST_ASSERT_NULL(rp_arq_sender_reserve(&sender));
+}
+
+void test_arq_all_commands_confirmed_over_lossy_channel(void)
+{
+    // Every third uplink frame and every second downlink frame is lost, 25 ms each way
+    uint32_t uplink_ids[64];
+    uint32_t uplink_arrivals[64];
+    size_t uplink_pending = 0;
+    rp_arq_ack_t downlink_acks[64];
+    uint32_t downlink_arrivals[64];
+    size_t downlink_pending = 0;
+    uint32_t uplink_count = 0;
+    uint32_t downlink_count = 0;
+    uint32_t submitted = 0;
+
+    for (uint32_t now = 0; now < 20000; now++) {
+        rp_arq_entry_t *reserved = (submitted < 32) ? rp_arq_sender_reserve(&sender) : NULL;
+
+        if (reserved != NULL) {
+            rp_arq_sender_commit(&sender, reserved, 1, now);
+            submitted++;
+        }
+
+        const rp_arq_entry_t *entry;
+
+        while ((entry = rp_arq_sender_poll(&sender, now)) != NULL) {
+            if (++uplink_count % 3 != 0) {
+                uplink_ids[uplink_pending] = entry->command_id;
+                uplink_arrivals[uplink_pending] = now + 25;
+                uplink_pending++;
+            }
+        }
+
+        for (size_t i = 0; i < uplink_pending;) {
+            if (uplink_arrivals[i] != now) {
+                i++;
+                continue;
+            }
+
+            rp_arq_receiver_accept(&receiver, uplink_ids[i]);
+
+            uplink_pending--;
+            uplink_ids[i] = uplink_ids[uplink_pending];
+            uplink_arrivals[i] = uplink_arrivals[uplink_pending];
+        }
+
+        // 50 Hz downlink carrying the pending acknowledgement
+        rp_arq_ack_t ack;
+
+        if (now % 20 == 0 && rp_arq_receiver_take_ack(&receiver, &ack) &&
+            ++downlink_count % 2 == 0) {
+            downlink_acks[downlink_pending] = ack;
+            downlink_arrivals[downlink_pending] = now + 25;
+            downlink_pending++;
+        }
+
+        for (size_t i = 0; i < downlink_pending;) {
+            if (downlink_arrivals[i] != now) {
+                i++;
+                continue;
+            }
+
+            rp_arq_sender_on_ack(&sender, &downlink_acks[i], now, NULL, 0);
+
+            downlink_pending--;
+            downlink_acks[i] = downlink_acks[downlink_pending];
+            downlink_arrivals[i] = downlink_arrivals[downlink_pending];
+        }
+
+        TEST_ASSERT_TRUE(uplink_pending < 64);
+        TEST_ASSERT_TRUE(downlink_pending < 64);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(32, sender.confirmed);
+    TEST_ASSERT_EQUAL_UINT32(0, sender.expired);
+    TEST_ASSERT_EQUAL_UINT32(32, receiver.executed);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arq_sender_init_rejects_invalid_config);
+    RUN_TEST(test_arq_new_command_is_sent_once_until_timeout);
+    RUN_TEST(test_arq_command_expires_after_max_transmissions);
+    RUN_TEST(test_arq_ack_confirms_and_samples_rtt);
+    RUN_TEST(test_arq_retransmitted_command_does_not_sample_rtt);
+    RUN_TEST(test_arq_selective_ack_confirms_out_of_order);
+    RUN_TEST(test_arq_receiver_suppresses_duplicates_and_repeats_ack);
+    RUN_TEST(test_arq_window_is_bounded);
+    RUN_TEST(test_arq_all_commands_confirmed_over_lossy_channel);
+
+    return UNITY_END();
+}
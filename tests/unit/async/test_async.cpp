@@ -0,0 +1,276 @@
+#include "async.hpp"
+#include "unity.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "proto/codec_test_data.pb.h"
+
+RP_MESSAGE_TRAITS_EX(codec_test_data_t, CODEC_TEST_DATA_FIELDS, CODEC_TEST_DATA_SIZE);
+
+namespace {
+
+struct link_fds {
+    int read_fd = -1;
+    int write_fd = -1;
+};
+
+struct received {
+    std::vector<std::uint32_t> values;
+    std::vector<rp::read_status> errors;
+    bool closed = false;
+};
+
+link_fds open_link()
+{
+    int fds[2];
+    link_fds link;
+
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+
+    link.read_fd = fds[0];
+    link.write_fd = fds[1];
+
+    return link;
+}
+
+// Lets the receiving task see end of stream and finish, then closes both ends
+void finish_link(rp::event_loop &loop, link_fds &link)
+{
+    if (link.write_fd >= 0) {
+        close(link.write_fd);
+        link.write_fd = -1;
+    }
+
+    loop.run();
+
+    TEST_ASSERT_EQUAL(0, loop.active_tasks());
+
+    close(link.read_fd);
+}
+
+void close_link(link_fds &link)
+{
+    if (link.read_fd >= 0) {
+        close(link.read_fd);
+    }
+
+    if (link.write_fd >= 0) {
+        close(link.write_fd);
+    }
+}
+
+std::vector<std::uint8_t> make_frame(std::uint32_t value)
+{
+    const rp::codec<codec_test_data_t> codec;
+    rp::codec<codec_test_data_t>::buffer_type buffer{};
+    codec_test_data_t message = CODEC_TEST_DATA_INIT_DEFAULT;
+
+    message.ui32 = value;
+
+    auto frame = codec.encode(message, buffer);
+
+    TEST_ASSERT_TRUE(frame.has_value());
+
+    return {frame->begin(), frame->end()};
+}
+
+void write_all(int fd, std::span<const std::uint8_t> bytes)
+{
+    TEST_ASSERT_EQUAL(static_cast<ssize_t>(bytes.size()), write(fd, bytes.data(), bytes.size()));
+}
+
+template <typename Reader> rp::task receive(Reader &reader, received &out)
+{
+    for (;;) {
+        auto frame = co_await reader.template next<codec_test_data_t>();
+
+        if (frame) {
+            out.values.push_back(frame->ui32);
+            continue;
+        }
+
+        if (frame.error().status == rp::read_status::closed) {
+            out.closed = true;
+            co_return;
+        }
+
+        out.errors.push_back(frame.error().status);
+    }
+}
+
+// Dispatches readiness events until nothing more is pending
+void drain(rp::event_loop &loop)
+{
+    while (loop.run_once(0) > 0) {
+    }
+}
+
+} // namespace
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_async_frames_should_arrive_in_order(void)
+{
+    rp::event_loop loop;
+    link_fds link = open_link();
+    rp::frame_reader<> reader{loop, link.read_fd};
+    received out;
+
+    TEST_ASSERT_TRUE(loop.valid());
+    TEST_ASSERT_TRUE(reader.valid());
+
+    loop.spawn(receive(reader, out));
+
+    TEST_ASSERT_EQUAL(1, loop.active_tasks());
+    TEST_ASSERT_EQUAL(0, out.values.size());
+
+    for (std::uint32_t i = 1; i <= 3; i++) {
+        write_all(link.write_fd, make_frame(i));
+    }
+
+    drain(loop);
+
+    TEST_ASSERT_EQUAL(3, out.values.size());
+    TEST_ASSERT_EQUAL_UINT32(1, out.values[0]);
+    TEST_ASSERT_EQUAL_UINT32(3, out.values[2]);
+    TEST_ASSERT_FALSE(out.closed);
+
+    close(link.write_fd);
+    link.write_fd = -1;
+
+    loop.run();
+
+    TEST_ASSERT_TRUE(out.closed);
+    TEST_ASSERT_EQUAL(0, loop.active_tasks());
+
+    close_link(link);
+}
+
+void test_async_partial_reads_should_reassemble(void)
+{
+    rp::event_loop loop;
+    link_fds link = open_link();
+    rp::frame_reader<RP_PACKET_MAX_SIZE, 3> reader{loop, link.read_fd};
+    received out;
+
+    loop.spawn(receive(reader, out));
+
+    std::vector<std::uint8_t> frame = make_frame(42);
+
+    // Dribble the frame in one byte at a time, as a slow serial port would
+    for (std::uint8_t byte : frame) {
+        TEST_ASSERT_EQUAL(0, out.values.size());
+        write_all(link.write_fd, std::span<const std::uint8_t>{&byte, 1});
+        drain(loop);
+    }
+
+    TEST_ASSERT_EQUAL(1, out.values.size());
+    TEST_ASSERT_EQUAL_UINT32(42, out.values[0]);
+
+    finish_link(loop, link);
+}
+
+void test_async_corrupt_frame_should_not_end_stream(void)
+{
+    rp::event_loop loop;
+    link_fds link = open_link();
+    rp::frame_reader<> reader{loop, link.read_fd};
+    received out;
+
+    loop.spawn(receive(reader, out));
+
+    std::vector<std::uint8_t> corrupt = make_frame(1);
+
+    // Any change that keeps the byte non-zero stays one frame but fails the COBS or CRC check
+    corrupt[1] ^= (corrupt[1] == 0x01) ? 0x02 : 0x01;
+
+    write_all(link.write_fd, corrupt);
+    write_all(link.write_fd, make_frame(2));
+    drain(loop);
+
+    TEST_ASSERT_EQUAL(1, out.errors.size());
+    TEST_ASSERT(rp::read_status::undecodable == out.errors[0]);
+    TEST_ASSERT_EQUAL(1, out.values.size());
+    TEST_ASSERT_EQUAL_UINT32(2, out.values[0]);
+
+    finish_link(loop, link);
+}
+
+void test_async_oversized_frame_should_overflow(void)
+{
+    rp::event_loop loop;
+    link_fds link = open_link();
+    rp::frame_reader<8> reader{loop, link.read_fd};
+    received out;
+
+    loop.spawn(receive(reader, out));
+
+    const std::array<std::uint8_t, 12> junk{1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0};
+
+    write_all(link.write_fd, junk);
+    drain(loop);
+
+    TEST_ASSERT_EQUAL(1, out.errors.size());
+    TEST_ASSERT(rp::read_status::overflow == out.errors[0]);
+
+    finish_link(loop, link);
+}
+
+void test_async_one_loop_should_serve_several_links(void)
+{
+    rp::event_loop loop;
+    std::array<link_fds, 3> links{open_link(), open_link(), open_link()};
+    rp::frame_reader<> reader_a{loop, links[0].read_fd};
+    rp::frame_reader<> reader_b{loop, links[1].read_fd};
+    rp::frame_reader<> reader_c{loop, links[2].read_fd};
+    std::array<received, 3> out;
+
+    loop.spawn(receive(reader_a, out[0]));
+    loop.spawn(receive(reader_b, out[1]));
+    loop.spawn(receive(reader_c, out[2]));
+
+    for (std::uint32_t round = 0; round < 4; round++) {
+        for (std::size_t i = 0; i < links.size(); i++) {
+            write_all(links[i].write_fd, make_frame(100 * static_cast<std::uint32_t>(i) + round));
+        }
+    }
+
+    for (link_fds &link : links) {
+        close(link.write_fd);
+        link.write_fd = -1;
+    }
+
+    loop.run();
+
+    for (std::size_t i = 0; i < links.size(); i++) {
+        TEST_ASSERT_TRUE(out[i].closed);
+        TEST_ASSERT_EQUAL(4, out[i].values.size());
+        TEST_ASSERT_EQUAL_UINT32(100 * i + 3, out[i].values[3]);
+        close_link(links[i]);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_async_frames_should_arrive_in_order);
+    RUN_TEST(test_async_partial_reads_should_reassemble);
+    RUN_TEST(test_async_corrupt_frame_should_not_end_stream);
+    RUN_TEST(test_async_oversized_frame_should_overflow);
+    RUN_TEST(test_async_one_loop_should_serve_several_links);
+
+    return UNITY_END();
+}
@@ -0,0 +1,187 @@
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+
+#define CAPTURE_CAPACITY (1024)
+
+typedef struct capture {
+    uint8_t bytes[CAPTURE_CAPACITY];
+    size_t size;
+    size_t calls;
+    size_t fail_after; /**< Refuse the call after this many, 0 to never refuse */
+} capture_t;
+
+static capture_t capture;
+static cobs_encoder_t encoder;
+
+/**
+ * Collects the sink output and checks that every call is one complete COBS block.
+ */
+static bool capture_sink(void *context, const uint8_t *data, size_t size)
+{
+    capture_t *target = context;
+
+    if (target->fail_after > 0 && target->calls == target->fail_after) {
+        return false;
+    }
+
+    TEST_ASSERT_TRUE(size >= 1 && size <= COBS_BLOCK_MAX_SIZE + 1);
+    TEST_ASSERT_TRUE(data[0] == size || (data[0] == size - 1 && data[size - 1] == 0));
+    TEST_ASSERT_TRUE(target->size + size <= sizeof(target->bytes));
+
+    memcpy(&target->bytes[target->size], data, size);
+    target->size += size;
+    target->calls++;
+
+    return true;
+}
+
+/**
+ * Encodes `data` in pieces of `piece_size` and compares with `cobs_encode`.
+ */
+static void assert_matches_cobs_encode(const uint8_t *data, size_t data_size, size_t piece_size)
+{
+    uint8_t expected[CAPTURE_CAPACITY];
+
+    cobs_result_t reference = cobs_encode(data, data_size, expected, sizeof(expected));
+
+    TEST_ASSERT_EQUAL(COBS_OK, reference.status);
+
+    memset(&capture, 0, sizeof(capture));
+
+    for (size_t offset = 0; offset < data_size; offset += piece_size) {
+        size_t size = (data_size - offset < piece_size) ? data_size - offset : piece_size;
+
+        TEST_ASSERT_EQUAL(COBS_OK, cobs_encoder_write(&encoder, &data[offset], size));
+    }
+
+    cobs_result_t result = cobs_encoder_finish(&encoder);
+
+    TEST_ASSERT_EQUAL(COBS_OK, result.status);
+    TEST_ASSERT_EQUAL(reference.written, result.written);
+    TEST_ASSERT_EQUAL(reference.written, capture.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, capture.bytes, reference.written);
+}
+
+void setUp(void)
+{
+    memset(&capture, 0, sizeof(capture));
+    cobs_encoder_init(&encoder, capture_sink, &capture);
+}
+
+void tearDown(void)
+{
+}
+
+void test_cobs_encoder_empty_frame(void)
+{
+    uint8_t expected[] = {0x01, COBS_DELIMITER_BYTE};
+
+    cobs_result_t result = cobs_encoder_finish(&encoder);
+
+    TEST_ASSERT_EQUAL(COBS_OK, result.status);
+    TEST_ASSERT_EQUAL(sizeof(expected), result.written);
+    TEST_ASSERT_EQUAL(1, capture.calls);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, capture.bytes, sizeof(expected));
+}
+
+void test_cobs_encoder_matches_cobs_encode_at_block_boundaries(void)
+{
+    static const size_t sizes[] = {1, 253, 254, 255, 508, 509, 600};
+    uint8_t data[600];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i % 255 + 1);
+    }
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        assert_matches_cobs_encode(data, sizes[s], sizes[s]);
+        assert_matches_cobs_encode(data, sizes[s], 1);
+        assert_matches_cobs_encode(data, sizes[s], 17);
+    }
+}
+
+void test_cobs_encoder_matches_cobs_encode_with_delimiters(void)
+{
+    uint8_t data[400];
+    uint32_t state = 12345;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        state = state * 1103515245U + 12345U;
+        data[i] = (uint8_t)(state >> 16);
+
+        // Plenty of zero runs, like protobuf output
+        if (state % 5 == 0) {
+            data[i] = 0;
+        }
+    }
+
+    data[0] = 0;
+    data[sizeof(data) - 1] = 0;
+
+    for (size_t piece_size = 1; piece_size <= sizeof(data); piece_size *= 3) {
+        assert_matches_cobs_encode(data, sizeof(data), piece_size);
+    }
+}
+
+void test_cobs_encoder_flushes_completed_blocks(void)
+{
+    uint8_t data[] = {0x11, 0x22, COBS_DELIMITER_BYTE, 0x33};
+    uint8_t first_block[] = {0x03, 0x11, 0x22};
+
+    TEST_ASSERT_EQUAL(COBS_OK, cobs_encoder_write(&encoder, data, sizeof(data)));
+
+    // The block ended by the zero is out, the open one waits for its code
+    TEST_ASSERT_EQUAL(1, capture.calls);
+    TEST_ASSERT_EQUAL(sizeof(first_block), capture.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first_block, capture.bytes, sizeof(first_block));
+}
+
+void test_cobs_encoder_reports_sink_failure(void)
+{
+    uint8_t data[] = {0x11, COBS_DELIMITER_BYTE, 0x22, COBS_DELIMITER_BYTE, 0x33};
+
+    capture.fail_after = 1;
+
+    TEST_ASSERT_EQUAL(COBS_SINK_FAILED, cobs_encoder_write(&encoder, data, sizeof(data)));
+    TEST_ASSERT_EQUAL(COBS_SINK_FAILED, cobs_encoder_write(&encoder, data, sizeof(data)));
+
+    cobs_result_t result = cobs_encoder_finish(&encoder);
+
+    TEST_ASSERT_EQUAL(COBS_SINK_FAILED, result.status);
+    TEST_ASSERT_EQUAL(0, result.written);
+
+    // The next frame starts clean
+    capture.fail_after = 0;
+    assert_matches_cobs_encode(data, sizeof(data), 2);
+}
+
+void test_cobs_encoder_null_arguments(void)
+{
+    cobs_encoder_t unset;
+
+    cobs_encoder_init(&unset, NULL, NULL);
+
+    TEST_ASSERT_EQUAL(COBS_NULL_POINTER, cobs_encoder_write(&unset, NULL, 0));
+    TEST_ASSERT_EQUAL(COBS_NULL_POINTER, cobs_encoder_finish(&unset).status);
+    TEST_ASSERT_EQUAL(COBS_NULL_POINTER, cobs_encoder_write(&encoder, NULL, 1));
+    TEST_ASSERT_EQUAL(COBS_NULL_POINTER, cobs_encoder_finish(NULL).status);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_cobs_encoder_empty_frame);
+    RUN_TEST(test_cobs_encoder_matches_cobs_encode_at_block_boundaries);
+    RUN_TEST(test_cobs_encoder_matches_cobs_encode_with_delimiters);
+    RUN_TEST(test_cobs_encoder_flushes_completed_blocks);
+    RUN_TEST(test_cobs_encoder_reports_sink_failure);
+    RUN_TEST(test_cobs_encoder_null_arguments);
+
+    return UNITY_END();
+}
@@ -2,12 +2,131 @@
 #include "unity.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "pb_encode.h"
 
 #include "proto/codec_test_data.pb.h"
+#include "rp/crc/crc.h"
+#include "rp/fec/rs.h"
+#include "rp/link/link.h"
+#include "rp/quant/quant.h"
 #include "unity_internals.h"
 
+// Too large for the stack of every test runner
+static rp_packet_verify_scratch_t verify_scratch;
+
+static const codec_test_data_t sample_message = {
+    .d = 3.1415926,
+    .ui32 = 1234567890,
+    .f = 0.0,
+    .b1 = true,
+    .b2 = false,
+    .which_oo = CODEC_TEST_DATA_MO_TAG,
+    .oo =
+        {
+            .mo = MY_OPTION_MY_OPTIONS_VALUE2,
+        },
+};
+
+/**
+ * Flips bits in `count` encoded bytes that are not COBS code bytes or the delimiter,
+ * so the frame structure survives and only its contents are damaged.
+ */
+static void corrupt_data_bytes(uint8_t *packet, size_t packet_size, size_t count)
+{
+    size_t next_code = 0;
+    size_t corrupted = 0;
+
+    for (size_t i = 0; i + 1 < packet_size && corrupted < count; i++) {
+        if (i == next_code) {
+            next_code += packet[i];
+            continue;
+        }
+
+        // Spread the damage out a little
+        if (i % 3 != 0) {
+            continue;
+        }
+
+        // Never turn a byte into a delimiter
+        packet[i] ^= (packet[i] == 0x5A) ? 0x0F : 0x5A;
+        corrupted++;
+    }
+
+    TEST_ASSERT_EQUAL(count, corrupted);
+}
+
+/**
+ * Flips a single bit in the `index`th encoded byte that is not a COBS code byte or the
+ * delimiter, without turning it into a delimiter.
+ */
+static void flip_data_bit(uint8_t *packet, size_t packet_size, size_t index)
+{
+    size_t next_code = 0;
+    size_t seen = 0;
+
+    for (size_t i = 0; i + 1 < packet_size; i++) {
+        if (i == next_code) {
+            next_code += packet[i];
+            continue;
+        }
+
+        if (seen++ == index) {
+            packet[i] ^= (packet[i] == 0x01) ? 0x02 : 0x01;
+            return;
+        }
+    }
+
+    TEST_FAIL_MESSAGE("Packet has too few data bytes");
+}
+
+typedef struct sink_capture {
+    uint8_t bytes[RP_PACKET_MAX_SIZE];
+    size_t size;
+    size_t calls;
+    bool fail;
+} sink_capture_t;
+
+static bool capture_sink(void *context, const uint8_t *data, size_t size)
+{
+    sink_capture_t *capture = context;
+
+    if (capture->fail || capture->size + size > sizeof(capture->bytes)) {
+        return false;
+    }
+
+    memcpy(&capture->bytes[capture->size], data, size);
+    capture->size += size;
+    capture->calls++;
+
+    return true;
+}
+
+/**
+ * Checks that streaming to a sink produces the same frame as the buffered encoder.
+ */
+static void assert_sink_matches_buffered(const codec_test_data_t *message,
+                                         const rp_codec_options_t *options)
+{
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+    sink_capture_t capture = {0};
+
+    rp_packet_encode_result_t buffered = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, message, options);
+    rp_packet_encode_result_t streamed = rp_packet_encode_to_sink(
+        capture_sink, &capture, CODEC_TEST_DATA_FIELDS, message, options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, buffered.status);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, streamed.status);
+    TEST_ASSERT_EQUAL(buffered.written, streamed.written);
+    TEST_ASSERT_EQUAL(buffered.written, capture.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(packet, capture.bytes, buffered.written);
+}
+
+static crc16_repair_table_t repair_table;
+
 void setUp(void)
 {
 }
@@ -146,6 +265,407 @@ void test_codec_encode_decode_should_succeed(void)
     TEST_ASSERT(input_message.oo.mo == output_message.oo.mo);
 }
 
+void test_codec_fec_encode_decode_should_succeed(void)
+{
+    rs_codec_t fec;
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, 8));
+
+    const rp_codec_options_t options = {.fec = &fec};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT_EQUAL(0, decode_result.corrected);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+}
+
+void test_codec_fec_should_correct_byte_errors(void)
+{
+    rs_codec_t fec;
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, 8));
+
+    const rp_codec_options_t options = {.fec = &fec};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    corrupt_data_bytes(packet, encode_result.written, 4);
+
+    // Without FEC the same damage is fatal
+    rp_packet_decode_result_t plain_result = rp_packet_decode(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message);
+
+    TEST_ASSERT_NOT_EQUAL(RP_CODEC_OK, plain_result.status);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT_EQUAL(4, decode_result.corrected);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+    TEST_ASSERT(sample_message.oo.mo == output_message.oo.mo);
+}
+
+void test_codec_fec_should_reject_uncorrectable_frame(void)
+{
+    rs_codec_t fec;
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, 2));
+
+    const rp_codec_options_t options = {.fec = &fec};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    corrupt_data_bytes(packet, encode_result.written, 3);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_NOT_EQUAL(RP_CODEC_OK, decode_result.status);
+}
+
+void test_codec_repair_should_fix_single_bit_error(void)
+{
+    crc16_repair_table_init(&repair_table);
+
+    const rp_codec_options_t options = {.repair = &repair_table, .repair_max_bits = 1};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result =
+        rp_packet_encode(packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    flip_data_bit(packet, encode_result.written, 3);
+
+    rp_packet_decode_result_t plain_result = rp_packet_decode(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, plain_result.status);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT_EQUAL(1, decode_result.repaired_bits);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+    TEST_ASSERT(sample_message.oo.mo == output_message.oo.mo);
+}
+
+void test_codec_repair_should_reject_heavy_damage(void)
+{
+    crc16_repair_table_init(&repair_table);
+
+    const rp_codec_options_t options = {.repair = &repair_table, .repair_max_bits = 1};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result =
+        rp_packet_encode(packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    // Two flipped bits have an even weight syndrome, which no single bit error matches
+    flip_data_bit(packet, encode_result.written, 1);
+    flip_data_bit(packet, encode_result.written, 5);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, decode_result.status);
+    TEST_ASSERT_EQUAL(0, decode_result.repaired_bits);
+}
+
+void test_codec_link_header_round_trip(void)
+{
+    rp_link_header_t sent = {.sequence = 513, .timestamp_us = 123456789};
+    rp_link_header_t received = {0};
+
+    const rp_codec_options_t encode_options = {.link_header = &sent};
+    const rp_codec_options_t decode_options = {.link_header = &received};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &encode_options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    rp_packet_decode_result_t decode_result =
+        rp_packet_decode_with_options(packet, encode_result.written, CODEC_TEST_DATA_FIELDS,
+                                      &output_message, &decode_options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT_EQUAL_UINT16(sent.sequence, received.sequence);
+    TEST_ASSERT_EQUAL_UINT32(sent.timestamp_us, received.timestamp_us);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+}
+
+void test_codec_crc32c_encode_decode_should_succeed(void)
+{
+    const rp_codec_options_t options = {.checksum = RP_CODEC_CHECKSUM_CRC32C};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+    uint8_t crc16_packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+    rp_packet_encode_result_t crc16_result = rp_packet_encode(
+        crc16_packet, sizeof(crc16_packet), CODEC_TEST_DATA_FIELDS, &sample_message);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, crc16_result.status);
+    TEST_ASSERT_EQUAL(crc16_result.written + 2, encode_result.written);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+}
+
+void test_codec_crc32c_should_checksum_mismatch(void)
+{
+    const rp_codec_options_t options = {.checksum = RP_CODEC_CHECKSUM_CRC32C};
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+
+    flip_data_bit(packet, encode_result.written, 2);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, decode_result.status);
+}
+
+void test_codec_quant_round_trip(void)
+{
+    static const rp_quant_field_t quant_fields[] = {
+        {
+            .offset = offsetof(codec_test_data_t, f),
+            .kind = RP_QUANT_HALF,
+            .present_offset = RP_QUANT_ALWAYS,
+            .which_offset = RP_QUANT_ALWAYS,
+        },
+    };
+    static const rp_quant_spec_t quant = {
+        .message = CODEC_TEST_DATA_FIELDS,
+        .message_size = sizeof(codec_test_data_t),
+        .fields = quant_fields,
+        .field_count = 1,
+    };
+
+    const rp_codec_options_t options = {.quant = &quant};
+    codec_test_data_t input_message = sample_message;
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+    uint8_t plain_packet[RP_PACKET_MAX_SIZE];
+
+    input_message.f = 1.5f;
+
+    rp_packet_encode_result_t encode_result = rp_packet_encode_with_options(
+        packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &input_message, &options);
+    rp_packet_encode_result_t plain_result = rp_packet_encode(
+        plain_packet, sizeof(plain_packet), CODEC_TEST_DATA_FIELDS, &input_message);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, encode_result.status);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, plain_result.status);
+    TEST_ASSERT(input_message.f == 1.5f);
+
+    // A 1 byte bitmap and 2 byte half instead of a tag and 4 byte float
+    TEST_ASSERT_EQUAL(plain_result.written - 2, encode_result.written);
+
+    rp_packet_decode_result_t decode_result = rp_packet_decode_with_options(
+        packet, encode_result.written, CODEC_TEST_DATA_FIELDS, &output_message, &options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, decode_result.status);
+    TEST_ASSERT(output_message.f == 1.5f);
+    TEST_ASSERT(sample_message.d == output_message.d);
+    TEST_ASSERT(sample_message.ui32 == output_message.ui32);
+}
+
+void test_codec_encode_to_sink_matches_buffered(void)
+{
+    static const rp_quant_field_t quant_fields[] = {
+        {
+            .offset = offsetof(codec_test_data_t, f),
+            .kind = RP_QUANT_HALF,
+            .present_offset = RP_QUANT_ALWAYS,
+            .which_offset = RP_QUANT_ALWAYS,
+        },
+    };
+    static const rp_quant_spec_t quant = {
+        .message = CODEC_TEST_DATA_FIELDS,
+        .message_size = sizeof(codec_test_data_t),
+        .fields = quant_fields,
+        .field_count = 1,
+    };
+
+    rs_codec_t fec;
+    rp_link_header_t header = {.sequence = 7, .timestamp_us = 99};
+    codec_test_data_t message = sample_message;
+
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, 8));
+
+    message.f = -2.5f;
+
+    const rp_codec_options_t crc32c_options = {
+        .checksum = RP_CODEC_CHECKSUM_CRC32C,
+        .link_header = &header,
+    };
+    const rp_codec_options_t fec_options = {.fec = &fec};
+    const rp_codec_options_t quant_options = {.link_header = &header, .quant = &quant};
+
+    assert_sink_matches_buffered(&sample_message, NULL);
+    assert_sink_matches_buffered(&message, &crc32c_options);
+    assert_sink_matches_buffered(&message, &fec_options);
+    assert_sink_matches_buffered(&message, &quant_options);
+}
+
+void test_codec_encode_to_sink_should_report_sink_failure(void)
+{
+    sink_capture_t capture = {.fail = true};
+
+    rp_packet_encode_result_t result = rp_packet_encode_to_sink(
+        capture_sink, &capture, CODEC_TEST_DATA_FIELDS, &sample_message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_ERROR, result.status);
+    TEST_ASSERT_EQUAL(0, result.written);
+
+    result = rp_packet_encode_to_sink(NULL, NULL, CODEC_TEST_DATA_FIELDS, &sample_message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER, result.status);
+}
+
+void test_codec_verify_batch_matches_decode(void)
+{
+    static uint8_t packets[150][RP_PACKET_MAX_SIZE];
+    const uint8_t *frames[150];
+    size_t sizes[150];
+    rp_codec_status_t statuses[150];
+    size_t expected_ok = 0;
+
+    for (uint32_t i = 0; i < 150; i++) {
+        codec_test_data_t message = sample_message;
+
+        // Varint fields of different sizes give frames of different lengths
+        message.ui32 = i * i * 997;
+        message.which_oo = (i % 3 == 0) ? CODEC_TEST_DATA_MO_TAG : 0;
+
+        rp_packet_encode_result_t encoded = rp_packet_encode(
+            packets[i], sizeof(packets[i]), CODEC_TEST_DATA_FIELDS, &message);
+
+        TEST_ASSERT_EQUAL(RP_CODEC_OK, encoded.status);
+
+        if (i % 7 == 3) {
+            flip_data_bit(packets[i], encoded.written, i % 5);
+        }
+
+        frames[i] = packets[i];
+        sizes[i] = (i % 50 == 20) ? 2 : encoded.written;
+    }
+
+    size_t verified = rp_packet_verify_batch(frames, sizes, 150, statuses, &verify_scratch, NULL);
+
+    for (size_t i = 0; i < 150; i++) {
+        codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+        rp_packet_decode_result_t decode_result =
+            rp_packet_decode(frames[i], sizes[i], CODEC_TEST_DATA_FIELDS, &output_message);
+
+        TEST_ASSERT_EQUAL(decode_result.status, statuses[i]);
+        expected_ok += (decode_result.status == RP_CODEC_OK);
+    }
+
+    TEST_ASSERT_EQUAL(expected_ok, verified);
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, statuses[3]);
+}
+
+void test_codec_verify_batch_with_fec_and_crc32c(void)
+{
+    rs_codec_t fec;
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, 4));
+
+    const rp_codec_options_t options = {.checksum = RP_CODEC_CHECKSUM_CRC32C, .fec = &fec};
+    uint8_t packets[3][RP_PACKET_MAX_SIZE];
+    const uint8_t *frames[3];
+    size_t sizes[3];
+    rp_codec_status_t statuses[3];
+
+    for (size_t i = 0; i < 3; i++) {
+        rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+            packets[i], sizeof(packets[i]), CODEC_TEST_DATA_FIELDS, &sample_message, &options);
+
+        TEST_ASSERT_EQUAL(RP_CODEC_OK, encoded.status);
+
+        frames[i] = packets[i];
+        sizes[i] = encoded.written;
+    }
+
+    // Correctable by the code, then beyond it
+    corrupt_data_bytes(packets[1], sizes[1], 2);
+    corrupt_data_bytes(packets[2], sizes[2], 6);
+
+    TEST_ASSERT_EQUAL(
+        2, rp_packet_verify_batch(frames, sizes, 3, statuses, &verify_scratch, &options));
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, statuses[0]);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, statuses[1]);
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, statuses[2]);
+}
+
+void test_codec_verify_batch_rejects_frame_shorter_than_link_header(void)
+{
+    rp_link_header_t header = {0};
+    const rp_codec_options_t options = {.link_header = &header};
+    uint8_t codeword[4] = {0x12, 0x34};
+    uint8_t packet[8];
+
+    // Two payload bytes and a matching checksum, but no room for the header
+    uint16_t crc = crc16_ccitt(codeword, 2);
+
+    codeword[2] = (uint8_t)(crc & 0xFF);
+    codeword[3] = (uint8_t)(crc >> 8);
+
+    const uint8_t *frames[1] = {packet};
+    size_t sizes[1] = {cobs_encode(codeword, sizeof(codeword), packet, sizeof(packet)).written};
+    rp_codec_status_t statuses[1];
+    codec_test_data_t output_message = CODEC_TEST_DATA_INIT_DEFAULT;
+
+    TEST_ASSERT_EQUAL(
+        0, rp_packet_verify_batch(frames, sizes, 1, statuses, &verify_scratch, &options));
+    TEST_ASSERT_EQUAL(RP_CODEC_ERROR, statuses[0]);
+    TEST_ASSERT_EQUAL(statuses[0], rp_packet_decode_with_options(packet, sizes[0],
+                                                                 CODEC_TEST_DATA_FIELDS,
+                                                                 &output_message, &options)
+                                       .status);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -154,6 +674,20 @@ int main(void)
     RUN_TEST(test_codec_decode_should_error);
     RUN_TEST(test_codec_decode_should_checksum_mismatch);
     RUN_TEST(test_codec_encode_decode_should_succeed);
+    RUN_TEST(test_codec_fec_encode_decode_should_succeed);
+    RUN_TEST(test_codec_fec_should_correct_byte_errors);
+    RUN_TEST(test_codec_fec_should_reject_uncorrectable_frame);
+    RUN_TEST(test_codec_repair_should_fix_single_bit_error);
+    RUN_TEST(test_codec_repair_should_reject_heavy_damage);
+    RUN_TEST(test_codec_link_header_round_trip);
+    RUN_TEST(test_codec_crc32c_encode_decode_should_succeed);
+    RUN_TEST(test_codec_crc32c_should_checksum_mismatch);
+    RUN_TEST(test_codec_quant_round_trip);
+    RUN_TEST(test_codec_encode_to_sink_matches_buffered);
+    RUN_TEST(test_codec_encode_to_sink_should_report_sink_failure);
+    RUN_TEST(test_codec_verify_batch_matches_decode);
+    RUN_TEST(test_codec_verify_batch_with_fec_and_crc32c);
+    RUN_TEST(test_codec_verify_batch_rejects_frame_shorter_than_link_header);
 
     return UNITY_END();
 }
@@ -0,0 +1,4 @@
+// The codec tests, run against the single header build instead of the libraries
+#include "rp_protocol_all.h"
+
+#include "test_codec.c"
@@ -0,0 +1,201 @@
+#include "rp/codec.hpp"
+#include "unity.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "proto/codec_test_data.pb.h"
+
+RP_MESSAGE_TRAITS_EX(codec_test_data_t, CODEC_TEST_DATA_FIELDS, CODEC_TEST_DATA_SIZE);
+RP_MESSAGE_TRAITS_EX(largest_frame_t, LARGEST_FRAME_FIELDS, LARGEST_FRAME_SIZE);
+RP_MESSAGE_TRAITS_EX(oversized_frame_t, OVERSIZED_FRAME_FIELDS, OVERSIZED_FRAME_SIZE);
+
+namespace {
+
+codec_test_data_t make_sample_message()
+{
+    codec_test_data_t message = CODEC_TEST_DATA_INIT_DEFAULT;
+
+    message.d = 3.1415926;
+    message.ui32 = 1234567890;
+    message.b1 = true;
+    message.which_oo = CODEC_TEST_DATA_MO_TAG;
+    message.oo.mo = MY_OPTION_MY_OPTIONS_VALUE2;
+
+    return message;
+}
+
+} // namespace
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_codec_hpp_frame_size_is_compile_time(void)
+{
+    using codec_type = rp::codec<codec_test_data_t>;
+    using fec_codec_type = rp::codec<codec_test_data_t, rp::framing{.parity_size = 16}>;
+
+    static_assert(rp::frame_size<codec_test_data_t> ==
+                  rp::cobs_max_encoded_size(CODEC_TEST_DATA_SIZE + 2));
+    static_assert(rp::frame_size<codec_test_data_t, rp::any_framing> ==
+                  rp::cobs_max_encoded_size(CODEC_TEST_DATA_SIZE + RP_LINK_HEADER_SIZE +
+                                            RP_QUANT_MAX_BITMAP_SIZE + 4 + RS_MAX_PARITY));
+    static_assert(std::tuple_size_v<codec_type::buffer_type> == codec_type::max_frame_size);
+    static_assert(fec_codec_type::max_frame_size ==
+                  rp::cobs_max_encoded_size(CODEC_TEST_DATA_SIZE + 2 + 16));
+    static_assert(rp::cobs_max_encoded_size(0) == 2);
+    static_assert(rp::cobs_max_encoded_size(254) == 256);
+    static_assert(rp::cobs_max_encoded_size(255) == 258);
+
+    TEST_ASSERT_EQUAL(cobs_get_max_encoded_size(300), rp::cobs_max_encoded_size(300));
+}
+
+void test_codec_hpp_largest_message_fits_a_packet(void)
+{
+    constexpr rp::framing crc16{.checksum = RP_CODEC_CHECKSUM_CRC16};
+    constexpr rp::framing crc32c{.checksum = RP_CODEC_CHECKSUM_CRC32C};
+
+    static_assert(LARGEST_FRAME_SIZE == 253);
+    static_assert(OVERSIZED_FRAME_SIZE == 254);
+    static_assert(rp::fits_packet<largest_frame_t, crc16>);
+    static_assert(!rp::fits_packet<oversized_frame_t, crc16>);
+    static_assert(!rp::fits_packet<largest_frame_t, crc32c>);
+    static_assert(!rp::fits_packet<largest_frame_t, rp::framing{.parity_size = 2}>);
+
+    rp_codec_options_t options{};
+
+    options.checksum = RP_CODEC_CHECKSUM_CRC16;
+
+    // What the static_assert allows encodes at its largest
+    const rp::codec<largest_frame_t, crc16> codec{options};
+    rp::codec<largest_frame_t, crc16>::buffer_type buffer{};
+    largest_frame_t largest = LARGEST_FRAME_INIT_ZERO;
+
+    largest.data.size = sizeof(largest.data.bytes);
+    std::memset(largest.data.bytes, 0x5A, sizeof(largest.data.bytes));
+
+    auto frame = codec.encode(largest, buffer);
+
+    TEST_ASSERT_TRUE(frame.has_value());
+
+    auto output = codec.decode(*frame);
+
+    TEST_ASSERT_TRUE(output.has_value());
+    TEST_ASSERT_EQUAL(sizeof(largest.data.bytes), output->data.size);
+
+    // One byte more overflows, so rp::codec<oversized_frame_t, crc16> does not compile
+    std::array<std::uint8_t, 2 * RP_PACKET_MAX_SIZE> large_buffer{};
+    oversized_frame_t oversized = OVERSIZED_FRAME_INIT_ZERO;
+
+    oversized.data.size = sizeof(oversized.data.bytes);
+    std::memset(oversized.data.bytes, 0x5A, sizeof(oversized.data.bytes));
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OVERFLOW,
+                      rp_packet_encode_with_options(large_buffer.data(), large_buffer.size(),
+                                                    OVERSIZED_FRAME_FIELDS, &oversized, &options)
+                          .status);
+}
+
+void test_codec_hpp_encode_decode_should_succeed(void)
+{
+    const rp::codec<codec_test_data_t> codec;
+    const codec_test_data_t input = make_sample_message();
+    rp::codec<codec_test_data_t>::buffer_type buffer{};
+
+    auto frame = codec.encode(input, buffer);
+
+    TEST_ASSERT_TRUE(frame.has_value());
+    TEST_ASSERT_EQUAL_PTR(buffer.data(), frame->data());
+
+    auto output = codec.decode(*frame);
+
+    TEST_ASSERT_TRUE(output.has_value());
+    TEST_ASSERT(input.d == output->d);
+    TEST_ASSERT(input.ui32 == output->ui32);
+    TEST_ASSERT(input.oo.mo == output->oo.mo);
+}
+
+void test_codec_hpp_encode_should_overflow(void)
+{
+    const rp::codec<codec_test_data_t> codec;
+    std::array<std::uint8_t, 4> buffer{};
+
+    auto frame = codec.encode(make_sample_message(), std::span<std::uint8_t>{buffer});
+
+    TEST_ASSERT_FALSE(frame.has_value());
+    TEST_ASSERT_EQUAL(RP_CODEC_OVERFLOW, frame.error());
+}
+
+void test_codec_hpp_decode_should_checksum_mismatch(void)
+{
+    const rp::codec<codec_test_data_t> codec;
+    rp::codec<codec_test_data_t>::buffer_type buffer{};
+
+    auto frame = codec.encode(make_sample_message(), buffer);
+
+    TEST_ASSERT_TRUE(frame.has_value());
+
+    // The payload does not start with a zero, so the byte after the COBS code is data
+    TEST_ASSERT_TRUE(buffer[0] > 1);
+    buffer[1] ^= (buffer[1] == 0x01) ? 0x02 : 0x01;
+
+    auto output = codec.decode(*frame);
+
+    TEST_ASSERT_FALSE(output.has_value());
+    TEST_ASSERT_EQUAL(RP_CODEC_CHECKSUM_MISMATCH, output.error());
+}
+
+void test_codec_hpp_options_are_applied(void)
+{
+    rs_codec_t fec;
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, RS_MAX_PARITY));
+
+    rp_link_header_t header = {.sequence = 7, .timestamp_us = 1000};
+    rp_codec_options_t options{};
+
+    options.checksum = RP_CODEC_CHECKSUM_CRC32C;
+    options.fec = &fec;
+    options.link_header = &header;
+
+    constexpr rp::framing framing{
+        .link_header = true, .checksum = RP_CODEC_CHECKSUM_CRC32C, .parity_size = RS_MAX_PARITY};
+
+    const rp::codec<codec_test_data_t, framing> codec{options};
+    rp::codec<codec_test_data_t, framing>::buffer_type buffer{};
+
+    // The compile-time buffer has room for the options described by the framing
+    auto frame = codec.encode(make_sample_message(), buffer);
+
+    TEST_ASSERT_TRUE(frame.has_value());
+
+    header = {};
+
+    codec_test_data_t output = CODEC_TEST_DATA_INIT_DEFAULT;
+    auto info = codec.decode(*frame, output);
+
+    TEST_ASSERT_TRUE(info.has_value());
+    TEST_ASSERT_EQUAL(0, info->corrected);
+    TEST_ASSERT_EQUAL_UINT16(7, header.sequence);
+    TEST_ASSERT(make_sample_message().ui32 == output.ui32);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_codec_hpp_frame_size_is_compile_time);
+    RUN_TEST(test_codec_hpp_largest_message_fits_a_packet);
+    RUN_TEST(test_codec_hpp_encode_decode_should_succeed);
+    RUN_TEST(test_codec_hpp_encode_should_overflow);
+    RUN_TEST(test_codec_hpp_decode_should_checksum_mismatch);
+    RUN_TEST(test_codec_hpp_options_are_applied);
+
+    return UNITY_END();
+}
@@ -0,0 +1,168 @@
+#include "rp/frame_cache.h"
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "proto/codec_test_data.pb.h"
+#include "rp/codec.h"
+#include "rp/link/link.h"
+#include "unity_internals.h"
+
+static const codec_test_data_t sample_message = {
+    .d = 3.1415926,
+    .ui32 = 1234567890,
+    .f = 0.0,
+    .b1 = true,
+    .b2 = false,
+    .which_oo = CODEC_TEST_DATA_MO_TAG,
+    .oo =
+        {
+            .mo = MY_OPTION_MY_OPTIONS_VALUE2,
+        },
+};
+
+static rp_frame_cache_t cache;
+static codec_test_data_t snapshot;
+
+/**
+ * Encodes `message` through the cache and checks the frame against a fresh encode.
+ */
+static void assert_cached_encode(const codec_test_data_t *message,
+                                 const rp_codec_options_t *options)
+{
+    uint8_t expected[RP_PACKET_MAX_SIZE];
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t fresh = rp_packet_encode_with_options(
+        expected, sizeof(expected), CODEC_TEST_DATA_FIELDS, message, options);
+    rp_packet_encode_result_t cached =
+        rp_frame_cache_encode(&cache, packet, sizeof(packet), message, options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, fresh.status);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, cached.status);
+    TEST_ASSERT_EQUAL(fresh.written, cached.written);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, packet, fresh.written);
+}
+
+void setUp(void)
+{
+    memset(&snapshot, 0, sizeof(snapshot));
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, rp_frame_cache_init(&cache, CODEC_TEST_DATA_FIELDS,
+                                                       &snapshot, sizeof(snapshot)));
+}
+
+void tearDown(void)
+{
+}
+
+void test_frame_cache_should_reuse_unchanged_message(void)
+{
+    codec_test_data_t message = sample_message;
+
+    assert_cached_encode(&message, NULL);
+    assert_cached_encode(&message, NULL);
+    assert_cached_encode(&message, NULL);
+
+    TEST_ASSERT_EQUAL(1, cache.misses);
+    TEST_ASSERT_EQUAL(2, cache.hits);
+}
+
+void test_frame_cache_should_reencode_changed_message(void)
+{
+    codec_test_data_t message = sample_message;
+
+    assert_cached_encode(&message, NULL);
+
+    message.ui32++;
+    assert_cached_encode(&message, NULL);
+
+    message.which_oo = CODEC_TEST_DATA_UI64_TAG;
+    message.oo.ui64 = 0x0123456789ABCDEFULL;
+    assert_cached_encode(&message, NULL);
+    assert_cached_encode(&message, NULL);
+
+    TEST_ASSERT_EQUAL(3, cache.misses);
+    TEST_ASSERT_EQUAL(1, cache.hits);
+}
+
+void test_frame_cache_should_reencode_changed_options(void)
+{
+    rp_link_header_t header = {.sequence = 7, .timestamp_us = 1000};
+    const rp_codec_options_t crc32c_options = {.checksum = RP_CODEC_CHECKSUM_CRC32C};
+    const rp_codec_options_t link_options = {.link_header = &header};
+
+    assert_cached_encode(&sample_message, NULL);
+    assert_cached_encode(&sample_message, &crc32c_options);
+    assert_cached_encode(&sample_message, &link_options);
+
+    // Same header again, e.g. a retransmission
+    assert_cached_encode(&sample_message, &link_options);
+
+    // Headers are updated in place between frames
+    header.sequence++;
+    assert_cached_encode(&sample_message, &link_options);
+
+    TEST_ASSERT_EQUAL(4, cache.misses);
+    TEST_ASSERT_EQUAL(1, cache.hits);
+}
+
+void test_frame_cache_invalidate_should_force_encode(void)
+{
+    assert_cached_encode(&sample_message, NULL);
+
+    rp_frame_cache_invalidate(&cache);
+    assert_cached_encode(&sample_message, NULL);
+
+    TEST_ASSERT_EQUAL(2, cache.misses);
+    TEST_ASSERT_EQUAL(0, cache.hits);
+}
+
+void test_frame_cache_should_report_small_packet(void)
+{
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t result =
+        rp_frame_cache_encode(&cache, packet, 4, &sample_message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OVERFLOW, result.status);
+    TEST_ASSERT_EQUAL(0, result.written);
+
+    // The frame was still cached
+    assert_cached_encode(&sample_message, NULL);
+    TEST_ASSERT_EQUAL(1, cache.hits);
+}
+
+void test_frame_cache_should_reject_null_pointers(void)
+{
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER,
+                      rp_frame_cache_init(NULL, CODEC_TEST_DATA_FIELDS, &snapshot, 1));
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER,
+                      rp_frame_cache_init(&cache, CODEC_TEST_DATA_FIELDS, NULL, 1));
+    TEST_ASSERT_EQUAL(RP_CODEC_ERROR,
+                      rp_frame_cache_init(&cache, CODEC_TEST_DATA_FIELDS, &snapshot, 0));
+
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER,
+                      rp_frame_cache_encode(NULL, packet, sizeof(packet), &sample_message, NULL)
+                          .status);
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER,
+                      rp_frame_cache_encode(&cache, packet, sizeof(packet), NULL, NULL).status);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_frame_cache_should_reuse_unchanged_message);
+    RUN_TEST(test_frame_cache_should_reencode_changed_message);
+    RUN_TEST(test_frame_cache_should_reencode_changed_options);
+    RUN_TEST(test_frame_cache_invalidate_should_force_encode);
+    RUN_TEST(test_frame_cache_should_report_small_packet);
+    RUN_TEST(test_frame_cache_should_reject_null_pointers);
+
+    return UNITY_END();
+}
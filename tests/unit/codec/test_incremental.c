@@ -0,0 +1,228 @@
+#include "rp/incremental.h"
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "proto/codec_test_data.pb.h"
+#include "rp/codec.h"
+#include "rp/link/link.h"
+#include "unity_internals.h"
+
+static const rp_incremental_field_t test_fields[] = {
+    {.offset = offsetof(codec_test_data_t, d),
+     .wire = RP_INCREMENTAL_FIXED64,
+     .depth = 1,
+     .tags = {1}},
+    {.offset = offsetof(codec_test_data_t, ui32),
+     .wire = RP_INCREMENTAL_VARINT,
+     .depth = 1,
+     .tags = {2}},
+    {.offset = offsetof(codec_test_data_t, f),
+     .wire = RP_INCREMENTAL_FIXED32,
+     .depth = 1,
+     .tags = {3}},
+};
+
+static const rp_incremental_spec_t test_spec = {
+    .message = CODEC_TEST_DATA_FIELDS,
+    .message_size = sizeof(codec_test_data_t),
+    .fields = test_fields,
+    .field_count = sizeof(test_fields) / sizeof(test_fields[0]),
+};
+
+static rp_incremental_encoder_t encoder;
+static codec_test_data_t snapshot;
+static codec_test_data_t message;
+
+/**
+ * Encodes `message` incrementally and checks the frame against a full encode.
+ */
+static void assert_incremental_encode(const rp_codec_options_t *options)
+{
+    uint8_t expected[RP_PACKET_MAX_SIZE];
+    uint8_t packet[RP_PACKET_MAX_SIZE];
+
+    rp_packet_encode_result_t full = rp_packet_encode_with_options(
+        expected, sizeof(expected), CODEC_TEST_DATA_FIELDS, &message, options);
+    rp_packet_encode_result_t incremental =
+        rp_incremental_encode(&encoder, packet, sizeof(packet), &message, options);
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, full.status);
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, incremental.status);
+    TEST_ASSERT_EQUAL(full.written, incremental.written);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, packet, full.written);
+}
+
+void setUp(void)
+{
+    memset(&message, 0, sizeof(message));
+
+    message.d = 3.1415926;
+    message.ui32 = 100000;
+    message.f = 1.5f;
+    message.b1 = true;
+    message.which_oo = CODEC_TEST_DATA_MO_TAG;
+    message.oo.mo = MY_OPTION_MY_OPTIONS_VALUE2;
+
+    TEST_ASSERT_EQUAL(RP_CODEC_OK, rp_incremental_init(&encoder, &test_spec, &snapshot));
+}
+
+void tearDown(void)
+{
+}
+
+void test_incremental_should_patch_changed_fields(void)
+{
+    uint32_t state = 12345;
+
+    assert_incremental_encode(NULL);
+
+    for (int i = 0; i < 500; i++) {
+        state = state * 1103515245 + 12345;
+
+        // Same varint length, never zero
+        message.ui32 = 16384 + (state >> 12) % 2000000;
+
+        if (i % 3 == 0) {
+            message.f = (float)(state % 1000) * 0.25f + 0.125f;
+        }
+
+        if (i % 5 == 0) {
+            message.d += 0.001 * (double)(state % 97);
+        }
+
+        assert_incremental_encode(NULL);
+    }
+
+    TEST_ASSERT_EQUAL(1, encoder.full_encodes);
+    TEST_ASSERT_EQUAL(500, encoder.patched_encodes);
+}
+
+void test_incremental_should_fall_back_on_layout_change(void)
+{
+    assert_incremental_encode(NULL);
+
+    // Longer varint
+    message.ui32 = 3000000;
+    assert_incremental_encode(NULL);
+
+    // Field disappears, and comes back
+    message.f = 0.0f;
+    assert_incremental_encode(NULL);
+    message.f = 2.0f;
+    assert_incremental_encode(NULL);
+
+    // Member outside the spec
+    message.b2 = true;
+    assert_incremental_encode(NULL);
+
+    message.which_oo = CODEC_TEST_DATA_UI64_TAG;
+    message.oo.ui64 = 0x0123456789ABCDEFULL;
+    assert_incremental_encode(NULL);
+
+    TEST_ASSERT_EQUAL(6, encoder.full_encodes);
+    TEST_ASSERT_EQUAL(0, encoder.patched_encodes);
+
+    message.ui32 = 3000001;
+    assert_incremental_encode(NULL);
+
+    TEST_ASSERT_EQUAL(1, encoder.patched_encodes);
+}
+
+void test_incremental_should_reencode_cobs_when_zero_bytes_change(void)
+{
+    // 2.0f is 00 00 00 40, 2.0000002f is 01 00 00 40
+    message.f = 2.0f;
+    assert_incremental_encode(NULL);
+
+    uint32_t bits = 0x40000001;
+
+    memcpy(&message.f, &bits, sizeof(bits));
+    assert_incremental_encode(NULL);
+
+    bits = 0x40010101;
+    memcpy(&message.f, &bits, sizeof(bits));
+    assert_incremental_encode(NULL);
+
+    TEST_ASSERT_EQUAL(1, encoder.full_encodes);
+    TEST_ASSERT_EQUAL(2, encoder.patched_encodes);
+    TEST_ASSERT_GREATER_OR_EQUAL(2, encoder.cobs_reencodes);
+}
+
+void test_incremental_should_patch_link_header(void)
+{
+    rp_link_header_t header = {.sequence = 65530, .timestamp_us = 250};
+    const rp_codec_options_t options = {.link_header = &header};
+
+    assert_incremental_encode(&options);
+
+    for (int i = 0; i < 300; i++) {
+        header.sequence++;
+        header.timestamp_us += 977;
+        message.ui32++;
+
+        assert_incremental_encode(&options);
+    }
+
+    TEST_ASSERT_EQUAL(1, encoder.full_encodes);
+    TEST_ASSERT_EQUAL(300, encoder.patched_encodes);
+
+    // Dropping the header changes the layout
+    assert_incremental_encode(NULL);
+
+    TEST_ASSERT_EQUAL(2, encoder.full_encodes);
+}
+
+void test_incremental_should_encode_unsupported_options_in_full(void)
+{
+    const rp_codec_options_t options = {.checksum = RP_CODEC_CHECKSUM_CRC32C};
+
+    for (int i = 0; i < 4; i++) {
+        message.ui32++;
+        assert_incremental_encode(&options);
+    }
+
+    TEST_ASSERT_EQUAL(4, encoder.full_encodes);
+    TEST_ASSERT_EQUAL(0, encoder.patched_encodes);
+}
+
+void test_incremental_should_reject_invalid_spec(void)
+{
+    rp_incremental_field_t unsorted[] = {test_fields[1], test_fields[0]};
+    rp_incremental_spec_t spec = test_spec;
+
+    TEST_ASSERT_TRUE(rp_incremental_spec_valid(&test_spec));
+
+    spec.fields = unsorted;
+    spec.field_count = 2;
+    TEST_ASSERT_FALSE(rp_incremental_spec_valid(&spec));
+    TEST_ASSERT_EQUAL(RP_CODEC_ERROR, rp_incremental_init(&encoder, &spec, &snapshot));
+
+    unsorted[0] = test_fields[0];
+    unsorted[0].depth = 0;
+    spec.field_count = 1;
+    TEST_ASSERT_FALSE(rp_incremental_spec_valid(&spec));
+
+    unsorted[0] = test_fields[0];
+    unsorted[0].offset = sizeof(codec_test_data_t) - 4;
+    TEST_ASSERT_FALSE(rp_incremental_spec_valid(&spec));
+
+    TEST_ASSERT_EQUAL(RP_CODEC_NULL_POINTER, rp_incremental_init(&encoder, &test_spec, NULL));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_incremental_should_patch_changed_fields);
+    RUN_TEST(test_incremental_should_fall_back_on_layout_change);
+    RUN_TEST(test_incremental_should_reencode_cobs_when_zero_bytes_change);
+    RUN_TEST(test_incremental_should_patch_link_header);
+    RUN_TEST(test_incremental_should_encode_unsupported_options_in_full);
+    RUN_TEST(test_incremental_should_reject_invalid_spec);
+
+    return UNITY_END();
+}
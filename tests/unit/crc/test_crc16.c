@@ -1,11 +1,15 @@
 #include "unity.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #include "rp/crc/crc.h"
 
+static crc16_repair_table_t repair_table;
+
 void setUp(void)
 {
+    crc16_repair_table_init(&repair_table);
 }
 
 void tearDown(void)
@@ -40,6 +44,158 @@ void test_crc16_ccitt_check_with_incorrect_codeword(void)
     TEST_ASSERT_NOT_EQUAL_UINT16(CRC16_CCITT_RESIDUE, residue);
 }
 
+void test_crc16_ccitt_update_continues_checksum(void)
+{
+    const uint8_t data[] = "123456789";
+
+    for (size_t split = 0; split <= 9; split++) {
+        uint16_t checksum = crc16_ccitt_update(crc16_ccitt(data, split), &data[split], 9 - split);
+
+        TEST_ASSERT_EQUAL_UINT16(0x2189, checksum);
+    }
+}
+
+void test_crc16_ccitt_shift_matches_zero_bytes(void)
+{
+    const uint8_t zeros[300] = {0};
+    const uint8_t data[] = "123456789";
+    uint16_t checksum = crc16_ccitt(data, 9);
+
+    for (size_t length = 0; length <= sizeof(zeros); length += 13) {
+        TEST_ASSERT_EQUAL_UINT16(crc16_ccitt_update(checksum, zeros, length),
+                                 crc16_ccitt_shift(checksum, crc16_ccitt_shift_operator(length)));
+    }
+}
+
+void test_crc16_ccitt_shift_updates_changed_bytes(void)
+{
+    uint8_t data[] = "123456789";
+    uint16_t checksum = crc16_ccitt(data, 9);
+
+    // Replace "45" by "xy": delta of the changed bytes, followed by 4 unchanged bytes
+    const uint8_t delta[] = {'4' ^ 'x', '5' ^ 'y'};
+
+    data[3] = 'x';
+    data[4] = 'y';
+    checksum ^= crc16_ccitt_shift(crc16_ccitt(delta, 2), crc16_ccitt_shift_operator(4));
+
+    TEST_ASSERT_EQUAL_UINT16(crc16_ccitt(data, 9), checksum);
+}
+
+void test_crc16_ccitt_batch_matches_single(void)
+{
+    static uint8_t data[4096];
+    const uint8_t *buffers[300];
+    size_t lengths[300];
+    uint16_t crcs[300];
+    uint32_t state = 12345;
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        state = state * 1103515245U + 12345U;
+        data[i] = (uint8_t)(state >> 16);
+    }
+
+    // Mixed lengths, including empty and NULL buffers, and a count that is not a
+    // multiple of the lanes
+    for (size_t i = 0; i < 300; i++) {
+        state = state * 1103515245U + 12345U;
+        lengths[i] = (state >> 16) % 257;
+        buffers[i] = (i % 37 == 5) ? NULL : &data[(state >> 8) % (sizeof(data) - 256)];
+    }
+
+    lengths[7] = 0;
+
+    crc16_ccitt_batch(buffers, lengths, 300, crcs);
+
+    for (size_t i = 0; i < 300; i++) {
+        TEST_ASSERT_EQUAL_UINT16(crc16_ccitt(buffers[i], lengths[i]), crcs[i]);
+    }
+}
+
+void test_crc16_ccitt_batch_few_buffers(void)
+{
+    const uint8_t check[] = "123456789";
+    const uint8_t codeword[] = "123456789\x89\x21";
+    const uint8_t *buffers[] = {check, codeword, check};
+    const size_t lengths[] = {9, 11, 3};
+    uint16_t crcs[3];
+
+    crc16_ccitt_batch(buffers, lengths, 3, crcs);
+
+    TEST_ASSERT_EQUAL_UINT16(0x2189, crcs[0]);
+    TEST_ASSERT_EQUAL_UINT16(CRC16_CCITT_RESIDUE, crcs[1]);
+    TEST_ASSERT_EQUAL_UINT16(crc16_ccitt(check, 3), crcs[2]);
+}
+
+void test_crc16_repair_single_bit_error(void)
+{
+    const uint8_t expected[] = "123456789\x89\x21";
+    const size_t length = sizeof(expected) - 1;
+
+    for (size_t bit = 0; bit < length * 8; bit++) {
+        uint8_t codeword[sizeof(expected)];
+        memcpy(codeword, expected, sizeof(expected));
+
+        codeword[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+
+        size_t repaired =
+            crc16_repair(&repair_table, codeword, length, crc16_ccitt(codeword, length), 1);
+
+        TEST_ASSERT_EQUAL_size_t(1, repaired);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, length);
+    }
+}
+
+void test_crc16_repair_double_bit_error(void)
+{
+    const uint8_t expected[] = "123456789\x89\x21";
+    const size_t length = sizeof(expected) - 1;
+    uint8_t codeword[sizeof(expected)];
+
+    memcpy(codeword, expected, sizeof(expected));
+    codeword[2] ^= 0x10;
+    codeword[7] ^= 0x02;
+
+    size_t repaired =
+        crc16_repair(&repair_table, codeword, length, crc16_ccitt(codeword, length), 2);
+
+    TEST_ASSERT_EQUAL_size_t(2, repaired);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, length);
+}
+
+void test_crc16_repair_double_bit_error_not_attempted_when_limited_to_one(void)
+{
+    const uint8_t expected[] = "123456789\x89\x21";
+    const size_t length = sizeof(expected) - 1;
+    uint8_t codeword[sizeof(expected)];
+
+    memcpy(codeword, expected, sizeof(expected));
+    codeword[2] ^= 0x10;
+    codeword[7] ^= 0x02;
+
+    uint8_t received[sizeof(expected)];
+    memcpy(received, codeword, sizeof(codeword));
+
+    size_t repaired =
+        crc16_repair(&repair_table, codeword, length, crc16_ccitt(codeword, length), 1);
+
+    TEST_ASSERT_EQUAL_size_t(0, repaired);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(received, codeword, length);
+}
+
+void test_crc16_repair_rejects_codeword_that_is_too_long(void)
+{
+    uint8_t codeword[CRC16_REPAIR_MAX_LENGTH + 1] = {0};
+
+    codeword[0] = 0x01;
+
+    size_t repaired = crc16_repair(&repair_table, codeword, sizeof(codeword),
+                                   crc16_ccitt(codeword, sizeof(codeword)), 2);
+
+    TEST_ASSERT_EQUAL_size_t(0, repaired);
+    TEST_ASSERT_EQUAL_UINT8(0x01, codeword[0]);
+}
+
 int main(void)
 {
     UNITY_BEGIN();
@@ -47,6 +203,15 @@ int main(void)
     RUN_TEST(test_crc16_ccitt_checksum_correct);
     RUN_TEST(test_crc16_ccitt_check_with_correct_codeword);
     RUN_TEST(test_crc16_ccitt_check_with_incorrect_codeword);
+    RUN_TEST(test_crc16_ccitt_update_continues_checksum);
+    RUN_TEST(test_crc16_ccitt_shift_matches_zero_bytes);
+    RUN_TEST(test_crc16_ccitt_shift_updates_changed_bytes);
+    RUN_TEST(test_crc16_ccitt_batch_matches_single);
+    RUN_TEST(test_crc16_ccitt_batch_few_buffers);
+    RUN_TEST(test_crc16_repair_single_bit_error);
+    RUN_TEST(test_crc16_repair_double_bit_error);
+    RUN_TEST(test_crc16_repair_double_bit_error_not_attempted_when_limited_to_one);
+    RUN_TEST(test_crc16_repair_rejects_codeword_that_is_too_long);
 
     return UNITY_END();
 }
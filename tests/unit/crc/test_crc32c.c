@@ -0,0 +1,90 @@
+#include "unity.h"
+
+#include <stdint.h>
+
+#include "rp/crc/crc.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_crc32c_checksum_correct(void)
+{
+    const uint8_t data[] = "123456789";
+    const uint32_t expected = 0xE3069283;
+
+    TEST_ASSERT_EQUAL_HEX32(expected, crc32c(data, sizeof(data) - 1));
+    TEST_ASSERT_EQUAL_HEX32(expected, crc32c_software(data, sizeof(data) - 1));
+}
+
+void test_crc32c_check_with_correct_codeword(void)
+{
+    const uint8_t codeword[] = "123456789\x83\x92\x06\xE3";
+
+    const uint32_t residue = crc32c(codeword, sizeof(codeword) - 1);
+
+    TEST_ASSERT_EQUAL_HEX32(CRC32C_RESIDUE, residue);
+}
+
+void test_crc32c_check_with_incorrect_codeword(void)
+{
+    const uint8_t codeword[] = "023456789\x83\x92\x06\xE3";
+
+    const uint32_t residue = crc32c(codeword, sizeof(codeword) - 1);
+
+    TEST_ASSERT_NOT_EQUAL(CRC32C_RESIDUE, residue);
+}
+
+void test_crc32c_matches_software_for_all_lengths_and_alignments(void)
+{
+    uint8_t data[300];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    // Covers the 8, 4 and 1 byte steps of the hardware path from every alignment
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t length = 0; length + offset <= sizeof(data); length += 7) {
+            TEST_ASSERT_EQUAL_HEX32(crc32c_software(&data[offset], length),
+                                    crc32c(&data[offset], length));
+        }
+    }
+}
+
+void test_crc32c_update_continues_checksum(void)
+{
+    uint8_t data[100];
+
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 131 + 7);
+    }
+
+    uint32_t expected = crc32c(data, sizeof(data));
+
+    TEST_ASSERT_EQUAL_HEX32(expected, crc32c_update(0, data, sizeof(data)));
+
+    for (size_t split = 0; split <= sizeof(data); split += 9) {
+        uint32_t checksum =
+            crc32c_update(crc32c(data, split), &data[split], sizeof(data) - split);
+
+        TEST_ASSERT_EQUAL_HEX32(expected, checksum);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_crc32c_checksum_correct);
+    RUN_TEST(test_crc32c_check_with_correct_codeword);
+    RUN_TEST(test_crc32c_check_with_incorrect_codeword);
+    RUN_TEST(test_crc32c_matches_software_for_all_lengths_and_alignments);
+    RUN_TEST(test_crc32c_update_continues_checksum);
+
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+#include "unity.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/deadband/deadband.h"
+
+typedef struct sample {
+    uint32_t timestamp_ms;
+    float position[3];
+    float velocity[3];
+    bool has_attitude;
+    float attitude[4];
+    float angular_rate[3];
+    uint32_t mode;
+    float unfiltered;
+} sample_t;
+
+static const rp_deadband_field_t sample_fields[] = {
+    {
+        .offset = offsetof(sample_t, position),
+        .kind = RP_DEADBAND_VECTOR,
+        .count = 3,
+        .rate_offset = offsetof(sample_t, velocity),
+        .tolerance = 0.1f,
+        .present_offset = RP_DEADBAND_NONE,
+    },
+    {
+        .offset = offsetof(sample_t, velocity),
+        .kind = RP_DEADBAND_VECTOR,
+        .count = 3,
+        .rate_offset = RP_DEADBAND_NONE,
+        .tolerance = 0.1f,
+        .present_offset = RP_DEADBAND_NONE,
+    },
+    {
+        .offset = offsetof(sample_t, attitude),
+        .kind = RP_DEADBAND_ROTATION,
+        .rate_offset = offsetof(sample_t, angular_rate),
+        .tolerance = 0.02f,
+        .present_offset = offsetof(sample_t, has_attitude),
+    },
+    {
+        .offset = offsetof(sample_t, mode),
+        .kind = RP_DEADBAND_EXACT,
+        .count = sizeof(uint32_t),
+        .rate_offset = RP_DEADBAND_NONE,
+        .present_offset = RP_DEADBAND_NONE,
+    },
+};
+
+static const rp_deadband_spec_t sample_spec = {
+    .message_size = sizeof(sample_t),
+    .timestamp_offset = offsetof(sample_t, timestamp_ms),
+    .max_interval_ms = 1000,
+    .fields = sample_fields,
+    .field_count = sizeof(sample_fields) / sizeof(sample_fields[0]),
+};
+
+static rp_deadband_t sender;
+static rp_deadband_t receiver;
+static sample_t sender_reference;
+static sample_t receiver_reference;
+static sample_t sample;
+
+/**
+ * Runs the sample through the sender and hands sent frames to the receiver.
+ */
+static bool transmit(void)
+{
+    bool sent = rp_deadband_filter(&sender, &sample);
+
+    if (sent) {
+        rp_deadband_received(&receiver, &sample);
+    }
+
+    return sent;
+}
+
+void setUp(void)
+{
+    memset(&sample, 0, sizeof(sample));
+
+    sample.timestamp_ms = 5000;
+    sample.velocity[0] = 2.0f;
+    sample.has_attitude = true;
+    sample.attitude[0] = 1.0f;
+    sample.angular_rate[2] = 0.5f;
+    sample.mode = 3;
+
+    TEST_ASSERT_EQUAL(RP_DEADBAND_OK, rp_deadband_init(&sender, &sample_spec, &sender_reference));
+    TEST_ASSERT_EQUAL(RP_DEADBAND_OK,
+                      rp_deadband_init(&receiver, &sample_spec, &receiver_reference));
+}
+
+void tearDown(void)
+{
+}
+
+void test_deadband_suppresses_predictable_motion(void)
+{
+    TEST_ASSERT_TRUE(transmit());
+
+    // Constant velocity and body rate, exactly what the receiver predicts
+    for (uint32_t i = 1; i < 10; i++) {
+        float yaw = 0.5f * 0.1f * (float)i;
+
+        sample.timestamp_ms = 5000 + i * 100;
+        sample.position[0] = 2.0f * 0.1f * (float)i;
+        sample.attitude[0] = cosf(0.5f * yaw);
+        sample.attitude[3] = sinf(0.5f * yaw);
+
+        TEST_ASSERT_FALSE(transmit());
+    }
+
+    TEST_ASSERT_EQUAL(1, sender.sent);
+    TEST_ASSERT_EQUAL(9, sender.suppressed);
+
+    // Reconstruction matches the suppressed sample
+    sample_t rebuilt;
+
+    TEST_ASSERT_EQUAL(RP_DEADBAND_OK, rp_deadband_reconstruct(&receiver, 5900, &rebuilt));
+    TEST_ASSERT_EQUAL_UINT32(5900, rebuilt.timestamp_ms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sample.position[0], rebuilt.position[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sample.attitude[0], rebuilt.attitude[0]);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, sample.attitude[3], rebuilt.attitude[3]);
+}
+
+void test_deadband_sends_when_position_drifts(void)
+{
+    sample.angular_rate[2] = 0.0f;
+    TEST_ASSERT_TRUE(transmit());
+
+    // 0.05 m off the extrapolation is within tolerance, 0.15 m is not
+    sample.timestamp_ms = 5100;
+    sample.position[0] = 0.2f + 0.05f;
+    TEST_ASSERT_FALSE(transmit());
+
+    sample.timestamp_ms = 5200;
+    sample.position[0] = 0.4f + 0.15f;
+    TEST_ASSERT_TRUE(transmit());
+    TEST_ASSERT_EQUAL_FLOAT(0.55f, receiver_reference.position[0]);
+}
+
+void test_deadband_sends_when_rotation_drifts(void)
+{
+    sample.velocity[0] = 0.0f;
+    TEST_ASSERT_TRUE(transmit());
+
+    // Attitude held still while the reference spins at 0.5 rad/s
+    sample.timestamp_ms = 5030;
+    TEST_ASSERT_FALSE(transmit());
+
+    sample.timestamp_ms = 5050;
+    TEST_ASSERT_TRUE(transmit());
+}
+
+void test_deadband_sends_exact_and_presence_changes(void)
+{
+    TEST_ASSERT_TRUE(transmit());
+
+    sample.mode = 4;
+    TEST_ASSERT_TRUE(transmit());
+
+    sample.has_attitude = false;
+    TEST_ASSERT_TRUE(transmit());
+
+    // Neither side has an attitude, and members outside the spec never trigger a frame
+    sample.attitude[1] = 0.7f;
+    sample.unfiltered = 42.0f;
+    TEST_ASSERT_FALSE(transmit());
+}
+
+void test_deadband_sends_after_max_interval(void)
+{
+    sample.velocity[0] = 0.0f;
+    sample.angular_rate[2] = 0.0f;
+    TEST_ASSERT_TRUE(transmit());
+
+    sample.timestamp_ms = 5999;
+    TEST_ASSERT_FALSE(transmit());
+
+    sample.timestamp_ms = 6000;
+    TEST_ASSERT_TRUE(transmit());
+
+    rp_deadband_reset(&sender);
+    TEST_ASSERT_TRUE(transmit());
+}
+
+void test_deadband_reconstruct_without_reference(void)
+{
+    sample_t rebuilt;
+
+    TEST_ASSERT_EQUAL(RP_DEADBAND_NO_REFERENCE, rp_deadband_reconstruct(&receiver, 0, &rebuilt));
+    TEST_ASSERT_EQUAL(RP_DEADBAND_NULL_POINTER, rp_deadband_reconstruct(NULL, 0, &rebuilt));
+    TEST_ASSERT_TRUE(rp_deadband_filter(NULL, &sample));
+}
+
+void test_deadband_rejects_invalid_spec(void)
+{
+    rp_deadband_field_t field = sample_fields[0];
+    rp_deadband_spec_t spec = sample_spec;
+
+    TEST_ASSERT_TRUE(rp_deadband_spec_valid(&sample_spec));
+
+    spec.fields = &field;
+    spec.field_count = 1;
+
+    field.count = 5;
+    TEST_ASSERT_FALSE(rp_deadband_spec_valid(&spec));
+
+    field = sample_fields[0];
+    field.offset = sizeof(sample_t) - sizeof(float);
+    TEST_ASSERT_FALSE(rp_deadband_spec_valid(&spec));
+
+    field = sample_fields[0];
+    field.tolerance = NAN;
+    TEST_ASSERT_FALSE(rp_deadband_spec_valid(&spec));
+
+    field = sample_fields[2];
+    field.rate_offset = offsetof(sample_t, unfiltered);
+    TEST_ASSERT_FALSE(rp_deadband_spec_valid(&spec));
+
+    spec = sample_spec;
+    spec.max_interval_ms = 0;
+    TEST_ASSERT_FALSE(rp_deadband_spec_valid(&spec));
+    TEST_ASSERT_EQUAL(RP_DEADBAND_INVALID_SPEC, rp_deadband_init(&sender, &spec, &sample));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deadband_suppresses_predictable_motion);
+    RUN_TEST(test_deadband_sends_when_position_drifts);
+    RUN_TEST(test_deadband_sends_when_rotation_drifts);
+    RUN_TEST(test_deadband_sends_exact_and_presence_changes);
+    RUN_TEST(test_deadband_sends_after_max_interval);
+    RUN_TEST(test_deadband_reconstruct_without_reference);
+    RUN_TEST(test_deadband_rejects_invalid_spec);
+
+    return UNITY_END();
+}
@@ -0,0 +1,107 @@
+#include "unity.h"
+
+#include <stdint.h>
+
+#include "rp/cobs/cobs.h"
+#include "rp/deframer/deframer.h"
+
+static uint8_t buffer[8];
+static rp_deframer_t deframer;
+
+void setUp(void)
+{
+    rp_deframer_init(&deframer, buffer, sizeof(buffer));
+}
+
+void tearDown(void)
+{
+}
+
+void test_deframer_single_frame(void)
+{
+    uint8_t stream[] = {0x03, 0x11, 0x22, COBS_DELIMITER_BYTE};
+
+    rp_deframer_result_t result = rp_deframer_feed(&deframer, stream, sizeof(stream));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_FRAME_READY, result.status);
+    TEST_ASSERT_EQUAL(sizeof(stream), result.consumed);
+    TEST_ASSERT_EQUAL(sizeof(stream), deframer.size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(stream, deframer.buffer, sizeof(stream));
+}
+
+void test_deframer_frame_split_across_feeds(void)
+{
+    uint8_t first[] = {0x03, 0x11};
+    uint8_t second[] = {0x22, COBS_DELIMITER_BYTE};
+    uint8_t expected[] = {0x03, 0x11, 0x22, COBS_DELIMITER_BYTE};
+
+    rp_deframer_result_t result = rp_deframer_feed(&deframer, first, sizeof(first));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_NEED_MORE, result.status);
+    TEST_ASSERT_EQUAL(sizeof(first), result.consumed);
+
+    result = rp_deframer_feed(&deframer, second, sizeof(second));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_FRAME_READY, result.status);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, deframer.buffer, sizeof(expected));
+}
+
+void test_deframer_multiple_frames_and_idle_delimiters(void)
+{
+    uint8_t stream[] = {COBS_DELIMITER_BYTE, 0x02, 0x11, COBS_DELIMITER_BYTE,
+                        COBS_DELIMITER_BYTE, 0x02, 0x22, COBS_DELIMITER_BYTE};
+
+    rp_deframer_result_t result = rp_deframer_feed(&deframer, stream, sizeof(stream));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_FRAME_READY, result.status);
+    TEST_ASSERT_EQUAL(4, result.consumed);
+    TEST_ASSERT_EQUAL(3, deframer.size);
+    TEST_ASSERT_EQUAL_HEX8(0x11, deframer.buffer[1]);
+
+    result = rp_deframer_feed(&deframer, &stream[4], sizeof(stream) - 4);
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_FRAME_READY, result.status);
+    TEST_ASSERT_EQUAL(4, result.consumed);
+    TEST_ASSERT_EQUAL(3, deframer.size);
+    TEST_ASSERT_EQUAL_HEX8(0x22, deframer.buffer[1]);
+}
+
+void test_deframer_overflow_recovers_at_next_delimiter(void)
+{
+    uint8_t stream[] = {0x0A, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09,
+                        COBS_DELIMITER_BYTE, 0x02, 0x33, COBS_DELIMITER_BYTE};
+
+    rp_deframer_result_t result = rp_deframer_feed(&deframer, stream, sizeof(stream));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_OVERFLOW, result.status);
+
+    size_t offset = result.consumed;
+
+    result = rp_deframer_feed(&deframer, &stream[offset], sizeof(stream) - offset);
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_FRAME_READY, result.status);
+    TEST_ASSERT_EQUAL(3, deframer.size);
+    TEST_ASSERT_EQUAL_HEX8(0x33, deframer.buffer[1]);
+}
+
+void test_deframer_null_pointer(void)
+{
+    uint8_t stream[] = {COBS_DELIMITER_BYTE};
+
+    rp_deframer_result_t result = rp_deframer_feed(NULL, stream, sizeof(stream));
+
+    TEST_ASSERT_EQUAL(RP_DEFRAMER_NULL_POINTER, result.status);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deframer_single_frame);
+    RUN_TEST(test_deframer_frame_split_across_feeds);
+    RUN_TEST(test_deframer_multiple_frames_and_idle_delimiters);
+    RUN_TEST(test_deframer_overflow_recovers_at_next_delimiter);
+    RUN_TEST(test_deframer_null_pointer);
+
+    return UNITY_END();
+}
@@ -0,0 +1,214 @@
+#include "export.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char buffer[RP_EXPORT_ROW_MAX_SIZE * 2];
+static rp_export_t exporter;
+
+static const char *format_float(float value)
+{
+    static char text[RP_EXPORT_FLOAT_MAX_SIZE];
+
+    text[rp_export_format_float(text, value)] = '\0';
+
+    return text;
+}
+
+static tvr_Downlink telemetry(void)
+{
+    tvr_Downlink downlink = tvr_Downlink_init_zero;
+
+    downlink.which_payload = tvr_Downlink_telemetry_tag;
+    downlink.payload.telemetry.timestamp_ms = 4294967295u;
+    downlink.payload.telemetry.has_position = true;
+    downlink.payload.telemetry.position = (tvr_Vec3){0.1f, -2.5f, 1e-7f};
+    downlink.payload.telemetry.flight_state = tvr_FlightState_FLIGHT_STATE_HOVER;
+    downlink.payload.telemetry.thrust_cmd = 14.2f;
+
+    return downlink;
+}
+
+static const char *exported(void)
+{
+    buffer[exporter.size] = '\0';
+
+    return buffer;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_export_format_float_is_shortest(void)
+{
+    TEST_ASSERT_EQUAL_STRING("0.1", format_float(0.1f));
+    TEST_ASSERT_EQUAL_STRING("1", format_float(1.0f));
+    TEST_ASSERT_EQUAL_STRING("-0.5", format_float(-0.5f));
+    TEST_ASSERT_EQUAL_STRING("14.2", format_float(14.2f));
+    TEST_ASSERT_EQUAL_STRING("123456790", format_float(123456792.0f));
+    TEST_ASSERT_EQUAL_STRING("0.00001", format_float(1e-5f));
+    TEST_ASSERT_EQUAL_STRING("1e-6", format_float(1e-6f));
+    TEST_ASSERT_EQUAL_STRING("1e9", format_float(1e9f));
+    TEST_ASSERT_EQUAL_STRING("3.4028235e38", format_float(3.4028235e38f));
+    TEST_ASSERT_EQUAL_STRING("1e-45", format_float(1e-45f));
+    TEST_ASSERT_EQUAL_STRING("0", format_float(0.0f));
+    TEST_ASSERT_EQUAL_STRING("-0", format_float(-0.0f));
+    TEST_ASSERT_EQUAL_STRING("inf", format_float(INFINITY));
+    TEST_ASSERT_EQUAL_STRING("-inf", format_float(-INFINITY));
+    TEST_ASSERT_EQUAL_STRING("nan", format_float(NAN));
+}
+
+void test_export_format_float_round_trips(void)
+{
+    uint32_t state = 0x9E3779B9u;
+
+    for (int i = 0; i < 200000; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        float value;
+
+        memcpy(&value, &state, sizeof(value));
+
+        if (!isfinite(value)) {
+            continue;
+        }
+
+        float parsed = strtof(format_float(value), NULL);
+
+        TEST_ASSERT_EQUAL_MEMORY(&value, &parsed, sizeof(value));
+    }
+}
+
+void test_export_csv_writes_header_and_rows(void)
+{
+    tvr_Downlink downlink = telemetry();
+
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag,
+                                     "timestamp_ms,position.x,position.z,velocity.x,flight_state,"
+                                     "thrust_cmd",
+                                     -1, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_header(&exporter));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_downlink(&exporter, &downlink));
+
+    TEST_ASSERT_EQUAL_STRING("timestamp_ms,position.x,position.z,velocity.x,flight_state,"
+                             "thrust_cmd\n"
+                             "4294967295,0.1,1e-7,,3,14.2\n",
+                             exported());
+    TEST_ASSERT_EQUAL(1, exporter.rows);
+}
+
+void test_export_ndjson_writes_null_for_absent_fields(void)
+{
+    tvr_Downlink downlink = telemetry();
+
+    downlink.payload.telemetry.position.y = NAN;
+
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK,
+                      rp_export_init(&exporter, RP_EXPORT_NDJSON, tvr_Downlink_telemetry_tag,
+                                     "timestamp_ms,position.y,attitude.w", -1, buffer,
+                                     sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_header(&exporter));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_downlink(&exporter, &downlink));
+
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"timestamp_ms\":4294967295,\"position.y\":null,\"attitude.w\":null}\n", exported());
+}
+
+void test_export_skips_other_payloads(void)
+{
+    tvr_Downlink downlink = telemetry();
+    tvr_Downlink status = tvr_Downlink_init_zero;
+
+    status.which_payload = tvr_Downlink_status_tag;
+    status.payload.status.uptime_ms = 1000;
+    status.payload.status.gyro_ok = true;
+
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_status_tag,
+                                     "uptime_ms,accel_ok,gyro_ok", -1, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_downlink(&exporter, &downlink));
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_downlink(&exporter, &status));
+
+    TEST_ASSERT_EQUAL_STRING("1000,false,true\n", exported());
+    TEST_ASSERT_EQUAL(1, exporter.rows);
+    TEST_ASSERT_EQUAL(1, exporter.skipped);
+}
+
+void test_export_init_rejects_bad_arguments(void)
+{
+    TEST_ASSERT_EQUAL(RP_EXPORT_UNKNOWN_COLUMN,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag,
+                                     "timestamp_ms,uptime_ms", -1, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_UNKNOWN_COLUMN,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag,
+                                     "position", -1, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_INVALID_ARGUMENT,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_ack_tag, NULL, -1,
+                                     buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL(RP_EXPORT_INVALID_ARGUMENT,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag, NULL,
+                                     -1, buffer, RP_EXPORT_ROW_MAX_SIZE - 1));
+    TEST_ASSERT_EQUAL(RP_EXPORT_NULL_POINTER,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag, NULL,
+                                     -1, NULL, sizeof(buffer)));
+}
+
+void test_export_flushes_to_the_descriptor(void)
+{
+    tvr_Downlink downlink = telemetry();
+    FILE *file = tmpfile();
+    char line[RP_EXPORT_ROW_MAX_SIZE];
+    int rows = 0;
+
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK,
+                      rp_export_init(&exporter, RP_EXPORT_CSV, tvr_Downlink_telemetry_tag, NULL,
+                                     fileno(file), buffer, sizeof(buffer)));
+
+    // Every field of every row, so the buffer fills and is written out several times
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_downlink(&exporter, &downlink));
+    }
+
+    TEST_ASSERT_EQUAL(RP_EXPORT_OK, rp_export_flush(&exporter));
+    TEST_ASSERT_EQUAL(0, exporter.size);
+
+    rewind(file);
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        TEST_ASSERT_EQUAL_STRING("4294967295,0.1,-2.5,1e-7,,,,,,,,,,,3,14.2,0,0\n", line);
+        rows++;
+    }
+
+    TEST_ASSERT_EQUAL(1000, rows);
+
+    fclose(file);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_export_format_float_is_shortest);
+    RUN_TEST(test_export_format_float_round_trips);
+    RUN_TEST(test_export_csv_writes_header_and_rows);
+    RUN_TEST(test_export_ndjson_writes_null_for_absent_fields);
+    RUN_TEST(test_export_skips_other_payloads);
+    RUN_TEST(test_export_init_rejects_bad_arguments);
+    RUN_TEST(test_export_flushes_to_the_descriptor);
+
+    return UNITY_END();
+}
@@ -0,0 +1,217 @@
+#include "unity.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/fec/rs.h"
+
+static rs_codec_t codec;
+
+static void fill_pattern(uint8_t *data, size_t size, uint8_t seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        data[i] = (uint8_t)(seed + i * 37);
+    }
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&codec, RS_MAX_PARITY));
+}
+
+void tearDown(void)
+{
+}
+
+void test_rs_init_rejects_invalid_parity(void)
+{
+    rs_codec_t invalid;
+
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH, rs_codec_init(&invalid, 0));
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH, rs_codec_init(&invalid, RS_MAX_PARITY + 1));
+    TEST_ASSERT_EQUAL(RS_NULL_POINTER, rs_codec_init(NULL, 8));
+}
+
+void test_rs_clean_codeword_has_no_corrections(void)
+{
+    uint8_t codeword[64 + RS_MAX_PARITY];
+
+    fill_pattern(codeword, 64, 0x11);
+
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&codec, codeword, 64, &codeword[64]));
+
+    rs_result_t result = rs_decode(&codec, codeword, sizeof(codeword));
+
+    TEST_ASSERT_EQUAL(RS_OK, result.status);
+    TEST_ASSERT_EQUAL(0, result.corrected);
+}
+
+void test_rs_encode_update_matches_rs_encode(void)
+{
+    uint8_t data[200];
+    uint8_t expected[RS_MAX_PARITY];
+    uint8_t parity[RS_MAX_PARITY];
+
+    fill_pattern(data, sizeof(data), 0x5A);
+
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&codec, data, sizeof(data), expected));
+
+    memset(parity, 0, sizeof(parity));
+
+    for (size_t offset = 0; offset < sizeof(data); offset += 13) {
+        size_t size = (sizeof(data) - offset < 13) ? sizeof(data) - offset : 13;
+
+        TEST_ASSERT_EQUAL(RS_OK, rs_encode_update(&codec, &data[offset], size, parity));
+    }
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, parity, sizeof(parity));
+}
+
+void test_rs_corrects_up_to_half_parity_errors(void)
+{
+    uint8_t codeword[100 + RS_MAX_PARITY];
+    uint8_t expected[sizeof(codeword)];
+
+    fill_pattern(codeword, 100, 0x5A);
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&codec, codeword, 100, &codeword[100]));
+    memcpy(expected, codeword, sizeof(codeword));
+
+    // 16 symbol errors spread over data and parity, including the first and last symbol
+    for (size_t i = 0; i < RS_MAX_PARITY / 2; i++) {
+        codeword[(i * 131) % sizeof(codeword)] ^= (uint8_t)(0xA5 + i);
+    }
+
+    codeword[sizeof(codeword) - 1] ^= 0x01;
+
+    rs_result_t result = rs_decode(&codec, codeword, sizeof(codeword));
+
+    TEST_ASSERT_EQUAL(RS_OK, result.status);
+    TEST_ASSERT_EQUAL(RS_MAX_PARITY / 2, result.corrected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, sizeof(codeword));
+}
+
+void test_rs_full_length_codeword(void)
+{
+    uint8_t codeword[RS_SYMBOL_COUNT];
+    uint8_t expected[sizeof(codeword)];
+    size_t data_size = RS_SYMBOL_COUNT - RS_MAX_PARITY;
+
+    fill_pattern(codeword, data_size, 0x01);
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&codec, codeword, data_size, &codeword[data_size]));
+    memcpy(expected, codeword, sizeof(codeword));
+
+    codeword[0] ^= 0xFF;
+    codeword[128] ^= 0x10;
+    codeword[254] ^= 0x80;
+
+    rs_result_t result = rs_decode(&codec, codeword, sizeof(codeword));
+
+    TEST_ASSERT_EQUAL(RS_OK, result.status);
+    TEST_ASSERT_EQUAL(3, result.corrected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, sizeof(codeword));
+}
+
+void test_rs_too_many_errors_is_not_silently_accepted(void)
+{
+    rs_codec_t small;
+    uint8_t codeword[20 + 4];
+    uint8_t corrupted[sizeof(codeword)];
+
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&small, 4));
+
+    fill_pattern(codeword, 20, 0x33);
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&small, codeword, 20, &codeword[20]));
+    memcpy(corrupted, codeword, sizeof(codeword));
+
+    corrupted[1] ^= 0x01;
+    corrupted[7] ^= 0x02;
+    corrupted[13] ^= 0x04;
+
+    rs_result_t result = rs_decode(&small, corrupted, sizeof(corrupted));
+
+    // Either detected, or "corrected" into a different codeword than the original
+    if (result.status == RS_OK) {
+        TEST_ASSERT_NOT_EQUAL(0, memcmp(codeword, corrupted, sizeof(codeword)));
+    } else {
+        TEST_ASSERT_EQUAL(RS_UNCORRECTABLE, result.status);
+    }
+}
+
+void test_rs_corrects_erasures_and_errors(void)
+{
+    uint8_t codeword[100 + RS_MAX_PARITY];
+    uint8_t expected[sizeof(codeword)];
+    size_t erasures[RS_MAX_PARITY];
+    static const size_t errors[] = {1, 5, 7, 9, 11, 15};
+
+    fill_pattern(codeword, 100, 0x42);
+    TEST_ASSERT_EQUAL(RS_OK, rs_encode(&codec, codeword, 100, &codeword[100]));
+    memcpy(expected, codeword, sizeof(codeword));
+
+    // As many erasures as parity symbols, one of them holding the right value
+    for (size_t i = 0; i < RS_MAX_PARITY; i++) {
+        erasures[i] = (i * 29 + 3) % sizeof(codeword);
+        codeword[erasures[i]] = (i == 5) ? expected[erasures[i]] : 0;
+    }
+
+    codeword[erasures[7]] ^= 0x80;
+
+    rs_result_t result =
+        rs_decode_erasures(&codec, codeword, sizeof(codeword), erasures, RS_MAX_PARITY);
+
+    TEST_ASSERT_EQUAL(RS_OK, result.status);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, sizeof(codeword));
+
+    // 20 erasures leave room for 6 errors at unknown positions
+    for (size_t i = 0; i < 20; i++) {
+        codeword[erasures[i]] ^= 0x3C;
+    }
+
+    for (size_t i = 0; i < 6; i++) {
+        codeword[errors[i]] ^= (uint8_t)(0x11 + i);
+    }
+
+    result = rs_decode_erasures(&codec, codeword, sizeof(codeword), erasures, 20);
+
+    TEST_ASSERT_EQUAL(RS_OK, result.status);
+    TEST_ASSERT_EQUAL(26, result.corrected);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, codeword, sizeof(codeword));
+}
+
+void test_rs_rejects_invalid_lengths(void)
+{
+    uint8_t codeword[RS_SYMBOL_COUNT + 1] = {0};
+    uint8_t parity[RS_MAX_PARITY];
+
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH,
+                      rs_encode(&codec, codeword, RS_SYMBOL_COUNT - RS_MAX_PARITY + 1, parity));
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH, rs_decode(&codec, codeword, sizeof(codeword)).status);
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH, rs_decode(&codec, codeword, RS_MAX_PARITY).status);
+
+    size_t erasures[RS_MAX_PARITY + 1] = {0};
+
+    TEST_ASSERT_EQUAL(
+        RS_INVALID_LENGTH,
+        rs_decode_erasures(&codec, codeword, 100, erasures, RS_MAX_PARITY + 1).status);
+
+    erasures[0] = 100;
+
+    TEST_ASSERT_EQUAL(RS_INVALID_LENGTH,
+                      rs_decode_erasures(&codec, codeword, 100, erasures, 1).status);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rs_init_rejects_invalid_parity);
+    RUN_TEST(test_rs_clean_codeword_has_no_corrections);
+    RUN_TEST(test_rs_encode_update_matches_rs_encode);
+    RUN_TEST(test_rs_corrects_up_to_half_parity_errors);
+    RUN_TEST(test_rs_full_length_codeword);
+    RUN_TEST(test_rs_too_many_errors_is_not_silently_accepted);
+    RUN_TEST(test_rs_corrects_erasures_and_errors);
+    RUN_TEST(test_rs_rejects_invalid_lengths);
+
+    return UNITY_END();
+}
@@ -0,0 +1,248 @@
+#include "fanout.h"
+#include "unity.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define BURST (200)
+
+static rp_fanout_t fanout;
+static char path[64];
+
+// Shrinks the gateway side socket buffer so a burst overflows into the queue
+static void shrink_send_buffer(const rp_fanout_consumer_t *consumer)
+{
+    int size = 1;
+
+    TEST_ASSERT_EQUAL(0, setsockopt(consumer->fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)));
+}
+
+// Runs one non-blocking pass of the gateway loop
+static void pump(void)
+{
+    struct pollfd fds[RP_FANOUT_POLL_FDS];
+
+    rp_fanout_poll_fds(&fanout, fds);
+
+    if (poll(fds, RP_FANOUT_POLL_FDS, 0) > 0) {
+        rp_fanout_handle(&fanout, fds);
+    }
+}
+
+/**
+ * Reads records until the consumer socket and its queue are empty.
+ *
+ * @return size_t Number of records read
+ */
+static size_t drain(int fd, uint32_t *sequences, size_t capacity)
+{
+    size_t count = 0;
+
+    for (;;) {
+        rp_fanout_record_header_t header;
+        uint32_t payload;
+
+        rp_fanout_status_t status = rp_fanout_receive(fd, &header, &payload, sizeof(payload));
+
+        if (status == RP_FANOUT_OK) {
+            TEST_ASSERT_EQUAL_UINT32(header.sequence, payload);
+            TEST_ASSERT_TRUE(count < capacity);
+            sequences[count++] = header.sequence;
+            continue;
+        }
+
+        TEST_ASSERT_EQUAL(RP_FANOUT_WOULD_BLOCK, status);
+
+        if (fanout.consumers[0].fd < 0 || fanout.consumers[0].count == 0) {
+            return count;
+        }
+
+        pump();
+    }
+}
+
+// Receives time out after 1 ms instead of blocking the test
+static int connect_with_timeout(rp_fanout_policy_t policy)
+{
+    int fd = rp_fanout_connect(path, policy);
+    struct timeval timeout = {.tv_sec = 0, .tv_usec = 1000};
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    TEST_ASSERT_EQUAL(0, setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+    return fd;
+}
+
+static void publish_burst(void)
+{
+    for (uint32_t i = 0; i < BURST; i++) {
+        TEST_ASSERT_EQUAL(RP_FANOUT_OK, rp_fanout_publish(&fanout, &i, sizeof(i), 0));
+    }
+}
+
+void setUp(void)
+{
+    snprintf(path, sizeof(path), "/tmp/rp_test_fanout_%ld.sock", (long)getpid());
+
+    TEST_ASSERT_EQUAL(RP_FANOUT_OK, rp_fanout_open(&fanout, path, RP_FANOUT_DROP_OLDEST));
+}
+
+void tearDown(void)
+{
+    rp_fanout_close(&fanout);
+}
+
+void test_fanout_publish_should_reach_every_consumer(void)
+{
+    int fds[3];
+
+    for (size_t i = 0; i < 3; i++) {
+        fds[i] = rp_fanout_connect(path, RP_FANOUT_DROP_OLDEST);
+        TEST_ASSERT_TRUE(fds[i] >= 0);
+    }
+
+    TEST_ASSERT_EQUAL(3, rp_fanout_accept(&fanout));
+
+    const char message[] = "apogee";
+
+    TEST_ASSERT_EQUAL(RP_FANOUT_OK, rp_fanout_publish(&fanout, message, sizeof(message), 42));
+
+    for (size_t i = 0; i < 3; i++) {
+        rp_fanout_record_header_t header;
+        char payload[16];
+
+        rp_fanout_status_t status = rp_fanout_receive(fds[i], &header, payload, sizeof(payload));
+
+        TEST_ASSERT_EQUAL(RP_FANOUT_OK, status);
+        TEST_ASSERT_EQUAL_UINT32(0, header.sequence);
+        TEST_ASSERT_EQUAL_UINT32(sizeof(message), header.size);
+        TEST_ASSERT_EQUAL_UINT64(42, header.received_ns);
+        TEST_ASSERT_EQUAL_STRING(message, payload);
+
+        close(fds[i]);
+    }
+}
+
+void test_fanout_publish_should_reject_oversized_payload(void)
+{
+    uint8_t payload[RP_FANOUT_PAYLOAD_CAPACITY + 1] = {0};
+
+    TEST_ASSERT_EQUAL(RP_FANOUT_TOO_LARGE, rp_fanout_publish(&fanout, payload, sizeof(payload), 0));
+    TEST_ASSERT_EQUAL(RP_FANOUT_OK, rp_fanout_publish(&fanout, payload, sizeof(payload) - 1, 0));
+}
+
+void test_fanout_consumer_should_choose_policy(void)
+{
+    int fd = rp_fanout_connect(path, RP_FANOUT_DROP_NEWEST);
+
+    TEST_ASSERT_EQUAL(1, rp_fanout_accept(&fanout));
+    TEST_ASSERT_EQUAL(RP_FANOUT_DROP_NEWEST, fanout.consumers[0].policy);
+
+    close(fd);
+}
+
+void test_fanout_drop_oldest_should_deliver_latest(void)
+{
+    static uint32_t sequences[BURST];
+    int fd = connect_with_timeout(RP_FANOUT_DROP_OLDEST);
+
+    TEST_ASSERT_EQUAL(1, rp_fanout_accept(&fanout));
+    shrink_send_buffer(&fanout.consumers[0]);
+
+    publish_burst();
+
+    TEST_ASSERT_TRUE(fanout.consumers[0].dropped > 0);
+    TEST_ASSERT_EQUAL(RP_FANOUT_QUEUE_DEPTH, fanout.consumers[0].count);
+
+    size_t count = drain(fd, sequences, BURST);
+
+    TEST_ASSERT_EQUAL(BURST - fanout.consumers[0].dropped, count);
+    TEST_ASSERT_EQUAL_UINT32(BURST - 1, sequences[count - 1]);
+
+    for (size_t i = 1; i < count; i++) {
+        TEST_ASSERT_TRUE(sequences[i] > sequences[i - 1]);
+    }
+
+    close(fd);
+}
+
+void test_fanout_drop_newest_should_deliver_prefix(void)
+{
+    static uint32_t sequences[BURST];
+    int fd = connect_with_timeout(RP_FANOUT_DROP_NEWEST);
+
+    TEST_ASSERT_EQUAL(1, rp_fanout_accept(&fanout));
+    shrink_send_buffer(&fanout.consumers[0]);
+
+    publish_burst();
+
+    TEST_ASSERT_TRUE(fanout.consumers[0].dropped > 0);
+
+    size_t count = drain(fd, sequences, BURST);
+
+    TEST_ASSERT_EQUAL(BURST - fanout.consumers[0].dropped, count);
+
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i, sequences[i]);
+    }
+
+    close(fd);
+}
+
+void test_fanout_disconnect_policy_should_close_slow_consumer(void)
+{
+    int fd = connect_with_timeout(RP_FANOUT_DISCONNECT);
+
+    TEST_ASSERT_EQUAL(1, rp_fanout_accept(&fanout));
+    shrink_send_buffer(&fanout.consumers[0]);
+
+    publish_burst();
+
+    TEST_ASSERT_EQUAL(0, fanout.consumer_count);
+    TEST_ASSERT_EQUAL_UINT64(1, fanout.disconnects);
+
+    // Records already in the socket are still readable, then the stream ends
+    rp_fanout_record_header_t header;
+    uint32_t payload;
+    rp_fanout_status_t status;
+
+    do {
+        status = rp_fanout_receive(fd, &header, &payload, sizeof(payload));
+    } while (status == RP_FANOUT_OK);
+
+    TEST_ASSERT_EQUAL(RP_FANOUT_CLOSED, status);
+
+    close(fd);
+}
+
+void test_fanout_hangup_should_free_slot(void)
+{
+    int fd = rp_fanout_connect(path, RP_FANOUT_DROP_OLDEST);
+
+    TEST_ASSERT_EQUAL(1, rp_fanout_accept(&fanout));
+
+    close(fd);
+    pump();
+
+    TEST_ASSERT_EQUAL(0, fanout.consumer_count);
+    TEST_ASSERT_EQUAL(-1, fanout.consumers[0].fd);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fanout_publish_should_reach_every_consumer);
+    RUN_TEST(test_fanout_publish_should_reject_oversized_payload);
+    RUN_TEST(test_fanout_consumer_should_choose_policy);
+    RUN_TEST(test_fanout_drop_oldest_should_deliver_latest);
+    RUN_TEST(test_fanout_drop_newest_should_deliver_prefix);
+    RUN_TEST(test_fanout_disconnect_policy_should_close_slow_consumer);
+    RUN_TEST(test_fanout_hangup_should_free_slot);
+
+    return UNITY_END();
+}
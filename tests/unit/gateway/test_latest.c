@@ -0,0 +1,203 @@
+#include "latest.h"
+#include "unity.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#define STRESS_READERS (4)
+#define STRESS_UPDATES (200000)
+#define STRESS_SLOT (1)
+
+// Fills a whole slot so a torn copy shows up as mismatched words
+typedef struct pattern {
+    uint64_t counter;
+    uint64_t check[RP_LATEST_SLOT_WORDS - 1];
+} pattern_t;
+
+typedef struct reader_result {
+    uint64_t reads;
+    uint64_t torn;
+    uint64_t backwards;
+    uint64_t last_counter;
+} reader_result_t;
+
+static rp_latest_table_t table;
+static atomic_bool writer_done;
+
+static void fill_pattern(pattern_t *value, uint64_t counter)
+{
+    value->counter = counter;
+
+    for (size_t i = 0; i < RP_LATEST_SLOT_WORDS - 1; i++) {
+        value->check[i] = counter * 0x9E3779B97F4A7C15ULL + i;
+    }
+}
+
+static void *stress_writer(void *argument)
+{
+    (void)argument;
+
+    for (uint64_t counter = 1; counter <= STRESS_UPDATES; counter++) {
+        pattern_t value;
+
+        fill_pattern(&value, counter);
+        rp_latest_write(&table, STRESS_SLOT, &value, sizeof(value), counter);
+    }
+
+    atomic_store(&writer_done, true);
+
+    return NULL;
+}
+
+static void *stress_reader(void *argument)
+{
+    reader_result_t *result = argument;
+
+    for (;;) {
+        bool done = atomic_load(&writer_done);
+        pattern_t value;
+        pattern_t expected;
+        rp_latest_snapshot_t snapshot;
+
+        if (rp_latest_read(&table, STRESS_SLOT, &value, sizeof(value), &snapshot) ==
+            RP_LATEST_OK) {
+            fill_pattern(&expected, value.counter);
+
+            result->reads++;
+            result->torn += (memcmp(&value, &expected, sizeof(value)) != 0 ||
+                             snapshot.updated_ns != value.counter);
+            result->backwards += (value.counter < result->last_counter);
+            result->last_counter = value.counter;
+        }
+
+        // One more read after the writer finished must see the final value
+        if (done) {
+            return NULL;
+        }
+    }
+}
+
+void setUp(void)
+{
+    rp_latest_init(&table);
+}
+
+void tearDown(void)
+{
+}
+
+void test_latest_read_should_report_empty_slot(void)
+{
+    uint8_t value[4];
+
+    TEST_ASSERT_EQUAL(RP_LATEST_EMPTY, rp_latest_read(&table, 1, value, sizeof(value), NULL));
+}
+
+void test_latest_should_reject_invalid_slot(void)
+{
+    uint8_t value[4] = {0};
+
+    TEST_ASSERT_EQUAL(RP_LATEST_INVALID_ARGUMENT, rp_latest_write(&table, 0, value, 4, 0));
+    TEST_ASSERT_EQUAL(RP_LATEST_INVALID_ARGUMENT,
+                      rp_latest_write(&table, RP_LATEST_SLOT_COUNT, value, 4, 0));
+    TEST_ASSERT_EQUAL(RP_LATEST_INVALID_ARGUMENT, rp_latest_read(&table, 0, value, 4, NULL));
+}
+
+void test_latest_write_should_reject_oversized_value(void)
+{
+    uint8_t value[RP_LATEST_SLOT_CAPACITY + 1] = {0};
+
+    TEST_ASSERT_EQUAL(RP_LATEST_TOO_LARGE, rp_latest_write(&table, 1, value, sizeof(value), 0));
+}
+
+void test_latest_read_should_return_latest_value(void)
+{
+    const char first[] = "pad";
+    const char second[] = "ascent";
+    char value[16];
+    rp_latest_snapshot_t snapshot;
+
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_write(&table, 2, first, sizeof(first), 10));
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_write(&table, 2, second, sizeof(second), 20));
+
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_read(&table, 2, value, sizeof(value), &snapshot));
+    TEST_ASSERT_EQUAL_STRING(second, value);
+    TEST_ASSERT_EQUAL_UINT32(4, snapshot.sequence);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(second), snapshot.size);
+    TEST_ASSERT_EQUAL_UINT64(20, snapshot.updated_ns);
+
+    // Other slots are independent
+    TEST_ASSERT_EQUAL(RP_LATEST_EMPTY, rp_latest_read(&table, 1, value, sizeof(value), NULL));
+
+    // The output must hold the whole value
+    TEST_ASSERT_EQUAL(RP_LATEST_TOO_LARGE, rp_latest_read(&table, 2, value, 4, NULL));
+}
+
+void test_latest_shared_memory_should_be_visible_to_readers(void)
+{
+    char name[64];
+    rp_latest_table_t *writer;
+    const rp_latest_table_t *reader;
+    uint32_t value = 0;
+
+    snprintf(name, sizeof(name), "/rp_test_latest_%ld", (long)getpid());
+
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_create(name, &writer));
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_attach(name, &reader));
+    TEST_ASSERT_TRUE((const void *)writer != (const void *)reader);
+
+    uint32_t written = 0xC0FFEE;
+
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_write(writer, 1, &written, sizeof(written), 1));
+    TEST_ASSERT_EQUAL(RP_LATEST_OK, rp_latest_read(reader, 1, &value, sizeof(value), NULL));
+    TEST_ASSERT_EQUAL_HEX32(written, value);
+
+    rp_latest_detach(reader);
+    rp_latest_detach(writer);
+    rp_latest_unlink(name);
+
+    TEST_ASSERT_EQUAL(RP_LATEST_SHM_ERROR, rp_latest_attach(name, &reader));
+}
+
+void test_latest_concurrent_readers_should_see_consistent_snapshots(void)
+{
+    pthread_t writer;
+    pthread_t readers[STRESS_READERS];
+    reader_result_t results[STRESS_READERS] = {0};
+
+    atomic_store(&writer_done, false);
+
+    for (size_t i = 0; i < STRESS_READERS; i++) {
+        pthread_create(&readers[i], NULL, stress_reader, &results[i]);
+    }
+
+    pthread_create(&writer, NULL, stress_writer, NULL);
+    pthread_join(writer, NULL);
+
+    for (size_t i = 0; i < STRESS_READERS; i++) {
+        pthread_join(readers[i], NULL);
+
+        TEST_ASSERT_TRUE(results[i].reads > 0);
+        TEST_ASSERT_EQUAL_UINT64(0, results[i].torn);
+        TEST_ASSERT_EQUAL_UINT64(0, results[i].backwards);
+        TEST_ASSERT_EQUAL_UINT64(STRESS_UPDATES, results[i].last_counter);
+    }
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_latest_read_should_report_empty_slot);
+    RUN_TEST(test_latest_should_reject_invalid_slot);
+    RUN_TEST(test_latest_write_should_reject_oversized_value);
+    RUN_TEST(test_latest_read_should_return_latest_value);
+    RUN_TEST(test_latest_shared_memory_should_be_visible_to_readers);
+    RUN_TEST(test_latest_concurrent_readers_should_see_consistent_snapshots);
+
+    return UNITY_END();
+}
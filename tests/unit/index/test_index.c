@@ -0,0 +1,247 @@
+#include "index.h"
+#include "unity.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static rp_index_builder_t builder;
+
+static tvr_Downlink telemetry(uint32_t timestamp_ms, float z)
+{
+    tvr_Downlink downlink = tvr_Downlink_init_zero;
+
+    downlink.which_payload = tvr_Downlink_telemetry_tag;
+    downlink.payload.telemetry.timestamp_ms = timestamp_ms;
+    downlink.payload.telemetry.has_position = true;
+    downlink.payload.telemetry.position.z = z;
+    downlink.payload.telemetry.thrust_cmd = 14.0f;
+
+    return downlink;
+}
+
+static void add(uint32_t timestamp_ms, float z)
+{
+    tvr_Downlink downlink = telemetry(timestamp_ms, z);
+
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_add(&builder, &downlink));
+}
+
+static const rp_index_summary_t *summary(size_t level, size_t bucket, size_t field)
+{
+    return &builder.levels[level].summaries[bucket * builder.field_count + field];
+}
+
+/**
+ * 16 samples, 1 ms apart, `position.z` counting up from 0, in 4 ms buckets.
+ */
+static void build_ramp(void)
+{
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag,
+                                                         "position.z,thrust_cmd", 2));
+
+    for (uint32_t t = 0; t < 16; t++) {
+        add(t, (float)t);
+    }
+
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_finish(&builder));
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+    rp_index_builder_free(&builder);
+}
+
+void test_index_summarizes_level_0_buckets(void)
+{
+    tvr_Downlink status = tvr_Downlink_init_zero;
+    tvr_Downlink no_position = telemetry(106, 0.0f);
+
+    status.which_payload = tvr_Downlink_status_tag;
+    status.payload.status.timestamp_ms = 104;
+    no_position.payload.telemetry.has_position = false;
+
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag,
+                                                         "position.z,thrust_cmd", 2));
+
+    add(101, 1.0f);
+    add(102, -3.0f);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_add(&builder, &status));
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_add(&builder, &no_position));
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_finish(&builder));
+
+    TEST_ASSERT_EQUAL(100, builder.origin_ms);
+    TEST_ASSERT_EQUAL(3, builder.samples);
+    TEST_ASSERT_EQUAL(2, builder.levels[0].bucket_count);
+
+    TEST_ASSERT_EQUAL(2, summary(0, 0, 0)->count);
+    TEST_ASSERT_EQUAL_FLOAT(-3.0f, summary(0, 0, 0)->min);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, summary(0, 0, 0)->max);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, summary(0, 0, 0)->mean);
+
+    // Absent in the second bucket's only sample, which still has a thrust
+    TEST_ASSERT_EQUAL(0, summary(0, 1, 0)->count);
+    TEST_ASSERT_EQUAL(1, summary(0, 1, 1)->count);
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, summary(0, 1, 1)->mean);
+}
+
+void test_index_merges_buckets_up_the_levels(void)
+{
+    build_ramp();
+
+    TEST_ASSERT_EQUAL(4, builder.levels[0].bucket_count);
+    TEST_ASSERT_EQUAL(2, builder.levels[1].bucket_count);
+    TEST_ASSERT_EQUAL(1, builder.levels[2].bucket_count);
+    TEST_ASSERT_EQUAL(0, builder.levels[3].bucket_count);
+
+    TEST_ASSERT_EQUAL(8, summary(1, 1, 0)->count);
+    TEST_ASSERT_EQUAL_FLOAT(8.0f, summary(1, 1, 0)->min);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, summary(1, 1, 0)->max);
+    TEST_ASSERT_EQUAL_FLOAT(11.5f, summary(1, 1, 0)->mean);
+
+    TEST_ASSERT_EQUAL(16, summary(2, 0, 0)->count);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, summary(2, 0, 0)->min);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, summary(2, 0, 0)->max);
+    TEST_ASSERT_EQUAL_FLOAT(7.5f, summary(2, 0, 0)->mean);
+}
+
+void test_index_keeps_empty_buckets_for_gaps(void)
+{
+    TEST_ASSERT_EQUAL(RP_INDEX_OK,
+                      rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag, "position.z", 2));
+
+    add(0, 1.0f);
+    add(20, 2.0f);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_finish(&builder));
+
+    TEST_ASSERT_EQUAL(6, builder.levels[0].bucket_count);
+
+    for (size_t b = 1; b < 5; b++) {
+        TEST_ASSERT_EQUAL(0, summary(0, b, 0)->count);
+        TEST_ASSERT_TRUE(isnan(summary(0, b, 0)->mean));
+    }
+
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, summary(0, 5, 0)->mean);
+    TEST_ASSERT_EQUAL(0, summary(1, 1, 0)->count);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, summary(3, 0, 0)->mean);
+}
+
+void test_index_counts_a_wild_jump_in_the_current_bucket(void)
+{
+    TEST_ASSERT_EQUAL(RP_INDEX_OK,
+                      rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag, "position.z", 2));
+    TEST_ASSERT_EQUAL(RP_INDEX_DEFAULT_MAX_GAP_MS, builder.max_gap_ms);
+
+    builder.max_gap_ms = 100;
+
+    add(0, 1.0f);
+    add(UINT32_MAX, 5.0f);
+    add(100, 3.0f);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_finish(&builder));
+
+    // A jump of exactly `max_gap_ms` is still a gap
+    TEST_ASSERT_EQUAL(3, builder.samples);
+    TEST_ASSERT_EQUAL(26, builder.levels[0].bucket_count);
+    TEST_ASSERT_EQUAL(2, summary(0, 0, 0)->count);
+    TEST_ASSERT_EQUAL_FLOAT(5.0f, summary(0, 0, 0)->max);
+    TEST_ASSERT_EQUAL_FLOAT(3.0f, summary(0, 25, 0)->mean);
+}
+
+void test_index_reads_back_a_time_range(void)
+{
+    FILE *file = tmpfile();
+    rp_index_reader_t reader;
+    rp_index_summary_t summaries[4];
+    size_t count;
+
+    build_ramp();
+
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_write(&builder, fileno(file)));
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_open(&reader, fileno(file)));
+
+    TEST_ASSERT_EQUAL(3, reader.level_count);
+    TEST_ASSERT_EQUAL(2, reader.field_count);
+    TEST_ASSERT_EQUAL(1, rp_index_find_field(&reader, "thrust_cmd"));
+    TEST_ASSERT_EQUAL(2, rp_index_find_field(&reader, "position.x"));
+
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_read(&reader, 0, 0, 5, 12, summaries, 4, &count));
+    TEST_ASSERT_EQUAL(3, count);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, summaries[0].min);
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, summaries[2].max);
+
+    // Past the last bucket, and cut short to the capacity
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_read(&reader, 1, 1, 0, 1000, summaries, 1, &count));
+    TEST_ASSERT_EQUAL(1, count);
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, summaries[0].mean);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_read(&reader, 0, 0, 16, 1000, summaries, 4, &count));
+    TEST_ASSERT_EQUAL(0, count);
+
+    TEST_ASSERT_EQUAL(RP_INDEX_INVALID_ARGUMENT,
+                      rp_index_read(&reader, 3, 0, 0, 15, summaries, 4, &count));
+
+    fclose(file);
+}
+
+void test_index_chooses_the_coarsest_level_for_a_plot(void)
+{
+    FILE *file = tmpfile();
+    rp_index_reader_t reader;
+
+    build_ramp();
+
+    TEST_ASSERT_NOT_NULL(file);
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_write(&builder, fileno(file)));
+    TEST_ASSERT_EQUAL(RP_INDEX_OK, rp_index_open(&reader, fileno(file)));
+
+    TEST_ASSERT_EQUAL(2, rp_index_choose_level(&reader, 0, 15, 1));
+    TEST_ASSERT_EQUAL(1, rp_index_choose_level(&reader, 0, 15, 2));
+    TEST_ASSERT_EQUAL(0, rp_index_choose_level(&reader, 0, 15, 4));
+    TEST_ASSERT_EQUAL(0, rp_index_choose_level(&reader, 0, 15, 100));
+
+    // Only the indexed part of the range counts
+    TEST_ASSERT_EQUAL(1, rp_index_choose_level(&reader, 0, UINT32_MAX, 2));
+
+    fclose(file);
+}
+
+void test_index_rejects_bad_arguments(void)
+{
+    FILE *file = tmpfile();
+    rp_index_reader_t reader;
+
+    TEST_ASSERT_EQUAL(RP_INDEX_UNKNOWN_FIELD,
+                      rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag, "uptime_ms", 2));
+    TEST_ASSERT_EQUAL(RP_INDEX_INVALID_ARGUMENT,
+                      rp_index_builder_init(&builder, tvr_Downlink_ack_tag, NULL, 2));
+    TEST_ASSERT_EQUAL(RP_INDEX_INVALID_ARGUMENT,
+                      rp_index_builder_init(&builder, tvr_Downlink_telemetry_tag, NULL, 32));
+    TEST_ASSERT_EQUAL(RP_INDEX_NULL_POINTER,
+                      rp_index_builder_init(NULL, tvr_Downlink_telemetry_tag, NULL, 2));
+
+    TEST_ASSERT_NOT_NULL(file);
+    fputs("not an index file", file);
+    fflush(file);
+    TEST_ASSERT_EQUAL(RP_INDEX_BAD_FILE, rp_index_open(&reader, fileno(file)));
+
+    fclose(file);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_index_summarizes_level_0_buckets);
+    RUN_TEST(test_index_merges_buckets_up_the_levels);
+    RUN_TEST(test_index_keeps_empty_buckets_for_gaps);
+    RUN_TEST(test_index_counts_a_wild_jump_in_the_current_bucket);
+    RUN_TEST(test_index_reads_back_a_time_range);
+    RUN_TEST(test_index_chooses_the_coarsest_level_for_a_plot);
+    RUN_TEST(test_index_rejects_bad_arguments);
+
+    return UNITY_END();
+}
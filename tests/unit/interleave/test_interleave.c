@@ -0,0 +1,329 @@
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+#include "rp/fec/rs.h"
+#include "rp/interleave/interleave.h"
+
+#define MAX_CAPTURED (32)
+#define ROW_SIZE (60)
+#define PARITY_SIZE (16)
+
+typedef struct captured {
+    uint8_t data[MAX_CAPTURED][RP_INTERLEAVE_FRAME_MAX_SIZE];
+    size_t sizes[MAX_CAPTURED];
+    size_t count;
+} captured_t;
+
+static captured_t frames;
+static captured_t packets;
+// Room for packets past the interleaver's limit, up to the codec's largest
+static uint8_t rows[RP_INTERLEAVE_MAX_DEPTH][RP_INTERLEAVE_BODY_MAX_SIZE];
+static uint8_t encoded[RP_INTERLEAVE_MAX_DEPTH][RP_INTERLEAVE_FRAME_MAX_SIZE];
+static size_t encoded_sizes[RP_INTERLEAVE_MAX_DEPTH];
+static rp_interleaver_t interleaver;
+static rp_deinterleaver_t deinterleaver;
+
+static bool capture(void *context, const uint8_t *data, size_t size)
+{
+    captured_t *captured = context;
+
+    TEST_ASSERT_LESS_THAN(MAX_CAPTURED, captured->count);
+    TEST_ASSERT_LESS_OR_EQUAL(RP_INTERLEAVE_FRAME_MAX_SIZE, size);
+
+    memcpy(captured->data[captured->count], data, size);
+    captured->sizes[captured->count++] = size;
+
+    return true;
+}
+
+/**
+ * Makes packet `i` of a test block, `size` bytes with zeros in them, COBS encoded.
+ */
+static void make_packet(size_t i, size_t size)
+{
+    for (size_t b = 0; b < size; b++) {
+        rows[i][b] = (b % 7 == 3) ? 0 : (uint8_t)(i * 31 + b * 7 + 1);
+    }
+
+    encoded_sizes[i] = cobs_encode(rows[i], size, encoded[i], sizeof(encoded[i])).written;
+}
+
+/**
+ * Decodes delivered packet `i` into `row`.
+ */
+static size_t delivered(size_t i, uint8_t *row)
+{
+    cobs_result_t result =
+        cobs_decode(packets.data[i], packets.sizes[i], row, RP_INTERLEAVE_ROW_MAX_SIZE);
+
+    TEST_ASSERT_EQUAL(COBS_OK, result.status);
+
+    return result.written;
+}
+
+static void push_frame(size_t j)
+{
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK,
+                      rp_deinterleaver_push(&deinterleaver, frames.data[j], frames.sizes[j]));
+}
+
+void setUp(void)
+{
+    memset(&frames, 0, sizeof(frames));
+    memset(&packets, 0, sizeof(packets));
+    rp_deinterleaver_init(&deinterleaver, NULL, capture, &packets);
+}
+
+void tearDown(void)
+{
+}
+
+void test_interleave_round_trip(void)
+{
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_init(&interleaver, 4, capture, &frames));
+
+    for (size_t i = 0; i < 4; i++) {
+        make_packet(i, 40 + i * 9);
+        TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK,
+                          rp_interleaver_push(&interleaver, encoded[i], encoded_sizes[i]));
+        TEST_ASSERT_EQUAL((i == 3) ? 4 : 0, frames.count);
+    }
+
+    for (size_t j = 0; j < 4; j++) {
+        push_frame(j);
+        TEST_ASSERT_EQUAL((j == 3) ? 4 : 0, packets.count);
+    }
+
+    for (size_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(encoded_sizes[i], packets.sizes[i]);
+        TEST_ASSERT_EQUAL_MEMORY(encoded[i], packets.data[i], encoded_sizes[i]);
+    }
+
+    TEST_ASSERT_EQUAL(1, deinterleaver.blocks);
+    TEST_ASSERT_EQUAL(4, deinterleaver.frames);
+    TEST_ASSERT_EQUAL(0, deinterleaver.lost);
+}
+
+void test_interleave_spreads_a_burst_across_packets(void)
+{
+    uint8_t body[RP_INTERLEAVE_BODY_MAX_SIZE];
+    uint8_t row[RP_INTERLEAVE_ROW_MAX_SIZE];
+
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_init(&interleaver, 8, capture, &frames));
+
+    for (size_t i = 0; i < 8; i++) {
+        make_packet(i, ROW_SIZE);
+        rp_interleaver_push(&interleaver, encoded[i], encoded_sizes[i]);
+    }
+
+    // 16 consecutive payload bytes of frame 5 replaced
+    size_t size = cobs_decode(frames.data[5], frames.sizes[5], body, sizeof(body)).written;
+
+    memset(&body[RP_INTERLEAVE_HEADER_SIZE(8) + 20], 0x5A, 16);
+    frames.sizes[5] = cobs_encode(body, size, frames.data[5], sizeof(frames.data[5])).written;
+
+    for (size_t j = 0; j < 8; j++) {
+        push_frame(j);
+    }
+
+    TEST_ASSERT_EQUAL(8, packets.count);
+
+    for (size_t i = 0; i < 8; i++) {
+        size_t damaged = 0;
+
+        TEST_ASSERT_EQUAL(ROW_SIZE, delivered(i, row));
+
+        for (size_t b = 0; b < ROW_SIZE; b++) {
+            damaged += row[b] != rows[i][b];
+        }
+
+        TEST_ASSERT_LESS_OR_EQUAL(2, damaged);
+    }
+}
+
+void test_interleave_lost_frame_is_corrected_as_erasures(void)
+{
+    rs_codec_t fec;
+    uint8_t row[RP_INTERLEAVE_ROW_MAX_SIZE];
+
+    TEST_ASSERT_EQUAL(RS_OK, rs_codec_init(&fec, PARITY_SIZE));
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_init(&interleaver, 8, capture, &frames));
+    rp_deinterleaver_init(&deinterleaver, &fec, capture, &packets);
+
+    // Two blocks of Reed-Solomon codewords
+    for (size_t i = 0; i < 16; i++) {
+        size_t r = i % 8;
+
+        for (size_t b = 0; b < ROW_SIZE; b++) {
+            rows[r][b] = (uint8_t)(i * 13 + b * 3);
+        }
+
+        rs_encode(&fec, rows[r], ROW_SIZE, &rows[r][ROW_SIZE]);
+        encoded_sizes[r] = cobs_encode(rows[r], ROW_SIZE + PARITY_SIZE, encoded[r],
+                                       sizeof(encoded[r]))
+                               .written;
+        rp_interleaver_push(&interleaver, encoded[r], encoded_sizes[r]);
+    }
+
+    TEST_ASSERT_EQUAL(16, frames.count);
+
+    // Frame 6 of the first block lost: 11 bytes of each codeword, more than the 8 errors its
+    // parity corrects, but not than the 16 erasures. Delivered when the second block starts
+    for (size_t j = 0; j < 9; j++) {
+        if (j != 6) {
+            push_frame(j);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(8, packets.count);
+    TEST_ASSERT_EQUAL(1, deinterleaver.lost);
+    TEST_ASSERT_GREATER_THAN(0, deinterleaver.corrected);
+
+    for (size_t i = 0; i < 8; i++) {
+        size_t size = delivered(i, row);
+
+        TEST_ASSERT_EQUAL(ROW_SIZE + PARITY_SIZE, size);
+        TEST_ASSERT_EQUAL(0, rs_decode(&fec, row, size).corrected);
+
+        for (size_t b = 0; b < ROW_SIZE; b++) {
+            TEST_ASSERT_EQUAL_UINT8((uint8_t)(i * 13 + b * 3), row[b]);
+        }
+    }
+}
+
+void test_interleave_flush_sends_a_short_block(void)
+{
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_init(&interleaver, 8, capture, &frames));
+
+    for (size_t i = 0; i < 3; i++) {
+        make_packet(i, 20 + i);
+        rp_interleaver_push(&interleaver, encoded[i], encoded_sizes[i]);
+    }
+
+    TEST_ASSERT_EQUAL(0, frames.count);
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_flush(&interleaver));
+    TEST_ASSERT_EQUAL(3, frames.count);
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_flush(&interleaver));
+    TEST_ASSERT_EQUAL(3, frames.count);
+
+    // Last frame lost, the receiver gives up on it
+    push_frame(0);
+    push_frame(1);
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_deinterleaver_flush(&deinterleaver));
+
+    TEST_ASSERT_EQUAL(3, packets.count);
+    TEST_ASSERT_EQUAL(1, deinterleaver.lost);
+}
+
+void test_interleave_largest_packets_fit_a_packet_frame(void)
+{
+    for (size_t depth = 1; depth <= RP_INTERLEAVE_MAX_DEPTH; depth++) {
+        size_t size = RP_INTERLEAVE_PACKET_MAX_SIZE(depth);
+
+        TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK,
+                          rp_interleaver_init(&interleaver, depth, capture, &frames));
+
+        // Short blocks too, each frame is checked against the limit as it is captured
+        for (size_t rows_in_block = 1; rows_in_block <= depth; rows_in_block++) {
+            frames.count = 0;
+
+            for (size_t i = 0; i < rows_in_block; i++) {
+                make_packet(i, size);
+                TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_push(&interleaver, encoded[i],
+                                                                        encoded_sizes[i]));
+            }
+
+            TEST_ASSERT_EQUAL(RP_INTERLEAVE_OK, rp_interleaver_flush(&interleaver));
+            TEST_ASSERT_EQUAL(rows_in_block, frames.count);
+        }
+
+        make_packet(0, size + 1);
+        TEST_ASSERT_EQUAL(RP_INTERLEAVE_BAD_PACKET,
+                          rp_interleaver_push(&interleaver, encoded[0], encoded_sizes[0]));
+    }
+
+    TEST_ASSERT_EQUAL(256, RP_INTERLEAVE_FRAME_MAX_SIZE);
+}
+
+void test_interleave_rejects_damaged_and_late_frames(void)
+{
+    uint8_t body[RP_INTERLEAVE_BODY_MAX_SIZE];
+
+    rp_interleaver_init(&interleaver, 2, capture, &frames);
+
+    for (size_t i = 0; i < 4; i++) {
+        make_packet(i % 2, 30);
+        rp_interleaver_push(&interleaver, encoded[i % 2], encoded_sizes[i % 2]);
+    }
+
+    // A packet size in the header changed
+    size_t size = cobs_decode(frames.data[0], frames.sizes[0], body, sizeof(body)).written;
+    uint8_t damaged[RP_INTERLEAVE_FRAME_MAX_SIZE];
+
+    body[2] ^= 0x04;
+
+    size_t damaged_size = cobs_encode(body, size, damaged, sizeof(damaged)).written;
+
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_BAD_FRAME,
+                      rp_deinterleaver_push(&deinterleaver, damaged, damaged_size));
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_BAD_FRAME,
+                      rp_deinterleaver_push(&deinterleaver, encoded[0], encoded_sizes[0]));
+
+    // A duplicate is ignored, a frame of a delivered block is late
+    push_frame(0);
+    push_frame(0);
+    push_frame(1);
+    TEST_ASSERT_EQUAL(2, packets.count);
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_LATE,
+                      rp_deinterleaver_push(&deinterleaver, frames.data[1], frames.sizes[1]));
+
+    push_frame(3);
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_LATE,
+                      rp_deinterleaver_push(&deinterleaver, frames.data[0], frames.sizes[0]));
+    push_frame(2);
+
+    TEST_ASSERT_EQUAL(4, packets.count);
+    TEST_ASSERT_EQUAL(4, deinterleaver.rejected);
+}
+
+void test_interleave_init_rejects_bad_arguments(void)
+{
+    uint8_t too_long[RP_INTERLEAVE_ROW_MAX_SIZE + 3];
+
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_INVALID_ARGUMENT,
+                      rp_interleaver_init(&interleaver, 0, capture, &frames));
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_INVALID_ARGUMENT,
+                      rp_interleaver_init(&interleaver, RP_INTERLEAVE_MAX_DEPTH + 1, capture,
+                                          &frames));
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_NULL_POINTER,
+                      rp_interleaver_init(&interleaver, 4, NULL, &frames));
+
+    rp_interleaver_init(&interleaver, 4, capture, &frames);
+    memset(too_long, 0x11, sizeof(too_long));
+    too_long[sizeof(too_long) - 1] = 0;
+
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_BAD_PACKET,
+                      rp_interleaver_push(&interleaver, too_long, sizeof(too_long)));
+    TEST_ASSERT_EQUAL(RP_INTERLEAVE_BAD_PACKET,
+                      rp_interleaver_push(&interleaver, (const uint8_t *)"\x01\x00", 2));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_interleave_round_trip);
+    RUN_TEST(test_interleave_spreads_a_burst_across_packets);
+    RUN_TEST(test_interleave_lost_frame_is_corrected_as_erasures);
+    RUN_TEST(test_interleave_flush_sends_a_short_block);
+    RUN_TEST(test_interleave_largest_packets_fit_a_packet_frame);
+    RUN_TEST(test_interleave_rejects_damaged_and_late_frames);
+    RUN_TEST(test_interleave_init_rejects_bad_arguments);
+
+    return UNITY_END();
+}
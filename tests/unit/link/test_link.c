@@ -0,0 +1,156 @@
+#include "unity.h"
+
+#include <stdint.h>
+
+#include "rp/link/link.h"
+
+static rp_link_stats_t stats;
+
+static rp_link_event_t receive(uint16_t sequence, uint32_t sent_us, uint32_t received_us)
+{
+    rp_link_header_t header = {.sequence = sequence, .timestamp_us = sent_us};
+
+    return rp_link_stats_update(&stats, &header, received_us);
+}
+
+void setUp(void)
+{
+    rp_link_stats_init(&stats);
+}
+
+void tearDown(void)
+{
+}
+
+void test_link_header_write_read_round_trip(void)
+{
+    const rp_link_header_t header = {.sequence = 0xBEEF, .timestamp_us = 0x12345678};
+    const uint8_t expected[RP_LINK_HEADER_SIZE] = {0xEF, 0xBE, 0x78, 0x56, 0x34, 0x12};
+    uint8_t buffer[RP_LINK_HEADER_SIZE];
+    rp_link_header_t parsed;
+
+    rp_link_header_write(&header, buffer);
+    rp_link_header_read(&parsed, buffer);
+
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, buffer, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT16(header.sequence, parsed.sequence);
+    TEST_ASSERT_EQUAL_UINT32(header.timestamp_us, parsed.timestamp_us);
+}
+
+void test_link_sender_increments_and_wraps(void)
+{
+    rp_link_sender_t sender;
+
+    rp_link_sender_init(&sender, UINT16_MAX);
+
+    rp_link_header_t first = rp_link_sender_next(&sender, 100);
+    rp_link_header_t second = rp_link_sender_next(&sender, 200);
+
+    TEST_ASSERT_EQUAL_UINT16(UINT16_MAX, first.sequence);
+    TEST_ASSERT_EQUAL_UINT32(100, first.timestamp_us);
+    TEST_ASSERT_EQUAL_UINT16(0, second.sequence);
+    TEST_ASSERT_EQUAL_UINT32(200, second.timestamp_us);
+}
+
+void test_link_stats_in_order_across_wrap(void)
+{
+    TEST_ASSERT_EQUAL(RP_LINK_RESYNC, receive(UINT16_MAX - 1, 0, 10));
+    TEST_ASSERT_EQUAL(RP_LINK_IN_ORDER, receive(UINT16_MAX, 0, 10));
+    TEST_ASSERT_EQUAL(RP_LINK_IN_ORDER, receive(0, 0, 10));
+    TEST_ASSERT_EQUAL(RP_LINK_IN_ORDER, receive(1, 0, 10));
+
+    TEST_ASSERT_EQUAL_UINT32(4, stats.received);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.resyncs);
+}
+
+void test_link_stats_gap_then_reorder_recovers_loss(void)
+{
+    receive(10, 0, 0);
+
+    TEST_ASSERT_EQUAL(RP_LINK_GAP, receive(14, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(3, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.gaps);
+
+    TEST_ASSERT_EQUAL(RP_LINK_REORDERED, receive(12, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.reordered);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.received);
+}
+
+void test_link_stats_duplicates_and_late_frames(void)
+{
+    receive(100, 0, 0);
+    receive(101, 0, 0);
+
+    TEST_ASSERT_EQUAL(RP_LINK_DUPLICATE, receive(101, 0, 0));
+    TEST_ASSERT_EQUAL(RP_LINK_DUPLICATE, receive(100, 0, 0));
+    TEST_ASSERT_EQUAL(RP_LINK_LATE, receive(101 - RP_LINK_WINDOW_SIZE, 0, 0));
+
+    TEST_ASSERT_EQUAL_UINT32(2, stats.duplicates);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.received);
+}
+
+void test_link_stats_large_jump_resyncs(void)
+{
+    receive(5, 0, 0);
+
+    TEST_ASSERT_EQUAL(RP_LINK_RESYNC, receive(5 + RP_LINK_MAX_DROPOUT + 1, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.lost);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.resyncs);
+}
+
+void test_link_stats_latency_and_jitter(void)
+{
+    stats.clock_offset_us = 1000;
+
+    // Transit times of 1500, 1700 and 1600 us including the clock offset
+    receive(0, 0, 1500);
+    receive(1, 10000, 11700);
+    receive(2, 20000, 21600);
+
+    TEST_ASSERT_EQUAL_UINT32(3, stats.latency.samples);
+    TEST_ASSERT_EQUAL_UINT32(500, stats.latency.min_us);
+    TEST_ASSERT_EQUAL_UINT32(700, stats.latency.max_us);
+    TEST_ASSERT_EQUAL_UINT64(1800, stats.latency.sum_us);
+
+    TEST_ASSERT_EQUAL_UINT32(2, stats.jitter.samples);
+    TEST_ASSERT_EQUAL_UINT32(100, stats.jitter.min_us);
+    TEST_ASSERT_EQUAL_UINT32(200, stats.jitter.max_us);
+
+    // 200 / 16 = 12, then 12 + (100 - 12) / 16 = 17
+    TEST_ASSERT_EQUAL_UINT32(17, stats.jitter_us);
+}
+
+void test_link_histogram_percentile(void)
+{
+    rp_link_histogram_t histogram = {0};
+
+    for (uint32_t i = 0; i < 99; i++) {
+        rp_link_histogram_add(&histogram, 100);
+    }
+
+    rp_link_histogram_add(&histogram, 5000);
+
+    // 100 us lands in [64, 128)
+    TEST_ASSERT_EQUAL_UINT32(127, rp_link_histogram_percentile(&histogram, 50.0));
+    TEST_ASSERT_EQUAL_UINT32(127, rp_link_histogram_percentile(&histogram, 99.0));
+    TEST_ASSERT_EQUAL_UINT32(5000, rp_link_histogram_percentile(&histogram, 100.0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_link_header_write_read_round_trip);
+    RUN_TEST(test_link_sender_increments_and_wraps);
+    RUN_TEST(test_link_stats_in_order_across_wrap);
+    RUN_TEST(test_link_stats_gap_then_reorder_recovers_loss);
+    RUN_TEST(test_link_stats_duplicates_and_late_frames);
+    RUN_TEST(test_link_stats_large_jump_resyncs);
+    RUN_TEST(test_link_stats_latency_and_jitter);
+    RUN_TEST(test_link_histogram_percentile);
+
+    return UNITY_END();
+}
@@ -0,0 +1,254 @@
+#include "pipeline.h"
+#include "unity.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "proto/codec_test_data.pb.h"
+
+#define FRAME_COUNT (2000)
+#define CORRUPT_EVERY (97)
+
+// Kept out of the stack, the slots hold RP_PIPELINE_DEPTH frames and messages
+static rp_pipeline_t pipeline;
+static uint8_t stream[FRAME_COUNT * RP_PACKET_MAX_SIZE];
+
+typedef struct delivery_log {
+    uint64_t count;
+    uint64_t errors;
+    bool in_order;
+    bool values_match;
+} delivery_log_t;
+
+static delivery_log_t delivery_log;
+
+static codec_test_data_t message_for(uint32_t index)
+{
+    codec_test_data_t message = CODEC_TEST_DATA_INIT_ZERO;
+
+    message.d = 0.25 * index;
+    message.ui32 = 5000 + index;
+    message.f = (float)index;
+
+    return message;
+}
+
+static void record_delivery(void *context, const rp_pipeline_result_t *result)
+{
+    delivery_log_t *log = context;
+    bool corrupt = (result->sequence % CORRUPT_EVERY) == 1;
+
+    log->in_order = log->in_order && result->sequence == log->count;
+    log->count++;
+
+    if (result->status != RP_CODEC_OK) {
+        log->errors++;
+        log->values_match = log->values_match && corrupt;
+        return;
+    }
+
+    const codec_test_data_t *message = result->message;
+    codec_test_data_t expected = message_for((uint32_t)result->sequence);
+
+    log->values_match = log->values_match && !corrupt && message->ui32 == expected.ui32 &&
+                        message->f == expected.f && message->d == expected.d &&
+                        result->received_ns == result->sequence;
+}
+
+/**
+ * Encodes `count` frames back to back, flipping a payload byte in some of them.
+ *
+ * @return size_t Bytes of stream written
+ */
+static size_t build_stream(uint32_t count, size_t *frame_ends)
+{
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        codec_test_data_t message = message_for(i);
+        rp_packet_encode_result_t encoded = rp_packet_encode(
+            &stream[size], sizeof(stream) - size, CODEC_TEST_DATA_FIELDS, &message);
+
+        TEST_ASSERT_EQUAL(RP_CODEC_OK, encoded.status);
+
+        if (i % CORRUPT_EVERY == 1) {
+            stream[size + 2] ^= 0x10;
+        }
+
+        size += encoded.written;
+        frame_ends[i] = size;
+    }
+
+    return size;
+}
+
+static void start(size_t worker_count)
+{
+    const rp_pipeline_config_t config = {
+        .worker_count = worker_count,
+        .fields = CODEC_TEST_DATA_FIELDS,
+        .message_size = sizeof(codec_test_data_t),
+        .callback = record_delivery,
+        .context = &delivery_log,
+    };
+
+    TEST_ASSERT_EQUAL(RP_PIPELINE_OK, rp_pipeline_start(&pipeline, &config));
+}
+
+void setUp(void)
+{
+    delivery_log = (delivery_log_t){.in_order = true, .values_match = true};
+}
+
+void tearDown(void)
+{
+}
+
+void test_pipeline_delivers_in_arrival_order(void)
+{
+    static size_t frame_ends[FRAME_COUNT];
+    size_t size = build_stream(FRAME_COUNT, frame_ends);
+    size_t offset = 0;
+
+    start(4);
+
+    // One feed per frame, so `received_ns` identifies the frame
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        rp_pipeline_feed(&pipeline, &stream[offset], frame_ends[i] - offset, i);
+        offset = frame_ends[i];
+    }
+
+    TEST_ASSERT_EQUAL(size, offset);
+
+    rp_pipeline_flush(&pipeline);
+
+    TEST_ASSERT_EQUAL(FRAME_COUNT, delivery_log.count);
+    TEST_ASSERT_TRUE(delivery_log.in_order);
+    TEST_ASSERT_TRUE(delivery_log.values_match);
+    TEST_ASSERT_EQUAL((FRAME_COUNT + CORRUPT_EVERY - 2) / CORRUPT_EVERY, delivery_log.errors);
+    TEST_ASSERT_EQUAL(delivery_log.errors, pipeline.decode_errors);
+
+    rp_pipeline_stop(&pipeline);
+}
+
+void test_pipeline_splits_arbitrary_chunks(void)
+{
+    static size_t frame_ends[FRAME_COUNT];
+    size_t size = build_stream(FRAME_COUNT, frame_ends);
+    size_t chunk = 1;
+
+    start(3);
+
+    for (size_t offset = 0; offset < size; offset += chunk, chunk = chunk % 61 + 7) {
+        size_t length = (size - offset < chunk) ? size - offset : chunk;
+
+        rp_pipeline_feed(&pipeline, &stream[offset], length, 0);
+    }
+
+    // Stop delivers what was split before joining the threads
+    rp_pipeline_stop(&pipeline);
+
+    TEST_ASSERT_EQUAL(FRAME_COUNT, delivery_log.count);
+    TEST_ASSERT_TRUE(delivery_log.in_order);
+}
+
+void test_pipeline_single_worker(void)
+{
+    static size_t frame_ends[8];
+    size_t size = build_stream(8, frame_ends);
+
+    start(1);
+    rp_pipeline_feed(&pipeline, stream, size, 0);
+    rp_pipeline_stop(&pipeline);
+
+    TEST_ASSERT_EQUAL(8, delivery_log.count);
+    TEST_ASSERT_TRUE(delivery_log.in_order);
+}
+
+static void record_link_header(void *context, const rp_pipeline_result_t *result)
+{
+    delivery_log_t *log = context;
+
+    log->count++;
+    log->values_match = log->values_match && result->status == RP_CODEC_OK &&
+                        result->link_header != NULL &&
+                        result->link_header->sequence == (uint16_t)(100 + result->sequence);
+}
+
+void test_pipeline_returns_link_header_of_each_frame(void)
+{
+    rp_link_header_t header = {0};
+    rp_codec_options_t options = {.link_header = &header};
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < FRAME_COUNT; i++) {
+        codec_test_data_t message = message_for(i);
+
+        header.sequence = (uint16_t)(100 + i);
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode_with_options(&stream[size], sizeof(stream) - size,
+                                          CODEC_TEST_DATA_FIELDS, &message, &options);
+
+        TEST_ASSERT_EQUAL(RP_CODEC_OK, encoded.status);
+        size += encoded.written;
+    }
+
+    header = (rp_link_header_t){0};
+
+    const rp_pipeline_config_t config = {
+        .worker_count = 4,
+        .fields = CODEC_TEST_DATA_FIELDS,
+        .message_size = sizeof(codec_test_data_t),
+        .options = &options,
+        .callback = record_link_header,
+        .context = &delivery_log,
+    };
+
+    TEST_ASSERT_EQUAL(RP_PIPELINE_OK, rp_pipeline_start(&pipeline, &config));
+    rp_pipeline_feed(&pipeline, stream, size, 0);
+    rp_pipeline_stop(&pipeline);
+
+    TEST_ASSERT_EQUAL(FRAME_COUNT, delivery_log.count);
+    TEST_ASSERT_TRUE(delivery_log.values_match);
+
+    // Workers decode into their slots, never into the caller's header
+    TEST_ASSERT_EQUAL_UINT16(0, header.sequence);
+}
+
+void test_pipeline_rejects_invalid_config(void)
+{
+    rp_pipeline_config_t config = {
+        .worker_count = 0,
+        .fields = CODEC_TEST_DATA_FIELDS,
+        .message_size = sizeof(codec_test_data_t),
+        .callback = record_delivery,
+    };
+
+    TEST_ASSERT_EQUAL(RP_PIPELINE_INVALID_ARGUMENT, rp_pipeline_start(&pipeline, &config));
+
+    config.worker_count = RP_PIPELINE_MAX_WORKERS + 1;
+    TEST_ASSERT_EQUAL(RP_PIPELINE_INVALID_ARGUMENT, rp_pipeline_start(&pipeline, &config));
+
+    config.worker_count = 2;
+    config.message_size = RP_PIPELINE_MESSAGE_CAPACITY + 1;
+    TEST_ASSERT_EQUAL(RP_PIPELINE_INVALID_ARGUMENT, rp_pipeline_start(&pipeline, &config));
+
+    config.message_size = sizeof(codec_test_data_t);
+    config.callback = NULL;
+    TEST_ASSERT_EQUAL(RP_PIPELINE_NULL_POINTER, rp_pipeline_start(&pipeline, &config));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pipeline_delivers_in_arrival_order);
+    RUN_TEST(test_pipeline_splits_arbitrary_chunks);
+    RUN_TEST(test_pipeline_single_worker);
+    RUN_TEST(test_pipeline_returns_link_header_of_each_frame);
+    RUN_TEST(test_pipeline_rejects_invalid_config);
+
+    return UNITY_END();
+}
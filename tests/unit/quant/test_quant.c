@@ -0,0 +1,249 @@
+#include "unity.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pb.h"
+#include "rp/quant/quant.h"
+
+typedef struct sample {
+    float always;
+    float optional;
+    float selected;
+    bool has_optional;
+    pb_size_t which;
+} sample_t;
+
+// Only identifies the message type, the quantizer never reads it
+static const pb_msgdesc_t sample_msg = {0};
+
+static const rp_quant_field_t sample_fields[] = {
+    {
+        .offset = offsetof(sample_t, always),
+        .kind = RP_QUANT_HALF,
+        .present_offset = RP_QUANT_ALWAYS,
+        .which_offset = RP_QUANT_ALWAYS,
+    },
+    {
+        .offset = offsetof(sample_t, optional),
+        .kind = RP_QUANT_SCALED,
+        .min = -10.0f,
+        .resolution = 0.01f,
+        .bits = 11,
+        .present_offset = offsetof(sample_t, has_optional),
+        .which_offset = RP_QUANT_ALWAYS,
+    },
+    {
+        .offset = offsetof(sample_t, selected),
+        .kind = RP_QUANT_SCALED,
+        .min = 0.0f,
+        .resolution = 0.5f,
+        .bits = 3,
+        .present_offset = RP_QUANT_ALWAYS,
+        .which_offset = offsetof(sample_t, which),
+        .which_tag = 2,
+    },
+};
+
+static const rp_quant_spec_t sample_spec = {
+    .message = &sample_msg,
+    .message_size = sizeof(sample_t),
+    .fields = sample_fields,
+    .field_count = sizeof(sample_fields) / sizeof(sample_fields[0]),
+};
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_quant_half_known_values(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0x0000, rp_quant_half_from_float(0.0f));
+    TEST_ASSERT_EQUAL_HEX16(0x8000, rp_quant_half_from_float(-0.0f));
+    TEST_ASSERT_EQUAL_HEX16(0x3C00, rp_quant_half_from_float(1.0f));
+    TEST_ASSERT_EQUAL_HEX16(0xC000, rp_quant_half_from_float(-2.0f));
+    TEST_ASSERT_EQUAL_HEX16(0x3555, rp_quant_half_from_float(1.0f / 3.0f));
+    TEST_ASSERT_EQUAL_HEX16(0x7BFF, rp_quant_half_from_float(65504.0f));
+    TEST_ASSERT_EQUAL_HEX16(0x7C00, rp_quant_half_from_float(65520.0f));
+    TEST_ASSERT_EQUAL_HEX16(0xFC00, rp_quant_half_from_float(-1e9f));
+    TEST_ASSERT_EQUAL_HEX16(0x7C00, rp_quant_half_from_float(INFINITY));
+    TEST_ASSERT_TRUE((rp_quant_half_from_float(NAN) & 0x7FFF) > 0x7C00);
+
+    // Smallest subnormal, and values that round to it or to zero
+    TEST_ASSERT_EQUAL_HEX16(0x0001, rp_quant_half_from_float(5.9604645e-8f));
+    TEST_ASSERT_EQUAL_HEX16(0x0001, rp_quant_half_from_float(4.0e-8f));
+    TEST_ASSERT_EQUAL_HEX16(0x0000, rp_quant_half_from_float(2.0e-8f));
+    TEST_ASSERT_EQUAL_HEX16(0x03FF, rp_quant_half_from_float(6.0975552e-5f));
+}
+
+void test_quant_half_rounds_to_nearest_even(void)
+{
+    // 1 + 2^-11 lies halfway between 0x3C00 and 0x3C01
+    TEST_ASSERT_EQUAL_HEX16(0x3C00, rp_quant_half_from_float(1.00048828125f));
+    // 1 + 3 * 2^-11 lies halfway between 0x3C01 and 0x3C02
+    TEST_ASSERT_EQUAL_HEX16(0x3C02, rp_quant_half_from_float(1.00146484375f));
+    TEST_ASSERT_EQUAL_HEX16(0x3C01, rp_quant_half_from_float(1.0006f));
+}
+
+void test_quant_half_round_trip_is_exact(void)
+{
+    for (uint32_t half = 0; half < 0x10000; half++) {
+        // Skip NaN payloads
+        if ((half & 0x7C00) == 0x7C00 && (half & 0x3FF) != 0) {
+            continue;
+        }
+
+        float value = rp_quant_half_to_float((uint16_t)half);
+
+        TEST_ASSERT_EQUAL_HEX16(half, rp_quant_half_from_float(value));
+    }
+}
+
+void test_quant_scale_rounds_and_saturates(void)
+{
+    const rp_quant_field_t *field = &sample_fields[1];
+
+    TEST_ASSERT_EQUAL_UINT32(1000, rp_quant_scale(field, 0.0f));
+    TEST_ASSERT_EQUAL_UINT32(1001, rp_quant_scale(field, 0.006f));
+    TEST_ASSERT_EQUAL_UINT32(1000, rp_quant_scale(field, 0.004f));
+    TEST_ASSERT_EQUAL_UINT32(0, rp_quant_scale(field, -50.0f));
+    TEST_ASSERT_EQUAL_UINT32(2047, rp_quant_scale(field, 50.0f));
+    TEST_ASSERT_EQUAL_UINT32(0, rp_quant_scale(field, NAN));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.0f, rp_quant_unscale(field, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 10.47f, rp_quant_unscale(field, 2047));
+}
+
+void test_quant_spec_valid_should_reject_bad_specs(void)
+{
+    rp_quant_field_t field = sample_fields[1];
+    rp_quant_spec_t spec = sample_spec;
+
+    spec.fields = &field;
+    spec.field_count = 1;
+
+    TEST_ASSERT_TRUE(rp_quant_spec_valid(&spec));
+
+    field.bits = 0;
+    TEST_ASSERT_FALSE(rp_quant_spec_valid(&spec));
+
+    field = sample_fields[1];
+    field.resolution = 0.0f;
+    TEST_ASSERT_FALSE(rp_quant_spec_valid(&spec));
+
+    field = sample_fields[1];
+    field.offset = sizeof(sample_t);
+    TEST_ASSERT_FALSE(rp_quant_spec_valid(&spec));
+
+    spec.field_count = RP_QUANT_MAX_FIELDS + 1;
+    TEST_ASSERT_FALSE(rp_quant_spec_valid(&spec));
+    TEST_ASSERT_FALSE(rp_quant_spec_valid(NULL));
+}
+
+void test_quant_pack_unpack_round_trip(void)
+{
+    sample_t message = {
+        .always = 1.5f,
+        .optional = -3.21f,
+        .selected = 2.5f,
+        .has_optional = true,
+        .which = 2,
+    };
+    uint8_t block[8];
+    rp_quant_values_t values;
+
+    // Bitmap, then 16 + 11 + 3 bits of codes
+    TEST_ASSERT_EQUAL(5, rp_quant_max_block_size(&sample_spec));
+
+    rp_quant_result_t packed = rp_quant_pack(&sample_spec, &message, block, sizeof(block));
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OK, packed.status);
+    TEST_ASSERT_EQUAL(5, packed.size);
+    TEST_ASSERT_EQUAL_HEX8(0x07, block[0]);
+
+    // Moved into the block, so protobuf leaves them out
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, message.always);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, message.optional);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, message.selected);
+
+    rp_quant_result_t unpacked = rp_quant_unpack(&sample_spec, block, packed.size, &values);
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OK, unpacked.status);
+    TEST_ASSERT_EQUAL(packed.size, unpacked.size);
+    TEST_ASSERT_EQUAL_HEX32(0x7, values.present);
+
+    rp_quant_apply(&sample_spec, &values, &message);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, message.always);
+    TEST_ASSERT_FLOAT_WITHIN(0.005f, -3.21f, message.optional);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, message.selected);
+}
+
+void test_quant_pack_should_skip_absent_fields(void)
+{
+    sample_t message = {
+        .always = -0.25f,
+        .optional = 7.0f,
+        .selected = 1.0f,
+        .has_optional = false,
+        .which = 1,
+    };
+    uint8_t block[8];
+    rp_quant_values_t values;
+
+    rp_quant_result_t packed = rp_quant_pack(&sample_spec, &message, block, sizeof(block));
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OK, packed.status);
+    TEST_ASSERT_EQUAL(3, packed.size);
+    TEST_ASSERT_EQUAL_HEX8(0x01, block[0]);
+
+    // Absent fields are left alone for protobuf
+    TEST_ASSERT_EQUAL_FLOAT(7.0f, message.optional);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, message.selected);
+
+    rp_quant_result_t unpacked = rp_quant_unpack(&sample_spec, block, sizeof(block), &values);
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OK, unpacked.status);
+    TEST_ASSERT_EQUAL(3, unpacked.size);
+    TEST_ASSERT_EQUAL_HEX32(0x1, values.present);
+    TEST_ASSERT_EQUAL_FLOAT(-0.25f, values.values[0]);
+}
+
+void test_quant_should_report_short_buffers(void)
+{
+    sample_t message = {.always = 1.0f, .has_optional = true, .which = 2};
+    uint8_t block[8];
+    rp_quant_values_t values;
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OVERFLOW, rp_quant_pack(&sample_spec, &message, block, 4).status);
+
+    message = (sample_t){.always = 1.0f, .has_optional = true, .which = 2};
+
+    rp_quant_result_t packed = rp_quant_pack(&sample_spec, &message, block, sizeof(block));
+
+    TEST_ASSERT_EQUAL(RP_QUANT_OK, packed.status);
+    TEST_ASSERT_EQUAL(RP_QUANT_TRUNCATED,
+                      rp_quant_unpack(&sample_spec, block, packed.size - 1, &values).status);
+    TEST_ASSERT_EQUAL(RP_QUANT_TRUNCATED, rp_quant_unpack(&sample_spec, block, 0, &values).status);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_quant_half_known_values);
+    RUN_TEST(test_quant_half_rounds_to_nearest_even);
+    RUN_TEST(test_quant_half_round_trip_is_exact);
+    RUN_TEST(test_quant_scale_rounds_and_saturates);
+    RUN_TEST(test_quant_spec_valid_should_reject_bad_specs);
+    RUN_TEST(test_quant_pack_unpack_round_trip);
+    RUN_TEST(test_quant_pack_should_skip_absent_fields);
+    RUN_TEST(test_quant_should_report_short_buffers);
+
+    return UNITY_END();
+}
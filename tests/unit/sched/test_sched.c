@@ -0,0 +1,175 @@
+#include "unity.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp/sched/sched.h"
+
+#define TELEMETRY (0)
+#define STATUS (1)
+
+static const rp_sched_stream_config_t configs[] = {
+    [TELEMETRY] = {.min_mhz = 2000, .target_mhz = 10000, .max_mhz = 50000},
+    [STATUS] = {.min_mhz = 200, .target_mhz = 1000, .max_mhz = 2000},
+};
+
+static rp_sched_t sched;
+
+/**
+ * Runs the scheduler for `duration_ms` in 1 ms steps, sending whatever it picks.
+ */
+static void run(uint32_t start_ms, uint32_t duration_ms, size_t telemetry_size,
+                size_t status_size)
+{
+    for (uint32_t i = 0; i < duration_ms; i++) {
+        uint32_t now = start_ms + i;
+        size_t stream;
+
+        while ((stream = rp_sched_next(&sched, now)) != RP_SCHED_NONE) {
+            size_t size = (stream == TELEMETRY) ? telemetry_size : status_size;
+
+            TEST_ASSERT_EQUAL(RP_SCHED_OK, rp_sched_sent(&sched, stream, size, now));
+        }
+    }
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(RP_SCHED_OK, rp_sched_init(&sched, configs, 2, 1000, 200));
+    TEST_ASSERT_EQUAL(RP_SCHED_OK, rp_sched_set_size(&sched, TELEMETRY, 60));
+    TEST_ASSERT_EQUAL(RP_SCHED_OK, rp_sched_set_size(&sched, STATUS, 20));
+}
+
+void tearDown(void)
+{
+}
+
+void test_sched_levels_follow_budget(void)
+{
+    // At target: 10 Hz * 60 + 1 Hz * 20 = 620 B/s, at maximum 3040 B/s
+    rp_sched_next(&sched, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_ABOVE_TARGET, sched.level);
+    TEST_ASSERT_GREATER_THAN_UINT32(10000, sched.streams[TELEMETRY].rate_mhz);
+    TEST_ASSERT_LESS_THAN_UINT32(50000, sched.streams[TELEMETRY].rate_mhz);
+
+    rp_sched_set_budget(&sched, 620);
+    rp_sched_next(&sched, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_ABOVE_TARGET, sched.level);
+    TEST_ASSERT_EQUAL_UINT32(10000, sched.streams[TELEMETRY].rate_mhz);
+    TEST_ASSERT_EQUAL_UINT32(1000, sched.streams[STATUS].rate_mhz);
+
+    rp_sched_set_budget(&sched, 400);
+    rp_sched_next(&sched, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_BELOW_TARGET, sched.level);
+
+    rp_sched_set_budget(&sched, 62);
+    rp_sched_next(&sched, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_CONGESTED, sched.level);
+    TEST_ASSERT_UINT32_WITHIN(10, 1000, sched.streams[TELEMETRY].rate_mhz);
+    TEST_ASSERT_UINT32_WITHIN(2, 100, sched.streams[STATUS].rate_mhz);
+
+    rp_sched_set_budget(&sched, 5000);
+    rp_sched_next(&sched, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_MAXIMUM, sched.level);
+    TEST_ASSERT_EQUAL_UINT32(50000, sched.streams[TELEMETRY].rate_mhz);
+}
+
+void test_sched_meets_target_rates(void)
+{
+    rp_sched_set_budget(&sched, 620);
+    run(0, 10000, 60, 20);
+
+    // 10 s at 10 Hz and 1 Hz, first frames sent at time 0
+    TEST_ASSERT_UINT32_WITHIN(1, 100, sched.streams[TELEMETRY].sent);
+    TEST_ASSERT_UINT32_WITHIN(1, 10, sched.streams[STATUS].sent);
+}
+
+void test_sched_stays_within_budget(void)
+{
+    rp_sched_set_budget(&sched, 300);
+    run(0, 20000, 60, 20);
+
+    uint32_t bytes =
+        (uint32_t)(sched.streams[TELEMETRY].sent_bytes + sched.streams[STATUS].sent_bytes);
+
+    // 20 s of budget plus the initial burst
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(300 * 20 + 200, bytes);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(300 * 20 * 9 / 10, bytes);
+    TEST_ASSERT_EQUAL(RP_SCHED_BELOW_TARGET, sched.level);
+}
+
+void test_sched_tracks_encoded_size(void)
+{
+    rp_sched_set_budget(&sched, 620);
+    run(0, 1000, 60, 20);
+    TEST_ASSERT_EQUAL(RP_SCHED_ABOVE_TARGET, sched.level);
+
+    // Frames grew, the same budget no longer covers the targets
+    run(1000, 1000, 120, 20);
+    TEST_ASSERT_EQUAL(RP_SCHED_BELOW_TARGET, sched.level);
+    TEST_ASSERT_EQUAL(120, sched.streams[TELEMETRY].size);
+}
+
+void test_sched_waits_for_tokens(void)
+{
+    rp_sched_set_budget(&sched, 100);
+
+    TEST_ASSERT_EQUAL(TELEMETRY, rp_sched_next(&sched, 0));
+
+    // Unscheduled traffic empties the bucket
+    rp_sched_consume(&sched, 200, 0);
+    TEST_ASSERT_EQUAL(RP_SCHED_NONE, rp_sched_next(&sched, 0));
+    TEST_ASSERT_EQUAL(RP_SCHED_NONE, rp_sched_next(&sched, 599));
+    TEST_ASSERT_EQUAL(TELEMETRY, rp_sched_next(&sched, 600));
+}
+
+void test_sched_early_send_restarts_period(void)
+{
+    rp_sched_set_budget(&sched, 620);
+    run(0, 1, 60, 20);
+
+    // Status is sent on a state change, the next one comes a full period later
+    TEST_ASSERT_EQUAL(RP_SCHED_OK, rp_sched_sent(&sched, STATUS, 20, 500));
+    run(500, 1000, 60, 20);
+    TEST_ASSERT_EQUAL(2, sched.streams[STATUS].sent);
+    run(1500, 1, 60, 20);
+    TEST_ASSERT_EQUAL(3, sched.streams[STATUS].sent);
+}
+
+void test_sched_clock_wraparound(void)
+{
+    rp_sched_set_budget(&sched, 620);
+    run(UINT32_MAX - 2000, 4000, 60, 20);
+
+    TEST_ASSERT_UINT32_WITHIN(1, 40, sched.streams[TELEMETRY].sent);
+    TEST_ASSERT_UINT32_WITHIN(1, 4, sched.streams[STATUS].sent);
+}
+
+void test_sched_invalid_arguments(void)
+{
+    rp_sched_stream_config_t bad = {.min_mhz = 2000, .target_mhz = 1000, .max_mhz = 3000};
+
+    TEST_ASSERT_EQUAL(RP_SCHED_INVALID_ARGUMENT, rp_sched_init(&sched, &bad, 1, 1000, 200));
+    TEST_ASSERT_EQUAL(RP_SCHED_INVALID_ARGUMENT,
+                      rp_sched_init(&sched, configs, RP_SCHED_MAX_STREAMS + 1, 1000, 200));
+    TEST_ASSERT_EQUAL(RP_SCHED_NULL_POINTER, rp_sched_init(NULL, configs, 2, 1000, 200));
+    TEST_ASSERT_EQUAL(RP_SCHED_INVALID_ARGUMENT, rp_sched_set_size(&sched, 2, 10));
+    TEST_ASSERT_EQUAL(RP_SCHED_INVALID_ARGUMENT, rp_sched_sent(&sched, 2, 10, 0));
+    TEST_ASSERT_EQUAL(RP_SCHED_NONE, rp_sched_next(NULL, 0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sched_levels_follow_budget);
+    RUN_TEST(test_sched_meets_target_rates);
+    RUN_TEST(test_sched_stays_within_budget);
+    RUN_TEST(test_sched_tracks_encoded_size);
+    RUN_TEST(test_sched_waits_for_tokens);
+    RUN_TEST(test_sched_early_send_restarts_period);
+    RUN_TEST(test_sched_clock_wraparound);
+    RUN_TEST(test_sched_invalid_arguments);
+
+    return UNITY_END();
+}
@@ -0,0 +1,258 @@
+#include "unity.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "rp/cobs/cobs.h"
+#include "rp/txq/txq.h"
+
+#define SLOT_COUNT (4)
+
+static rp_txq_slot_t slots[SLOT_COUNT];
+static rp_txq_t queue;
+
+static void push_frame(rp_txq_class_t class_id, uint8_t tag, size_t size, uint32_t now_ms)
+{
+    uint8_t frame[RP_TXQ_FRAME_CAPACITY];
+
+    memset(frame, tag, size - 1);
+    frame[size - 1] = COBS_DELIMITER_BYTE;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_push(&queue, class_id, frame, size, now_ms));
+}
+
+static uint8_t pop_tag(uint32_t now_ms)
+{
+    rp_txq_slot_t *slot = rp_txq_pop(&queue, now_ms);
+
+    TEST_ASSERT_NOT_NULL(slot);
+
+    uint8_t tag = slot->frame[0];
+
+    rp_txq_release(&queue, slot);
+
+    return tag;
+}
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, NULL));
+}
+
+void tearDown(void)
+{
+}
+
+void test_txq_strict_priority_order(void)
+{
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 8, 0);
+    push_frame(RP_TXQ_CLASS_STATUS, 0x30, 8, 0);
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x41, 8, 0);
+    push_frame(RP_TXQ_CLASS_ABORT, 0x10, 8, 0);
+
+    TEST_ASSERT_EQUAL_HEX8(0x10, pop_tag(0));
+    TEST_ASSERT_EQUAL_HEX8(0x30, pop_tag(0));
+    TEST_ASSERT_EQUAL_HEX8(0x40, pop_tag(0));
+    TEST_ASSERT_EQUAL_HEX8(0x41, pop_tag(0));
+    TEST_ASSERT_NULL(rp_txq_pop(&queue, 0));
+}
+
+void test_txq_full_without_drop_policy(void)
+{
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        push_frame(RP_TXQ_CLASS_TELEMETRY, i + 1, 8, 0);
+    }
+
+    uint8_t frame[] = {0x01, COBS_DELIMITER_BYTE};
+
+    TEST_ASSERT_EQUAL(RP_TXQ_FULL,
+                      rp_txq_push(&queue, RP_TXQ_CLASS_ABORT, frame, sizeof(frame), 0));
+}
+
+void test_txq_abort_evicts_oldest_telemetry(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    configs[RP_TXQ_CLASS_TELEMETRY].drop_oldest = true;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    for (uint8_t i = 0; i < SLOT_COUNT; i++) {
+        push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40 + i, 8, 0);
+    }
+
+    push_frame(RP_TXQ_CLASS_ABORT, 0x10, 8, 0);
+
+    TEST_ASSERT_EQUAL(1, queue.dropped);
+    TEST_ASSERT_EQUAL_HEX8(0x10, pop_tag(0));
+    TEST_ASSERT_EQUAL_HEX8(0x41, pop_tag(0));
+}
+
+void test_txq_max_queued_drops_oldest_in_class(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    configs[RP_TXQ_CLASS_TELEMETRY].max_queued = 1;
+    configs[RP_TXQ_CLASS_TELEMETRY].drop_oldest = true;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 8, 0);
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x41, 8, 0);
+
+    TEST_ASSERT_EQUAL(1, rp_txq_pending(&queue, RP_TXQ_CLASS_TELEMETRY));
+    TEST_ASSERT_EQUAL_HEX8(0x41, pop_tag(0));
+}
+
+void test_txq_rate_limit_lets_lower_class_through(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    // 1 byte per millisecond, room for a single 10 byte frame
+    configs[RP_TXQ_CLASS_STATUS].rate_bytes_per_s = 1000;
+    configs[RP_TXQ_CLASS_STATUS].burst_bytes = 10;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    push_frame(RP_TXQ_CLASS_STATUS, 0x30, 10, 0);
+    push_frame(RP_TXQ_CLASS_STATUS, 0x31, 10, 0);
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 10, 0);
+
+    TEST_ASSERT_EQUAL_HEX8(0x30, pop_tag(0));
+    TEST_ASSERT_EQUAL_HEX8(0x40, pop_tag(5));
+    TEST_ASSERT_NULL(rp_txq_pop(&queue, 5));
+    TEST_ASSERT_EQUAL_HEX8(0x31, pop_tag(10));
+}
+
+void test_txq_read_streams_frames_in_chunks(void)
+{
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 5, 0);
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x41, 5, 0);
+
+    uint8_t expected[] = {0x40, 0x40, 0x40, 0x40, COBS_DELIMITER_BYTE,
+                          0x41, 0x41, 0x41, 0x41, COBS_DELIMITER_BYTE};
+    uint8_t actual[sizeof(expected) + 4];
+    size_t total = 0;
+
+    total += rp_txq_read(&queue, 0, &actual[total], 3);
+    total += rp_txq_read(&queue, 0, &actual[total], 3);
+    total += rp_txq_read(&queue, 0, &actual[total], sizeof(actual) - total);
+
+    TEST_ASSERT_EQUAL(sizeof(expected), total);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+}
+
+void test_txq_read_preempts_partial_frame(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    configs[RP_TXQ_CLASS_ABORT].preemptive = true;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 6, 0);
+
+    uint8_t actual[32];
+    size_t total = rp_txq_read(&queue, 0, actual, 2);
+
+    push_frame(RP_TXQ_CLASS_ABORT, 0x10, 3, 1);
+
+    total += rp_txq_read(&queue, 1, &actual[total], sizeof(actual) - total);
+
+    // Truncated telemetry, abort, then the telemetry frame again from the start
+    uint8_t expected[] = {0x40, 0x40, COBS_DELIMITER_BYTE,
+                          0x10, 0x10, COBS_DELIMITER_BYTE,
+                          0x40, 0x40, 0x40, 0x40, 0x40, COBS_DELIMITER_BYTE};
+
+    TEST_ASSERT_EQUAL(sizeof(expected), total);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+    TEST_ASSERT_EQUAL(1, queue.preemptions);
+}
+
+void test_txq_preempted_frame_is_refunded_unsent_bytes(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    configs[RP_TXQ_CLASS_ABORT].preemptive = true;
+    configs[RP_TXQ_CLASS_TELEMETRY].rate_bytes_per_s = 1000;
+    configs[RP_TXQ_CLASS_TELEMETRY].burst_bytes = 20;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 10, 0);
+
+    uint8_t actual[32];
+    size_t total = rp_txq_read(&queue, 0, actual, 2);
+
+    TEST_ASSERT_EQUAL(10 * 1000, queue.classes[RP_TXQ_CLASS_TELEMETRY].tokens);
+
+    push_frame(RP_TXQ_CLASS_ABORT, 0x10, 3, 0);
+    total += rp_txq_read(&queue, 0, &actual[total], sizeof(actual) - total);
+
+    // Charged for the 2 bytes and the delimiter sent, then for the whole frame again
+    TEST_ASSERT_EQUAL(2 + 1 + 3 + 10, total);
+    TEST_ASSERT_EQUAL(1, queue.preemptions);
+    TEST_ASSERT_EQUAL((20 - 3 - 10) * 1000, queue.classes[RP_TXQ_CLASS_TELEMETRY].tokens);
+}
+
+void test_txq_preempted_frame_respects_max_queued(void)
+{
+    rp_txq_class_config_t configs[RP_TXQ_CLASS_COUNT] = {0};
+
+    configs[RP_TXQ_CLASS_ABORT].preemptive = true;
+    configs[RP_TXQ_CLASS_TELEMETRY].max_queued = 1;
+    configs[RP_TXQ_CLASS_TELEMETRY].drop_oldest = true;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_init(&queue, slots, SLOT_COUNT, configs));
+
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x40, 6, 0);
+
+    uint8_t actual[32];
+    size_t total = rp_txq_read(&queue, 0, actual, 2);
+
+    push_frame(RP_TXQ_CLASS_TELEMETRY, 0x41, 6, 0);
+    push_frame(RP_TXQ_CLASS_ABORT, 0x10, 3, 0);
+    total += rp_txq_read(&queue, 0, &actual[total], sizeof(actual) - total);
+
+    // The cut off frame is the oldest of a full class, so it is not sent again
+    uint8_t expected[] = {0x40, 0x40, COBS_DELIMITER_BYTE,
+                          0x10, 0x10, COBS_DELIMITER_BYTE,
+                          0x41, 0x41, 0x41, 0x41, 0x41, COBS_DELIMITER_BYTE};
+
+    TEST_ASSERT_EQUAL(sizeof(expected), total);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, sizeof(expected));
+    TEST_ASSERT_EQUAL(1, queue.dropped);
+    TEST_ASSERT_EQUAL(0, rp_txq_pending(&queue, RP_TXQ_CLASS_TELEMETRY));
+}
+
+void test_txq_reserve_commit_zero_copy(void)
+{
+    rp_txq_slot_t *slot = rp_txq_reserve(&queue, RP_TXQ_CLASS_COMMAND);
+
+    TEST_ASSERT_NOT_NULL(slot);
+
+    slot->frame[0] = 0x20;
+    slot->frame[1] = COBS_DELIMITER_BYTE;
+
+    TEST_ASSERT_EQUAL(RP_TXQ_OK, rp_txq_commit(&queue, slot, 2, 0));
+    TEST_ASSERT_EQUAL(1, rp_txq_pending(&queue, RP_TXQ_CLASS_COMMAND));
+    TEST_ASSERT_EQUAL_HEX8(0x20, pop_tag(0));
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_txq_strict_priority_order);
+    RUN_TEST(test_txq_full_without_drop_policy);
+    RUN_TEST(test_txq_abort_evicts_oldest_telemetry);
+    RUN_TEST(test_txq_max_queued_drops_oldest_in_class);
+    RUN_TEST(test_txq_rate_limit_lets_lower_class_through);
+    RUN_TEST(test_txq_read_streams_frames_in_chunks);
+    RUN_TEST(test_txq_read_preempts_partial_frame);
+    RUN_TEST(test_txq_preempted_frame_is_refunded_unsent_bytes);
+    RUN_TEST(test_txq_preempted_frame_respects_max_queued);
+    RUN_TEST(test_txq_reserve_commit_zero_copy);
+
+    return UNITY_END();
+}
@@ -0,0 +1,220 @@
+#include "uplink.h"
+#include "unity.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "proto/codec_test_data.pb.h"
+
+#define FRAME_COUNT (256)
+#define PAGE_SIZE (4096)
+
+static const uint8_t modem_header[] = {0xA5, 0x5A, 0x01};
+
+static uint8_t arena[FRAME_COUNT * RP_UPLINK_FRAME_RESERVE];
+static struct iovec iov[8];
+static rp_uplink_batch_t batch;
+static int pipe_fds[2];
+
+static codec_test_data_t message_for(uint32_t index)
+{
+    codec_test_data_t message = CODEC_TEST_DATA_INIT_ZERO;
+
+    message.d = 1.5 * index;
+    message.ui32 = 1000000 + index;
+    message.f = (float)index;
+    message.b1 = (index % 2) == 0;
+
+    return message;
+}
+
+/**
+ * Builds what the copy based path would send for the first `count` messages.
+ */
+static size_t expected_stream(uint8_t *output, size_t capacity, uint32_t count)
+{
+    size_t size = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        codec_test_data_t message = message_for(i);
+        uint8_t packet[RP_PACKET_MAX_SIZE];
+
+        rp_packet_encode_result_t encoded =
+            rp_packet_encode(packet, sizeof(packet), CODEC_TEST_DATA_FIELDS, &message);
+
+        TEST_ASSERT_EQUAL(RP_CODEC_OK, encoded.status);
+        TEST_ASSERT_TRUE(size + sizeof(modem_header) + encoded.written <= capacity);
+
+        memcpy(&output[size], modem_header, sizeof(modem_header));
+        size += sizeof(modem_header);
+        memcpy(&output[size], packet, encoded.written);
+        size += encoded.written;
+    }
+
+    return size;
+}
+
+static void add_messages(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        codec_test_data_t message = message_for(i);
+
+        rp_uplink_add_result_t added = rp_uplink_batch_add(
+            &batch, modem_header, sizeof(modem_header), CODEC_TEST_DATA_FIELDS, &message, NULL);
+
+        TEST_ASSERT_EQUAL(RP_UPLINK_OK, added.status);
+        TEST_ASSERT_TRUE(added.frame_size > 0);
+    }
+}
+
+static size_t read_available(uint8_t *output, size_t capacity)
+{
+    size_t size = 0;
+
+    for (;;) {
+        ssize_t count = read(pipe_fds[0], &output[size], capacity - size);
+
+        if (count <= 0) {
+            return size;
+        }
+
+        size += (size_t)count;
+    }
+}
+
+void setUp(void)
+{
+    rp_uplink_batch_init(&batch, iov, sizeof(iov) / sizeof(iov[0]), arena, sizeof(arena));
+
+    TEST_ASSERT_EQUAL(0, pipe(pipe_fds));
+    TEST_ASSERT_EQUAL(0, fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK));
+}
+
+void tearDown(void)
+{
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+}
+
+void test_uplink_batch_coalesces_frames_in_the_arena(void)
+{
+    static const uint8_t preamble[] = {0x55, 0x55};
+    codec_test_data_t message = message_for(7);
+
+    add_messages(3);
+
+    TEST_ASSERT_EQUAL(3, batch.frame_count);
+    TEST_ASSERT_EQUAL(1, batch.iov_count);
+    TEST_ASSERT_EQUAL_PTR(arena, batch.iov[0].iov_base);
+    TEST_ASSERT_EQUAL(batch.size, batch.iov[0].iov_len);
+
+    // A referenced buffer starts a new entry, the next frame another one
+    TEST_ASSERT_EQUAL(RP_UPLINK_OK, rp_uplink_batch_append(&batch, preamble, sizeof(preamble)));
+
+    rp_uplink_add_result_t added =
+        rp_uplink_batch_add(&batch, NULL, 2, CODEC_TEST_DATA_FIELDS, &message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_UPLINK_OK, added.status);
+    TEST_ASSERT_EQUAL(3, batch.iov_count);
+    TEST_ASSERT_EQUAL_PTR(preamble, batch.iov[1].iov_base);
+    TEST_ASSERT_EQUAL_PTR(added.header, batch.iov[2].iov_base);
+    TEST_ASSERT_EQUAL(2 + added.frame_size, batch.iov[2].iov_len);
+    TEST_ASSERT_EQUAL_HEX8(0x00, added.header[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, added.header[2 + added.frame_size - 1]);
+}
+
+void test_uplink_batch_add_rejects_bad_arguments(void)
+{
+    uint8_t header[RP_UPLINK_MAX_HEADER_SIZE + 1] = {0};
+    uint8_t small_arena[RP_UPLINK_MAX_HEADER_SIZE];
+    codec_test_data_t message = message_for(1);
+
+    rp_uplink_add_result_t added = rp_uplink_batch_add(&batch, header, sizeof(header),
+                                                       CODEC_TEST_DATA_FIELDS, &message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_UPLINK_INVALID_ARGUMENT, added.status);
+
+    rp_uplink_batch_init(&batch, iov, 1, small_arena, sizeof(small_arena));
+    added = rp_uplink_batch_add(&batch, modem_header, sizeof(modem_header),
+                                CODEC_TEST_DATA_FIELDS, &message, NULL);
+
+    TEST_ASSERT_EQUAL(RP_UPLINK_FULL, added.status);
+    TEST_ASSERT_EQUAL(0, batch.size);
+}
+
+void test_uplink_batch_write_matches_copy_path(void)
+{
+    static uint8_t expected[sizeof(arena)];
+    static uint8_t received[sizeof(expected)];
+
+    size_t expected_size = expected_stream(expected, sizeof(expected), 10);
+
+    add_messages(10);
+
+    TEST_ASSERT_EQUAL(expected_size, batch.size);
+    TEST_ASSERT_EQUAL(RP_UPLINK_OK, rp_uplink_batch_write(&batch, pipe_fds[1]));
+    TEST_ASSERT_EQUAL(0, batch.frame_count);
+    TEST_ASSERT_EQUAL(0, batch.size);
+
+    TEST_ASSERT_EQUAL(expected_size, read_available(received, sizeof(received)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, received, expected_size);
+}
+
+void test_uplink_batch_write_resumes_after_short_write(void)
+{
+    static uint8_t expected[sizeof(arena)];
+    static uint8_t received[128 * 1024];
+    uint8_t filler[PAGE_SIZE];
+
+    size_t expected_size = expected_stream(expected, sizeof(expected), FRAME_COUNT);
+
+    TEST_ASSERT_TRUE(expected_size > PAGE_SIZE);
+
+    // Fill the pipe, then free a single page so that the batch only partly fits
+    TEST_ASSERT_EQUAL(0, fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK));
+    memset(filler, 0xEE, sizeof(filler));
+
+    size_t filled = 0;
+    ssize_t count;
+
+    while ((count = write(pipe_fds[1], filler, sizeof(filler))) > 0) {
+        filled += (size_t)count;
+    }
+
+    while ((count = write(pipe_fds[1], filler, 1)) > 0) {
+        filled += (size_t)count;
+    }
+
+    TEST_ASSERT_EQUAL(PAGE_SIZE, read(pipe_fds[0], filler, sizeof(filler)));
+    filled -= PAGE_SIZE;
+
+    add_messages(FRAME_COUNT);
+
+    TEST_ASSERT_EQUAL(RP_UPLINK_WRITE_FAILED, rp_uplink_batch_write(&batch, pipe_fds[1]));
+    TEST_ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+    TEST_ASSERT_TRUE(batch.size > 0 && batch.size < expected_size);
+
+    size_t received_size = read_available(received, sizeof(received));
+
+    TEST_ASSERT_EQUAL(RP_UPLINK_OK, rp_uplink_batch_write(&batch, pipe_fds[1]));
+
+    received_size += read_available(&received[received_size], sizeof(received) - received_size);
+
+    TEST_ASSERT_EQUAL(filled + expected_size, received_size);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, &received[filled], expected_size);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_uplink_batch_coalesces_frames_in_the_arena);
+    RUN_TEST(test_uplink_batch_add_rejects_bad_arguments);
+    RUN_TEST(test_uplink_batch_write_matches_copy_path);
+    RUN_TEST(test_uplink_batch_write_resumes_after_short_write);
+
+    return UNITY_END();
+}
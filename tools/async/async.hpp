@@ -0,0 +1,459 @@
+#ifndef RP_ASYNC_HPP
+#define RP_ASYNC_HPP
+
+/*
+ * C++20 coroutine frame reader for Linux file descriptors (serial ports, ptys, pipes,
+ * sockets), driven by a single threaded epoll loop:
+ *
+ *     rp::task receive(rp::frame_reader<> &radio)
+ *     {
+ *         for (;;) {
+ *             auto frame = co_await radio.next<tvr_Downlink>();
+ *
+ *             if (!frame && frame.error().status == rp::read_status::closed) {
+ *                 co_return;
+ *             }
+ *             ...
+ *         }
+ *     }
+ *
+ *     rp::event_loop loop;
+ *     rp::frame_reader<> radio{loop, fd};
+ *     loop.spawn(receive(radio));
+ *     loop.run();
+ *
+ * Each reader owns one read buffer and one frame buffer (`rp_deframer_t`) and reuses them
+ * for every frame; awaiting a frame does not allocate. Only `spawn`ing a task allocates
+ * its coroutine frame. Readers are registered edge triggered and always drain the
+ * descriptor before suspending, so one loop serves many links without busy waiting.
+ */
+
+#include <array>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "rp/codec.hpp"
+
+extern "C" {
+#include "rp/deframer/deframer.h"
+}
+
+namespace rp {
+
+class event_loop;
+
+/**
+ * Something registered with an `event_loop` that reacts to epoll events.
+ */
+class io_source {
+  public:
+    virtual void on_event(std::uint32_t events) noexcept = 0;
+
+  protected:
+    ~io_source() = default;
+};
+
+/**
+ * Fire-and-forget coroutine run by `event_loop::spawn`. The task is started lazily
+ * and its frame is freed when it finishes.
+ */
+class task {
+  public:
+    struct promise_type {
+        event_loop *loop = nullptr;
+
+        task get_return_object() noexcept
+        {
+            return task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        auto final_suspend() noexcept;
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            std::terminate();
+        }
+    };
+
+    task(task &&other) noexcept : handle_{std::exchange(other.handle_, {})}
+    {
+    }
+
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    task &operator=(task &&) = delete;
+
+    ~task()
+    {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+  private:
+    friend class event_loop;
+
+    explicit task(std::coroutine_handle<promise_type> handle) noexcept : handle_{handle}
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * Single threaded epoll executor.
+ */
+class event_loop {
+  public:
+    static constexpr int max_events = 16;
+
+    event_loop() noexcept : epoll_fd_{epoll_create1(EPOLL_CLOEXEC)}
+    {
+    }
+
+    event_loop(const event_loop &) = delete;
+    event_loop &operator=(const event_loop &) = delete;
+
+    ~event_loop()
+    {
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
+
+    /**
+     * @return bool Whether the epoll instance could be created
+     */
+    bool valid() const noexcept
+    {
+        return epoll_fd_ >= 0;
+    }
+
+    /**
+     * Starts a task. It runs until its first suspension before `spawn` returns.
+     */
+    void spawn(task &&coroutine) noexcept
+    {
+        std::coroutine_handle<task::promise_type> handle = std::exchange(coroutine.handle_, {});
+
+        handle.promise().loop = this;
+        active_tasks_++;
+        handle.resume();
+    }
+
+    /**
+     * Registers a descriptor, edge triggered.
+     *
+     * @return bool Whether epoll accepted the descriptor
+     */
+    bool add(int fd, io_source *source) noexcept
+    {
+        epoll_event event{};
+
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.ptr = source;
+
+        return epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    void remove(int fd) noexcept
+    {
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    /**
+     * Dispatches events until every spawned task has finished or `stop` is called. Tasks
+     * end when their coroutine returns, typically after their link reports
+     * `read_status::closed`; a task still suspended when the loop is destroyed is leaked.
+     */
+    void run() noexcept
+    {
+        stopped_ = false;
+
+        while (!stopped_ && active_tasks_ > 0) {
+            run_once(-1);
+        }
+    }
+
+    /**
+     * Waits for and dispatches one batch of events.
+     *
+     * @param timeout_ms Longest wait, -1 for no limit
+     * @return int Number of events dispatched, -1 on error
+     */
+    int run_once(int timeout_ms) noexcept
+    {
+        std::array<epoll_event, max_events> events;
+
+        int count = epoll_wait(epoll_fd_, events.data(), max_events, timeout_ms);
+
+        if (count < 0) {
+            return (errno == EINTR) ? 0 : -1;
+        }
+
+        for (int i = 0; i < count; i++) {
+            static_cast<io_source *>(events[i].data.ptr)->on_event(events[i].events);
+        }
+
+        return count;
+    }
+
+    void stop() noexcept
+    {
+        stopped_ = true;
+    }
+
+    std::size_t active_tasks() const noexcept
+    {
+        return active_tasks_;
+    }
+
+  private:
+    friend struct task::promise_type;
+
+    int epoll_fd_;
+    std::size_t active_tasks_ = 0;
+    bool stopped_ = false;
+};
+
+inline auto task::promise_type::final_suspend() noexcept
+{
+    struct finisher {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<promise_type> handle) const noexcept
+        {
+            if (handle.promise().loop != nullptr) {
+                handle.promise().loop->active_tasks_--;
+            }
+
+            handle.destroy();
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+    };
+
+    return finisher{};
+}
+
+enum class read_status {
+    closed,      /**< End of stream, or the other end of a pty hung up */
+    io_error,    /**< `read` failed, see `frame_error::error_number` */
+    overflow,    /**< A frame did not fit in the frame buffer and was dropped */
+    undecodable, /**< A complete frame failed to decode, see `frame_error::codec` */
+};
+
+struct frame_error {
+    read_status status;
+    rp_codec_status_t codec = RP_CODEC_OK; /**< Set for `read_status::undecodable` */
+    int error_number = 0;                  /**< Set for `read_status::io_error` */
+};
+
+/**
+ * Splits the byte stream of one descriptor into frames and decodes them.
+ *
+ * @tparam FrameCapacity Largest frame, including the delimiter
+ * @tparam ReadSize Bytes requested from the descriptor per `read`
+ */
+template <std::size_t FrameCapacity = RP_PACKET_MAX_SIZE, std::size_t ReadSize = 512>
+class frame_reader : private io_source {
+  public:
+    /**
+     * Switches `fd` to non-blocking mode and registers it with the loop. The reader
+     * does not own the descriptor.
+     */
+    frame_reader(event_loop &loop, int fd, const rp_codec_options_t &options = {}) noexcept
+        : loop_{loop}, fd_{fd}, options_{options}
+    {
+        rp_deframer_init(&deframer_, frame_.data(), frame_.size());
+
+        int flags = fcntl(fd_, F_GETFL);
+
+        registered_ = flags >= 0 && fcntl(fd_, F_SETFL, flags | O_NONBLOCK) == 0 &&
+                      loop_.add(fd_, this);
+    }
+
+    frame_reader(const frame_reader &) = delete;
+    frame_reader &operator=(const frame_reader &) = delete;
+
+    ~frame_reader()
+    {
+        if (registered_) {
+            loop_.remove(fd_);
+        }
+    }
+
+    bool valid() const noexcept
+    {
+        return registered_;
+    }
+
+    /**
+     * Awaitable for the next frame, decoded as `Msg`. Only one frame may be awaited per
+     * reader at a time.
+     */
+    template <message Msg> auto next() noexcept
+    {
+        return awaiter<Msg>{*this};
+    }
+
+  private:
+    /**
+     * Type erased view of the frame being awaited, see `awaiter`.
+     */
+    struct waiter {
+        std::coroutine_handle<> handle;
+        bool (*complete)(waiter *self) noexcept;
+    };
+
+    template <message Msg> struct awaiter : waiter {
+        frame_reader &reader;
+        result<Msg, frame_error> value{unexpected<frame_error>{{read_status::closed}}};
+
+        explicit awaiter(frame_reader &owner) noexcept
+            : waiter{{}, &awaiter::try_complete}, reader{owner}
+        {
+        }
+
+        static bool try_complete(waiter *self) noexcept
+        {
+            auto *pending = static_cast<awaiter *>(self);
+
+            return pending->reader.template poll<Msg>(pending->value);
+        }
+
+        bool await_ready() noexcept
+        {
+            return try_complete(this);
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) noexcept
+        {
+            this->handle = handle;
+            reader.waiting_ = this;
+        }
+
+        result<Msg, frame_error> await_resume() noexcept
+        {
+            return std::move(value);
+        }
+    };
+
+    /**
+     * Produces the next frame from buffered and readable bytes.
+     *
+     * @return bool False when more bytes are needed and the descriptor would block
+     */
+    template <message Msg> bool poll(result<Msg, frame_error> &value) noexcept
+    {
+        for (;;) {
+            if (read_offset_ < read_size_) {
+                rp_deframer_result_t fed = rp_deframer_feed(
+                    &deframer_, &read_buffer_[read_offset_], read_size_ - read_offset_);
+
+                read_offset_ += fed.consumed;
+
+                if (fed.status == RP_DEFRAMER_FRAME_READY) {
+                    value = decode<Msg>();
+                    return true;
+                }
+
+                if (fed.status == RP_DEFRAMER_OVERFLOW) {
+                    value = unexpected<frame_error>{{read_status::overflow}};
+                    return true;
+                }
+
+                continue;
+            }
+
+            ssize_t count = read(fd_, read_buffer_.data(), read_buffer_.size());
+
+            if (count > 0) {
+                read_offset_ = 0;
+                read_size_ = static_cast<std::size_t>(count);
+                continue;
+            }
+
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+
+            if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                return false;
+            }
+
+            // A pty master reads EIO once the slave side is closed
+            if (count == 0 || errno == EIO) {
+                value = unexpected<frame_error>{{read_status::closed}};
+            } else {
+                value = unexpected<frame_error>{{read_status::io_error, RP_CODEC_OK, errno}};
+            }
+
+            return true;
+        }
+    }
+
+    template <message Msg> result<Msg, frame_error> decode() noexcept
+    {
+        Msg message{};
+
+        rp_packet_decode_result_t decoded = rp_packet_decode_with_options(
+            deframer_.buffer, deframer_.size, message_traits<Msg>::fields, &message, &options_);
+
+        if (decoded.status != RP_CODEC_OK) {
+            return unexpected<frame_error>{{read_status::undecodable, decoded.status}};
+        }
+
+        return message;
+    }
+
+    void on_event(std::uint32_t) noexcept override
+    {
+        if (waiting_ == nullptr || !waiting_->complete(waiting_)) {
+            return;
+        }
+
+        std::coroutine_handle<> handle = waiting_->handle;
+
+        waiting_ = nullptr;
+        handle.resume();
+    }
+
+    event_loop &loop_;
+    int fd_;
+    rp_codec_options_t options_;
+    bool registered_ = false;
+    waiter *waiting_ = nullptr;
+
+    rp_deframer_t deframer_;
+    std::array<std::uint8_t, FrameCapacity> frame_;
+    std::array<std::uint8_t, ReadSize> read_buffer_;
+    std::size_t read_offset_ = 0;
+    std::size_t read_size_ = 0;
+};
+
+} // namespace rp
+
+#endif // RP_ASYNC_HPP
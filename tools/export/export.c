@@ -0,0 +1,805 @@
+#include "export.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Floats are printed with the fewest significant digits that read back as the same
+ * float, found with the Ryu algorithm (Ulf Adams, "Ryu: fast float-to-string conversion",
+ * PLDI 2018): the value and the halfway points to its neighbours are scaled by a power of
+ * ten with one 32x64-bit multiplication each, using the tables below, then digits are
+ * removed while the bounds still differ. There is no division by powers of ten on big
+ * numbers and no retry loop, unlike `printf("%.9g")` followed by a round trip check.
+ */
+
+#define FLOAT_MANTISSA_BITS (23)
+#define FLOAT_EXPONENT_BITS (8)
+#define FLOAT_BIAS (127)
+
+#define POW5_INV_BITCOUNT (59)
+#define POW5_BITCOUNT (61)
+
+// floor(2^(ceil(log2(5^q)) - 1 + POW5_INV_BITCOUNT) / 5^q) + 1
+static const uint64_t pow5_inv_split[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u, 295147905179352826u,
+    472236648286964522u, 377789318629571618u, 302231454903657294u, 483570327845851670u,
+    386856262276681336u, 309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u, 324518553658426727u,
+    519229685853482763u, 415383748682786211u, 332306998946228969u, 531691198313966350u,
+    425352958651173080u, 340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u, 356811923176489971u,
+    570899077082383953u, 456719261665907162u, 365375409332725730u,
+};
+
+// The top POW5_BITCOUNT bits of 5^i
+static const uint64_t pow5_split[48] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u, 2251799813685248000u,
+    1407374883553280000u, 1759218604441600000u, 2199023255552000000u, 1374389534720000000u,
+    1717986918400000000u, 2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u, 2048000000000000000u,
+    1280000000000000000u, 1600000000000000000u, 2000000000000000000u, 1250000000000000000u,
+    1562500000000000000u, 1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u, 1862645149230957031u,
+    1164153218269348144u, 1455191522836685180u, 1818989403545856475u, 2273736754432320594u,
+    1421085471520200371u, 1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u, 1694065894508600678u,
+    2117582368135750847u, 1323488980084844279u, 1654361225106055349u, 2067951531382569187u,
+    1292469707114105741u, 1615587133892632177u, 2019483917365790221u, 1262177448353618888u,
+};
+
+static const char digit_pairs[200] = {
+    '0', '0', '0', '1', '0', '2', '0', '3', '0', '4', '0', '5', '0', '6', '0', '7', '0', '8',
+    '0', '9', '1', '0', '1', '1', '1', '2', '1', '3', '1', '4', '1', '5', '1', '6', '1', '7',
+    '1', '8', '1', '9', '2', '0', '2', '1', '2', '2', '2', '3', '2', '4', '2', '5', '2', '6',
+    '2', '7', '2', '8', '2', '9', '3', '0', '3', '1', '3', '2', '3', '3', '3', '4', '3', '5',
+    '3', '6', '3', '7', '3', '8', '3', '9', '4', '0', '4', '1', '4', '2', '4', '3', '4', '4',
+    '4', '5', '4', '6', '4', '7', '4', '8', '4', '9', '5', '0', '5', '1', '5', '2', '5', '3',
+    '5', '4', '5', '5', '5', '6', '5', '7', '5', '8', '5', '9', '6', '0', '6', '1', '6', '2',
+    '6', '3', '6', '4', '6', '5', '6', '6', '6', '7', '6', '8', '6', '9', '7', '0', '7', '1',
+    '7', '2', '7', '3', '7', '4', '7', '5', '7', '6', '7', '7', '7', '8', '7', '9', '8', '0',
+    '8', '1', '8', '2', '8', '3', '8', '4', '8', '5', '8', '6', '8', '7', '8', '8', '8', '9',
+    '9', '0', '9', '1', '9', '2', '9', '3', '9', '4', '9', '5', '9', '6', '9', '7', '9', '8',
+    '9', '9',
+};
+
+#define TELEMETRY(name, field, type, presence)                                                \
+    {name, sizeof(name) - 1, tvr_Downlink_telemetry_tag, type,                                \
+     offsetof(tvr_TelemetryState, field), presence}
+#define TELEMETRY_OPTIONAL(name, message, field)                                              \
+    TELEMETRY(name, message.field, RP_EXPORT_COLUMN_FLOAT,                                    \
+              offsetof(tvr_TelemetryState, has_##message))
+#define STATUS(name, type)                                                                    \
+    {#name, sizeof(#name) - 1, tvr_Downlink_status_tag, type,                                 \
+     offsetof(tvr_SystemStatus, name), -1}
+
+const rp_export_column_t rp_export_columns[] = {
+    TELEMETRY("timestamp_ms", timestamp_ms, RP_EXPORT_COLUMN_U32, -1),
+    TELEMETRY_OPTIONAL("position.x", position, x),
+    TELEMETRY_OPTIONAL("position.y", position, y),
+    TELEMETRY_OPTIONAL("position.z", position, z),
+    TELEMETRY_OPTIONAL("velocity.x", velocity, x),
+    TELEMETRY_OPTIONAL("velocity.y", velocity, y),
+    TELEMETRY_OPTIONAL("velocity.z", velocity, z),
+    TELEMETRY_OPTIONAL("attitude.w", attitude, w),
+    TELEMETRY_OPTIONAL("attitude.x", attitude, x),
+    TELEMETRY_OPTIONAL("attitude.y", attitude, y),
+    TELEMETRY_OPTIONAL("attitude.z", attitude, z),
+    TELEMETRY_OPTIONAL("angular_rate.x", angular_rate, x),
+    TELEMETRY_OPTIONAL("angular_rate.y", angular_rate, y),
+    TELEMETRY_OPTIONAL("angular_rate.z", angular_rate, z),
+    TELEMETRY("flight_state", flight_state, RP_EXPORT_COLUMN_ENUM, -1),
+    TELEMETRY("thrust_cmd", thrust_cmd, RP_EXPORT_COLUMN_FLOAT, -1),
+    TELEMETRY("gimbal_x", gimbal_x, RP_EXPORT_COLUMN_FLOAT, -1),
+    TELEMETRY("gimbal_y", gimbal_y, RP_EXPORT_COLUMN_FLOAT, -1),
+    STATUS(timestamp_ms, RP_EXPORT_COLUMN_U32),
+    STATUS(uptime_ms, RP_EXPORT_COLUMN_U32),
+    STATUS(flight_state, RP_EXPORT_COLUMN_ENUM),
+    STATUS(accel_ok, RP_EXPORT_COLUMN_BOOL),
+    STATUS(gyro_ok, RP_EXPORT_COLUMN_BOOL),
+    STATUS(baro1_ok, RP_EXPORT_COLUMN_BOOL),
+    STATUS(baro2_ok, RP_EXPORT_COLUMN_BOOL),
+    STATUS(gps_connected, RP_EXPORT_COLUMN_BOOL),
+    STATUS(radio_tx_count, RP_EXPORT_COLUMN_U32),
+    STATUS(radio_rx_count, RP_EXPORT_COLUMN_U32),
+    STATUS(cmd_rx_count, RP_EXPORT_COLUMN_U32),
+};
+
+const size_t rp_export_column_count = sizeof(rp_export_columns) / sizeof(rp_export_columns[0]);
+
+static rp_export_status_t select_columns(rp_export_t *exporter, const char *columns);
+static char *write_row(const rp_export_t *exporter, char *out, const uint8_t *payload);
+static char *write_value(char *out, const rp_export_column_t *column, const uint8_t *payload,
+                         bool json);
+static size_t write_u32(char *output, uint32_t value);
+static void float_to_decimal(uint32_t bits, uint32_t *digits, int32_t *exponent);
+
+/**
+ * Sets up an exporter. Nothing is written until the first row or `rp_export_header`.
+ *
+ * @param exporter Exporter to initialize
+ * @param format Output format
+ * @param message `Downlink` payload to export, other payloads are skipped
+ * @param columns Comma separated fields to write, in order, or NULL for all of `message`
+ * @param fd Descriptor the output is written to
+ * @param buffer Output buffer, at least `RP_EXPORT_ROW_MAX_SIZE` bytes
+ * @param capacity Size of `buffer`
+ * @return rp_export_status_t Status
+ */
+rp_export_status_t rp_export_init(rp_export_t *exporter, rp_export_format_t format,
+                                  pb_size_t message, const char *columns, int fd, char *buffer,
+                                  size_t capacity)
+{
+    if (exporter == NULL || buffer == NULL) {
+        return RP_EXPORT_NULL_POINTER;
+    }
+
+    if ((format != RP_EXPORT_CSV && format != RP_EXPORT_NDJSON) ||
+        (message != tvr_Downlink_telemetry_tag && message != tvr_Downlink_status_tag) ||
+        capacity < RP_EXPORT_ROW_MAX_SIZE) {
+        return RP_EXPORT_INVALID_ARGUMENT;
+    }
+
+    *exporter = (rp_export_t){
+        .format = format,
+        .message = message,
+        .fd = fd,
+        .buffer = buffer,
+        .capacity = capacity,
+    };
+
+    return select_columns(exporter, columns);
+}
+
+/**
+ * Writes the CSV header row. Does nothing for NDJSON, where every line names its fields.
+ *
+ * @param exporter Exporter
+ * @return rp_export_status_t Status
+ */
+rp_export_status_t rp_export_header(rp_export_t *exporter)
+{
+    if (exporter == NULL) {
+        return RP_EXPORT_NULL_POINTER;
+    }
+
+    if (exporter->format != RP_EXPORT_CSV) {
+        return RP_EXPORT_OK;
+    }
+
+    if (exporter->capacity - exporter->size < RP_EXPORT_ROW_MAX_SIZE) {
+        rp_export_status_t status = rp_export_flush(exporter);
+
+        if (status != RP_EXPORT_OK) {
+            return status;
+        }
+    }
+
+    char *out = &exporter->buffer[exporter->size];
+
+    for (size_t i = 0; i < exporter->column_count; i++) {
+        if (i > 0) {
+            *out++ = ',';
+        }
+
+        memcpy(out, exporter->columns[i]->name, exporter->columns[i]->name_size);
+        out += exporter->columns[i]->name_size;
+    }
+
+    *out++ = '\n';
+    exporter->size = (size_t)(out - exporter->buffer);
+
+    return RP_EXPORT_OK;
+}
+
+/**
+ * Appends a row for a decoded `Downlink`, or counts it as skipped if it carries another
+ * payload.
+ *
+ * @param exporter Exporter
+ * @param downlink Decoded message
+ * @return rp_export_status_t Status, `RP_EXPORT_WRITE_FAILED` if the buffer had to be
+ * written out and that failed
+ */
+rp_export_status_t rp_export_downlink(rp_export_t *exporter, const tvr_Downlink *downlink)
+{
+    if (exporter == NULL || downlink == NULL) {
+        return RP_EXPORT_NULL_POINTER;
+    }
+
+    if (downlink->which_payload != exporter->message) {
+        exporter->skipped++;
+        return RP_EXPORT_OK;
+    }
+
+    if (exporter->capacity - exporter->size < RP_EXPORT_ROW_MAX_SIZE) {
+        rp_export_status_t status = rp_export_flush(exporter);
+
+        if (status != RP_EXPORT_OK) {
+            return status;
+        }
+    }
+
+    char *end = write_row(exporter, &exporter->buffer[exporter->size],
+                          (const uint8_t *)&downlink->payload);
+
+    exporter->size = (size_t)(end - exporter->buffer);
+    exporter->rows++;
+
+    return RP_EXPORT_OK;
+}
+
+/**
+ * Writes out everything buffered.
+ *
+ * @param exporter Exporter
+ * @return rp_export_status_t Status, the unwritten bytes stay buffered on failure
+ */
+rp_export_status_t rp_export_flush(rp_export_t *exporter)
+{
+    if (exporter == NULL) {
+        return RP_EXPORT_NULL_POINTER;
+    }
+
+    size_t written = 0;
+
+    while (written < exporter->size) {
+        ssize_t count = write(exporter->fd, &exporter->buffer[written], exporter->size - written);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            memmove(exporter->buffer, &exporter->buffer[written], exporter->size - written);
+            exporter->size -= written;
+            return RP_EXPORT_WRITE_FAILED;
+        }
+
+        written += (size_t)count;
+    }
+
+    exporter->size = 0;
+
+    return RP_EXPORT_OK;
+}
+
+/**
+ * Formats a float with the fewest significant digits that parse back to the same value,
+ * e.g. 0.1f as "0.1" rather than "0.100000001". Values with a decimal exponent from -5 to
+ * 8 are written in positional notation, others as "1.5e-7". Not NUL terminated.
+ *
+ * @param output Receives the text, at least `RP_EXPORT_FLOAT_MAX_SIZE` bytes
+ * @param value Value to format, infinities and NaN are written "inf", "-inf" and "nan"
+ * @return size_t Characters written
+ */
+size_t rp_export_format_float(char *output, float value)
+{
+    uint32_t bits;
+    char *out = output;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 31) != 0;
+    uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+    uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+
+    if (ieee_exponent == (1u << FLOAT_EXPONENT_BITS) - 1) {
+        if (ieee_mantissa != 0) {
+            memcpy(out, "nan", 3);
+            return 3;
+        }
+
+        memcpy(out, negative ? "-inf" : "inf", 4 - !negative);
+        return 4 - !negative;
+    }
+
+    if (negative) {
+        *out++ = '-';
+    }
+
+    if (ieee_exponent == 0 && ieee_mantissa == 0) {
+        *out++ = '0';
+        return (size_t)(out - output);
+    }
+
+    uint32_t digits_value;
+    int32_t exponent;
+    char digits[10];
+
+    float_to_decimal(bits, &digits_value, &exponent);
+
+    int32_t length = (int32_t)write_u32(digits, digits_value);
+    int32_t scientific_exponent = length + exponent - 1;
+
+    if (scientific_exponent < -5 || scientific_exponent > 8) {
+        *out++ = digits[0];
+
+        if (length > 1) {
+            *out++ = '.';
+            memcpy(out, &digits[1], (size_t)length - 1);
+            out += length - 1;
+        }
+
+        *out++ = 'e';
+
+        if (scientific_exponent < 0) {
+            *out++ = '-';
+            scientific_exponent = -scientific_exponent;
+        }
+
+        out += write_u32(out, (uint32_t)scientific_exponent);
+    } else if (scientific_exponent < 0) {
+        *out++ = '0';
+        *out++ = '.';
+
+        for (int32_t i = scientific_exponent + 1; i < 0; i++) {
+            *out++ = '0';
+        }
+
+        memcpy(out, digits, (size_t)length);
+        out += length;
+    } else if (scientific_exponent + 1 >= length) {
+        memcpy(out, digits, (size_t)length);
+        out += length;
+
+        for (int32_t i = length; i <= scientific_exponent; i++) {
+            *out++ = '0';
+        }
+    } else {
+        memcpy(out, digits, (size_t)scientific_exponent + 1);
+        out += scientific_exponent + 1;
+        *out++ = '.';
+        memcpy(out, &digits[scientific_exponent + 1], (size_t)(length - scientific_exponent - 1));
+        out += length - scientific_exponent - 1;
+    }
+
+    return (size_t)(out - output);
+}
+
+/**
+ * Looks up a field of a message by name.
+ *
+ * @param message `Downlink` payload tag
+ * @param name Field path, need not be NUL terminated
+ * @param length Characters in `name`
+ * @return const rp_export_column_t* The column, or NULL if `message` has no such field
+ */
+const rp_export_column_t *rp_export_find_column(pb_size_t message, const char *name,
+                                                size_t length)
+{
+    for (size_t i = 0; i < rp_export_column_count; i++) {
+        const rp_export_column_t *column = &rp_export_columns[i];
+
+        if (column->message == message && column->name_size == length &&
+            memcmp(column->name, name, length) == 0) {
+            return column;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Reads a field of a decoded message as a number, booleans as 0 or 1.
+ *
+ * @param column Field to read
+ * @param downlink Decoded message, carrying the payload `column` belongs to
+ * @param value Receives the value
+ * @return bool False if the field is absent or belongs to another payload
+ */
+bool rp_export_column_value(const rp_export_column_t *column, const tvr_Downlink *downlink,
+                            double *value)
+{
+    const uint8_t *payload = (const uint8_t *)&downlink->payload;
+
+    if (downlink->which_payload != column->message ||
+        (column->presence >= 0 && !*(const bool *)&payload[column->presence])) {
+        return false;
+    }
+
+    const uint8_t *field = &payload[column->offset];
+
+    switch (column->type) {
+    case RP_EXPORT_COLUMN_U32: {
+        uint32_t number;
+
+        memcpy(&number, field, sizeof(number));
+        *value = number;
+        break;
+    }
+    case RP_EXPORT_COLUMN_ENUM: {
+        tvr_FlightState state;
+
+        memcpy(&state, field, sizeof(state));
+        *value = (double)state;
+        break;
+    }
+    case RP_EXPORT_COLUMN_BOOL:
+        *value = *(const bool *)field ? 1.0 : 0.0;
+        break;
+    default: {
+        float number;
+
+        memcpy(&number, field, sizeof(number));
+        *value = number;
+        break;
+    }
+    }
+
+    return true;
+}
+
+/**
+ * Parses the column selection, or selects every field of the exported message.
+ *
+ * @param exporter Exporter, `message` set
+ * @param columns Comma separated field names, or NULL
+ * @return rp_export_status_t Status
+ */
+static rp_export_status_t select_columns(rp_export_t *exporter, const char *columns)
+{
+    if (columns == NULL || columns[0] == '\0') {
+        for (size_t i = 0; i < rp_export_column_count; i++) {
+            if (rp_export_columns[i].message == exporter->message) {
+                exporter->columns[exporter->column_count++] = &rp_export_columns[i];
+            }
+        }
+
+        return RP_EXPORT_OK;
+    }
+
+    const char *name = columns;
+
+    for (;;) {
+        const char *end = strchr(name, ',');
+        size_t length = (end != NULL) ? (size_t)(end - name) : strlen(name);
+        const rp_export_column_t *column =
+            rp_export_find_column(exporter->message, name, length);
+
+        if (column == NULL) {
+            return RP_EXPORT_UNKNOWN_COLUMN;
+        }
+
+        if (exporter->column_count == RP_EXPORT_MAX_COLUMNS) {
+            return RP_EXPORT_INVALID_ARGUMENT;
+        }
+
+        exporter->columns[exporter->column_count++] = column;
+
+        if (end == NULL) {
+            return RP_EXPORT_OK;
+        }
+
+        name = end + 1;
+    }
+}
+
+/**
+ * Formats one message as a CSV row or NDJSON line, newline included.
+ *
+ * @param exporter Exporter
+ * @param out Where to write, with `RP_EXPORT_ROW_MAX_SIZE` bytes of room
+ * @param payload The payload struct of the message
+ * @return char* End of the row
+ */
+static char *write_row(const rp_export_t *exporter, char *out, const uint8_t *payload)
+{
+    bool json = exporter->format == RP_EXPORT_NDJSON;
+
+    if (json) {
+        *out++ = '{';
+    }
+
+    for (size_t i = 0; i < exporter->column_count; i++) {
+        const rp_export_column_t *column = exporter->columns[i];
+
+        if (i > 0) {
+            *out++ = ',';
+        }
+
+        if (json) {
+            *out++ = '"';
+            memcpy(out, column->name, column->name_size);
+            out += column->name_size;
+            *out++ = '"';
+            *out++ = ':';
+        }
+
+        out = write_value(out, column, payload, json);
+    }
+
+    if (json) {
+        *out++ = '}';
+    }
+
+    *out++ = '\n';
+
+    return out;
+}
+
+/**
+ * Formats one field. Absent fields are empty in CSV and null in JSON, as are non-finite
+ * floats in JSON, which has no literal for them.
+ */
+static char *write_value(char *out, const rp_export_column_t *column, const uint8_t *payload,
+                         bool json)
+{
+    static const char null_text[] = "null";
+
+    if (column->presence >= 0 && !*(const bool *)&payload[column->presence]) {
+        if (json) {
+            memcpy(out, null_text, sizeof(null_text) - 1);
+            out += sizeof(null_text) - 1;
+        }
+
+        return out;
+    }
+
+    const uint8_t *value = &payload[column->offset];
+
+    switch (column->type) {
+    case RP_EXPORT_COLUMN_U32: {
+        uint32_t number;
+
+        memcpy(&number, value, sizeof(number));
+        return out + write_u32(out, number);
+    }
+    case RP_EXPORT_COLUMN_ENUM: {
+        tvr_FlightState state;
+
+        memcpy(&state, value, sizeof(state));
+        return out + write_u32(out, (uint32_t)state);
+    }
+    case RP_EXPORT_COLUMN_BOOL:
+        if (*(const bool *)value) {
+            memcpy(out, "true", 4);
+            return out + 4;
+        }
+
+        memcpy(out, "false", 5);
+        return out + 5;
+    default: {
+        float number;
+
+        memcpy(&number, value, sizeof(number));
+
+        if (json && !isfinite(number)) {
+            memcpy(out, null_text, sizeof(null_text) - 1);
+            return out + sizeof(null_text) - 1;
+        }
+
+        return out + rp_export_format_float(out, number);
+    }
+    }
+}
+
+/**
+ * Writes a number in decimal, two digits at a time.
+ *
+ * @return size_t Characters written, at most 10
+ */
+static size_t write_u32(char *output, uint32_t value)
+{
+    char reversed[10];
+    size_t length = 0;
+
+    while (value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+
+        value /= 100;
+        reversed[length++] = digit_pairs[pair + 1];
+        reversed[length++] = digit_pairs[pair];
+    }
+
+    if (value >= 10) {
+        reversed[length++] = digit_pairs[value * 2 + 1];
+        reversed[length++] = digit_pairs[value * 2];
+    } else {
+        reversed[length++] = (char)('0' + value);
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        output[i] = reversed[length - 1 - i];
+    }
+
+    return length;
+}
+
+// ceil(log2(5^e)), or 1 for e = 0
+static inline int32_t pow5_bits(int32_t e)
+{
+    return (int32_t)(((uint32_t)e * 1217359u) >> 19) + 1;
+}
+
+// floor(log10(2^e))
+static inline uint32_t log10_pow2(int32_t e)
+{
+    return ((uint32_t)e * 78913u) >> 18;
+}
+
+// floor(log10(5^e))
+static inline uint32_t log10_pow5(int32_t e)
+{
+    return ((uint32_t)e * 732923u) >> 20;
+}
+
+static inline uint32_t pow5_factor(uint32_t value)
+{
+    uint32_t count = 0;
+
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+
+    return count;
+}
+
+static inline bool multiple_of_pow5(uint32_t value, uint32_t p)
+{
+    return pow5_factor(value) >= p;
+}
+
+static inline bool multiple_of_pow2(uint32_t value, uint32_t p)
+{
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+static inline uint32_t mul_shift(uint32_t m, uint64_t factor, int32_t shift)
+{
+    uint64_t low = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (factor >> 32);
+
+    return (uint32_t)(((low >> 32) + high) >> (shift - 32));
+}
+
+/**
+ * Shortest decimal `digits * 10^exponent` that rounds to the float with the given bits,
+ * the closest to it when several are as short.
+ *
+ * @param bits A finite, non-zero float
+ * @param digits Receives the significant digits, at most 9
+ * @param exponent Receives the power of ten
+ */
+static void float_to_decimal(uint32_t bits, uint32_t *digits, int32_t *exponent)
+{
+    uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & ((1u << FLOAT_EXPONENT_BITS) - 1);
+    uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    int32_t e2;
+    uint32_t m2;
+
+    if (ieee_exponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int32_t)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+    }
+
+    // Round half to even when parsing: the bounds themselves belong to an even mantissa
+    bool accept_bounds = (m2 & 1) == 0;
+
+    // The value and the halfway points to its neighbours, times 4
+    uint32_t mv = 4 * m2;
+    uint32_t mm_shift = (ieee_mantissa != 0 || ieee_exponent <= 1) ? 1 : 0;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr;
+    uint32_t vp;
+    uint32_t vm;
+    int32_t e10;
+    bool vm_trailing_zeros = false;
+    bool vr_trailing_zeros = false;
+    uint8_t last_removed_digit = 0;
+
+    if (e2 >= 0) {
+        uint32_t q = log10_pow2(e2);
+        int32_t k = POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+
+        e10 = (int32_t)q;
+        vr = mul_shift(mv, pow5_inv_split[q], i);
+        vp = mul_shift(mp, pow5_inv_split[q], i);
+        vm = mul_shift(mm, pow5_inv_split[q], i);
+
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            int32_t l = POW5_INV_BITCOUNT + pow5_bits((int32_t)q - 1) - 1;
+
+            last_removed_digit =
+                (uint8_t)(mul_shift(mv, pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10);
+        }
+
+        if (q <= 9) {
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = multiple_of_pow5(mm, q);
+            } else {
+                vp -= multiple_of_pow5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = log10_pow5(-e2);
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = pow5_bits(i) - POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+
+        e10 = (int32_t)q + e2;
+        vr = mul_shift(mv, pow5_split[i], j);
+        vp = mul_shift(mp, pow5_split[i], j);
+        vm = mul_shift(mm, pow5_split[i], j);
+
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (pow5_bits(i + 1) - POW5_BITCOUNT);
+            last_removed_digit = (uint8_t)(mul_shift(mv, pow5_split[i + 1], j) % 10);
+        }
+
+        if (q <= 1) {
+            // mv has at least q trailing zero bits, mm one less
+            vr_trailing_zeros = true;
+
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                vp--;
+            }
+        } else if (q < 31) {
+            vr_trailing_zeros = multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    // Remove digits while the bounds still differ
+    int32_t removed = 0;
+    uint32_t output;
+
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = (uint8_t)(vr % 10);
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+
+        // Exactly halfway, round to even
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            last_removed_digit = 4;
+        }
+
+        output = vr + (((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                        last_removed_digit >= 5)
+                           ? 1
+                           : 0);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed_digit = (uint8_t)(vr % 10);
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+
+        output = vr + ((vr == vm || last_removed_digit >= 5) ? 1 : 0);
+    }
+
+    *digits = output;
+    *exponent = e10 + removed;
+}
@@ -0,0 +1,89 @@
+#ifndef RP_EXPORT_H
+#define RP_EXPORT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tvr/downlink.pb.h"
+
+// Longest text `rp_export_format_float` writes, "-0.0000123456789", and a terminator
+#define RP_EXPORT_FLOAT_MAX_SIZE (17)
+
+#define RP_EXPORT_MAX_COLUMNS (32)
+
+// Longest row the writer appends, the output buffer must hold at least one
+#define RP_EXPORT_ROW_MAX_SIZE (2048)
+
+typedef enum rp_export_status {
+    RP_EXPORT_OK,
+    RP_EXPORT_NULL_POINTER,
+    RP_EXPORT_INVALID_ARGUMENT,
+    RP_EXPORT_UNKNOWN_COLUMN, /**< A selected column is not a field of the message */
+    RP_EXPORT_WRITE_FAILED,   /**< `write` failed, see `errno` */
+} rp_export_status_t;
+
+typedef enum rp_export_format {
+    RP_EXPORT_CSV,    /**< Header row, then one row per message, absent fields empty */
+    RP_EXPORT_NDJSON, /**< One JSON object per line, absent and non-finite fields null */
+} rp_export_format_t;
+
+typedef enum rp_export_column_type {
+    RP_EXPORT_COLUMN_U32,
+    RP_EXPORT_COLUMN_FLOAT,
+    RP_EXPORT_COLUMN_BOOL,
+    RP_EXPORT_COLUMN_ENUM, /**< `tvr_FlightState`, written as its number */
+} rp_export_column_type_t;
+
+/**
+ * A field of an exported message, see `rp_export_columns`.
+ */
+typedef struct rp_export_column {
+    const char *name;  /**< Field path, e.g. "position.x" */
+    size_t name_size;  /**< Without the terminator */
+    pb_size_t message; /**< `Downlink` payload tag the field belongs to */
+    uint8_t type;      /**< `rp_export_column_type_t` */
+    uint16_t offset;   /**< Of the value in the payload struct */
+    int16_t presence;  /**< Of the `has_` flag in the payload struct, -1 if always present */
+} rp_export_column_t;
+
+/**
+ * Writes one `Downlink` payload type as CSV or NDJSON.
+ *
+ * Rows are formatted straight into `buffer`, which is written to `fd` whenever it cannot
+ * fit another row, so output goes out in a few large writes.
+ */
+typedef struct rp_export {
+    rp_export_format_t format;
+    pb_size_t message; /**< `tvr_Downlink_telemetry_tag` or `tvr_Downlink_status_tag` */
+    const rp_export_column_t *columns[RP_EXPORT_MAX_COLUMNS];
+    size_t column_count;
+
+    int fd;
+    char *buffer;
+    size_t capacity;
+    size_t size; /**< Bytes in `buffer` not yet written */
+
+    uint64_t rows;    /**< Messages written */
+    uint64_t skipped; /**< Messages of another payload type */
+} rp_export_t;
+
+extern const rp_export_column_t rp_export_columns[];
+extern const size_t rp_export_column_count;
+
+rp_export_status_t rp_export_init(rp_export_t *exporter, rp_export_format_t format,
+                                  pb_size_t message, const char *columns, int fd, char *buffer,
+                                  size_t capacity);
+
+rp_export_status_t rp_export_header(rp_export_t *exporter);
+rp_export_status_t rp_export_downlink(rp_export_t *exporter, const tvr_Downlink *downlink);
+rp_export_status_t rp_export_flush(rp_export_t *exporter);
+
+size_t rp_export_format_float(char *output, float value);
+
+const rp_export_column_t *rp_export_find_column(pb_size_t message, const char *name,
+                                                size_t length);
+bool rp_export_column_value(const rp_export_column_t *column, const tvr_Downlink *downlink,
+                            double *value);
+
+#endif // RP_EXPORT_H
@@ -0,0 +1,290 @@
+/**
+ * Capture exporter.
+ *
+ * Decodes a raw downlink capture (the bytes read from the ground radio, as recorded by
+ * the gateway or a serial logger) and writes one `Downlink` payload type as CSV or
+ * NDJSON, for analysis in spreadsheets, pandas and the like:
+ *
+ *     rp-export [-f csv|ndjson] [-m telemetry|status] [-c col,col,...] [-j workers]
+ *               [-o output] [capture.bin]
+ *
+ * The capture is read from stdin without a path and the output goes to stdout without
+ * `-o`. `-c` selects and orders the columns, e.g. `-c timestamp_ms,position.z,thrust_cmd`;
+ * `-l` lists the columns of the message. With `-j`, frames are decoded by that many
+ * threads of a `rp_pipeline_t` while this thread formats, for captures large enough that
+ * decoding dominates. Counters are printed to stderr on exit.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "export.h"
+#include "pipeline.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "tvr/downlink.pb.h"
+
+#define READ_SIZE (1 << 20)
+#define OUTPUT_SIZE (1 << 20)
+
+_Static_assert(sizeof(tvr_Downlink) <= RP_PIPELINE_MESSAGE_CAPACITY,
+               "tvr_Downlink does not fit in a pipeline slot");
+
+typedef struct export_stats {
+    uint64_t frames;
+    uint64_t decode_errors;
+    uint64_t overflows;
+    rp_export_status_t status; /**< First error writing the output */
+} export_stats_t;
+
+// Too large for the stack
+static uint8_t input[READ_SIZE];
+static char output[OUTPUT_SIZE];
+static rp_export_t exporter;
+static rp_pipeline_t pipeline;
+static export_stats_t stats;
+
+static void export_decoded(rp_codec_status_t status, const tvr_Downlink *downlink)
+{
+    stats.frames++;
+
+    if (status != RP_CODEC_OK) {
+        stats.decode_errors++;
+        return;
+    }
+
+    if (stats.status == RP_EXPORT_OK) {
+        stats.status = rp_export_downlink(&exporter, downlink);
+    }
+}
+
+static void export_result(void *context, const rp_pipeline_result_t *result)
+{
+    (void)context;
+    export_decoded(result->status, result->message);
+}
+
+/**
+ * Splits, decodes and exports the capture on this thread.
+ */
+static bool export_inline(int fd)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    ssize_t count;
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    while ((count = read(fd, input, sizeof(input))) != 0) {
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0) {
+            perror("read");
+            return false;
+        }
+
+        size_t offset = 0;
+
+        while (offset < (size_t)count) {
+            rp_deframer_result_t rx = rp_deframer_feed(&deframer, &input[offset],
+                                                       (size_t)count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status == RP_DEFRAMER_OVERFLOW) {
+                stats.overflows++;
+                continue;
+            }
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+            export_decoded(decoded.status, &downlink);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Feeds the capture to a decode pipeline, which calls back in capture order.
+ */
+static bool export_pipeline(int fd, size_t worker_count)
+{
+    const rp_pipeline_config_t config = {
+        .worker_count = worker_count,
+        .fields = tvr_Downlink_fields,
+        .message_size = sizeof(tvr_Downlink),
+        .callback = export_result,
+    };
+    bool ok = true;
+    ssize_t count;
+
+    if (rp_pipeline_start(&pipeline, &config) != RP_PIPELINE_OK) {
+        fprintf(stderr, "could not start %zu decode workers\n", worker_count);
+        return false;
+    }
+
+    while ((count = read(fd, input, sizeof(input))) != 0) {
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0) {
+            perror("read");
+            ok = false;
+            break;
+        }
+
+        rp_pipeline_feed(&pipeline, input, (size_t)count, 0);
+    }
+
+    rp_pipeline_flush(&pipeline);
+    stats.overflows = pipeline.overflows;
+    rp_pipeline_stop(&pipeline);
+
+    return ok;
+}
+
+static void list_columns(pb_size_t message)
+{
+    for (size_t i = 0; i < rp_export_column_count; i++) {
+        if (rp_export_columns[i].message == message) {
+            printf("%s\n", rp_export_columns[i].name);
+        }
+    }
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-f csv|ndjson] [-m telemetry|status] [-c col,col,...] [-l] "
+            "[-j workers] [-o output] [capture.bin]\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    rp_export_format_t format = RP_EXPORT_CSV;
+    pb_size_t message = tvr_Downlink_telemetry_tag;
+    const char *columns = NULL;
+    const char *output_path = NULL;
+    size_t worker_count = 0;
+    bool list = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "f:m:c:lj:o:")) != -1) {
+        switch (option) {
+        case 'f':
+            if (strcmp(optarg, "csv") == 0) {
+                format = RP_EXPORT_CSV;
+            } else if (strcmp(optarg, "ndjson") == 0) {
+                format = RP_EXPORT_NDJSON;
+            } else {
+                fprintf(stderr, "unknown format %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'm':
+            if (strcmp(optarg, "telemetry") == 0) {
+                message = tvr_Downlink_telemetry_tag;
+            } else if (strcmp(optarg, "status") == 0) {
+                message = tvr_Downlink_status_tag;
+            } else {
+                fprintf(stderr, "unknown message %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'c':
+            columns = optarg;
+            break;
+        case 'l':
+            list = true;
+            break;
+        case 'j':
+            worker_count = strtoul(optarg, NULL, 10);
+            break;
+        case 'o':
+            output_path = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (list) {
+        list_columns(message);
+        return 0;
+    }
+
+    if (argc - optind > 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int input_fd = STDIN_FILENO;
+    int output_fd = STDOUT_FILENO;
+
+    if (optind < argc && (input_fd = open(argv[optind], O_RDONLY)) < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    if (output_path != NULL &&
+        (output_fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+        perror(output_path);
+        return 1;
+    }
+
+    rp_export_status_t status =
+        rp_export_init(&exporter, format, message, columns, output_fd, output, sizeof(output));
+
+    if (status == RP_EXPORT_UNKNOWN_COLUMN) {
+        fprintf(stderr, "unknown column in %s, see -l\n", columns);
+        return 1;
+    }
+
+    if (status != RP_EXPORT_OK) {
+        fprintf(stderr, "invalid export options\n");
+        return 1;
+    }
+
+    stats.status = rp_export_header(&exporter);
+
+    bool ok = (worker_count > 0) ? export_pipeline(input_fd, worker_count)
+                                 : export_inline(input_fd);
+
+    if (stats.status == RP_EXPORT_OK) {
+        stats.status = rp_export_flush(&exporter);
+    }
+
+    if (stats.status != RP_EXPORT_OK) {
+        perror("write");
+        ok = false;
+    }
+
+    fprintf(stderr, "frames %llu rows %llu skipped %llu decode_errors %llu overflows %llu\n",
+            (unsigned long long)stats.frames, (unsigned long long)exporter.rows,
+            (unsigned long long)exporter.skipped, (unsigned long long)stats.decode_errors,
+            (unsigned long long)stats.overflows);
+
+    if (output_fd != STDOUT_FILENO) {
+        close(output_fd);
+    }
+
+    return ok ? 0 : 1;
+}
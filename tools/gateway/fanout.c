@@ -0,0 +1,505 @@
+#include "fanout.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef enum send_result {
+    SEND_OK,
+    SEND_FULL,
+    SEND_FAILED,
+} send_result_t;
+
+static bool set_nonblocking(int fd);
+static bool fill_address(struct sockaddr_un *address, const char *path);
+static send_result_t send_record(int fd, const uint8_t *record, size_t size);
+static void consumer_remove(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer);
+static void consumer_enqueue(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer,
+                             const uint8_t *record, size_t size);
+static void consumer_flush(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer);
+static void consumer_read_control(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer);
+
+/**
+ * Creates the listening socket that consumers connect to. A stale socket left at
+ * `path` by a previous run is replaced.
+ *
+ * @param fanout Fan-out state
+ * @param path Filesystem path of the Unix domain socket
+ * @param default_policy Drop policy of consumers that do not choose one
+ * @return rp_fanout_status_t
+ */
+rp_fanout_status_t rp_fanout_open(rp_fanout_t *fanout, const char *path,
+                                  rp_fanout_policy_t default_policy)
+{
+    if (fanout == NULL || path == NULL) {
+        return RP_FANOUT_NULL_POINTER;
+    }
+
+    struct sockaddr_un address;
+
+    if (default_policy >= RP_FANOUT_POLICY_COUNT || !fill_address(&address, path)) {
+        return RP_FANOUT_INVALID_ARGUMENT;
+    }
+
+    memset(fanout, 0, sizeof(*fanout));
+
+    fanout->listen_fd = -1;
+    fanout->default_policy = default_policy;
+    strcpy(fanout->path, address.sun_path);
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        fanout->consumers[i].fd = -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+    if (fd < 0) {
+        return RP_FANOUT_SOCKET_ERROR;
+    }
+
+    unlink(path);
+
+    if (bind(fd, (const struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(fd, 16) != 0 || !set_nonblocking(fd)) {
+        close(fd);
+        return RP_FANOUT_SOCKET_ERROR;
+    }
+
+    fanout->listen_fd = fd;
+
+    return RP_FANOUT_OK;
+}
+
+/**
+ * Disconnects every consumer and removes the socket.
+ *
+ * @param fanout Fan-out state
+ */
+void rp_fanout_close(rp_fanout_t *fanout)
+{
+    if (fanout == NULL || fanout->listen_fd < 0) {
+        return;
+    }
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        if (fanout->consumers[i].fd >= 0) {
+            consumer_remove(fanout, &fanout->consumers[i]);
+        }
+    }
+
+    close(fanout->listen_fd);
+    unlink(fanout->path);
+
+    fanout->listen_fd = -1;
+}
+
+/**
+ * Accepts every pending connection. Connections beyond `RP_FANOUT_MAX_CONSUMERS` are
+ * closed straight away.
+ *
+ * @param fanout Fan-out state
+ * @return size_t Number of consumers added
+ */
+size_t rp_fanout_accept(rp_fanout_t *fanout)
+{
+    size_t accepted = 0;
+
+    if (fanout == NULL || fanout->listen_fd < 0) {
+        return 0;
+    }
+
+    for (;;) {
+        int fd = accept(fanout->listen_fd, NULL, NULL);
+
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            return accepted;
+        }
+
+        rp_fanout_consumer_t *consumer = NULL;
+
+        for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+            if (fanout->consumers[i].fd < 0) {
+                consumer = &fanout->consumers[i];
+                break;
+            }
+        }
+
+        if (consumer == NULL || !set_nonblocking(fd)) {
+            fanout->rejected++;
+            close(fd);
+            continue;
+        }
+
+        consumer->fd = fd;
+        consumer->policy = fanout->default_policy;
+        consumer->head = 0;
+        consumer->count = 0;
+        consumer->delivered = 0;
+        consumer->dropped = 0;
+
+        fanout->consumer_count++;
+        accepted++;
+
+        // `rp_fanout_connect` sends the policy request right after connecting
+        consumer_read_control(fanout, consumer);
+    }
+}
+
+/**
+ * Sends one record to every consumer.
+ *
+ * The record goes straight to the socket of a consumer that is keeping up. A consumer
+ * whose socket is full gets it queued instead, and once its queue is full too, its
+ * drop policy decides. Publishing never blocks on a slow consumer.
+ *
+ * @param fanout Fan-out state
+ * @param payload Record payload
+ * @param size Payload size, at most `RP_FANOUT_PAYLOAD_CAPACITY`
+ * @param received_ns Receive time carried in the record header
+ * @return rp_fanout_status_t
+ */
+rp_fanout_status_t rp_fanout_publish(rp_fanout_t *fanout, const void *payload, size_t size,
+                                     uint64_t received_ns)
+{
+    if (fanout == NULL || (payload == NULL && size > 0)) {
+        return RP_FANOUT_NULL_POINTER;
+    }
+
+    if (size > RP_FANOUT_PAYLOAD_CAPACITY) {
+        return RP_FANOUT_TOO_LARGE;
+    }
+
+    uint8_t record[RP_FANOUT_RECORD_CAPACITY];
+
+    rp_fanout_record_header_t header = {
+        .sequence = fanout->sequence++,
+        .size = (uint32_t)size,
+        .received_ns = received_ns,
+    };
+
+    memcpy(record, &header, sizeof(header));
+
+    if (size > 0) {
+        memcpy(&record[sizeof(header)], payload, size);
+    }
+
+    size_t record_size = sizeof(header) + size;
+
+    fanout->published++;
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        rp_fanout_consumer_t *consumer = &fanout->consumers[i];
+
+        if (consumer->fd < 0) {
+            continue;
+        }
+
+        // Queued records go first so each consumer sees records in order
+        if (consumer->count > 0) {
+            consumer_flush(fanout, consumer);
+        }
+
+        if (consumer->count > 0) {
+            consumer_enqueue(fanout, consumer, record, record_size);
+            continue;
+        }
+
+        if (consumer->fd < 0) {
+            continue;
+        }
+
+        switch (send_record(consumer->fd, record, record_size)) {
+        case SEND_OK:
+            consumer->delivered++;
+            break;
+        case SEND_FULL:
+            consumer_enqueue(fanout, consumer, record, record_size);
+            break;
+        case SEND_FAILED:
+            consumer_remove(fanout, consumer);
+            break;
+        }
+    }
+
+    return RP_FANOUT_OK;
+}
+
+/**
+ * Fills the poll set for the fan-out. Entry 0 is the listening socket, entry `i + 1`
+ * belongs to consumer slot `i` and has a negative descriptor when the slot is unused,
+ * which `poll` ignores. Consumers with queued records also wait for `POLLOUT`.
+ *
+ * @param fanout Fan-out state
+ * @param fds Output, `RP_FANOUT_POLL_FDS` entries
+ */
+void rp_fanout_poll_fds(const rp_fanout_t *fanout, struct pollfd *fds)
+{
+    fds[0].fd = fanout->listen_fd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        const rp_fanout_consumer_t *consumer = &fanout->consumers[i];
+
+        fds[i + 1].fd = consumer->fd;
+        fds[i + 1].events = (consumer->count > 0) ? (POLLIN | POLLOUT) : POLLIN;
+        fds[i + 1].revents = 0;
+    }
+}
+
+/**
+ * Handles the events `poll` reported for a set filled by `rp_fanout_poll_fds`: accepts
+ * connections, applies policy requests, drains queues and removes consumers that hung up.
+ *
+ * @param fanout Fan-out state
+ * @param fds Poll set after `poll` returned
+ */
+void rp_fanout_handle(rp_fanout_t *fanout, const struct pollfd *fds)
+{
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        rp_fanout_consumer_t *consumer = &fanout->consumers[i];
+        short revents = fds[i + 1].revents;
+
+        // The slot may have been reused since the poll set was filled
+        if (consumer->fd < 0 || consumer->fd != fds[i + 1].fd || revents == 0) {
+            continue;
+        }
+
+        if (revents & (POLLERR | POLLNVAL)) {
+            consumer_remove(fanout, consumer);
+            continue;
+        }
+
+        if (revents & (POLLIN | POLLHUP)) {
+            consumer_read_control(fanout, consumer);
+        }
+
+        if (consumer->fd >= 0 && (revents & POLLOUT)) {
+            consumer_flush(fanout, consumer);
+        }
+    }
+
+    if (fds[0].revents & POLLIN) {
+        rp_fanout_accept(fanout);
+    }
+}
+
+/**
+ * Connects a consumer to a gateway.
+ *
+ * @param path Socket path passed to `rp_fanout_open`
+ * @param policy Drop policy requested for this consumer
+ * @return int Connected socket, or -1 on error
+ */
+int rp_fanout_connect(const char *path, rp_fanout_policy_t policy)
+{
+    struct sockaddr_un address;
+
+    if (path == NULL || policy >= RP_FANOUT_POLICY_COUNT || !fill_address(&address, path)) {
+        return -1;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    uint8_t request = (uint8_t)policy;
+
+    if (connect(fd, (const struct sockaddr *)&address, sizeof(address)) != 0 ||
+        send(fd, &request, sizeof(request), MSG_NOSIGNAL) != (ssize_t)sizeof(request)) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * Receives one record on a consumer socket. Blocks unless the socket is non-blocking.
+ *
+ * @param fd Socket returned by `rp_fanout_connect`
+ * @param header Record header, `header->size` is the payload size
+ * @param payload Output for the payload
+ * @param capacity Size of the payload output
+ * @return rp_fanout_status_t
+ */
+rp_fanout_status_t rp_fanout_receive(int fd, rp_fanout_record_header_t *header, void *payload,
+                                     size_t capacity)
+{
+    if (header == NULL || (payload == NULL && capacity > 0)) {
+        return RP_FANOUT_NULL_POINTER;
+    }
+
+    struct iovec parts[2] = {
+        {.iov_base = header, .iov_len = sizeof(*header)},
+        {.iov_base = payload, .iov_len = capacity},
+    };
+
+    struct msghdr message = {
+        .msg_iov = parts,
+        .msg_iovlen = 2,
+    };
+
+    ssize_t received;
+
+    do {
+        received = recvmsg(fd, &message, 0);
+    } while (received < 0 && errno == EINTR);
+
+    if (received == 0) {
+        return RP_FANOUT_CLOSED;
+    }
+
+    if (received < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? RP_FANOUT_WOULD_BLOCK
+                                                         : RP_FANOUT_SOCKET_ERROR;
+    }
+
+    if ((message.msg_flags & MSG_TRUNC) != 0) {
+        return RP_FANOUT_TOO_LARGE;
+    }
+
+    if ((size_t)received < sizeof(*header) || (size_t)received != sizeof(*header) + header->size) {
+        return RP_FANOUT_INVALID_ARGUMENT;
+    }
+
+    return RP_FANOUT_OK;
+}
+
+static bool set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+static bool fill_address(struct sockaddr_un *address, const char *path)
+{
+    size_t length = strlen(path);
+
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+
+    if (length == 0 || length >= sizeof(address->sun_path)) {
+        return false;
+    }
+
+    memcpy(address->sun_path, path, length + 1);
+
+    return true;
+}
+
+static send_result_t send_record(int fd, const uint8_t *record, size_t size)
+{
+    for (;;) {
+        ssize_t sent = send(fd, record, size, MSG_NOSIGNAL);
+
+        if (sent == (ssize_t)size) {
+            return SEND_OK;
+        }
+
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+
+        // A full socket buffer, the kernel reports ENOBUFS for some Unix socket limits
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS)) {
+            return SEND_FULL;
+        }
+
+        return SEND_FAILED;
+    }
+}
+
+static void consumer_remove(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer)
+{
+    close(consumer->fd);
+
+    consumer->fd = -1;
+    consumer->count = 0;
+
+    fanout->consumer_count--;
+}
+
+static void consumer_enqueue(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer,
+                             const uint8_t *record, size_t size)
+{
+    if (consumer->count == RP_FANOUT_QUEUE_DEPTH) {
+        switch (consumer->policy) {
+        case RP_FANOUT_DROP_OLDEST:
+            consumer->head = (consumer->head + 1) % RP_FANOUT_QUEUE_DEPTH;
+            consumer->count--;
+            consumer->dropped++;
+            break;
+        case RP_FANOUT_DROP_NEWEST:
+            consumer->dropped++;
+            return;
+        default:
+            fanout->disconnects++;
+            consumer_remove(fanout, consumer);
+            return;
+        }
+    }
+
+    uint16_t tail = (consumer->head + consumer->count) % RP_FANOUT_QUEUE_DEPTH;
+
+    memcpy(consumer->records[tail], record, size);
+    consumer->sizes[tail] = (uint16_t)size;
+    consumer->count++;
+}
+
+static void consumer_flush(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer)
+{
+    while (consumer->count > 0) {
+        uint16_t head = consumer->head;
+
+        switch (send_record(consumer->fd, consumer->records[head], consumer->sizes[head])) {
+        case SEND_OK:
+            consumer->head = (head + 1) % RP_FANOUT_QUEUE_DEPTH;
+            consumer->count--;
+            consumer->delivered++;
+            break;
+        case SEND_FULL:
+            return;
+        case SEND_FAILED:
+            consumer_remove(fanout, consumer);
+            return;
+        }
+    }
+}
+
+static void consumer_read_control(rp_fanout_t *fanout, rp_fanout_consumer_t *consumer)
+{
+    for (;;) {
+        uint8_t request;
+        ssize_t received = recv(consumer->fd, &request, sizeof(request), 0);
+
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+
+        if (received <= 0) {
+            consumer_remove(fanout, consumer);
+            return;
+        }
+
+        // The only request a consumer sends is its drop policy
+        if (request < RP_FANOUT_POLICY_COUNT) {
+            consumer->policy = (rp_fanout_policy_t)request;
+        }
+    }
+}
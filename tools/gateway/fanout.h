@@ -0,0 +1,94 @@
+#ifndef RP_GATEWAY_FANOUT_H
+#define RP_GATEWAY_FANOUT_H
+
+#include <poll.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef RP_FANOUT_MAX_CONSUMERS
+#define RP_FANOUT_MAX_CONSUMERS (128)
+#endif
+
+// Records buffered per consumer while its socket is full
+#ifndef RP_FANOUT_QUEUE_DEPTH
+#define RP_FANOUT_QUEUE_DEPTH (32)
+#endif
+
+#define RP_FANOUT_RECORD_CAPACITY (256)
+#define RP_FANOUT_PAYLOAD_CAPACITY (RP_FANOUT_RECORD_CAPACITY - sizeof(rp_fanout_record_header_t))
+
+// Entries needed by `rp_fanout_poll_fds`: the listening socket and every consumer slot
+#define RP_FANOUT_POLL_FDS (RP_FANOUT_MAX_CONSUMERS + 1)
+
+/**
+ * What happens to a consumer whose queue is full when a new record is published.
+ */
+typedef enum rp_fanout_policy {
+    RP_FANOUT_DROP_OLDEST, /**< Discard the oldest queued record, the consumer sees the latest */
+    RP_FANOUT_DROP_NEWEST, /**< Discard the new record, the consumer sees a contiguous prefix */
+    RP_FANOUT_DISCONNECT,  /**< Close the consumer, for tools that must not miss records */
+    RP_FANOUT_POLICY_COUNT,
+} rp_fanout_policy_t;
+
+typedef enum rp_fanout_status {
+    RP_FANOUT_OK,
+    RP_FANOUT_NULL_POINTER,
+    RP_FANOUT_INVALID_ARGUMENT,
+    RP_FANOUT_SOCKET_ERROR,
+    RP_FANOUT_TOO_LARGE,
+    RP_FANOUT_WOULD_BLOCK,
+    RP_FANOUT_CLOSED,
+} rp_fanout_status_t;
+
+/**
+ * Prefix of every record, followed by `size` bytes of payload. Records are only
+ * exchanged between processes on the same host, so the header is in native byte order.
+ */
+typedef struct rp_fanout_record_header {
+    uint32_t sequence;    /**< Published record count, gaps show drops */
+    uint32_t size;        /**< Payload size in bytes */
+    uint64_t received_ns; /**< `CLOCK_MONOTONIC` time the frame was received */
+} rp_fanout_record_header_t;
+
+typedef struct rp_fanout_consumer {
+    int fd; /**< Connected socket, -1 for an unused slot */
+    rp_fanout_policy_t policy;
+    uint8_t records[RP_FANOUT_QUEUE_DEPTH][RP_FANOUT_RECORD_CAPACITY];
+    uint16_t sizes[RP_FANOUT_QUEUE_DEPTH];
+    uint16_t head;      /**< Oldest queued record */
+    uint16_t count;     /**< Number of queued records */
+    uint64_t delivered; /**< Records handed to the socket */
+    uint64_t dropped;   /**< Records discarded by the drop policy */
+} rp_fanout_consumer_t;
+
+typedef struct rp_fanout {
+    int listen_fd;
+    char path[108]; /**< Socket path, removed again by `rp_fanout_close` */
+    rp_fanout_policy_t default_policy;
+    uint32_t sequence;
+    size_t consumer_count;
+    rp_fanout_consumer_t consumers[RP_FANOUT_MAX_CONSUMERS];
+
+    uint64_t published;   /**< Records passed to `rp_fanout_publish` */
+    uint64_t rejected;    /**< Connections refused because every slot was in use */
+    uint64_t disconnects; /**< Consumers closed by `RP_FANOUT_DISCONNECT` */
+} rp_fanout_t;
+
+rp_fanout_status_t rp_fanout_open(rp_fanout_t *fanout, const char *path,
+                                  rp_fanout_policy_t default_policy);
+void rp_fanout_close(rp_fanout_t *fanout);
+
+size_t rp_fanout_accept(rp_fanout_t *fanout);
+
+rp_fanout_status_t rp_fanout_publish(rp_fanout_t *fanout, const void *payload, size_t size,
+                                     uint64_t received_ns);
+
+void rp_fanout_poll_fds(const rp_fanout_t *fanout, struct pollfd *fds);
+void rp_fanout_handle(rp_fanout_t *fanout, const struct pollfd *fds);
+
+int rp_fanout_connect(const char *path, rp_fanout_policy_t policy);
+rp_fanout_status_t rp_fanout_receive(int fd, rp_fanout_record_header_t *header, void *payload,
+                                     size_t capacity);
+
+#endif // RP_GATEWAY_FANOUT_H
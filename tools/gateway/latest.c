@@ -0,0 +1,277 @@
+#include "latest.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static bool slot_valid(size_t slot);
+
+/**
+ * Initializes an empty table in memory the caller provides.
+ *
+ * @param table Table to initialize
+ */
+void rp_latest_init(rp_latest_table_t *table)
+{
+    if (table == NULL) {
+        return;
+    }
+
+    table->magic = RP_LATEST_MAGIC;
+    table->version = RP_LATEST_VERSION;
+    table->slot_count = RP_LATEST_SLOT_COUNT;
+    table->slot_capacity = RP_LATEST_SLOT_CAPACITY;
+
+    for (size_t i = 0; i < RP_LATEST_SLOT_COUNT; i++) {
+        rp_latest_slot_t *entry = &table->slots[i];
+
+        atomic_init(&entry->sequence, 0);
+        atomic_init(&entry->size, 0);
+        atomic_init(&entry->updated_ns, 0);
+
+        for (size_t w = 0; w < RP_LATEST_SLOT_WORDS; w++) {
+            atomic_init(&entry->words[w], 0);
+        }
+    }
+}
+
+/**
+ * Replaces the value in a slot. There must be only one writer per table; readers are
+ * never blocked and the writer never waits for them.
+ *
+ * @param table Table to update
+ * @param slot Slot index, the `Downlink` payload tag
+ * @param value New value
+ * @param size Size of the value, at most `RP_LATEST_SLOT_CAPACITY`
+ * @param updated_ns Time stored with the value
+ * @return rp_latest_status_t
+ */
+rp_latest_status_t rp_latest_write(rp_latest_table_t *table, size_t slot, const void *value,
+                                   size_t size, uint64_t updated_ns)
+{
+    if (table == NULL || (value == NULL && size > 0)) {
+        return RP_LATEST_NULL_POINTER;
+    }
+
+    if (!slot_valid(slot)) {
+        return RP_LATEST_INVALID_ARGUMENT;
+    }
+
+    if (size > RP_LATEST_SLOT_CAPACITY) {
+        return RP_LATEST_TOO_LARGE;
+    }
+
+    uint64_t words[RP_LATEST_SLOT_WORDS] = {0};
+    size_t word_count = (size + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    if (size > 0) {
+        memcpy(words, value, size);
+    }
+
+    rp_latest_slot_t *entry = &table->slots[slot];
+    uint32_t sequence = atomic_load_explicit(&entry->sequence, memory_order_relaxed);
+
+    // Odd sequence: readers that started before this store retry
+    atomic_store_explicit(&entry->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    atomic_store_explicit(&entry->size, (uint32_t)size, memory_order_relaxed);
+    atomic_store_explicit(&entry->updated_ns, updated_ns, memory_order_relaxed);
+
+    for (size_t w = 0; w < word_count; w++) {
+        atomic_store_explicit(&entry->words[w], words[w], memory_order_relaxed);
+    }
+
+    atomic_store_explicit(&entry->sequence, sequence + 2, memory_order_release);
+
+    return RP_LATEST_OK;
+}
+
+/**
+ * Copies a consistent snapshot of a slot without taking a lock. A copy that overlapped
+ * an update is discarded and retried.
+ *
+ * @param table Table to read
+ * @param slot Slot index, the `Downlink` payload tag
+ * @param value Output for the value
+ * @param capacity Size of the output
+ * @param snapshot Optional details of the copy
+ * @return rp_latest_status_t
+ */
+rp_latest_status_t rp_latest_read(const rp_latest_table_t *table, size_t slot, void *value,
+                                  size_t capacity, rp_latest_snapshot_t *snapshot)
+{
+    if (table == NULL || (value == NULL && capacity > 0)) {
+        return RP_LATEST_NULL_POINTER;
+    }
+
+    if (!slot_valid(slot)) {
+        return RP_LATEST_INVALID_ARGUMENT;
+    }
+
+    const rp_latest_slot_t *entry = &table->slots[slot];
+
+    for (uint32_t attempt = 0; attempt < RP_LATEST_READ_ATTEMPTS; attempt++) {
+        uint32_t before = atomic_load_explicit(&entry->sequence, memory_order_acquire);
+
+        if (before == 0) {
+            return RP_LATEST_EMPTY;
+        }
+
+        if (before & 1) {
+            continue;
+        }
+
+        uint32_t size = atomic_load_explicit(&entry->size, memory_order_relaxed);
+        uint64_t updated_ns = atomic_load_explicit(&entry->updated_ns, memory_order_relaxed);
+        uint64_t words[RP_LATEST_SLOT_WORDS];
+
+        // A torn read may see any size, keep the copy inside the slot
+        size_t word_count = (size <= RP_LATEST_SLOT_CAPACITY)
+                                ? (size + sizeof(uint64_t) - 1) / sizeof(uint64_t)
+                                : RP_LATEST_SLOT_WORDS;
+
+        for (size_t w = 0; w < word_count; w++) {
+            words[w] = atomic_load_explicit(&entry->words[w], memory_order_relaxed);
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+
+        if (atomic_load_explicit(&entry->sequence, memory_order_relaxed) != before) {
+            continue;
+        }
+
+        if (size > capacity) {
+            return RP_LATEST_TOO_LARGE;
+        }
+
+        if (size > 0) {
+            memcpy(value, words, size);
+        }
+
+        if (snapshot != NULL) {
+            snapshot->sequence = before;
+            snapshot->size = size;
+            snapshot->updated_ns = updated_ns;
+            snapshot->retries = attempt;
+        }
+
+        return RP_LATEST_OK;
+    }
+
+    return RP_LATEST_BUSY;
+}
+
+/**
+ * Creates a named POSIX shared memory segment holding an empty table and maps it for
+ * writing. A segment left under the same name is unlinked first rather than truncated,
+ * so readers still mapping it keep a valid, if stale, table.
+ *
+ * @param name Segment name, e.g. "/rp-latest"
+ * @param table Output, the mapped table
+ * @return rp_latest_status_t
+ */
+rp_latest_status_t rp_latest_create(const char *name, rp_latest_table_t **table)
+{
+    if (name == NULL || table == NULL) {
+        return RP_LATEST_NULL_POINTER;
+    }
+
+    shm_unlink(name);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+
+    if (fd < 0) {
+        return RP_LATEST_SHM_ERROR;
+    }
+
+    void *mapping = MAP_FAILED;
+
+    if (ftruncate(fd, sizeof(rp_latest_table_t)) == 0) {
+        mapping =
+            mmap(NULL, sizeof(rp_latest_table_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        return RP_LATEST_SHM_ERROR;
+    }
+
+    *table = mapping;
+    rp_latest_init(*table);
+
+    return RP_LATEST_OK;
+}
+
+/**
+ * Maps an existing segment read-only.
+ *
+ * @param name Segment name passed to `rp_latest_create`
+ * @param table Output, the mapped table
+ * @return rp_latest_status_t
+ */
+rp_latest_status_t rp_latest_attach(const char *name, const rp_latest_table_t **table)
+{
+    if (name == NULL || table == NULL) {
+        return RP_LATEST_NULL_POINTER;
+    }
+
+    int fd = shm_open(name, O_RDONLY, 0);
+
+    if (fd < 0) {
+        return RP_LATEST_SHM_ERROR;
+    }
+
+    void *mapping = mmap(NULL, sizeof(rp_latest_table_t), PROT_READ, MAP_SHARED, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        return RP_LATEST_SHM_ERROR;
+    }
+
+    const rp_latest_table_t *mapped = mapping;
+
+    if (mapped->magic != RP_LATEST_MAGIC || mapped->version != RP_LATEST_VERSION ||
+        mapped->slot_count != RP_LATEST_SLOT_COUNT ||
+        mapped->slot_capacity != RP_LATEST_SLOT_CAPACITY) {
+        munmap(mapping, sizeof(rp_latest_table_t));
+        return RP_LATEST_INCOMPATIBLE;
+    }
+
+    *table = mapped;
+
+    return RP_LATEST_OK;
+}
+
+/**
+ * Unmaps a table returned by `rp_latest_create` or `rp_latest_attach`.
+ *
+ * @param table Mapped table
+ */
+void rp_latest_detach(const rp_latest_table_t *table)
+{
+    if (table != NULL) {
+        munmap((void *)table, sizeof(rp_latest_table_t));
+    }
+}
+
+/**
+ * Removes a segment name. Processes that have it mapped keep their mapping.
+ *
+ * @param name Segment name
+ */
+void rp_latest_unlink(const char *name)
+{
+    if (name != NULL) {
+        shm_unlink(name);
+    }
+}
+
+static bool slot_valid(size_t slot)
+{
+    return slot > 0 && slot < RP_LATEST_SLOT_COUNT;
+}
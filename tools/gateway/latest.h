@@ -0,0 +1,72 @@
+#ifndef RP_GATEWAY_LATEST_H
+#define RP_GATEWAY_LATEST_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// One slot per `Downlink` payload tag, slot 0 is unused
+#define RP_LATEST_SLOT_COUNT (8)
+#define RP_LATEST_SLOT_CAPACITY (128)
+#define RP_LATEST_SLOT_WORDS (RP_LATEST_SLOT_CAPACITY / sizeof(uint64_t))
+
+#define RP_LATEST_MAGIC (0x52504C54) // "RPLT"
+#define RP_LATEST_VERSION (1)
+
+// Attempts a reader makes before giving up on a slot that keeps changing under it
+#ifndef RP_LATEST_READ_ATTEMPTS
+#define RP_LATEST_READ_ATTEMPTS (1000)
+#endif
+
+typedef enum rp_latest_status {
+    RP_LATEST_OK,
+    RP_LATEST_NULL_POINTER,
+    RP_LATEST_INVALID_ARGUMENT,
+    RP_LATEST_TOO_LARGE,
+    RP_LATEST_EMPTY, /**< The slot has never been written */
+    RP_LATEST_BUSY,  /**< The writer kept the slot busy for every attempt */
+    RP_LATEST_SHM_ERROR,
+    RP_LATEST_INCOMPATIBLE, /**< The segment was created by a different layout */
+} rp_latest_status_t;
+
+/**
+ * Seqlock protected value. The sequence is odd while the writer is updating the slot
+ * and advances by two per update. The value is stored as atomic words so that readers
+ * racing the writer are well defined; torn copies are detected by the sequence and
+ * retried.
+ */
+typedef struct rp_latest_slot {
+    _Alignas(64) atomic_uint_least32_t sequence;
+    atomic_uint_least32_t size;
+    atomic_uint_least64_t updated_ns;
+    atomic_uint_least64_t words[RP_LATEST_SLOT_WORDS];
+} rp_latest_slot_t;
+
+typedef struct rp_latest_table {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_capacity;
+    rp_latest_slot_t slots[RP_LATEST_SLOT_COUNT];
+} rp_latest_table_t;
+
+typedef struct rp_latest_snapshot {
+    uint32_t sequence;   /**< Slot sequence of the copy, half of it is the update count */
+    uint32_t size;       /**< Bytes copied */
+    uint64_t updated_ns; /**< `CLOCK_MONOTONIC` time of the update */
+    uint32_t retries;    /**< Copies discarded because the writer was active */
+} rp_latest_snapshot_t;
+
+void rp_latest_init(rp_latest_table_t *table);
+
+rp_latest_status_t rp_latest_write(rp_latest_table_t *table, size_t slot, const void *value,
+                                   size_t size, uint64_t updated_ns);
+rp_latest_status_t rp_latest_read(const rp_latest_table_t *table, size_t slot, void *value,
+                                  size_t capacity, rp_latest_snapshot_t *snapshot);
+
+rp_latest_status_t rp_latest_create(const char *name, rp_latest_table_t **table);
+rp_latest_status_t rp_latest_attach(const char *name, const rp_latest_table_t **table);
+void rp_latest_detach(const rp_latest_table_t *table);
+void rp_latest_unlink(const char *name);
+
+#endif // RP_GATEWAY_LATEST_H
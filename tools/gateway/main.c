@@ -0,0 +1,334 @@
+/**
+ * Telemetry gateway.
+ *
+ * Owns the ground radio (a serial device, or a pty standing in for one), decodes each
+ * `Downlink` frame once and publishes the decoded `tvr_Downlink` struct to every local
+ * consumer through a `rp_fanout_t`:
+ *
+ *     rp-gateway [-b baud] [-l shm-name] /dev/ttyUSB0 /tmp/rp-gateway.sock
+ *
+ * Consumers link against the same generated code and read records with
+ * `rp_fanout_connect` and `rp_fanout_receive`. With `-l`, the latest value of each
+ * payload is also kept in a shared memory `rp_latest_table_t` (slot = `Downlink` field
+ * tag) for displays that only need the current state. Counters are printed to stderr
+ * on exit.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fanout.h"
+#include "latest.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "tvr/downlink.pb.h"
+
+_Static_assert(sizeof(tvr_Downlink) <= RP_FANOUT_PAYLOAD_CAPACITY,
+               "tvr_Downlink does not fit in a fan-out record");
+_Static_assert(sizeof(tvr_TelemetryState) <= RP_LATEST_SLOT_CAPACITY &&
+                   sizeof(tvr_SystemStatus) <= RP_LATEST_SLOT_CAPACITY &&
+                   sizeof(tvr_CommandAck) <= RP_LATEST_SLOT_CAPACITY,
+               "Downlink payload does not fit in a latest-value slot");
+
+typedef struct gateway_stats {
+    uint64_t frames;
+    uint64_t decode_errors;
+    uint64_t overflows;
+} gateway_stats_t;
+
+static volatile sig_atomic_t running = 1;
+
+// Over 1 MiB of consumer queues, kept out of the stack
+static rp_fanout_t fanout;
+static rp_latest_table_t *latest;
+
+static void handle_signal(int signal_number)
+{
+    (void)signal_number;
+    running = 0;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static bool baud_to_speed(unsigned long baud, speed_t *speed)
+{
+    static const struct {
+        unsigned long baud;
+        speed_t speed;
+    } speeds[] = {
+        {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+    };
+
+    for (size_t i = 0; i < sizeof(speeds) / sizeof(speeds[0]); i++) {
+        if (speeds[i].baud == baud) {
+            *speed = speeds[i].speed;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static int open_device(const char *path, unsigned long baud)
+{
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    // Pipes and FIFOs used for replay have no line settings
+    if (!isatty(fd)) {
+        return fd;
+    }
+
+    struct termios tty;
+    speed_t speed;
+
+    if (!baud_to_speed(baud, &speed)) {
+        fprintf(stderr, "unsupported baud rate %lu\n", baud);
+        close(fd);
+        return -1;
+    }
+
+    if (tcgetattr(fd, &tty) != 0) {
+        perror("tcgetattr");
+        close(fd);
+        return -1;
+    }
+
+    // Raw 8N1
+    tty.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+    tty.c_oflag &= ~OPOST;
+    tty.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tty.c_cflag &= ~(CSIZE | PARENB | CSTOPB);
+    tty.c_cflag |= CS8 | CREAD | CLOCAL;
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+
+    if (cfsetispeed(&tty, speed) != 0 || cfsetospeed(&tty, speed) != 0 ||
+        tcsetattr(fd, TCSANOW, &tty) != 0) {
+        perror("tcsetattr");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static void update_latest(const tvr_Downlink *downlink, uint64_t received_ns)
+{
+    switch (downlink->which_payload) {
+    case tvr_Downlink_telemetry_tag:
+        rp_latest_write(latest, tvr_Downlink_telemetry_tag, &downlink->payload.telemetry,
+                        sizeof(downlink->payload.telemetry), received_ns);
+        break;
+    case tvr_Downlink_status_tag:
+        rp_latest_write(latest, tvr_Downlink_status_tag, &downlink->payload.status,
+                        sizeof(downlink->payload.status), received_ns);
+        break;
+    default:
+        break;
+    }
+
+    if (downlink->has_ack) {
+        rp_latest_write(latest, tvr_Downlink_ack_tag, &downlink->ack, sizeof(downlink->ack),
+                        received_ns);
+    }
+}
+
+/**
+ * Reads everything available on the device and publishes each decoded frame.
+ *
+ * @return bool False once the device reached end of file or failed
+ */
+static bool service_device(int fd, rp_deframer_t *deframer, gateway_stats_t *stats)
+{
+    uint8_t chunk[512];
+
+    for (;;) {
+        ssize_t count = read(fd, chunk, sizeof(chunk));
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+
+        if (count <= 0) {
+            return false;
+        }
+
+        uint64_t received_ns = now_ns();
+        size_t offset = 0;
+
+        while (offset < (size_t)count) {
+            rp_deframer_result_t rx =
+                rp_deframer_feed(deframer, &chunk[offset], (size_t)count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status == RP_DEFRAMER_OVERFLOW) {
+                stats->overflows++;
+                continue;
+            }
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer->buffer, deframer->size, tvr_Downlink_fields, &downlink);
+
+            if (decoded.status != RP_CODEC_OK) {
+                stats->decode_errors++;
+                continue;
+            }
+
+            stats->frames++;
+            rp_fanout_publish(&fanout, &downlink, sizeof(downlink), received_ns);
+
+            if (latest != NULL) {
+                update_latest(&downlink, received_ns);
+            }
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long baud = 57600;
+    const char *latest_name = NULL;
+    bool usage_error = false;
+    int option;
+
+    while ((option = getopt(argc, argv, "b:l:")) != -1) {
+        switch (option) {
+        case 'b':
+            baud = strtoul(optarg, NULL, 10);
+            break;
+        case 'l':
+            latest_name = optarg;
+            break;
+        default:
+            usage_error = true;
+            break;
+        }
+    }
+
+    if (usage_error || argc - optind != 2) {
+        fprintf(stderr, "usage: %s [-b baud] [-l shm-name] <device> <socket>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const char *device_path = argv[optind];
+    const char *socket_path = argv[optind + 1];
+
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    int device = open_device(device_path, baud);
+
+    if (device < 0) {
+        return EXIT_FAILURE;
+    }
+
+    if (latest_name != NULL && rp_latest_create(latest_name, &latest) != RP_LATEST_OK) {
+        perror(latest_name);
+        close(device);
+        return EXIT_FAILURE;
+    }
+
+    if (rp_fanout_open(&fanout, socket_path, RP_FANOUT_DROP_OLDEST) != RP_FANOUT_OK) {
+        perror(socket_path);
+        close(device);
+
+        if (latest != NULL) {
+            rp_latest_detach(latest);
+            rp_latest_unlink(latest_name);
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    gateway_stats_t stats = {0};
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    static struct pollfd fds[RP_FANOUT_POLL_FDS + 1];
+
+    while (running) {
+        fds[0].fd = device;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+
+        rp_fanout_poll_fds(&fanout, &fds[1]);
+
+        if (poll(fds, RP_FANOUT_POLL_FDS + 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("poll");
+            break;
+        }
+
+        if (fds[0].revents != 0 && !service_device(device, &deframer, &stats)) {
+            fprintf(stderr, "%s closed\n", device_path);
+            break;
+        }
+
+        rp_fanout_handle(&fanout, &fds[1]);
+    }
+
+    uint64_t dropped = 0;
+
+    for (size_t i = 0; i < RP_FANOUT_MAX_CONSUMERS; i++) {
+        dropped += fanout.consumers[i].dropped;
+    }
+
+    fprintf(stderr,
+            "frames %llu, decode errors %llu, overflows %llu, consumers %zu, "
+            "dropped by connected consumers %llu, disconnected %llu\n",
+            (unsigned long long)stats.frames, (unsigned long long)stats.decode_errors,
+            (unsigned long long)stats.overflows, fanout.consumer_count,
+            (unsigned long long)dropped, (unsigned long long)fanout.disconnects);
+
+    rp_fanout_close(&fanout);
+    close(device);
+
+    if (latest != NULL) {
+        rp_latest_detach(latest);
+        rp_latest_unlink(latest_name);
+    }
+
+    return EXIT_SUCCESS;
+}
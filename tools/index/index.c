@@ -0,0 +1,635 @@
+#include "index.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Side file layout, native byte order (the index is built and read on the same ground
+ * machines):
+ *
+ *     file_header_t
+ *     field names, field_count * RP_INDEX_NAME_SIZE bytes
+ *     rp_index_level_info_t for each level
+ *     level 0 summaries, field-major: every bucket of field 0, then of field 1, ...
+ *     level 1 summaries
+ *     ...
+ *
+ * Field-major storage makes the buckets of one field in a time range contiguous, so a
+ * plot reads them with a single `pread`.
+ */
+
+typedef struct file_header {
+    char magic[4];
+    uint16_t version;
+    uint8_t base_shift;
+    uint8_t level_count;
+    uint32_t origin_ms;
+    uint32_t field_count;
+} file_header_t;
+
+_Static_assert(sizeof(file_header_t) == 16, "index header must have no padding");
+_Static_assert(sizeof(rp_index_summary_t) == 16, "index summary must have no padding");
+_Static_assert(sizeof(rp_index_level_info_t) == 16, "index level must have no padding");
+
+// Summaries transposed per write when saving a level
+#define WRITE_CHUNK (256)
+
+static rp_index_status_t select_fields(rp_index_builder_t *builder, const char *fields);
+static rp_index_status_t move_to(rp_index_builder_t *builder, size_t level, uint64_t bucket);
+static rp_index_status_t close_bucket(rp_index_builder_t *builder, size_t level);
+static void accumulator_reset(rp_index_accumulator_t *accumulator);
+static rp_index_status_t write_all(int fd, const void *data, size_t size);
+static rp_index_status_t read_all(int fd, void *data, size_t size, uint64_t offset);
+
+/**
+ * Sets up a builder.
+ *
+ * @param builder Builder to initialize
+ * @param message `Downlink` payload to index, other payloads are skipped
+ * @param fields Comma separated fields to summarize, or NULL for every field of
+ * `message` but its timestamp
+ * @param base_shift Level 0 buckets are `2^base_shift` ms wide, at most 31
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_builder_init(rp_index_builder_t *builder, pb_size_t message,
+                                        const char *fields, uint8_t base_shift)
+{
+    if (builder == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    const rp_export_column_t *time = rp_export_find_column(message, "timestamp_ms", 12);
+
+    if (time == NULL || base_shift > 31) {
+        return RP_INDEX_INVALID_ARGUMENT;
+    }
+
+    *builder = (rp_index_builder_t){
+        .message = message,
+        .time = time,
+        .base_shift = base_shift,
+        .max_gap_ms = RP_INDEX_DEFAULT_MAX_GAP_MS,
+    };
+
+    rp_index_status_t status = select_fields(builder, fields);
+
+    for (size_t l = 0; l < RP_INDEX_MAX_LEVELS; l++) {
+        for (size_t f = 0; f < RP_INDEX_MAX_FIELDS; f++) {
+            accumulator_reset(&builder->levels[l].accumulators[f]);
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Frees the summaries held by a builder.
+ *
+ * @param builder Builder
+ */
+void rp_index_builder_free(rp_index_builder_t *builder)
+{
+    if (builder == NULL) {
+        return;
+    }
+
+    for (size_t l = 0; l < RP_INDEX_MAX_LEVELS; l++) {
+        free(builder->levels[l].summaries);
+        builder->levels[l].summaries = NULL;
+        builder->levels[l].bucket_count = 0;
+        builder->levels[l].capacity = 0;
+    }
+}
+
+/**
+ * Adds a decoded message, or skips it if it carries another payload.
+ *
+ * @param builder Builder
+ * @param downlink Decoded message
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_add(rp_index_builder_t *builder, const tvr_Downlink *downlink)
+{
+    if (builder == NULL || downlink == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    double time;
+
+    if (!rp_export_column_value(builder->time, downlink, &time)) {
+        return RP_INDEX_OK;
+    }
+
+    uint32_t time_ms = (uint32_t)time;
+
+    if (!builder->started) {
+        builder->origin_ms = (time_ms >> builder->base_shift) << builder->base_shift;
+        builder->started = true;
+    }
+
+    if (time_ms > builder->origin_ms) {
+        uint64_t bucket = (time_ms - builder->origin_ms) >> builder->base_shift;
+        uint64_t current = builder->levels[0].bucket;
+
+        // Too far ahead to be real, counted in the current bucket like an older sample
+        if (bucket > current && ((bucket - current) << builder->base_shift) > builder->max_gap_ms) {
+            bucket = current;
+        }
+
+        rp_index_status_t status = move_to(builder, 0, bucket);
+
+        if (status != RP_INDEX_OK) {
+            return status;
+        }
+    }
+
+    rp_index_accumulator_t *accumulators = builder->levels[0].accumulators;
+
+    for (size_t f = 0; f < builder->field_count; f++) {
+        double value;
+
+        if (!rp_export_column_value(builder->fields[f], downlink, &value) || !isfinite(value)) {
+            continue;
+        }
+
+        float sample = (float)value;
+
+        accumulators[f].min = fminf(accumulators[f].min, sample);
+        accumulators[f].max = fmaxf(accumulators[f].max, sample);
+        accumulators[f].sum += value;
+        accumulators[f].count++;
+    }
+
+    builder->samples++;
+
+    return RP_INDEX_OK;
+}
+
+/**
+ * Closes the buckets being filled at every level, up to the first level with a single
+ * bucket. No message may be added afterwards.
+ *
+ * @param builder Builder
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_finish(rp_index_builder_t *builder)
+{
+    if (builder == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    if (!builder->started) {
+        return RP_INDEX_OK;
+    }
+
+    for (size_t l = 0; l < RP_INDEX_MAX_LEVELS; l++) {
+        rp_index_status_t status = close_bucket(builder, l);
+
+        if (status != RP_INDEX_OK) {
+            return status;
+        }
+
+        if (builder->levels[l].bucket_count == 1) {
+            break;
+        }
+    }
+
+    return RP_INDEX_OK;
+}
+
+/**
+ * Writes a finished index.
+ *
+ * @param builder Builder, after `rp_index_finish`
+ * @param fd Descriptor to write the side file to
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_write(const rp_index_builder_t *builder, int fd)
+{
+    if (builder == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    size_t level_count = 0;
+
+    while (level_count < RP_INDEX_MAX_LEVELS && builder->levels[level_count].bucket_count > 0) {
+        level_count++;
+
+        if (builder->levels[level_count - 1].bucket_count == 1) {
+            break;
+        }
+    }
+
+    file_header_t header = {
+        .version = RP_INDEX_VERSION,
+        .base_shift = builder->base_shift,
+        .level_count = (uint8_t)level_count,
+        .origin_ms = builder->origin_ms,
+        .field_count = (uint32_t)builder->field_count,
+    };
+    char names[RP_INDEX_MAX_FIELDS][RP_INDEX_NAME_SIZE] = {{0}};
+    rp_index_level_info_t levels[RP_INDEX_MAX_LEVELS];
+    uint64_t offset = sizeof(header) + builder->field_count * RP_INDEX_NAME_SIZE +
+                      level_count * sizeof(rp_index_level_info_t);
+
+    memcpy(header.magic, RP_INDEX_MAGIC, sizeof(header.magic));
+
+    for (size_t f = 0; f < builder->field_count; f++) {
+        strncpy(names[f], builder->fields[f]->name, RP_INDEX_NAME_SIZE - 1);
+    }
+
+    for (size_t l = 0; l < level_count; l++) {
+        levels[l].bucket_count = builder->levels[l].bucket_count;
+        levels[l].offset = offset;
+        offset += levels[l].bucket_count * builder->field_count * sizeof(rp_index_summary_t);
+    }
+
+    rp_index_status_t status = write_all(fd, &header, sizeof(header));
+
+    if (status == RP_INDEX_OK) {
+        status = write_all(fd, names, builder->field_count * RP_INDEX_NAME_SIZE);
+    }
+
+    if (status == RP_INDEX_OK) {
+        status = write_all(fd, levels, level_count * sizeof(rp_index_level_info_t));
+    }
+
+    // Stored bucket-major while building, written field-major
+    rp_index_summary_t chunk[WRITE_CHUNK];
+
+    for (size_t l = 0; l < level_count && status == RP_INDEX_OK; l++) {
+        const rp_index_level_t *level = &builder->levels[l];
+
+        for (size_t f = 0; f < builder->field_count && status == RP_INDEX_OK; f++) {
+            for (size_t first = 0; first < level->bucket_count && status == RP_INDEX_OK;
+                 first += WRITE_CHUNK) {
+                size_t count = level->bucket_count - first;
+
+                if (count > WRITE_CHUNK) {
+                    count = WRITE_CHUNK;
+                }
+
+                for (size_t b = 0; b < count; b++) {
+                    chunk[b] = level->summaries[(first + b) * builder->field_count + f];
+                }
+
+                status = write_all(fd, chunk, count * sizeof(rp_index_summary_t));
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ * Reads the header of an index file. Summaries are read on demand with `rp_index_read`.
+ *
+ * @param reader Reader to initialize
+ * @param fd Descriptor of the side file, kept open by the caller
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_open(rp_index_reader_t *reader, int fd)
+{
+    if (reader == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    file_header_t header;
+    rp_index_status_t status = read_all(fd, &header, sizeof(header), 0);
+
+    if (status != RP_INDEX_OK) {
+        return status;
+    }
+
+    if (memcmp(header.magic, RP_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RP_INDEX_VERSION || header.field_count > RP_INDEX_MAX_FIELDS ||
+        header.level_count > RP_INDEX_MAX_LEVELS || header.base_shift > 31) {
+        return RP_INDEX_BAD_FILE;
+    }
+
+    *reader = (rp_index_reader_t){
+        .fd = fd,
+        .base_shift = header.base_shift,
+        .origin_ms = header.origin_ms,
+        .field_count = header.field_count,
+        .level_count = header.level_count,
+    };
+
+    status = read_all(fd, reader->field_names, reader->field_count * RP_INDEX_NAME_SIZE,
+                      sizeof(header));
+
+    if (status == RP_INDEX_OK) {
+        status = read_all(fd, reader->levels, reader->level_count * sizeof(rp_index_level_info_t),
+                          sizeof(header) + reader->field_count * RP_INDEX_NAME_SIZE);
+    }
+
+    for (size_t f = 0; f < reader->field_count; f++) {
+        reader->field_names[f][RP_INDEX_NAME_SIZE - 1] = '\0';
+    }
+
+    return status;
+}
+
+/**
+ * Looks up a field of an index by name.
+ *
+ * @param reader Reader
+ * @param name Field path
+ * @return size_t Field number, `reader->field_count` if the index has no such field
+ */
+size_t rp_index_find_field(const rp_index_reader_t *reader, const char *name)
+{
+    size_t f = 0;
+
+    while (f < reader->field_count && strcmp(reader->field_names[f], name) != 0) {
+        f++;
+    }
+
+    return f;
+}
+
+/**
+ * Picks the coarsest level that still has a bucket for every pixel of a plot.
+ *
+ * @param reader Reader
+ * @param start_ms Start of the plotted range
+ * @param end_ms End of the plotted range, inclusive, clipped to the end of the index
+ * @param pixels Width of the plot
+ * @return size_t Level, 0 if even level 0 has fewer buckets than pixels
+ */
+size_t rp_index_choose_level(const rp_index_reader_t *reader, uint32_t start_ms,
+                             uint32_t end_ms, size_t pixels)
+{
+    if (reader->level_count == 0) {
+        return 0;
+    }
+
+    // Only the part of the range the index covers is plotted
+    uint64_t first_ms = (start_ms > reader->origin_ms) ? start_ms : reader->origin_ms;
+    uint64_t last_ms = reader->origin_ms +
+                       (reader->levels[0].bucket_count << reader->base_shift) - 1;
+
+    if (end_ms < last_ms) {
+        last_ms = end_ms;
+    }
+
+    uint64_t span_ms = (last_ms >= first_ms) ? last_ms - first_ms + 1 : 1;
+
+    for (size_t l = reader->level_count; l-- > 1;) {
+        if ((span_ms >> (reader->base_shift + l)) >= pixels) {
+            return l;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Reads the summaries of one field covering a time range.
+ *
+ * @param reader Reader
+ * @param level Level to read
+ * @param field Field number, see `rp_index_find_field`
+ * @param start_ms Start of the range
+ * @param end_ms End of the range, inclusive
+ * @param summaries Receives the summaries, the first one for the bucket holding
+ * `start_ms` (or the first bucket of the index)
+ * @param capacity Summaries `summaries` has room for, the range is cut short to it
+ * @param count Receives the number of summaries read
+ * @return rp_index_status_t Status
+ */
+rp_index_status_t rp_index_read(const rp_index_reader_t *reader, size_t level, size_t field,
+                                uint32_t start_ms, uint32_t end_ms,
+                                rp_index_summary_t *summaries, size_t capacity,
+                                size_t *count)
+{
+    if (reader == NULL || summaries == NULL || count == NULL) {
+        return RP_INDEX_NULL_POINTER;
+    }
+
+    *count = 0;
+
+    if (level >= reader->level_count || field >= reader->field_count) {
+        return RP_INDEX_INVALID_ARGUMENT;
+    }
+
+    const rp_index_level_info_t *info = &reader->levels[level];
+    uint8_t shift = (uint8_t)(reader->base_shift + level);
+    uint64_t first =
+        (start_ms > reader->origin_ms) ? (uint64_t)(start_ms - reader->origin_ms) >> shift : 0;
+    uint64_t last =
+        (end_ms > reader->origin_ms) ? (uint64_t)(end_ms - reader->origin_ms) >> shift : 0;
+
+    if (end_ms < start_ms || first >= info->bucket_count) {
+        return RP_INDEX_OK;
+    }
+
+    if (last >= info->bucket_count) {
+        last = info->bucket_count - 1;
+    }
+
+    size_t wanted = (size_t)(last - first + 1);
+
+    if (wanted > capacity) {
+        wanted = capacity;
+    }
+
+    uint64_t offset =
+        info->offset + (field * info->bucket_count + first) * sizeof(rp_index_summary_t);
+    rp_index_status_t status =
+        read_all(reader->fd, summaries, wanted * sizeof(rp_index_summary_t), offset);
+
+    if (status == RP_INDEX_OK) {
+        *count = wanted;
+    }
+
+    return status;
+}
+
+/**
+ * Parses the field selection, or selects every field of the message but its timestamp.
+ */
+static rp_index_status_t select_fields(rp_index_builder_t *builder, const char *fields)
+{
+    if (fields == NULL || fields[0] == '\0') {
+        for (size_t i = 0; i < rp_export_column_count; i++) {
+            const rp_export_column_t *column = &rp_export_columns[i];
+
+            if (column->message == builder->message && column != builder->time) {
+                builder->fields[builder->field_count++] = column;
+            }
+        }
+
+        return RP_INDEX_OK;
+    }
+
+    const char *name = fields;
+
+    for (;;) {
+        const char *end = strchr(name, ',');
+        size_t length = (end != NULL) ? (size_t)(end - name) : strlen(name);
+        const rp_export_column_t *column = rp_export_find_column(builder->message, name, length);
+
+        if (column == NULL) {
+            return RP_INDEX_UNKNOWN_FIELD;
+        }
+
+        if (builder->field_count == RP_INDEX_MAX_FIELDS) {
+            return RP_INDEX_INVALID_ARGUMENT;
+        }
+
+        builder->fields[builder->field_count++] = column;
+
+        if (end == NULL) {
+            return RP_INDEX_OK;
+        }
+
+        name = end + 1;
+    }
+}
+
+/**
+ * Closes buckets of a level until `bucket` is the one being filled. Buckets skipped over
+ * are stored with a count of 0, so every level can be indexed by time.
+ */
+static rp_index_status_t move_to(rp_index_builder_t *builder, size_t level, uint64_t bucket)
+{
+    while (builder->levels[level].bucket < bucket) {
+        rp_index_status_t status = close_bucket(builder, level);
+
+        if (status != RP_INDEX_OK) {
+            return status;
+        }
+    }
+
+    return RP_INDEX_OK;
+}
+
+/**
+ * Stores the summaries of the bucket being filled and merges its sums into the bucket
+ * covering it one level up.
+ */
+static rp_index_status_t close_bucket(rp_index_builder_t *builder, size_t level)
+{
+    rp_index_level_t *current = &builder->levels[level];
+
+    if (current->bucket_count == current->capacity) {
+        size_t capacity = (current->capacity > 0) ? current->capacity * 2 : 64;
+        rp_index_summary_t *summaries = realloc(
+            current->summaries, capacity * builder->field_count * sizeof(rp_index_summary_t));
+
+        if (summaries == NULL && builder->field_count > 0) {
+            return RP_INDEX_NO_MEMORY;
+        }
+
+        current->summaries = summaries;
+        current->capacity = capacity;
+    }
+
+    rp_index_summary_t *summaries =
+        &current->summaries[current->bucket_count * builder->field_count];
+
+    for (size_t f = 0; f < builder->field_count; f++) {
+        const rp_index_accumulator_t *accumulator = &current->accumulators[f];
+
+        if (accumulator->count == 0) {
+            summaries[f] = (rp_index_summary_t){NAN, NAN, NAN, 0};
+        } else {
+            summaries[f] = (rp_index_summary_t){
+                .min = accumulator->min,
+                .max = accumulator->max,
+                .mean = (float)(accumulator->sum / accumulator->count),
+                .count = accumulator->count,
+            };
+        }
+    }
+
+    current->bucket_count++;
+
+    if (level + 1 < RP_INDEX_MAX_LEVELS) {
+        rp_index_status_t status = move_to(builder, level + 1, current->bucket >> 1);
+
+        if (status != RP_INDEX_OK) {
+            return status;
+        }
+
+        rp_index_accumulator_t *parents = builder->levels[level + 1].accumulators;
+
+        for (size_t f = 0; f < builder->field_count; f++) {
+            const rp_index_accumulator_t *accumulator = &current->accumulators[f];
+
+            parents[f].min = fminf(parents[f].min, accumulator->min);
+            parents[f].max = fmaxf(parents[f].max, accumulator->max);
+            parents[f].sum += accumulator->sum;
+            parents[f].count += accumulator->count;
+        }
+    }
+
+    for (size_t f = 0; f < builder->field_count; f++) {
+        accumulator_reset(&current->accumulators[f]);
+    }
+
+    current->bucket++;
+
+    return RP_INDEX_OK;
+}
+
+static void accumulator_reset(rp_index_accumulator_t *accumulator)
+{
+    *accumulator = (rp_index_accumulator_t){
+        .min = INFINITY,
+        .max = -INFINITY,
+    };
+}
+
+static rp_index_status_t write_all(int fd, const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+
+    while (size > 0) {
+        ssize_t count = write(fd, bytes, size);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            return RP_INDEX_IO_ERROR;
+        }
+
+        bytes += count;
+        size -= (size_t)count;
+    }
+
+    return RP_INDEX_OK;
+}
+
+static rp_index_status_t read_all(int fd, void *data, size_t size, uint64_t offset)
+{
+    uint8_t *bytes = data;
+
+    while (size > 0) {
+        ssize_t count = pread(fd, bytes, size, (off_t)offset);
+
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0) {
+            return RP_INDEX_IO_ERROR;
+        }
+
+        if (count == 0) {
+            return RP_INDEX_BAD_FILE;
+        }
+
+        bytes += count;
+        size -= (size_t)count;
+        offset += (uint64_t)count;
+    }
+
+    return RP_INDEX_OK;
+}
@@ -0,0 +1,125 @@
+#ifndef RP_INDEX_H
+#define RP_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "export.h"
+
+#define RP_INDEX_MAGIC "RPIX"
+#define RP_INDEX_VERSION (1)
+
+#define RP_INDEX_MAX_FIELDS (RP_EXPORT_MAX_COLUMNS)
+
+// Enough levels for one bucket to span every 32-bit millisecond timestamp
+#define RP_INDEX_MAX_LEVELS (33)
+
+// Field names in the side file, NUL padded
+#define RP_INDEX_NAME_SIZE (32)
+
+// Largest forward jump between samples indexed as a gap, one hour
+#define RP_INDEX_DEFAULT_MAX_GAP_MS (3600000)
+
+typedef enum rp_index_status {
+    RP_INDEX_OK,
+    RP_INDEX_NULL_POINTER,
+    RP_INDEX_INVALID_ARGUMENT,
+    RP_INDEX_UNKNOWN_FIELD, /**< A selected field is not a field of the message */
+    RP_INDEX_NO_MEMORY,
+    RP_INDEX_IO_ERROR,      /**< `read` or `write` failed, see `errno` */
+    RP_INDEX_BAD_FILE,      /**< Not an index, or a version this code cannot read */
+} rp_index_status_t;
+
+/**
+ * Summary of one field over one time bucket, as stored in the side file.
+ */
+typedef struct rp_index_summary {
+    float min;
+    float max;
+    float mean;
+    uint32_t count; /**< Samples in the bucket, 0 for a bucket without any */
+} rp_index_summary_t;
+
+/**
+ * Running summary of a bucket being filled. Sums are kept in double so that the mean of a
+ * coarse bucket is exact to float precision however many samples it covers.
+ */
+typedef struct rp_index_accumulator {
+    float min;
+    float max;
+    double sum;
+    uint32_t count;
+} rp_index_accumulator_t;
+
+typedef struct rp_index_level {
+    uint64_t bucket; /**< Bucket being filled */
+    rp_index_accumulator_t accumulators[RP_INDEX_MAX_FIELDS];
+    rp_index_summary_t *summaries; /**< Closed buckets, `field_count` summaries each */
+    size_t bucket_count;           /**< Closed buckets */
+    size_t capacity;               /**< Buckets `summaries` has room for */
+} rp_index_level_t;
+
+/**
+ * Builds the summary pyramid of a capture in one pass.
+ *
+ * Level 0 buckets are `2^base_shift` ms wide, from `origin_ms`, the first sample's bucket.
+ * Each level above has buckets twice as wide, each covering two buckets of the level
+ * below, up to the first level with a single bucket. Buckets are only summarized from
+ * level 0 sums, so every level is exact. Samples are expected in timestamp order; a
+ * sample older than the current bucket, e.g. after a flight computer reboot, is counted
+ * in the current bucket. So is a sample more than `max_gap_ms` past it, most likely a
+ * corrupt timestamp, which would otherwise store an empty bucket for every step of the
+ * jump at every level.
+ */
+typedef struct rp_index_builder {
+    pb_size_t message;              /**< `Downlink` payload indexed */
+    const rp_export_column_t *time; /**< The payload's `timestamp_ms` */
+    const rp_export_column_t *fields[RP_INDEX_MAX_FIELDS];
+    size_t field_count;
+
+    uint8_t base_shift;
+    uint32_t max_gap_ms; /**< `RP_INDEX_DEFAULT_MAX_GAP_MS` unless changed after init */
+    bool started;
+    uint32_t origin_ms;
+    uint64_t samples;
+
+    rp_index_level_t levels[RP_INDEX_MAX_LEVELS];
+} rp_index_builder_t;
+
+/**
+ * Level of an index file, as read by `rp_index_open`.
+ */
+typedef struct rp_index_level_info {
+    uint64_t bucket_count;
+    uint64_t offset; /**< Of the level's summaries, field-major, in the file */
+} rp_index_level_info_t;
+
+typedef struct rp_index_reader {
+    int fd;
+    uint8_t base_shift;
+    uint32_t origin_ms;
+    size_t field_count;
+    char field_names[RP_INDEX_MAX_FIELDS][RP_INDEX_NAME_SIZE];
+    size_t level_count;
+    rp_index_level_info_t levels[RP_INDEX_MAX_LEVELS];
+} rp_index_reader_t;
+
+rp_index_status_t rp_index_builder_init(rp_index_builder_t *builder, pb_size_t message,
+                                        const char *fields, uint8_t base_shift);
+void rp_index_builder_free(rp_index_builder_t *builder);
+
+rp_index_status_t rp_index_add(rp_index_builder_t *builder, const tvr_Downlink *downlink);
+rp_index_status_t rp_index_finish(rp_index_builder_t *builder);
+rp_index_status_t rp_index_write(const rp_index_builder_t *builder, int fd);
+
+rp_index_status_t rp_index_open(rp_index_reader_t *reader, int fd);
+size_t rp_index_find_field(const rp_index_reader_t *reader, const char *name);
+size_t rp_index_choose_level(const rp_index_reader_t *reader, uint32_t start_ms,
+                             uint32_t end_ms, size_t pixels);
+rp_index_status_t rp_index_read(const rp_index_reader_t *reader, size_t level, size_t field,
+                                uint32_t start_ms, uint32_t end_ms,
+                                rp_index_summary_t *summaries, size_t capacity,
+                                size_t *count);
+
+#endif // RP_INDEX_H
@@ -0,0 +1,297 @@
+/**
+ * Summary pyramid indexer.
+ *
+ * Builds the min/max/mean pyramid of a raw downlink capture in one pass and saves it as a
+ * side file, or reads a range of it back the way a plot would:
+ *
+ *     rp-index [-m telemetry|status] [-c field,...] [-b shift] [-g max_gap_ms] capture.bin
+ *              index.rpix
+ *     rp-index -q field [-r start_ms:end_ms] [-p pixels] index.rpix
+ *
+ * `-b` sets the width of the finest buckets to `2^shift` ms (default 7, 128 ms, about one
+ * sample per bucket at 10 Hz). A timestamp more than `-g` ms past the previous sample
+ * (default one hour) is taken as corrupt and counted in the previous bucket. A query
+ * picks the coarsest level with at least `pixels` buckets in the range (default 1000)
+ * and prints one CSV row per bucket, so a plot of any zoom level reads O(pixels)
+ * summaries instead of decoding the capture.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "index.h"
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+#include "tvr/downlink.pb.h"
+
+#define READ_SIZE (1 << 20)
+#define DEFAULT_BASE_SHIFT (7)
+#define DEFAULT_PIXELS (1000)
+
+// Too large for the stack
+static uint8_t input[READ_SIZE];
+static rp_index_builder_t builder;
+
+static int build(int capture_fd, int index_fd)
+{
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    rp_deframer_t deframer;
+    uint64_t frames = 0;
+    uint64_t decode_errors = 0;
+    ssize_t count;
+
+    rp_deframer_init(&deframer, frame, sizeof(frame));
+
+    while ((count = read(capture_fd, input, sizeof(input))) != 0) {
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count < 0) {
+            perror("read");
+            return 1;
+        }
+
+        size_t offset = 0;
+
+        while (offset < (size_t)count) {
+            rp_deframer_result_t rx = rp_deframer_feed(&deframer, &input[offset],
+                                                       (size_t)count - offset);
+
+            offset += rx.consumed;
+
+            if (rx.status != RP_DEFRAMER_FRAME_READY) {
+                continue;
+            }
+
+            tvr_Downlink downlink = tvr_Downlink_init_zero;
+            rp_packet_decode_result_t decoded =
+                rp_packet_decode(deframer.buffer, deframer.size, tvr_Downlink_fields, &downlink);
+
+            frames++;
+
+            if (decoded.status != RP_CODEC_OK) {
+                decode_errors++;
+                continue;
+            }
+
+            if (rp_index_add(&builder, &downlink) != RP_INDEX_OK) {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+        }
+    }
+
+    if (rp_index_finish(&builder) != RP_INDEX_OK) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    if (rp_index_write(&builder, index_fd) != RP_INDEX_OK) {
+        perror("write");
+        return 1;
+    }
+
+    size_t levels = 0;
+
+    while (levels < RP_INDEX_MAX_LEVELS && builder.levels[levels].bucket_count > 1) {
+        levels++;
+    }
+
+    fprintf(stderr, "frames %" PRIu64 " samples %" PRIu64 " decode_errors %" PRIu64
+                    " buckets %zu levels %zu\n",
+            frames, builder.samples, decode_errors, builder.levels[0].bucket_count, levels + 1);
+
+    return 0;
+}
+
+static int query(int index_fd, const char *field_name, uint32_t start_ms, uint32_t end_ms,
+                 size_t pixels)
+{
+    rp_index_reader_t reader;
+    rp_index_status_t status = rp_index_open(&reader, index_fd);
+
+    if (status != RP_INDEX_OK) {
+        fprintf(stderr, "not an index file\n");
+        return 1;
+    }
+
+    size_t field = rp_index_find_field(&reader, field_name);
+
+    if (field == reader.field_count) {
+        fprintf(stderr, "no field %s in the index\n", field_name);
+        return 1;
+    }
+
+    if (reader.level_count == 0) {
+        return 0;
+    }
+
+    size_t level = rp_index_choose_level(&reader, start_ms, end_ms, pixels);
+    size_t capacity = 2 * pixels + 2;
+    rp_index_summary_t *summaries = malloc(capacity * sizeof(*summaries));
+    size_t count;
+
+    if (summaries == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    status = rp_index_read(&reader, level, field, start_ms, end_ms, summaries, capacity, &count);
+
+    if (status != RP_INDEX_OK) {
+        fprintf(stderr, "could not read the index\n");
+        free(summaries);
+        return 1;
+    }
+
+    uint8_t shift = (uint8_t)(reader.base_shift + level);
+    uint64_t first_ms = (start_ms > reader.origin_ms)
+                            ? (((uint64_t)(start_ms - reader.origin_ms) >> shift) << shift)
+                            : 0;
+
+    printf("start_ms,min,max,mean,count\n");
+
+    for (size_t i = 0; i < count; i++) {
+        printf("%" PRIu64 ",%.9g,%.9g,%.9g,%u\n",
+               reader.origin_ms + first_ms + ((uint64_t)i << shift), summaries[i].min,
+               summaries[i].max, summaries[i].mean, (unsigned)summaries[i].count);
+    }
+
+    fprintf(stderr, "level %zu, %" PRIu64 " ms buckets\n", level, (uint64_t)1 << shift);
+
+    free(summaries);
+
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-m telemetry|status] [-c field,...] [-b shift] [-g max_gap_ms]\n"
+            " capture.bin index.rpix\n"
+            "       %s -q field [-r start_ms:end_ms] [-p pixels] index.rpix\n",
+            name, name);
+}
+
+int main(int argc, char **argv)
+{
+    pb_size_t message = tvr_Downlink_telemetry_tag;
+    const char *fields = NULL;
+    const char *query_field = NULL;
+    unsigned long base_shift = DEFAULT_BASE_SHIFT;
+    unsigned long max_gap_ms = RP_INDEX_DEFAULT_MAX_GAP_MS;
+    unsigned long start_ms = 0;
+    unsigned long end_ms = UINT32_MAX;
+    unsigned long pixels = DEFAULT_PIXELS;
+    int option;
+
+    while ((option = getopt(argc, argv, "m:c:b:g:q:r:p:")) != -1) {
+        switch (option) {
+        case 'm':
+            if (strcmp(optarg, "telemetry") == 0) {
+                message = tvr_Downlink_telemetry_tag;
+            } else if (strcmp(optarg, "status") == 0) {
+                message = tvr_Downlink_status_tag;
+            } else {
+                fprintf(stderr, "unknown message %s\n", optarg);
+                return 1;
+            }
+            break;
+        case 'c':
+            fields = optarg;
+            break;
+        case 'b':
+            base_shift = strtoul(optarg, NULL, 10);
+            break;
+        case 'g':
+            max_gap_ms = strtoul(optarg, NULL, 10);
+            break;
+        case 'q':
+            query_field = optarg;
+            break;
+        case 'r':
+            if (sscanf(optarg, "%lu:%lu", &start_ms, &end_ms) != 2) {
+                fprintf(stderr, "range must be start_ms:end_ms\n");
+                return 1;
+            }
+            break;
+        case 'p':
+            pixels = strtoul(optarg, NULL, 10);
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (query_field != NULL) {
+        if (argc - optind != 1 || pixels == 0 || start_ms > UINT32_MAX || end_ms > UINT32_MAX) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        int index_fd = open(argv[optind], O_RDONLY);
+
+        if (index_fd < 0) {
+            perror(argv[optind]);
+            return 1;
+        }
+
+        int result = query(index_fd, query_field, (uint32_t)start_ms, (uint32_t)end_ms, pixels);
+
+        close(index_fd);
+
+        return result;
+    }
+
+    if (argc - optind != 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    rp_index_status_t status =
+        rp_index_builder_init(&builder, message, fields, (uint8_t)base_shift);
+
+    if (status == RP_INDEX_UNKNOWN_FIELD) {
+        fprintf(stderr, "unknown field in %s\n", fields);
+        return 1;
+    }
+
+    if (status != RP_INDEX_OK || base_shift > 31 || max_gap_ms > UINT32_MAX) {
+        fprintf(stderr, "invalid index options\n");
+        return 1;
+    }
+
+    builder.max_gap_ms = (uint32_t)max_gap_ms;
+
+    int capture_fd = open(argv[optind], O_RDONLY);
+
+    if (capture_fd < 0) {
+        perror(argv[optind]);
+        return 1;
+    }
+
+    int index_fd = open(argv[optind + 1], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+    if (index_fd < 0) {
+        perror(argv[optind + 1]);
+        close(capture_fd);
+        return 1;
+    }
+
+    int result = build(capture_fd, index_fd);
+
+    close(capture_fd);
+    close(index_fd);
+    rp_index_builder_free(&builder);
+
+    return result;
+}
@@ -0,0 +1,328 @@
+#include "pipeline.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define STAGE_FREE (0)
+#define STAGE_SPLIT (1)
+#define STAGE_DECODED (2)
+
+// Busy polls before yielding, and yields before sleeping, while a stage waits
+#define SPIN_LIMIT (64)
+#define YIELD_LIMIT (1024)
+#define IDLE_SLEEP_NS (20000)
+
+static uint64_t stamp_of(uint64_t sequence, unsigned stage);
+static rp_pipeline_slot_t *slot_of(rp_pipeline_t *pipeline, uint64_t sequence);
+static void backoff(unsigned *waits);
+static void publish(rp_pipeline_t *pipeline, const uint8_t *frame, size_t size,
+                    uint64_t received_ns);
+static void *worker_main(void *argument);
+static void *deliverer_main(void *argument);
+
+/**
+ * Starts the decode workers and the delivery thread.
+ *
+ * Each worker decodes with its own copy of `config->options`. With a link header set,
+ * the header of every frame is decoded into its slot and handed to the callback with the
+ * frame; the caller's `options->link_header` is never written.
+ *
+ * @param pipeline Pipeline to start, large enough that it should not live on the stack
+ * @param config Message type, codec options, callback and number of workers
+ * @return rp_pipeline_status_t
+ */
+rp_pipeline_status_t rp_pipeline_start(rp_pipeline_t *pipeline,
+                                       const rp_pipeline_config_t *config)
+{
+    if (pipeline == NULL || config == NULL || config->fields == NULL ||
+        config->callback == NULL) {
+        return RP_PIPELINE_NULL_POINTER;
+    }
+
+    if (config->worker_count == 0 || config->worker_count > RP_PIPELINE_MAX_WORKERS ||
+        config->message_size == 0 || config->message_size > RP_PIPELINE_MESSAGE_CAPACITY) {
+        return RP_PIPELINE_INVALID_ARGUMENT;
+    }
+
+    memset(pipeline, 0, sizeof(*pipeline));
+    pipeline->config = *config;
+    rp_deframer_init(&pipeline->deframer, pipeline->frame, sizeof(pipeline->frame));
+
+    for (uint64_t i = 0; i < RP_PIPELINE_DEPTH; i++) {
+        atomic_init(&pipeline->slots[i].stamp, stamp_of(i, STAGE_FREE));
+    }
+
+    atomic_init(&pipeline->next_decode, 0);
+    atomic_init(&pipeline->delivered, 0);
+    atomic_init(&pipeline->stopping, false);
+
+    for (size_t i = 0; i < config->worker_count; i++) {
+        if (pthread_create(&pipeline->workers[i], NULL, worker_main, pipeline) != 0) {
+            rp_pipeline_stop(pipeline);
+            return RP_PIPELINE_THREAD_ERROR;
+        }
+
+        pipeline->worker_threads++;
+    }
+
+    if (pthread_create(&pipeline->deliverer, NULL, deliverer_main, pipeline) != 0) {
+        rp_pipeline_stop(pipeline);
+        return RP_PIPELINE_THREAD_ERROR;
+    }
+
+    pipeline->deliverer_started = true;
+
+    return RP_PIPELINE_OK;
+}
+
+/**
+ * Delivers every frame split so far, then stops and joins the stage threads. Bytes of an
+ * unfinished frame are discarded.
+ *
+ * @param pipeline Pipeline
+ */
+void rp_pipeline_stop(rp_pipeline_t *pipeline)
+{
+    if (pipeline == NULL) {
+        return;
+    }
+
+    if (pipeline->deliverer_started) {
+        rp_pipeline_flush(pipeline);
+    }
+
+    atomic_store_explicit(&pipeline->stopping, true, memory_order_release);
+
+    for (size_t i = 0; i < pipeline->worker_threads; i++) {
+        pthread_join(pipeline->workers[i], NULL);
+    }
+
+    if (pipeline->deliverer_started) {
+        pthread_join(pipeline->deliverer, NULL);
+    }
+
+    pipeline->worker_threads = 0;
+    pipeline->deliverer_started = false;
+}
+
+/**
+ * Reader stage: splits received bytes into frames and hands each one to the workers.
+ * Must only be called from one thread. Waits while `RP_PIPELINE_DEPTH` frames are in
+ * flight, so a slow consumer holds back the reader instead of losing frames.
+ *
+ * @param pipeline Started pipeline
+ * @param data Received bytes
+ * @param size Number of bytes
+ * @param received_ns Receive time, passed on with every frame that ends in `data`
+ */
+void rp_pipeline_feed(rp_pipeline_t *pipeline, const uint8_t *data, size_t size,
+                      uint64_t received_ns)
+{
+    if (pipeline == NULL || data == NULL) {
+        return;
+    }
+
+    size_t offset = 0;
+
+    while (offset < size) {
+        rp_deframer_result_t rx =
+            rp_deframer_feed(&pipeline->deframer, &data[offset], size - offset);
+
+        offset += rx.consumed;
+
+        if (rx.status == RP_DEFRAMER_OVERFLOW) {
+            pipeline->overflows++;
+        } else if (rx.status == RP_DEFRAMER_FRAME_READY) {
+            publish(pipeline, pipeline->deframer.buffer, pipeline->deframer.size, received_ns);
+        }
+    }
+}
+
+/**
+ * Waits until every frame split so far has been delivered.
+ *
+ * @param pipeline Started pipeline
+ */
+void rp_pipeline_flush(rp_pipeline_t *pipeline)
+{
+    if (pipeline == NULL) {
+        return;
+    }
+
+    unsigned waits = 0;
+
+    while (atomic_load_explicit(&pipeline->delivered, memory_order_acquire) < pipeline->written) {
+        backoff(&waits);
+    }
+}
+
+/**
+ * @param sequence Frame number
+ * @param stage Stage the frame reached
+ * @return uint64_t Slot stamp
+ */
+static uint64_t stamp_of(uint64_t sequence, unsigned stage)
+{
+    return sequence * 4 + stage;
+}
+
+/**
+ * @param pipeline Pipeline
+ * @param sequence Frame number
+ * @return rp_pipeline_slot_t* Slot the frame moves through
+ */
+static rp_pipeline_slot_t *slot_of(rp_pipeline_t *pipeline, uint64_t sequence)
+{
+    return &pipeline->slots[sequence & (RP_PIPELINE_DEPTH - 1)];
+}
+
+/**
+ * Waits a little longer each time a stage finds nothing to do, from busy polling to
+ * short sleeps, so idle workers do not hold a core on a quiet link.
+ *
+ * @param waits Consecutive waits so far, reset by the caller once work is found
+ */
+static void backoff(unsigned *waits)
+{
+    if (*waits < SPIN_LIMIT) {
+        (*waits)++;
+    } else if (*waits < YIELD_LIMIT) {
+        (*waits)++;
+        sched_yield();
+    } else {
+        struct timespec pause = {.tv_sec = 0, .tv_nsec = IDLE_SLEEP_NS};
+
+        nanosleep(&pause, NULL);
+    }
+}
+
+/**
+ * Copies a split frame into its slot and marks it ready for the workers.
+ *
+ * @param pipeline Pipeline
+ * @param frame Frame including the delimiter
+ * @param size Frame size
+ * @param received_ns Receive time
+ */
+static void publish(rp_pipeline_t *pipeline, const uint8_t *frame, size_t size,
+                    uint64_t received_ns)
+{
+    uint64_t sequence = pipeline->written;
+    rp_pipeline_slot_t *slot = slot_of(pipeline, sequence);
+    uint64_t free_stamp = stamp_of(sequence, STAGE_FREE);
+    unsigned waits = 0;
+
+    if (atomic_load_explicit(&slot->stamp, memory_order_acquire) != free_stamp) {
+        pipeline->reader_stalls++;
+
+        while (atomic_load_explicit(&slot->stamp, memory_order_acquire) != free_stamp) {
+            backoff(&waits);
+        }
+    }
+
+    memcpy(slot->frame, frame, size);
+    slot->frame_size = size;
+    slot->received_ns = received_ns;
+
+    atomic_store_explicit(&slot->stamp, stamp_of(sequence, STAGE_SPLIT), memory_order_release);
+    pipeline->written = sequence + 1;
+}
+
+/**
+ * Decode stage: claims frames in order and decodes each in its own slot.
+ *
+ * @param argument Pipeline
+ * @return void* NULL
+ */
+static void *worker_main(void *argument)
+{
+    rp_pipeline_t *pipeline = argument;
+    const rp_pipeline_config_t *config = &pipeline->config;
+    rp_codec_options_t options = {0};
+
+    if (config->options != NULL) {
+        options = *config->options;
+    }
+
+    bool link_header = options.link_header != NULL;
+
+    for (;;) {
+        uint64_t sequence =
+            atomic_fetch_add_explicit(&pipeline->next_decode, 1, memory_order_relaxed);
+        rp_pipeline_slot_t *slot = slot_of(pipeline, sequence);
+        uint64_t split_stamp = stamp_of(sequence, STAGE_SPLIT);
+        unsigned waits = 0;
+
+        while (atomic_load_explicit(&slot->stamp, memory_order_acquire) != split_stamp) {
+            // Stop only leaves frames nobody split, the flush delivered the rest
+            if (atomic_load_explicit(&pipeline->stopping, memory_order_acquire)) {
+                return NULL;
+            }
+
+            backoff(&waits);
+        }
+
+        memset(slot->message, 0, config->message_size);
+        options.link_header = link_header ? &slot->link_header : NULL;
+        slot->status = rp_packet_decode_with_options(slot->frame, slot->frame_size,
+                                                     config->fields, slot->message, &options)
+                           .status;
+
+        atomic_store_explicit(&slot->stamp, stamp_of(sequence, STAGE_DECODED),
+                              memory_order_release);
+    }
+}
+
+/**
+ * Reorder stage: waits for the frames in arrival order, whichever worker decoded them,
+ * and hands them to the callback.
+ *
+ * @param argument Pipeline
+ * @return void* NULL
+ */
+static void *deliverer_main(void *argument)
+{
+    rp_pipeline_t *pipeline = argument;
+    const rp_pipeline_config_t *config = &pipeline->config;
+
+    for (uint64_t sequence = 0;; sequence++) {
+        rp_pipeline_slot_t *slot = slot_of(pipeline, sequence);
+        uint64_t decoded_stamp = stamp_of(sequence, STAGE_DECODED);
+        unsigned waits = 0;
+
+        while (atomic_load_explicit(&slot->stamp, memory_order_acquire) != decoded_stamp) {
+            if (atomic_load_explicit(&pipeline->stopping, memory_order_acquire)) {
+                return NULL;
+            }
+
+            backoff(&waits);
+        }
+
+        rp_pipeline_result_t result = {
+            .sequence = sequence,
+            .received_ns = slot->received_ns,
+            .status = slot->status,
+            .message = slot->message,
+            .frame_size = slot->frame_size,
+            .link_header = (config->options != NULL && config->options->link_header != NULL)
+                               ? &slot->link_header
+                               : NULL,
+        };
+
+        if (result.status != RP_CODEC_OK) {
+            pipeline->decode_errors++;
+        }
+
+        config->callback(config->context, &result);
+
+        atomic_store_explicit(&slot->stamp, stamp_of(sequence + RP_PIPELINE_DEPTH, STAGE_FREE),
+                              memory_order_release);
+        atomic_store_explicit(&pipeline->delivered, sequence + 1, memory_order_release);
+    }
+}
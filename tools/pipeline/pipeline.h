@@ -0,0 +1,110 @@
+#ifndef RP_PIPELINE_H
+#define RP_PIPELINE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rp/codec.h"
+#include "rp/deframer/deframer.h"
+
+// Frames in flight between the reader and the delivery stage, a power of two
+#ifndef RP_PIPELINE_DEPTH
+#define RP_PIPELINE_DEPTH (256)
+#endif
+
+#define RP_PIPELINE_MAX_WORKERS (16)
+
+// Largest message struct the workers decode into
+#define RP_PIPELINE_MESSAGE_CAPACITY (512)
+
+_Static_assert((RP_PIPELINE_DEPTH & (RP_PIPELINE_DEPTH - 1)) == 0,
+               "RP_PIPELINE_DEPTH must be a power of two");
+
+typedef enum rp_pipeline_status {
+    RP_PIPELINE_OK,
+    RP_PIPELINE_NULL_POINTER,
+    RP_PIPELINE_INVALID_ARGUMENT,
+    RP_PIPELINE_THREAD_ERROR, /**< A stage thread could not be created */
+} rp_pipeline_status_t;
+
+/**
+ * A decoded frame, handed to the callback in arrival order.
+ */
+typedef struct rp_pipeline_result {
+    uint64_t sequence;        /**< Frames split before this one */
+    uint64_t received_ns;     /**< Time passed to `rp_pipeline_feed` with the frame's last byte */
+    rp_codec_status_t status; /**< `RP_CODEC_OK` if `message` holds the decoded frame */
+    const void *message;      /**< Valid until the callback returns */
+    size_t frame_size;        /**< Including the delimiter */
+
+    /**
+     * Link header of the frame when `options->link_header` is set, otherwise NULL.
+     * Valid until the callback returns.
+     */
+    const rp_link_header_t *link_header;
+} rp_pipeline_result_t;
+
+typedef void (*rp_pipeline_callback_t)(void *context, const rp_pipeline_result_t *result);
+
+typedef struct rp_pipeline_config {
+    size_t worker_count; /**< Decode threads, 1 to `RP_PIPELINE_MAX_WORKERS` */
+    const pb_msgdesc_t *fields;
+    size_t message_size;               /**< `sizeof` the message struct */
+    const rp_codec_options_t *options; /**< NULL for the defaults, see `rp_pipeline_start` */
+    rp_pipeline_callback_t callback;   /**< Called from the delivery thread */
+    void *context;
+} rp_pipeline_config_t;
+
+/**
+ * One frame moving through the stages. `stamp` is `4 * sequence` plus the stage the
+ * frame has reached: 0 free for the reader, 1 split, 2 decoded. Delivery frees the slot
+ * for the frame `RP_PIPELINE_DEPTH` later.
+ */
+typedef struct rp_pipeline_slot {
+    _Alignas(64) atomic_uint_least64_t stamp;
+    uint64_t received_ns;
+    size_t frame_size;
+    rp_codec_status_t status;
+    rp_link_header_t link_header;
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    _Alignas(16) uint8_t message[RP_PIPELINE_MESSAGE_CAPACITY];
+} rp_pipeline_slot_t;
+
+/**
+ * Ordered multi-stage decoder: the caller's thread splits frames, `worker_count` threads
+ * decode them in parallel, and a delivery thread calls back in arrival order.
+ */
+typedef struct rp_pipeline {
+    rp_pipeline_config_t config;
+    rp_pipeline_slot_t slots[RP_PIPELINE_DEPTH];
+
+    rp_deframer_t deframer;
+    uint8_t frame[RP_PACKET_MAX_SIZE];
+    uint64_t written; /**< Frames split by the reader */
+
+    _Alignas(64) atomic_uint_least64_t next_decode; /**< Next frame a worker claims */
+    _Alignas(64) atomic_uint_least64_t delivered;   /**< Frames handed to the callback */
+    atomic_bool stopping;
+
+    pthread_t workers[RP_PIPELINE_MAX_WORKERS];
+    size_t worker_threads; /**< Workers started */
+    pthread_t deliverer;
+    bool deliverer_started;
+
+    uint64_t overflows;     /**< Frames too long for the deframer */
+    uint64_t reader_stalls; /**< Frames the reader waited for a free slot */
+    uint64_t decode_errors; /**< Frames delivered with an error, read after a flush */
+} rp_pipeline_t;
+
+rp_pipeline_status_t rp_pipeline_start(rp_pipeline_t *pipeline,
+                                       const rp_pipeline_config_t *config);
+void rp_pipeline_stop(rp_pipeline_t *pipeline);
+
+void rp_pipeline_feed(rp_pipeline_t *pipeline, const uint8_t *data, size_t size,
+                      uint64_t received_ns);
+void rp_pipeline_flush(rp_pipeline_t *pipeline);
+
+#endif // RP_PIPELINE_H
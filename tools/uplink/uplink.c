@@ -0,0 +1,253 @@
+#include "uplink.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+static bool push_segment(rp_uplink_batch_t *batch, uint8_t *data, size_t size);
+static size_t iov_limit(void);
+
+/**
+ * Initializes an empty batch.
+ *
+ * @param batch Batch to initialize
+ * @param iov Storage for the iovec entries
+ * @param iov_capacity Number of entries in `iov`
+ * @param arena Storage for headers and encoded frames, `RP_UPLINK_FRAME_RESERVE` bytes
+ *              per frame always suffice
+ * @param arena_capacity Size of the arena in bytes
+ */
+void rp_uplink_batch_init(rp_uplink_batch_t *batch, struct iovec *iov, size_t iov_capacity,
+                          uint8_t *arena, size_t arena_capacity)
+{
+    if (batch == NULL) {
+        return;
+    }
+
+    batch->iov = iov;
+    batch->iov_capacity = (iov == NULL) ? 0 : iov_capacity;
+    batch->arena = arena;
+    batch->arena_capacity = (arena == NULL) ? 0 : arena_capacity;
+
+    rp_uplink_batch_clear(batch);
+}
+
+/**
+ * Drops every frame from the batch.
+ *
+ * @param batch Batch state
+ */
+void rp_uplink_batch_clear(rp_uplink_batch_t *batch)
+{
+    if (batch == NULL) {
+        return;
+    }
+
+    batch->iov_count = 0;
+    batch->arena_used = 0;
+    batch->frame_count = 0;
+    batch->size = 0;
+}
+
+/**
+ * Places a modem header in the arena and encodes a message directly behind it.
+ *
+ * The header is a few bytes and is copied; the frame is encoded in place. A header
+ * that depends on the frame, such as a length field, can be written through
+ * `result.header` at any time before the batch is sent.
+ *
+ * @param batch Batch state
+ * @param header Modem header sent in front of the frame, or NULL to reserve zeroed space
+ * @param header_size Size of the header, up to `RP_UPLINK_MAX_HEADER_SIZE`
+ * @param fields Message descriptor
+ * @param message Message to encode
+ * @param options Codec options, or NULL for the defaults
+ * @return rp_uplink_add_result_t
+ */
+rp_uplink_add_result_t rp_uplink_batch_add(rp_uplink_batch_t *batch, const uint8_t *header,
+                                           size_t header_size, const pb_msgdesc_t *fields,
+                                           const void *message, const rp_codec_options_t *options)
+{
+    rp_uplink_add_result_t result = {
+        .status = RP_UPLINK_OK,
+        .codec = RP_CODEC_OK,
+        .header = NULL,
+        .frame_size = 0,
+    };
+
+    if (batch == NULL) {
+        result.status = RP_UPLINK_NULL_POINTER;
+        return result;
+    }
+
+    if (header_size > RP_UPLINK_MAX_HEADER_SIZE) {
+        result.status = RP_UPLINK_INVALID_ARGUMENT;
+        return result;
+    }
+
+    if (batch->arena_used + header_size + COBS_ENCODED_MIN_SIZE > batch->arena_capacity) {
+        result.status = RP_UPLINK_FULL;
+        return result;
+    }
+
+    uint8_t *start = &batch->arena[batch->arena_used];
+    size_t frame_capacity = batch->arena_capacity - batch->arena_used - header_size;
+
+    if (frame_capacity > RP_PACKET_MAX_SIZE) {
+        frame_capacity = RP_PACKET_MAX_SIZE;
+    }
+
+    rp_packet_encode_result_t encoded = rp_packet_encode_with_options(
+        &start[header_size], frame_capacity, fields, message, options);
+
+    if (encoded.status != RP_CODEC_OK) {
+        // Running out of arena is not the message's fault
+        bool arena_short =
+            encoded.status == RP_CODEC_OVERFLOW && frame_capacity < RP_PACKET_MAX_SIZE;
+
+        result.status = arena_short ? RP_UPLINK_FULL : RP_UPLINK_ENCODE_FAILED;
+        result.codec = encoded.status;
+        return result;
+    }
+
+    if (!push_segment(batch, start, header_size + encoded.written)) {
+        result.status = RP_UPLINK_FULL;
+        return result;
+    }
+
+    if (header != NULL) {
+        memcpy(start, header, header_size);
+    } else {
+        memset(start, 0, header_size);
+    }
+
+    batch->arena_used += header_size + encoded.written;
+    batch->frame_count++;
+
+    result.header = start;
+    result.frame_size = encoded.written;
+
+    return result;
+}
+
+/**
+ * Adds a caller owned buffer to the batch by reference, for data that is already laid
+ * out elsewhere (a large preamble, a pre-encoded frame). It must stay valid until the
+ * batch has been written.
+ *
+ * @param batch Batch state
+ * @param data Bytes to send
+ * @param size Number of bytes
+ * @return rp_uplink_status_t
+ */
+rp_uplink_status_t rp_uplink_batch_append(rp_uplink_batch_t *batch, const void *data, size_t size)
+{
+    if (batch == NULL || (data == NULL && size > 0)) {
+        return RP_UPLINK_NULL_POINTER;
+    }
+
+    if (size == 0) {
+        return RP_UPLINK_OK;
+    }
+
+    // iovec is not const correct, `writev` only reads
+    return push_segment(batch, (uint8_t *)data, size) ? RP_UPLINK_OK : RP_UPLINK_FULL;
+}
+
+/**
+ * Sends the batch with as few `writev` calls as possible, resuming after short writes,
+ * and clears it. Meant for blocking descriptors; on error the batch keeps whatever was
+ * not written, so the call can be repeated.
+ *
+ * @param batch Batch state
+ * @param fd Serial port, pty or socket of the modem
+ * @return rp_uplink_status_t
+ */
+rp_uplink_status_t rp_uplink_batch_write(rp_uplink_batch_t *batch, int fd)
+{
+    if (batch == NULL) {
+        return RP_UPLINK_NULL_POINTER;
+    }
+
+    size_t limit = iov_limit();
+    size_t first = 0;
+
+    while (first < batch->iov_count) {
+        size_t count = batch->iov_count - first;
+
+        if (count > limit) {
+            count = limit;
+        }
+
+        ssize_t written = writev(fd, &batch->iov[first], (int)count);
+
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // Keep the unsent entries at the front for a retry
+            memmove(&batch->iov[0], &batch->iov[first],
+                    (batch->iov_count - first) * sizeof(batch->iov[0]));
+            batch->iov_count -= first;
+
+            return RP_UPLINK_WRITE_FAILED;
+        }
+
+        size_t remaining = (size_t)written;
+
+        batch->size -= remaining;
+
+        // Skip fully written entries and trim a partially written one
+        while (first < batch->iov_count && remaining >= batch->iov[first].iov_len) {
+            remaining -= batch->iov[first].iov_len;
+            first++;
+        }
+
+        if (remaining > 0) {
+            batch->iov[first].iov_base = (uint8_t *)batch->iov[first].iov_base + remaining;
+            batch->iov[first].iov_len -= remaining;
+        }
+    }
+
+    rp_uplink_batch_clear(batch);
+
+    return RP_UPLINK_OK;
+}
+
+/**
+ * Appends bytes to the iovec array, extending the last entry when they follow it
+ * directly in memory.
+ */
+static bool push_segment(rp_uplink_batch_t *batch, uint8_t *data, size_t size)
+{
+    if (batch->iov_count > 0) {
+        struct iovec *last = &batch->iov[batch->iov_count - 1];
+
+        if ((uint8_t *)last->iov_base + last->iov_len == data) {
+            last->iov_len += size;
+            batch->size += size;
+            return true;
+        }
+    }
+
+    if (batch->iov_count >= batch->iov_capacity) {
+        return false;
+    }
+
+    batch->iov[batch->iov_count++] = (struct iovec){
+        .iov_base = data,
+        .iov_len = size,
+    };
+    batch->size += size;
+
+    return true;
+}
+
+static size_t iov_limit(void)
+{
+    long limit = sysconf(_SC_IOV_MAX);
+
+    // POSIX guarantees at least 16
+    return (limit < 16) ? 16 : (size_t)limit;
+}
@@ -0,0 +1,63 @@
+#ifndef RP_UPLINK_H
+#define RP_UPLINK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include "rp/codec.h"
+
+// Largest radio-modem header `rp_uplink_batch_add` places in front of a frame
+#define RP_UPLINK_MAX_HEADER_SIZE (16)
+
+// Arena space that always fits one more frame with the largest header
+#define RP_UPLINK_FRAME_RESERVE (RP_UPLINK_MAX_HEADER_SIZE + RP_PACKET_MAX_SIZE)
+
+typedef enum rp_uplink_status {
+    RP_UPLINK_OK,
+    RP_UPLINK_NULL_POINTER,
+    RP_UPLINK_INVALID_ARGUMENT,
+    RP_UPLINK_FULL,          /**< No arena space or iovec entry left in the batch */
+    RP_UPLINK_ENCODE_FAILED, /**< See `rp_uplink_add_result_t::codec` */
+    RP_UPLINK_WRITE_FAILED,  /**< `writev` failed, see `errno` */
+} rp_uplink_status_t;
+
+/**
+ * Frames waiting to be sent with a single `writev`.
+ *
+ * Frames are encoded straight into the arena behind their modem header, and the iovec
+ * array references the arena, so nothing is copied between encoding and the system
+ * call. Consecutive frames share one iovec entry; buffers added with
+ * `rp_uplink_batch_append` get their own entries.
+ */
+typedef struct rp_uplink_batch {
+    struct iovec *iov;
+    size_t iov_capacity;
+    size_t iov_count;
+    uint8_t *arena;
+    size_t arena_capacity;
+    size_t arena_used;
+    size_t frame_count;
+    size_t size; /**< Bytes referenced by `iov` */
+} rp_uplink_batch_t;
+
+typedef struct rp_uplink_add_result {
+    rp_uplink_status_t status;
+    rp_codec_status_t codec; /**< Set for `RP_UPLINK_ENCODE_FAILED` */
+    uint8_t *header;         /**< Header in the arena, may be filled in until the write */
+    size_t frame_size;       /**< Encoded frame, including the delimiter, without the header */
+} rp_uplink_add_result_t;
+
+void rp_uplink_batch_init(rp_uplink_batch_t *batch, struct iovec *iov, size_t iov_capacity,
+                          uint8_t *arena, size_t arena_capacity);
+void rp_uplink_batch_clear(rp_uplink_batch_t *batch);
+
+rp_uplink_add_result_t rp_uplink_batch_add(rp_uplink_batch_t *batch, const uint8_t *header,
+                                           size_t header_size, const pb_msgdesc_t *fields,
+                                           const void *message, const rp_codec_options_t *options);
+rp_uplink_status_t rp_uplink_batch_append(rp_uplink_batch_t *batch, const void *data, size_t size);
+
+rp_uplink_status_t rp_uplink_batch_write(rp_uplink_batch_t *batch, int fd);
+
+#endif // RP_UPLINK_H